@@ -0,0 +1,193 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "alloc_stats.h"
+#include "parse_argument.h"
+
+namespace synth {
+struct Structure;
+} // namespace synth
+
+/// @brief  A minimal benchmark harness for the 'bench' target of src/Makefile.
+namespace bench {
+
+// **************************************************************************
+// Input
+// **************************************************************************
+
+/// A pair of the input files.
+struct Input {
+  /// e.g. "small", "medium", "large", "sse-248"
+  std::string name;
+  std::string pdb_file;
+  std::string stride_file;
+  /// The contents of stride_file, to make a fresh pdb::stride_stream for each run.
+  std::string stride_text;
+};
+
+
+
+/// @brief  A synthetic structure written to temporary files (in $TMPDIR or /tmp), which
+///         are removed at the end of the scope.
+class TemporaryStructure {
+public:
+  explicit TemporaryStructure(synth::Structure const& structure);
+  TemporaryStructure(TemporaryStructure const&) = delete;
+  TemporaryStructure & operator=(TemporaryStructure const&) = delete;
+  ~TemporaryStructure();
+
+  std::string pdb_file() const { return prefix + ".pdb"; }
+  std::string stride_file() const { return prefix + ".stride"; }
+
+private:
+  std::string prefix;
+};
+
+
+
+// **************************************************************************
+// Result
+// **************************************************************************
+
+struct Result {
+  std::string name;
+  std::string input;
+  std::size_t iterations;
+  double ns_per_op;
+  /// Items (defined by each benchmark) processed per second.
+  double items_per_s;
+  /// Calls of the global operator new per op. Negative if not measured.
+  double allocs_per_op;
+};
+
+
+
+/// Keep the compiler from optimizing away the computation of \c value .
+template <class T>
+inline void keep(T const& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+
+
+/// A stream buffer that discards everything, to measure the formatting without I/O.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int const c) override { return c; }
+  std::streamsize xsputn(char const *, std::streamsize const n) override { return n; }
+};
+
+
+
+// **************************************************************************
+// Class Runner
+// **************************************************************************
+
+class Runner {
+public:
+  /// @param  min_time_  Each benchmark is repeated until it runs for this many seconds.
+  /// @param  filter_    Only the benchmarks whose names contain this string are run.
+  Runner(double const min_time_, std::string const& filter_):
+    min_time{min_time_}, filter{filter_}
+  {
+    alloc_stats::enable();
+  }
+
+  /// @return true if the benchmark \c name passes the filter.
+  bool selected(std::string const& name) const {
+    return name.find(filter) != std::string::npos;
+  }
+
+  /// @return true if the filter may select a benchmark whose name starts with \c prefix .
+  ///         Used to skip the preparation of a group of benchmarks.
+  bool may_select(std::string const& prefix) const {
+    return prefix.find(filter) != std::string::npos or
+           filter.compare(0, prefix.size(), prefix) == 0 or
+           filter.find('/') == std::string::npos;
+  }
+
+  /// @brief  Measure \c func by calling it repeatedly (doubling the number of calls)
+  ///         until the total time exceeds min_time.
+  /// @param  items_per_op  The number of items one call of \c func processes.
+  template <class Func>
+  void run(std::string const& name, std::string const& input, double const items_per_op,
+           Func func) {
+    if (not selected(name)) {
+      return;
+    }
+
+    // warm up
+    func();
+
+    std::size_t n = 1;
+    while (true) {
+      auto const allocs_before = alloc_stats::n_allocations();
+
+      auto const start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < n; ++i) {
+        func();
+      }
+      std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+      if (min_time <= elapsed.count() or n >= max_iterations) {
+        double const allocs =
+            static_cast<double>(alloc_stats::n_allocations() - allocs_before) /
+            static_cast<double>(n);
+
+        add(Result{name, input, n, elapsed.count() * 1e9 / static_cast<double>(n),
+                   items_per_op * static_cast<double>(n) / elapsed.count(), allocs});
+        return;
+      }
+      n *= 2;
+    }
+  }
+
+  /// Add a result measured elsewhere (e.g. from the profile of the stages).
+  void add(Result const& result) {
+    results.push_back(result);
+  }
+
+  /// Write all the results as a table.
+  void print(std::ostream & os) const;
+
+private:
+  static constexpr std::size_t max_iterations = std::size_t{1} << 30;
+
+  double const min_time;
+  std::string const filter;
+  std::vector<Result> results{};
+};
+
+
+
+// **************************************************************************
+// Suites
+// **************************************************************************
+
+/// The benchmarks of the individual kernels on \c input .
+void micro_benchmarks(Runner & runner, Input const& input);
+
+/// The benchmarks of the whole program on \c input .
+void end_to_end_benchmarks(Runner & runner, Input const& input);
+
+/// @brief  The whole program and each of its stages on synthetic structures of growing
+///         size (see synth::generate()), to show how each stage scales.
+void scaling_benchmarks(Runner & runner);
+
+/// Parse \c args (without the program name) in the same way as the main program.
+bpo::variables_map parse_command_line(std::vector<std::string> args);
+
+} // namespace bench
+
+#endif // ifndef BENCH_BENCH_H_
@@ -0,0 +1,72 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "bench.h"
+#include "pipeline.h"
+
+namespace bench {
+
+// **************************************************************************
+// Function parse_command_line()
+// **************************************************************************
+
+bpo::variables_map parse_command_line(std::vector<std::string> args) {
+  args.insert(args.begin(), "STRIDE2TOP");
+  std::vector<char *> argv;
+  for (auto & arg : args) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+  return arg::parse_arguments(static_cast<int>(args.size()), argv.data());
+} // function parse_command_line()
+
+
+
+// **************************************************************************
+// Function end_to_end_benchmarks()
+// **************************************************************************
+
+void end_to_end_benchmarks(Runner & runner, Input const& input) {
+  NullBuffer null_buffer;
+  std::ostream null_stream{&null_buffer};
+
+  struct Case {
+    std::string name;
+    std::vector<std::string> args;
+    /// Whether the structure is allocated from an arena released after each op, as
+    /// the command does. Otherwise from the heap, for the comparison.
+    bool with_arena;
+  };
+
+  std::vector<Case> const cases{
+    {"e2e/pdb-like", {"-t", "0", "-j", "1"}, true},
+    {"e2e/pdb-like/heap", {"-t", "0", "-j", "1"}, false},
+    {"e2e/mmcif", {"-t", "1", "-j", "1"}, true},
+    {"e2e/pdb-like/extract-3", {"-t", "0", "-j", "1", "-e", "3"}, true},
+    {"e2e/pdb-like/all-threads", {"-t", "0", "-j", "0"}, true},
+  };
+
+  arena::StructureArena memory;
+  for (auto const& c : cases) {
+    auto args = c.args;
+    args.insert(args.end(), {input.pdb_file, input.stride_file});
+    auto const vm = parse_command_line(args);
+
+    // items: structures
+    runner.run(c.name, input.name, 1.0, [&]() {
+      if (c.with_arena) {
+        arena::StructureScope const memory_scope{memory};
+        pipeline::run(vm, null_stream);
+      } else {
+        pipeline::run(vm, null_stream);
+      }
+    });
+  }
+} // function end_to_end_benchmarks()
+
+} // namespace bench
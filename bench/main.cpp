@@ -0,0 +1,130 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "bench.h"
+#include "profile.h"
+
+#include "synth/generator.h"
+
+namespace bench {
+
+constexpr std::size_t Runner::max_iterations;
+
+// **************************************************************************
+// Member Function Runner::print()
+// **************************************************************************
+
+void Runner::print(std::ostream & os) const {
+  os << boost::format("%-36s %-8s %10s %14s %14s %10s\n")
+        % "benchmark" % "input" % "iterations" % "ns/op" % "items/s" % "allocs/op";
+  for (auto const& r : results) {
+    os << boost::format("%-36s %-8s %10d %14.1f %14.1f %10s\n")
+          % r.name % r.input % r.iterations % r.ns_per_op % r.items_per_s
+          % (r.allocs_per_op < 0.0 ? std::string{"-"} :
+                                     (boost::format("%.1f") % r.allocs_per_op).str());
+  }
+} // member function Runner::print()
+
+} // namespace bench
+
+
+
+namespace {
+
+/// @return The whole contents of \c file .
+std::string read_file(std::string const& file) {
+  std::ifstream ifs{file};
+  if (not ifs) {
+    throw std::runtime_error{"Cannot open '" + file + "'"};
+  }
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+
+void usage(std::ostream & os, char const * const prog) {
+  os << "Usage: " << prog << " [--min-time SECONDS] [--filter SUBSTRING] [DATA_DIR]\n"
+     << "  Run the benchmarks on DATA_DIR/{small,medium,large}.{pdb,stride}\n"
+     << "  (6, 20 and 30 strands), on generated structures of 64, 128 and 248 SSEs\n"
+     << "  ('sse-N') and on synthetic structures of growing size ('scale/*').\n"
+     << "  DATA_DIR defaults to 'bench/data'.\n";
+}
+
+} // namespace
+
+
+
+int main(int const argc, char * const * argv) {
+  double min_time = 0.2;
+  std::string filter{""};
+  std::string data_dir{"bench/data"};
+
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg{argv[i]};
+    if (arg == "--min-time" and i + 1 < argc) {
+      min_time = std::stod(argv[++i]);
+    } else if (arg == "--filter" and i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "-h" or arg == "--help") {
+      usage(std::cout, argv[0]);
+      return 0;
+    } else if (arg.size() != 0 and arg[0] != '-') {
+      data_dir = arg;
+    } else {
+      usage(std::cerr, argv[0]);
+      return 1;
+    }
+  }
+
+  try {
+    std::vector<bench::Input> inputs;
+    for (std::string const name : {"small", "medium", "large"}) {
+      auto const base = data_dir + "/" + name;
+      inputs.push_back(bench::Input{name, base + ".pdb", base + ".stride",
+                                    read_file(base + ".stride")});
+    }
+
+    // The checked-in inputs are small, so the larger ones are generated: 4 mixed sheets
+    // with a helix after each strand in a random order, up to the limit of the SSEs
+    // (see pdb::too_many_sses).
+    std::vector<std::unique_ptr<bench::TemporaryStructure>> generated;
+    for (std::size_t const strands : {8, 16, 31}) {
+      synth::Params params;
+      params.sheets = 4;
+      params.strands = strands;
+      params.pattern = "random";
+      params.helix_every = 1;
+      params.shuffle = true;
+      generated.emplace_back(new bench::TemporaryStructure{synth::generate(params)});
+
+      auto const& files = *generated.back();
+      inputs.push_back(bench::Input{"sse-" + std::to_string(2 * params.sheets * strands),
+                                    files.pdb_file(), files.stride_file(),
+                                    read_file(files.stride_file())});
+    }
+
+    bench::Runner runner{min_time, filter};
+    for (auto const& input : inputs) {
+      bench::micro_benchmarks(runner, input);
+    }
+    for (auto const& input : inputs) {
+      bench::end_to_end_benchmarks(runner, input);
+    }
+    bench::scaling_benchmarks(runner);
+    runner.print(std::cout);
+
+  } catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,192 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "functions.h"
+#include "profile.h"
+#include "sheets_out.h"
+#include "stride2top.h"
+#include "substrands.h"
+
+#include "bab/filter.h"
+#include "pdb/sses.h"
+#include "pdb/stride_stream.h"
+#include "sheet/directed_adjacency_list.h"
+#include "sheet/find_cycle.h"
+#include "sheet/pairs.h"
+
+namespace bench {
+
+namespace {
+
+// **************************************************************************
+// Probes: expose the protected kernels to the benchmarks
+// **************************************************************************
+
+class PairsProbe : public sheet::Pairs {
+public:
+  using sheet::Pairs::Pairs;
+  using sheet::Pairs::init_involved_pairs;
+};
+
+
+class AdjacencyProbe : public sheet::DirectedAdjacencyList {
+public:
+  using sheet::DirectedAdjacencyList::DirectedAdjacencyList;
+  using sheet::DirectedAdjacencyList::search_all;
+  using sheet::DirectedAdjacencyList::init_adj_attr;
+};
+
+
+class BabFilterProbe : public bab::BabFilter {
+public:
+  using bab::BabFilter::BabFilter;
+  using bab::BabFilter::count_left_tri;
+  using bab::BabFilter::sides_map;
+};
+
+
+/// Make a fresh stride_stream from the contents of the stride file.
+pdb::stride_stream make_stride(Input const& input) {
+  std::istringstream iss{input.stride_text};
+  return pdb::stride_stream{iss};
+}
+
+
+/// @brief  Construct the DirectedAdjacencyList \c n times with the profile enabled and
+///         add the time of each stage of the construction as a result.
+void construction_stages(Runner & runner, Input const& input, pdb::SSES const& sses,
+                         std::size_t const n) {
+  static char const * const stages[] = {
+    "Pairs", "init_list", "StrictZone", "decide_side", "init_sheets", "init_adj_attr"
+  };
+
+  profile::reset();
+  profile::enable();
+  for (std::size_t i = 0; i < n; ++i) {
+    auto stride = make_stride(input);
+    AdjacencyProbe const adj{sses, stride, sheet::BridgeEngine::Sweep, 1};
+    keep(adj);
+  }
+  profile::disable();
+
+  for (auto const& row : profile::summary()) {
+    for (auto const stage : stages) {
+      std::string const name{"stage/" + row.stage};
+      if (row.stage == stage and runner.selected(name)) {
+        double const ns = row.wall_ms * 1e6 / static_cast<double>(row.calls);
+        runner.add(Result{name, input.name, row.calls, ns, 1e9 / ns, -1.0});
+      }
+    }
+  }
+  profile::reset();
+}
+
+
+/// @return The value of the counter \c c after calling \c func once.
+template <class Func>
+std::size_t count_once(profile::Counter const c, Func func) {
+  profile::reset();
+  profile::enable();
+  func();
+  profile::disable();
+  auto const ret = profile::counter(c);
+  profile::reset();
+  return ret;
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function micro_benchmarks()
+// **************************************************************************
+
+void micro_benchmarks(Runner & runner, Input const& input) {
+  auto stride = make_stride(input);
+  pdb::SSES const sses{input.pdb_file, stride};
+  auto const n_sses = static_cast<double>(sses.data.size());
+
+  // SSES: read the SSE headers and the ATOM lines.
+  runner.run("SSES", input.name, n_sses, [&]() {
+    pdb::SSES const parsed{input.pdb_file, stride};
+    keep(parsed);
+  });
+
+  // Pairs: pick up the hydrogen bonds involved with each strand.
+  PairsProbe const pairs{sses, stride};
+  runner.run("Pairs::init_involved_pairs", input.name, static_cast<double>(pairs.dnr.size()),
+             [&]() {
+    auto const involved = pairs.init_involved_pairs(pairs.dnr, sses);
+    keep(involved);
+  });
+
+  // The whole construction, and each of its stages.
+  auto const n_strands = static_cast<double>(sses.gen_index_vec('E').size());
+  for (auto const engine : {sheet::BridgeEngine::Sweep, sheet::BridgeEngine::StrandTable}) {
+    runner.run(engine == sheet::BridgeEngine::Sweep ? "DirectedAdjacencyList/sweep" :
+                                                      "DirectedAdjacencyList/strand_table",
+               input.name, n_strands, [&]() {
+      AdjacencyProbe const adj{sses, stride, engine, 1};
+      keep(adj);
+    });
+  }
+  construction_stages(runner, input, sses, 200);
+
+  AdjacencyProbe const adj{sses, stride, sheet::BridgeEngine::Sweep, 1};
+
+  // search_bfs() for all the pairs of Sub-Strands.
+  auto const n_bfs = count_once(profile::Counter::BfsInvocations, [&]() {
+    keep(adj.search_all(1));
+  });
+  runner.run("search_all", input.name, static_cast<double>(n_bfs), [&]() {
+    keep(adj.search_all(1));
+  });
+  runner.run("init_adj_attr", input.name, static_cast<double>(n_bfs), [&]() {
+    keep(adj.init_adj_attr(1));
+  });
+
+  // FindCycle for each sheet.
+  runner.run("FindCycle", input.name, static_cast<double>(adj.sheets.size()), [&]() {
+    for (std::size_t i = 0; i < adj.sheets.size(); ++i) {
+      sheet::FindCycle const cycle{adj.sheets[i].substr_keys()};
+      keep(cycle);
+    }
+  });
+
+  // recursive_extract() through extract_adjacent_substr().
+  runner.run("recursive_extract", input.name, static_cast<double>(adj.sheets.size()), [&]() {
+    for (std::size_t i = 0; i < adj.sheets.size(); ++i) {
+      keep(sheets_out::extract_adjacent_substr(3, adj.sheets[i], adj));
+    }
+  });
+
+  // count_left_tri() of each pair of Sub-Strands against all the SSEs.
+  BabFilterProbe const bab_filter{adj};
+  auto const count_all = [&]() {
+    for (auto const& pair : bab_filter.sides_map) {
+      for (auto const& sse : sses.data) {
+        keep(bab_filter.count_left_tri(pair.first.sub0(), pair.first.sub1(), false, false,
+                                       sse.atoms.cbegin(), sse.atoms.cend()));
+      }
+    }
+  };
+  auto const n_tri = count_once(profile::Counter::TriangleTests, count_all);
+  runner.run("BabFilter::count_left_tri", input.name, static_cast<double>(n_tri), count_all);
+
+  // Table formatting (the residue pairs written by stride2top::write()).
+  stride2top::Result residue_pairs;
+  rpo::residue_pair_out(residue_pairs.residue_pairs, adj);
+  runner.run("table/residue_pair", input.name, 1.0, [&]() {
+    std::ostringstream oss;
+    stride2top::write(oss, residue_pairs, 0);
+    keep(oss.str());
+  });
+} // function micro_benchmarks()
+
+} // namespace bench
@@ -0,0 +1,137 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "pipeline.h"
+#include "profile.h"
+
+#include "pdb/tools.h"
+#include "synth/generator.h"
+
+namespace bench {
+
+// **************************************************************************
+// Class TemporaryStructure
+// **************************************************************************
+
+TemporaryStructure::TemporaryStructure(synth::Structure const& structure) {
+  char const * const tmpdir = std::getenv("TMPDIR");
+  prefix = std::string{tmpdir != nullptr ? tmpdir : "/tmp"} + "/stride2top_bench_" +
+           pdb::rand_str(10);
+  synth::write(structure, prefix);
+}
+
+
+TemporaryStructure::~TemporaryStructure() {
+  for (auto const ext : {".pdb", ".stride", ".truth"}) {
+    std::remove((prefix + ext).c_str());
+  }
+}
+
+
+
+namespace {
+
+/// A family of synthetic structures and the sizes to sweep.
+struct Family {
+  std::string name;
+  synth::Params params;
+  /// Set the size of \c params to \c n .
+  void (*resize)(synth::Params & params, std::size_t const n);
+  std::vector<std::size_t> sizes;
+};
+
+
+/// @brief  Run the whole program on \c structure and add the time of it and of each of
+///         its stages as the results of \c family at the size \c n .
+void sweep_point(Runner & runner, Family const& family, std::size_t const n,
+                 synth::Structure const& structure) {
+  TemporaryStructure const files{structure};
+  auto const vm = parse_command_line({"-t", "0", "-j", "1", files.pdb_file(),
+                                      files.stride_file()});
+  NullBuffer null_buffer;
+  std::ostream null_stream{&null_buffer};
+  auto const input = "n=" + std::to_string(n);
+  auto const prefix = "scale/" + family.name + "/";
+
+  // items: strands
+  auto const n_strands = static_cast<double>(family.params.sheets * n);
+  runner.run(prefix + "e2e", input, n_strands, [&]() {
+    pipeline::run(vm, null_stream);
+  });
+
+  // The stages, from the profile of a few runs.
+  constexpr std::size_t n_runs = 3;
+  profile::reset();
+  profile::enable();
+  for (std::size_t i = 0; i < n_runs; ++i) {
+    pipeline::run(vm, null_stream);
+  }
+  profile::disable();
+  for (auto const& row : profile::summary()) {
+    auto const name = prefix + row.stage;
+    if (runner.selected(name)) {
+      double const ns = row.wall_ms * 1e6 / static_cast<double>(n_runs);
+      runner.add(Result{name, input, row.calls, ns, n_strands * 1e9 / ns, -1.0});
+    }
+  }
+  profile::reset();
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function scaling_benchmarks()
+// **************************************************************************
+
+void scaling_benchmarks(Runner & runner) {
+  // The sizes are limited by the number of SSEs (see pdb::too_many_sses).
+  std::vector<Family> families;
+
+  // one antiparallel sheet of n strands
+  families.push_back(Family{"sheet", {}, [](synth::Params & p, std::size_t const n) {
+    p.strands = n;
+  }, {8, 16, 32, 64, 128}});
+
+  // a barrel of n strands
+  families.push_back(Family{"barrel", {}, [](synth::Params & p, std::size_t const n) {
+    p.strands = n;
+  }, {8, 16, 24, 32, 40}});
+  families.back().params.barrel = true;
+
+  // 4 mixed sheets of n strands with a helix after each strand, in a random order
+  families.push_back(Family{"alpha-beta", {}, [](synth::Params & p, std::size_t const n) {
+    p.strands = n;
+  }, {4, 8, 16, 31}});
+  families.back().params.sheets = 4;
+  families.back().params.pattern = "random";
+  families.back().params.helix_every = 1;
+  families.back().params.shuffle = true;
+
+  // one sheet of n strands with n / 4 cross links
+  families.push_back(Family{"cross-linked", {}, [](synth::Params & p, std::size_t const n) {
+    p.strands = n;
+    p.cross_links = n / 4;
+  }, {8, 16, 32, 64}});
+  families.back().params.strand_len = 8;
+
+  for (auto & family : families) {
+    if (not runner.may_select("scale/" + family.name + "/")) {
+      continue;
+    }
+    for (auto const n : family.sizes) {
+      family.resize(family.params, n);
+      sweep_point(runner, family, n, synth::generate(family.params));
+    }
+  }
+} // function scaling_benchmarks()
+
+} // namespace bench
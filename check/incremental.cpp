@@ -0,0 +1,208 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+// Compare the incremental construction of sheet::DirectedAdjacencyList (from the previous
+// frame and a Pairs::Delta) with the construction from scratch.
+//
+// Usage: STRIDE2TOP_CHECK_INCREMENTAL [--seeds N] PREFIX...
+//
+// For each PREFIX.pdb and PREFIX.stride, a sequence of frames is made by dropping a
+// random part of the DNR records (H-bonds) of the stride file, which changes the bridges,
+// the Sub-Strands and the sheets from one frame to the next. Each frame is built from the
+// previous one (itself built incrementally) and from its own H-bonds, and the results of
+// stride2top::analyze() written in both formats, the warnings and the error message if
+// any must be the same. The differing frames are listed and the exit status is 1 if any.
+// The number of the strand components carried over from the previous frames is also
+// printed, to show the part of the incremental construction checked.
+
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "profile.h"
+#include "stride2top.h"
+#include "pdb/sses.h"
+#include "pdb/stride_stream.h"
+#include "pdb/tools.h"
+#include "sheet/directed_adjacency_list.h"
+#include "sheet/pairs.h"
+
+namespace {
+
+using sheet::DirectedAdjacencyList;
+using sheet::Pairs;
+
+/// The number of frames of each sequence, and the fractions of the H-bonds dropped.
+constexpr std::size_t n_frames = 6;
+constexpr double drop_fractions[] = {0.05, 0.1};
+
+
+/// Everything a construction gives: the output in both formats, or the error.
+struct Outcome {
+  std::string output{""};
+  std::vector<std::string> warnings{};
+  std::string error{""};
+
+  bool operator==(Outcome const& other) const {
+    return output == other.output and warnings == other.warnings and error == other.error;
+  }
+};
+
+
+/// @brief  Run \c build and analyze the adjacency list it returns. The adjacency list is
+///         kept in \c adj (null on an error) for the next frame.
+template <class Build>
+Outcome run(Build const& build, std::unique_ptr<DirectedAdjacencyList const> & adj) {
+  Outcome outcome;
+  pdb::WarningCapture const capture{outcome.warnings};
+  try {
+    adj.reset(build());
+    stride2top::Options options;
+    options.threads = 1;
+    auto const result = stride2top::analyze(*adj, options);
+    std::ostringstream oss;
+    stride2top::write(oss, result, 0);
+    stride2top::write(oss, result, 1);
+    outcome.output = oss.str();
+  } catch (std::exception const& e) {
+    adj.reset();
+    outcome.error = e.what();
+  }
+  return outcome;
+}
+
+
+/// @brief  The H-bonds of \c dnr kept in a frame. Each is dropped with the probability
+///         \c fraction .
+std::vector<bool> draw_frame(std::size_t const n, double const fraction, std::mt19937 & rng) {
+  std::bernoulli_distribution drop{fraction};
+  std::vector<bool> kept(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    kept[i] = not drop(rng);
+  }
+  return kept;
+}
+
+
+/// The frames checked.
+struct Tally {
+  std::size_t n_checked{0};
+  /// The frames which can not be analyzed (the same error both ways).
+  std::size_t n_errors{0};
+  /// The differing frames.
+  std::vector<std::string> failed{};
+};
+
+
+/// Check the frames of \c prefix for each seed.
+void check(std::string const& prefix, unsigned const n_seeds, Tally & tally) {
+  std::ifstream pdb_ifs{prefix + ".pdb"};
+  std::ifstream stride_ifs{prefix + ".stride"};
+  if (not pdb_ifs or not stride_ifs) {
+    throw std::runtime_error{"can not read " + prefix + ".pdb and " + prefix + ".stride"};
+  }
+  std::ostringstream stride_text;
+  stride_text << stride_ifs.rdbuf();
+
+  std::istringstream sses_stride_is{stride_text.str()};
+  pdb::stride_stream sses_stride{sses_stride_is};
+  pdb::SSES const sses{pdb_ifs, prefix, sses_stride};
+
+  std::istringstream pairs_stride_is{stride_text.str()};
+  pdb::stride_stream pairs_stride{pairs_stride_is};
+  auto const dnr = Pairs{sses, pairs_stride}.dnr;
+
+  for (unsigned seed = 0; seed < n_seeds; ++seed) {
+    std::mt19937 rng{seed};
+    std::unique_ptr<DirectedAdjacencyList const> previous;
+    std::vector<bool> kept_previous;
+
+    for (std::size_t frame = 0; frame < n_frames; ++frame) {
+      auto const kept = draw_frame(dnr.size(), drop_fractions[frame % 2], rng);
+      Pairs::PairsVec frame_dnr;
+      Pairs::Delta delta;
+      for (std::size_t i = 0; i < dnr.size(); ++i) {
+        if (kept[i]) {
+          frame_dnr.push_back(dnr[i]);
+        }
+        if (previous and kept[i] != kept_previous[i]) {
+          (kept[i] ? delta.added : delta.removed).push_back(dnr[i]);
+        }
+      }
+
+      std::unique_ptr<DirectedAdjacencyList const> full;
+      auto const expected = run([&]() {
+        return new DirectedAdjacencyList{sses, frame_dnr};
+      }, full);
+
+      if (previous) {
+        std::unique_ptr<DirectedAdjacencyList const> incremental;
+        auto const actual = run([&]() {
+          return new DirectedAdjacencyList{sses, *previous, delta};
+        }, incremental);
+
+        ++tally.n_checked;
+        if (not (actual == expected)) {
+          tally.failed.push_back(prefix + " (seed " + std::to_string(seed) + ", frame " +
+                           std::to_string(frame) + ")");
+        } else if (not actual.error.empty()) {
+          ++tally.n_errors;
+        }
+        previous = std::move(incremental);
+      } else {
+        previous = std::move(full);
+      }
+      // the next frame is built from scratch if this one failed
+      kept_previous = kept;
+    }
+  }
+}
+
+} // namespace
+
+
+int main(int const argc, char * const * argv) {
+  unsigned n_seeds = 10;
+  std::vector<std::string> prefixes;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg{argv[i]};
+    if (arg == "--seeds" and i + 1 < argc) {
+      n_seeds = static_cast<unsigned>(std::stoul(argv[++i]));
+    } else {
+      prefixes.push_back(arg);
+    }
+  }
+  if (prefixes.empty()) {
+    std::cerr << "Usage: STRIDE2TOP_CHECK_INCREMENTAL [--seeds N] PREFIX..." << std::endl;
+    return 2;
+  }
+
+  // for the counter of the carried strand components
+  profile::enable();
+
+  Tally tally;
+  try {
+    for (auto const& prefix : prefixes) {
+      check(prefix, n_seeds, tally);
+    }
+  } catch (std::exception const& e) {
+    std::cerr << "Fatal error: " << e.what() << std::endl;
+    return 2;
+  }
+
+  for (auto const& frame : tally.failed) {
+    std::cout << "DIFFERENT: " << frame << std::endl;
+  }
+  std::cout << tally.failed.size() << " of " << tally.n_checked << " frames differ ("
+            << tally.n_errors << " with the same error, "
+            << profile::counter(profile::Counter::ComponentsReused)
+            << " strand components carried over)" << std::endl;
+  return tally.failed.empty() ? 0 : 1;
+}
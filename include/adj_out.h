@@ -4,6 +4,7 @@
 #ifndef ADJ_OUT_H_
 #define ADJ_OUT_H_
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -12,10 +13,25 @@
 
 namespace adj_out {
 
-void adj_list_out(std::ostream & os, sheet::DirectedAdjacencyList const& adj);
+/// One pair of adjacent Sub-Strands in a sheet.
+struct Adjacency {
+  std::size_t sheet_id{0};
+  /// true for Parallel, false for Anti-Parallel
+  bool parallel{false};
+  int delta_1{0};
+  int delta_2{0};
+  unsigned num_bridges{0};
+  std::string substr_0{""};
+  std::string substr_1{""};
+};
 
 
-std::vector<std::string> gen_adj_list_vec(sheet::DirectedAdjacencyList const& adj);
+/// Write \c adj_list as the mmcif-like 'adjacency_list' section.
+void adj_list_out(std::ostream & os, std::vector<Adjacency> const& adj_list);
+
+
+/// List the pairs of adjacent Sub-Strands of each sheet in \c adj .
+std::vector<Adjacency> gen_adj_list(sheet::DirectedAdjacencyList const& adj);
 
 } // namespace adj_out
 
@@ -0,0 +1,26 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef ALLOC_STATS_H_
+#define ALLOC_STATS_H_
+
+#include <cstddef>
+
+/// @brief  Counters of the global operator new, for measuring the allocation pressure.
+///         The global allocation functions are replaced in every build, but they only
+///         count after enable() (called by profile::enable() for '--profile', and by the
+///         benchmarks); until then the cost is one relaxed load per allocation.
+namespace alloc_stats {
+
+/// Start counting. The counts are kept from then on.
+void enable();
+
+/// The number of calls to the global operator new since enable().
+std::size_t n_allocations();
+
+/// The total bytes requested to the global operator new since enable().
+std::size_t n_bytes();
+
+} // namespace alloc_stats
+
+#endif // ifndef ALLOC_STATS_H_
@@ -0,0 +1,146 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef ARCHIVE_H_
+#define ARCHIVE_H_
+
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parse_argument.h"
+#include "pipeline.h"
+#include "pdb/exceptions.h"
+
+/// @brief  Many structures in one input, without extracting them to files:
+///         an uncompressed tar archive of PDB and STRIDE files ('--tar'), or a PDB_FILE
+///         and a STRIDE_FILE holding many entries one after another ('--concatenated').
+///
+///         The members are read one by one and handed to pipeline::run() as in-memory
+///         pipeline::Input, so that only the members not paired yet are kept in memory.
+///         The input and the members may be gzipped. They are read and decompressed in
+///         another thread, a few entries ahead of the analysis.
+namespace archive {
+
+// **************************************************************************
+// Exception class archive_error
+// **************************************************************************
+
+class archive_error: public pdb::fatal_error_base {
+public:
+  explicit archive_error(std::string const& msg_):
+    pdb::fatal_error_base{"ARCHIVE: " + msg_} {}
+}; // Exception class archive_error
+
+
+
+/// A file read from an archive.
+struct Member {
+  std::string name{""};
+  std::string contents{""};
+};
+
+
+
+// **************************************************************************
+// Class TarReader
+// **************************************************************************
+
+/// @brief  Read the regular files of an uncompressed tar archive (ustar, with the GNU and
+///         pax long names) one at a time. The other members (directories, links, ...)
+///         are skipped.
+class TarReader {
+public:
+  explicit TarReader(std::istream & is_): is{is_} {}
+
+  /// @brief  Read the next regular file into \c member .
+  /// @return false at the end of the archive.
+  /// @throw  archive_error  If the archive is truncated or a header is broken.
+  bool next(Member & member);
+
+private:
+  /// Read \c size bytes of the data and the padding after them.
+  std::string read_data(std::size_t const size);
+
+  std::istream & is;
+};
+
+
+
+// **************************************************************************
+// Class EntryReader
+// **************************************************************************
+
+/// @brief  Split a stream of concatenated entries. An entry ends with an 'END' record, or
+///         with an 'ENDMDL' record which closes no 'MODEL' (a bare separator).
+class EntryReader {
+public:
+  explicit EntryReader(std::istream & is_): is{is_} {}
+
+  /// @brief  Read the next non-empty entry (without the separator) into \c text .
+  /// @return false at the end of the stream.
+  bool next(std::string & text);
+
+private:
+  std::istream & is;
+};
+
+
+
+// **************************************************************************
+// Class Pairer
+// **************************************************************************
+
+/// @brief  Pair the PDB and the STRIDE files of the same entry by name. A file whose
+///         name is 'DIR/ID.pdb' (or 'DIR/pdbID.ent') is paired with 'DIR2/ID.stride'
+///         (or '.str'), in any order. At most \c max_pending files wait for their pair;
+///         beyond that the oldest is given up.
+class Pairer {
+public:
+  explicit Pairer(std::size_t const max_pending_): max_pending{max_pending_} {}
+
+  /// @brief  Add \c member .
+  /// @return true if it completed a pair, which is moved to \c input .
+  bool add(Member && member, pipeline::Input & input);
+
+  /// The names of the files given up so far (and cleared).
+  std::vector<std::string> take_dropped();
+
+  /// The names of the files still waiting for their pair.
+  std::vector<std::string> unpaired() const;
+
+private:
+  /// A file waiting for its pair.
+  struct Pending {
+    std::string id;
+    bool is_pdb;
+    Member member;
+  };
+
+  std::size_t const max_pending;
+  /// In the order of arrival.
+  std::list<Pending> pending;
+  std::map<std::pair<std::string, bool>, std::list<Pending>::iterator> index;
+  std::vector<std::string> dropped;
+};
+
+
+/// @brief  The kind of the file \c name ('pdb', 'stride' or '' for neither) and its
+///         entry ID, the basename without the extension (and the 'pdb' prefix of '.ent').
+///         A '.gz' suffix is ignored.
+std::pair<std::string, std::string> classify(std::string const& name);
+
+
+/// @brief  Run the analysis for each entry of the archive or the concatenated files given
+///         in \c vm , and write the results to \c out_stream , each headed by its name.
+///         An entry which fails is reported to standard error and the others go on.
+/// @return The number of the entries which failed or were left without their pair.
+std::size_t run(bpo::variables_map const& vm, std::ostream & out_stream);
+
+} // namespace archive
+
+#endif // ifndef ARCHIVE_H_
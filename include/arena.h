@@ -0,0 +1,386 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/// @brief  Monotonic memory resources and standard allocators on them (C++14 has no
+///         std::pmr).
+///         The temporaries of the path search, sheet::DirectedAdjacencyList::search(),
+///         are allocated from a MonotonicArena of each thread through Allocator.
+///         The containers of a structure (the SSEs, the pairs, the strict zones, the
+///         adjacency lists, the sheets and the rows of the tables) are allocated through
+///         PolymorphicAllocator from the resource installed in the thread. Each worker
+///         (the command line, an entry of an archive, a model of an ensemble, a request
+///         of the server) installs its StructureArena with a StructureScope, and the
+///         arena is released wholesale when the structure has been written.
+///         The results (stride2top::Result) and the outputs use std::allocator, so that
+///         they can outlive the scope.
+namespace arena {
+
+// **************************************************************************
+// Class MonotonicArena
+// **************************************************************************
+
+/// @brief  A memory resource that hands out memory from large blocks and never frees
+///         each allocation. All the memory is released at once by release() or by
+///         the destructor. Like std::pmr::monotonic_buffer_resource, an initial buffer
+///         (e.g. on the stack) can be given so that small workloads do not touch the
+///         heap at all.
+///         Not thread safe. Use one arena per thread.
+class MonotonicArena {
+public:
+  MonotonicArena() = default;
+
+  /// @param  buffer  Initial buffer used before any block is allocated. Not owned.
+  /// @param  size    The size of \c buffer in bytes.
+  MonotonicArena(void * const buffer, std::size_t const size):
+    current{static_cast<unsigned char *>(buffer)}, remaining{size},
+    initial{static_cast<unsigned char *>(buffer)}, initial_size{size}
+  {}
+
+  MonotonicArena(MonotonicArena const&) = delete;
+  MonotonicArena& operator=(MonotonicArena const&) = delete;
+
+  ~MonotonicArena() { release(); }
+
+  /// @brief  Allocate \c bytes bytes aligned to \c align .
+  /// @exception std::bad_alloc If a new block can not be allocated.
+  void * allocate(std::size_t const bytes, std::size_t const align) {
+    auto const addr = reinterpret_cast<std::uintptr_t>(current);
+    std::size_t const padding = (align - addr % align) % align;
+    if (current == nullptr or remaining < padding + bytes) {
+      add_block(bytes + align);
+      return allocate(bytes, align);
+    }
+    current += padding;
+    void * const ret = current;
+    current += bytes;
+    remaining -= padding + bytes;
+    return ret;
+  }
+
+  /// @brief  Make all the memory available again without returning the largest block to
+  ///         the heap, so that an arena reused for similar workloads (e.g. one arena per
+  ///         thread) stops allocating once it is warm. The initial buffer is used again
+  ///         only if no block has been allocated.
+  void reset() {
+    if (blocks == nullptr) {
+      current = initial;
+      remaining = initial_size;
+      return;
+    }
+    // The blocks grow geometrically, so the newest one is the largest.
+    Block * const keep = blocks;
+    blocks = keep->next;
+    release();
+    keep->next = nullptr;
+    blocks = keep;
+    current = reinterpret_cast<unsigned char *>(keep) + sizeof(Block);
+    remaining = keep->size - sizeof(Block);
+    next_block_size = keep->size * 2;
+  }
+
+  /// @brief  Free all the blocks and start again from the initial buffer.
+  void release() {
+    while (blocks != nullptr) {
+      Block * const next = blocks->next;
+      ::operator delete(blocks);
+      blocks = next;
+    }
+    current = initial;
+    remaining = initial_size;
+    next_block_size = first_block_size;
+  }
+
+private:
+  /// Header of each heap block. The memory handed out follows this.
+  struct Block {
+    Block * next;
+    /// The size of the block including this header.
+    std::size_t size;
+  };
+
+  static constexpr std::size_t first_block_size = 4096;
+
+  /// Allocate a new block that has at least \c min_bytes bytes.
+  /// The size of the blocks grows geometrically.
+  void add_block(std::size_t const min_bytes) {
+    std::size_t size = next_block_size;
+    while (size < min_bytes + sizeof(Block)) {
+      size *= 2;
+    }
+    auto * const block = static_cast<Block *>(::operator new(size));
+    block->next = blocks;
+    block->size = size;
+    blocks = block;
+    current = reinterpret_cast<unsigned char *>(block) + sizeof(Block);
+    remaining = size - sizeof(Block);
+    next_block_size = size * 2;
+  }
+
+  unsigned char * current{nullptr};
+  std::size_t remaining{0};
+
+  unsigned char * const initial{nullptr};
+  std::size_t const initial_size{0};
+
+  Block * blocks{nullptr};
+  std::size_t next_block_size{first_block_size};
+};
+
+
+
+// **************************************************************************
+// Class Template Allocator
+// **************************************************************************
+
+/// @brief  Standard allocator that allocates from a MonotonicArena.
+///         deallocate() does nothing; the memory is reclaimed when the arena is released.
+///         The arena must outlive the containers using it.
+template <class T>
+class Allocator {
+public:
+  using value_type = T;
+
+  explicit Allocator(MonotonicArena & a) noexcept: arena{&a} {}
+
+  template <class U>
+  Allocator(Allocator<U> const& other) noexcept: arena{other.arena} {}
+
+  T * allocate(std::size_t const n) {
+    return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, std::size_t) noexcept {}
+
+  template <class U>
+  bool operator==(Allocator<U> const& other) const noexcept { return arena == other.arena; }
+
+  template <class U>
+  bool operator!=(Allocator<U> const& other) const noexcept { return arena != other.arena; }
+
+private:
+  template <class U> friend class Allocator;
+
+  MonotonicArena * arena;
+};
+
+
+
+// **************************************************************************
+// Class MemoryResource
+// **************************************************************************
+
+/// @brief  The interface of the memory resources of PolymorphicAllocator, like
+///         std::pmr::memory_resource.
+class MemoryResource {
+public:
+  virtual ~MemoryResource() = default;
+
+  /// @brief  Allocate \c bytes bytes aligned to \c align .
+  /// @exception std::bad_alloc If the memory can not be allocated.
+  void * allocate(std::size_t const bytes, std::size_t const align) {
+    return do_allocate(bytes, align);
+  }
+
+  /// Give back the memory of allocate(bytes, align).
+  void deallocate(void * const p, std::size_t const bytes, std::size_t const align) {
+    do_deallocate(p, bytes, align);
+  }
+
+protected:
+  virtual void * do_allocate(std::size_t const bytes, std::size_t const align) = 0;
+  virtual void do_deallocate(void * const p, std::size_t const bytes,
+                             std::size_t const align) = 0;
+};
+
+
+/// The resource that uses the global operator new and delete.
+MemoryResource * new_delete_resource() noexcept;
+
+
+namespace detail {
+/// The resource installed in this thread (see StructureScope). nullptr for the default.
+extern thread_local MemoryResource * current_resource;
+} // namespace detail
+
+
+/// @return The resource installed in the calling thread, or new_delete_resource().
+inline MemoryResource * default_resource() noexcept {
+  return detail::current_resource != nullptr ? detail::current_resource
+                                             : new_delete_resource();
+}
+
+
+
+// **************************************************************************
+// Class StructureArena
+// **************************************************************************
+
+/// @brief  The memory of the structures processed by a worker, one after another.
+///         deallocate() does nothing; the memory is reclaimed when the structure is done
+///         (StructureScope). Thread safe, as the stages of a structure run in the threads
+///         of the pool.
+class StructureArena : public MemoryResource {
+public:
+  StructureArena() = default;
+
+  StructureArena(StructureArena const&) = delete;
+  StructureArena& operator=(StructureArena const&) = delete;
+
+  /// Make all the memory available again, keeping the largest block for the next structure.
+  void reset() {
+    std::lock_guard<std::mutex> lock{mutex};
+    arena.reset();
+  }
+
+protected:
+  void * do_allocate(std::size_t const bytes, std::size_t const align) override {
+    std::lock_guard<std::mutex> lock{mutex};
+    return arena.allocate(bytes, align);
+  }
+
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+private:
+  std::mutex mutex{};
+  MonotonicArena arena{};
+};
+
+
+
+// **************************************************************************
+// Class ResourceScope
+// **************************************************************************
+
+/// @brief  Installs a resource in the calling thread from the construction to the
+///         destruction, when the previous one is restored. parallel::for_each_task()
+///         gives its threads the resource of the calling thread with this.
+class ResourceScope {
+public:
+  explicit ResourceScope(MemoryResource * const resource):
+    previous{detail::current_resource}
+  {
+    detail::current_resource = resource;
+  }
+
+  ResourceScope(ResourceScope const&) = delete;
+  ResourceScope& operator=(ResourceScope const&) = delete;
+
+  ~ResourceScope() { detail::current_resource = previous; }
+
+private:
+  MemoryResource * const previous;
+};
+
+
+
+// **************************************************************************
+// Class StructureScope
+// **************************************************************************
+
+/// @brief  Installs \c arena in the calling thread for one structure, and releases its
+///         memory at the destruction. Nothing allocated from the arena may outlive the
+///         scope: the containers of the structure must be destroyed (or moved to
+///         std::allocator) before.
+class StructureScope {
+public:
+  explicit StructureScope(StructureArena & arena_):
+    arena{arena_}, scope{&arena_} {}
+
+  StructureScope(StructureScope const&) = delete;
+  StructureScope& operator=(StructureScope const&) = delete;
+
+  ~StructureScope() { arena.reset(); }
+
+private:
+  StructureArena & arena;
+  ResourceScope const scope;
+};
+
+
+
+// **************************************************************************
+// Class Template PolymorphicAllocator
+// **************************************************************************
+
+/// @brief  Standard allocator that allocates from a MemoryResource, like
+///         std::pmr::polymorphic_allocator. A default constructed allocator (and so a
+///         container constructed without one) takes default_resource(), and so does the
+///         copy of a container, so that a copy made outside of a StructureScope does not
+///         refer to the arena of the structure. Moves and swaps carry the resource along.
+template <class T>
+class PolymorphicAllocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  PolymorphicAllocator() noexcept: resource_{default_resource()} {}
+
+  PolymorphicAllocator(MemoryResource * const resource) noexcept: resource_{resource} {}
+
+  template <class U>
+  PolymorphicAllocator(PolymorphicAllocator<U> const& other) noexcept:
+    resource_{other.resource()} {}
+
+  T * allocate(std::size_t const n) {
+    return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T * const p, std::size_t const n) noexcept {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  PolymorphicAllocator select_on_container_copy_construction() const noexcept {
+    return PolymorphicAllocator{};
+  }
+
+  MemoryResource * resource() const noexcept { return resource_; }
+
+  template <class U>
+  bool operator==(PolymorphicAllocator<U> const& other) const noexcept {
+    return resource_ == other.resource();
+  }
+
+  template <class U>
+  bool operator!=(PolymorphicAllocator<U> const& other) const noexcept {
+    return resource_ != other.resource();
+  }
+
+private:
+  MemoryResource * resource_;
+};
+
+
+/// The containers on PolymorphicAllocator.
+template <class T>
+using vector = std::vector<T, PolymorphicAllocator<T>>;
+
+template <class Key, class T, class Compare = std::less<Key>>
+using map = std::map<Key, T, Compare, PolymorphicAllocator<std::pair<Key const, T>>>;
+
+template <class Key, class T, class Hash = std::hash<Key>, class Pred = std::equal_to<Key>>
+using unordered_map =
+  std::unordered_map<Key, T, Hash, Pred, PolymorphicAllocator<std::pair<Key const, T>>>;
+
+template <class Key, class Hash = std::hash<Key>, class Pred = std::equal_to<Key>>
+using unordered_set = std::unordered_set<Key, Hash, Pred, PolymorphicAllocator<Key>>;
+
+} // namespace arena
+
+#endif // ifndef ARENA_H_
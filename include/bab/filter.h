@@ -72,13 +72,14 @@ struct BabFilterResult {
 
 
   /// If success == false, this variable states the cause of failure.
-  /// Has NO meaning if success == true.
+  /// Has NO meaning if success == true. Always 0 with StatOff.
   /// * 0:  No information.
   /// * 1:  One of the edge SSE is not a strand.
   /// * 2:  No mid-SSEs to perform bab filter.
   /// * 3:  ss0 and ss1 is not reachable or not Parallel.
   /// * 4:  The total number of residues in the mid-part exceeded the limit.
   /// * 5:  The total number of mid-strands in the same sheet exceeded the limit.
+  /// * 6:  The edge SSEs are on different chains.
   unsigned non_bab_reason{0};
 
 
@@ -87,7 +88,7 @@ struct BabFilterResult {
 
   /// The number of residues between the last residue of the first Sub-Strand
   /// and the first residue of the last Sub-Strand. (Strands in the same sheet included).
-  /// NOT COUNTED FOR LOOP REGIONS UNLESS WITH_LOOP IS DEFINED (counted if WITH_LOOP).
+  /// NOT COUNTED FOR LOOP REGIONS UNLESS RUN WITH LoopOn (counted if LoopOn).
   unsigned mid_res_len{0};
 
   /// The total number of triangle atom decision.
@@ -100,6 +101,7 @@ struct BabFilterResult {
   /// The number of strands in the same sheet.
   unsigned n_mid_str{0};
 
+  /// The jump between sub_first and sub_last. Always 0 with StatOff.
   unsigned jump{0};
 
 
@@ -109,6 +111,75 @@ struct BabFilterResult {
 
 
 
+/// @brief  The values of BabFilter::evaluate(ss0, ss1, first, last) before the cut-off
+///         values are applied, recorded by BabFilter::evaluate_raw(). result() gives the
+///         BabFilterResult of a BabFilter with any cut-off values (within the limits given
+///         to evaluate_raw()): success, left_score and tri_atom_count, and mid_res_len
+///         and n_mid_str if succeeded. The other members are not set.
+struct BabFilterRaw {
+  BabFilterRaw() = default;
+
+  BabFilterRaw(sheet::SubStrand const& sub_f, sheet::SubStrand const& sub_l):
+    sub_first{sub_f}, sub_last{sub_l}
+  {}
+
+  /// @brief  The result of the filter with the cut-off values \c c_res_len ,
+  ///         \c c_mid_str and \c c_side_min_dist .
+  BabFilterResult result(unsigned const c_res_len, unsigned const c_mid_str,
+                         double const c_side_min_dist) const;
+
+  /// Whether the mid-SSEs were examined (the edges are parallel strands in a sheet).
+  bool examined{false};
+
+  /// Same as BabFilterResult. Counted until the limits of evaluate_raw() are exceeded.
+  unsigned mid_res_len{0};
+  unsigned n_mid_str{0};
+
+  /// Side::left_distance() of each CA atom and triangle, in ascending order.
+  std::vector<double> left_distances{};
+
+  sheet::SubStrand sub_first{0, 0};
+  sheet::SubStrand sub_last{0, 0};
+};
+
+
+
+// ************************************************************************************
+// Policies
+// ************************************************************************************
+
+/// @brief  Statistics policies of BabFilter.
+///         With \c StatOn, the cause of failure (non_bab_reason) and the jump are
+///         recorded into BabFilterResult. \c StatOff skips all of such bookkeeping.
+struct StatOn  { static constexpr bool enabled = true; };
+struct StatOff { static constexpr bool enabled = false; };
+
+/// @brief  Loop policies of BabFilter.
+///         With \c LoopOn, the loop regions between SSEs are also used for the filtering.
+///         \c LoopOn has an effect only if compiled with WITH_LOOP.
+struct LoopOn  { static constexpr bool enabled = true; };
+struct LoopOff { static constexpr bool enabled = false; };
+
+
+/// @brief  Runtime selection of the policies above.
+///         All the combinations are instantiated, and BabFilter dispatches to one of them.
+struct BabPolicy {
+  BabPolicy() = default;
+  BabPolicy(bool const s, bool const l): stat{s}, loop{l} {}
+
+  /// true for StatOn, false for StatOff.
+  bool stat{true};
+
+  /// true for LoopOn, false for LoopOff.
+  #ifdef WITH_LOOP
+  bool loop{true};
+  #else
+  bool loop{false};
+  #endif // WITH_LOOP
+};
+
+
+
 /// key  : A pair of sub-strands.
 /// value: A vector of Sides between the sub-strands pair.
 using SidesMap = std::unordered_map<sheet::SubStrandsPairKey, std::vector<Side>,
@@ -118,6 +189,23 @@ using SeqIter = std::vector<pdb::IndexType>::const_iterator;
 
 
 
+/// @brief  One unit of work for BabFilter::evaluate_batch().
+///         The SubStrands and the range of SSEs are the same as the arguments to
+///         BabFilter::evaluate(). [first, last) must outlive the batch evaluation.
+struct BabFilterRequest {
+  BabFilterRequest(sheet::SubStrand const& ss0_, sheet::SubStrand const& ss1_,
+                   SeqIter const first_, SeqIter const last_, unsigned const reverse_=0):
+    ss0{ss0_}, ss1{ss1_}, first{first_}, last{last_}, reverse{reverse_} {}
+
+  sheet::SubStrand ss0{0, 0};
+  sheet::SubStrand ss1{0, 0};
+  SeqIter first;
+  SeqIter last;
+  unsigned reverse{0};
+};
+
+
+
 /// Function object to run filter
 using FilterFunc = std::function<bool(bab::SeqIter const, bab::SeqIter const,
                                       unsigned const)>;
@@ -136,7 +224,8 @@ public:
                      unsigned const c_res_len=DEFAULT_MAX_RES_LEN,
                      unsigned const c_mid_str=DEFAULT_MAX_MID_STR,
                      double const c_score=DEFAULT_MAX_SCORE,
-                     double const c_side_min_dist=DEFAULT_SIDE_MIN_DIST):
+                     double const c_side_min_dist=DEFAULT_SIDE_MIN_DIST,
+                     BabPolicy const policy_=BabPolicy{}):
     sses{adj_.sses},
     adj{adj_},
     sides_map{init_sides_map()},
@@ -144,7 +233,9 @@ public:
     cut_off_res_len{c_res_len},
     cut_off_mid_str{c_mid_str},
     cut_off_left_score{c_score},
-    cut_off_side_min_dist{c_side_min_dist}
+    cut_off_side_min_dist{c_side_min_dist},
+    policy{policy_},
+    evaluate_func{select_evaluate(policy_)}
   {}
 
 
@@ -170,17 +261,89 @@ public:
               SeqIter const first, SeqIter const last,
               unsigned const reverse=0);
 
+
+  /// @brief  Const version of operator()(first, last, reverse).
+  ///         Nothing in this object is modified, so a single BabFilter can be shared
+  ///         among threads.
+  /// @return The result of the first sub-strands pair that passed the filter,
+  ///         or the result of the last pair tried if none of them passed.
+  BabFilterResult evaluate(SeqIter const first, SeqIter const last,
+                           unsigned const reverse=0) const;
+
+
+  /// @brief  Const version of operator()(ss0, ss1, first, last, reverse).
+  ///         The same precondition as the non-const version applies.
+  BabFilterResult evaluate(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                           SeqIter const first, SeqIter const last,
+                           unsigned const reverse=0) const;
+
+
+  /// @brief  Run evaluate() for each request, sharing \c sides_map among the threads.
+  /// @param  requests   Units to evaluate.
+  /// @param  n_threads  The number of worker threads. 0 for the number of cores.
+  /// @return Results in the same order as \c requests .
+  std::vector<BabFilterResult> evaluate_batch(std::vector<BabFilterRequest> const& requests,
+                                              unsigned const n_threads=0) const;
+
+
+  /// @brief  Whether the result of evaluate() is regarded as left-handed.
+  ///         Same as the return value of operator().
+  bool passed(BabFilterResult const& result) const {
+    // If success is false, comp need not be evaluated.
+    return result.success and comp(result.left_score, cut_off_left_score);
+  }
+
+  /// Same as above, with the cut-off value \c c_score instead of the one of this filter.
+  bool passed(BabFilterResult const& result, double const c_score) const {
+    return result.success and comp(result.left_score, c_score);
+  }
+
+
+  /// @brief  Examine the same unit as evaluate(ss0, ss1, first, last, reverse), but record
+  ///         the values which the cut-off values are applied to (see BabFilterRaw),
+  ///         so that the result for many cut-off values is derived without the filtering
+  ///         again. The mid-SSEs are examined up to \c max_res_len residues and
+  ///         \c max_mid_str strands in the same sheet, the loosest cut-off values to apply.
+  BabFilterRaw evaluate_raw(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                            SeqIter const first, SeqIter const last,
+                            unsigned const max_res_len, unsigned const max_mid_str,
+                            unsigned const reverse=0) const;
+
+  /// The policies this filter is running with.
+  BabPolicy const& running_policy() const { return policy; }
+
   #ifdef WITH_STAT
+  /// The result of the last call to operator(). Not updated with StatOff.
   BabFilterResult const& result() const { return last_result; }
   #endif // WITH_STAT
 
 
 protected:
 
+  // *********************************************************************************
+  // Protected Member Types
+  // *********************************************************************************
+
+  /// Pointer to one of the instantiations of evaluate_unit().
+  using EvaluateFunc = BabFilterResult (BabFilter::*)(sheet::SubStrand const&,
+                                                      sheet::SubStrand const&,
+                                                      SeqIter const, SeqIter const,
+                                                      unsigned const) const;
+
   // *********************************************************************************
   // Protected Member Functions
   // *********************************************************************************
 
+  /// @brief  Return the instantiation of evaluate_unit() for the given policies.
+  static EvaluateFunc select_evaluate(BabPolicy const& p);
+
+
+  /// @brief  The body of evaluate(ss0, ss1, first, last, reverse).
+  template <class Stat, class Loop>
+  BabFilterResult evaluate_unit(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                                SeqIter const first, SeqIter const last,
+                                unsigned const reverse) const;
+
   /// @brief  Initialize sides map.
   SidesMap init_sides_map() const;
 
@@ -198,14 +361,40 @@ protected:
                                                 ATOM_vec_iter const a_end) const;
 
 
+  /// @brief  count_left_tri() without the cut-off: append Side::left_distance() of each
+  ///         pair of a CA atom and a triangle to \c distances .
+  void collect_left_distances(sheet::SubStrand const& b0, sheet::SubStrand const& b1,
+                              bool const b0_reverse, bool const b1_reverse,
+                              ATOM_vec_iter a_begin, ATOM_vec_iter const a_end,
+                              std::vector<double> & distances) const;
+
+
+  /// @brief  The body of evaluate_raw().
+  template <class Loop>
+  BabFilterRaw evaluate_raw_unit(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                                 SeqIter const first, SeqIter const last,
+                                 unsigned const max_res_len, unsigned const max_mid_str,
+                                 unsigned const reverse) const;
+
+
+  /// @brief  filter_one_unit() recording the values for BabFilterRaw.
+  template <class Loop>
+  BabFilterRaw filter_one_unit_raw(sheet::SubStrand const& b0, sheet::SubStrand const& b1,
+                                   bool const b0_reverse, bool const b1_reverse,
+                                   SeqIter const first, SeqIter const last,
+                                   unsigned const max_res_len,
+                                   unsigned const max_mid_str) const;
+
+
   /// @brief    Run filter for one beta-alpha-beta unit
   /// @return   An object with filter results.
   /// @param first    Iterator to the SSE_ID of the first beta of the unit
   /// @param last     Iterator to the SSE_ID of the last beta of the unit
   /// @param reverse  reverse flag (if i-th bit is 1, an SSE of SSE_ID i is reversed)
+  template <class Stat, class Loop>
   BabFilterResult filter_one_unit(sheet::SubStrand const& b0, sheet::SubStrand const& b1,
                                   bool const b0_reverse, bool const b1_reverse,
-                                  SeqIter const first, SeqIter const last);
+                                  SeqIter const first, SeqIter const last) const;
 
 
   /// Check if the given range [first, last) meets the bab unit condition.
@@ -213,6 +402,7 @@ protected:
   ///          The reason number is consistent with the variable non_bab_reason of
   ///          BabFilterResult class. See non_bab_reason for detailed possible values.
   /// @retval 0 if the range [first, last) meets the condition.
+  template <class Loop>
   unsigned non_bab_condition(SeqIter first, SeqIter last) const;
 
 
@@ -248,6 +438,12 @@ protected:
   /// CA atoms nearer than this value will be ignored.
   double const cut_off_side_min_dist{DEFAULT_SIDE_MIN_DIST};
 
+  /// Statistics and loop policies selected at the construction.
+  BabPolicy const policy{};
+
+  /// evaluate_unit() instantiated for \c policy .
+  EvaluateFunc const evaluate_func{nullptr};
+
   #ifdef WITH_STAT
   BabFilterResult last_result{};
   #endif // WITH_STAT
@@ -75,6 +75,15 @@ public:
                                       double const min_dist=1.0) const;
 
 
+  /// @brief            The signed distance of v from the plane of the triangle, positive on
+  ///                   the left-handed side. on_left_side() is (min_dist < distance,
+  ///                   min_dist < |distance|).
+  /// @param reversed   Same as on_left_side().
+  /// @param myside     Same as on_left_side().
+  double left_distance(Eigen::Vector3d const& v, bool const reversed,
+                       bool const myside) const;
+
+
   // for prototypes
 #ifdef PROTO
   ATOM_vec_iter iter_a0() const { return a0; }
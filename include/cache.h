@@ -0,0 +1,102 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "pdb/exceptions.h"
+
+/// @brief  A content-addressed cache in a directory ('--cache-dir').
+///
+///         Each entry is the file DIR/<kind>/<key>, where the key is the SHA-256 of
+///         everything the contents depend on. Entries are written to a temporary file
+///         and renamed into place, so that any number of processes can share a directory:
+///         a reader sees either no entry or a complete one.
+namespace cache {
+
+/// @brief  The version of the results stored in the cache. Part of the keys of the
+///         results, so that a new version does not reuse the results of an old one.
+///         Increment it whenever the output may change.
+constexpr char const * const results_version = "2";
+
+
+// **************************************************************************
+// Exception class cache_error
+// **************************************************************************
+
+class cache_error: public pdb::fatal_error_base {
+public:
+  explicit cache_error(std::string const& msg_):
+    pdb::fatal_error_base{"CACHE: " + msg_} {}
+}; // Exception class cache_error
+
+
+
+// **************************************************************************
+// Class Sha256
+// **************************************************************************
+
+/// An incremental SHA-256 (FIPS 180-4).
+class Sha256 {
+public:
+  Sha256();
+
+  /// Append \c data to the message.
+  Sha256 & update(std::string const& data);
+
+  /// @brief  Append \c data with its length in front of it, so that the fields of a key
+  ///         can not be confused with each other.
+  Sha256 & field(std::string const& data);
+
+  /// @return The hex digest of the message so far.
+  std::string hex() const;
+
+private:
+  void compress(unsigned char const * const block);
+
+  std::uint32_t state[8];
+  unsigned char buffer[64];
+  std::size_t buffered{0};
+  /// The length of the message in bytes.
+  std::uint64_t length{0};
+};
+
+
+/// @return The hex SHA-256 digest of \c data .
+std::string sha256(std::string const& data);
+
+
+
+// **************************************************************************
+// Class Store
+// **************************************************************************
+
+class Store {
+public:
+  /// @brief  Use the directory \c dir , creating it if needed.
+  /// @throw  cache_error  If the directory can not be created.
+  explicit Store(std::string const& dir);
+
+  /// @return The contents of the entry, or boost::none if not stored.
+  boost::optional<std::string> get(std::string const& kind, std::string const& key) const;
+
+  /// @brief  Store \c contents as the entry. An existing entry is replaced.
+  /// @throw  cache_error  If the entry can not be written.
+  void put(std::string const& kind, std::string const& key,
+           std::string const& contents) const;
+
+  std::string const dir{""};
+
+private:
+  std::string path(std::string const& kind, std::string const& key) const;
+};
+
+} // namespace cache
+
+#endif // ifndef CACHE_H_
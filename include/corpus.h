@@ -0,0 +1,87 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef CORPUS_H_
+#define CORPUS_H_
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "parse_argument.h"
+#include "pdb/exceptions.h"
+
+/// @brief  The corpus mode ('--corpus LIST').
+///
+///         Each structure in LIST is analyzed in its own forked process, at most
+///         '--threads' at once, so that a structure which throws, crashes or runs out of
+///         time or memory is recorded as failed without stopping the others.
+///         Each finished structure is appended to a journal, and the structures already
+///         in the journal are skipped, so an interrupted run resumes where it stopped.
+///
+///         The journal has one tab-separated line per structure:
+///
+///             <PDB_FILE> <status> <error class> <message>
+///
+///         where status is one of 'ok', 'failed' (an exception; the class is its type),
+///         'timeout' ('--time-limit') and 'crashed' (killed by a signal; the class is the
+///         name of the signal).
+///
+///         The output of a structure is written to CORPUS_OUT/<out_file_name()>, first
+///         under the name with '.part' appended, which is renamed when the structure
+///         finished with 'ok' and removed otherwise. So CORPUS_OUT never has the partial
+///         output of a structure which failed, crashed or ran out of time.
+namespace corpus {
+
+// **************************************************************************
+// Exception class corpus_error
+// **************************************************************************
+
+class corpus_error: public pdb::fatal_error_base {
+public:
+  explicit corpus_error(std::string const& msg_):
+    pdb::fatal_error_base{"CORPUS: " + msg_} {}
+}; // Exception class corpus_error
+
+
+
+/// One structure of the corpus.
+struct Entry {
+  std::string pdb_file{""};
+  /// Empty to read the STRIDE output with '--with-stride'.
+  std::string stride_file{""};
+};
+
+
+/// @brief  Read LIST: one structure per line, 'PDB_FILE [STRIDE_FILE]'.
+///         Empty lines and lines starting with '#' are skipped.
+/// @throw  corpus_error  If LIST can not be read.
+std::vector<Entry> read_list(std::string const& list_file);
+
+
+/// @brief  Select the shard \c shard ("K/N") of \c entries : every N-th entry from the K-th.
+/// @throw  arg::argument_error  If \c shard is malformed.
+std::vector<Entry> select_shard(std::vector<Entry> const& entries, std::string const& shard);
+
+
+/// @return The PDB_FILEs already recorded in \c journal_file (none if it does not exist).
+///         A last line without a newline (an interrupted write) is ignored.
+std::set<std::string> read_journal(std::string const& journal_file);
+
+
+/// @brief  The name of the output file of \c pdb_file in CORPUS_OUT: \c pdb_file as given
+///         in LIST with '%' escaped as '%25' and '/' as '%2F', followed by '.out' (e.g.
+///         'a%2Fx.pdb.out' for 'a/x.pdb'). The names of different PDB_FILEs never
+///         collide, and do not depend on the order of LIST or on '--shard'.
+std::string out_file_name(std::string const& pdb_file);
+
+
+/// @brief  Run the corpus mode with the options in \c vm .
+/// @return The number of the structures which did not finish with 'ok' in this run.
+/// @throw  corpus_error  If the output directory or the journal can not be written.
+std::size_t run(bpo::variables_map const& vm);
+
+} // namespace corpus
+
+#endif // ifndef CORPUS_H_
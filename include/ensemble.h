@@ -0,0 +1,71 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef ENSEMBLE_H_
+#define ENSEMBLE_H_
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "parse_argument.h"
+#include "stride2top.h"
+#include "table.h"
+#include "pdb/exceptions.h"
+
+/// @brief  All the MODELs of a multi-model PDB_FILE (an NMR ensemble or the snapshots of
+///         a simulation) in one run ('--models all').
+///
+///         PDB_FILE is read once and split into the models, each with the header records
+///         before the first MODEL (e.g. HELIX and SHEET). The models are analyzed in
+///         parallel, each with its own CA coordinates and hbonds, and the results are
+///         written per model, followed by the 'timeline' table which follows the sheets
+///         and the left-handed connections through the models.
+namespace ensemble {
+
+// **************************************************************************
+// Exception class ensemble_error
+// **************************************************************************
+
+class ensemble_error: public pdb::fatal_error_base {
+public:
+  explicit ensemble_error(std::string const& msg_):
+    pdb::fatal_error_base{"MODELS: " + msg_} {}
+}; // Exception class ensemble_error
+
+
+
+/// A model of a multi-model PDB file.
+struct Model {
+  /// The serial number of the MODEL record (1 if there are no MODEL records).
+  int serial{1};
+  /// The header records and the records of this model, as a single-model PDB file.
+  std::string pdb_text{""};
+};
+
+
+/// @brief  Split \c pdb_text into its models. A file without MODEL records is one model.
+/// @throw  ensemble_error  If a MODEL is not closed by ENDMDL.
+std::vector<Model> split_models(std::string const& pdb_text);
+
+
+/// @brief  The row of the 'timeline' table of a model: the members and the topology
+///         strings (Nomenclature_C) of its sheets, and its left-handed connections
+///         (the handedness score over \c cutoff_left_score ), named as in the members.
+table::Timeline timeline_row(int const serial, stride2top::Result const& result,
+                             double const cutoff_left_score);
+
+
+/// @brief  Analyze every model of PDB_FILE given in \c vm , '--threads' models at once,
+///         and write the results to \c out_stream .
+///         The hbonds are read from STRIDE_FILE, which holds either one stride output
+///         for all the models or one per model separated by 'END' records, or with
+///         '--with-stride' stride is run for each model.
+///         A model which fails is reported to standard error and the others go on.
+/// @return The number of the models which failed.
+std::size_t run(bpo::variables_map const& vm, std::ostream & out_stream);
+
+} // namespace ensemble
+
+#endif // ifndef ENSEMBLE_H_
@@ -14,7 +14,7 @@
 #include "sheet/directed_adjacency_list.h"
 
 #include "data_store.h"
-#include "table.h"
+#include "result.h"
 
 namespace out {
 
@@ -72,15 +72,20 @@ void adj_list_to_dot(std::ostream & ofs, sheet::DirectedAdjacencyList const& adj
 namespace cycles {
 
 /// Output All Cycles Pathes to the out stream.
-void output_cycles(table::Table<table::Cycle> & tbl,
-                   sheet::DirectedAdjacencyList const& adj);
+/// @param  n_threads  The number of threads. 0 for the number of cores.
+void output_cycles(std::vector<stride2top::Cycle> & cycles_out,
+                   sheet::DirectedAdjacencyList const& adj,
+                   unsigned const n_threads = 0);
 
 // Helper Function for output_cycles()
 using CycleMembers = std::vector<sheet::SubStrand>;
 using CyclesVec = std::vector<std::tuple<std::size_t, CycleMembers>>;
 
 /// Given an adjacency list, return a vector of lists of Sub-Strands.
-CyclesVec gen_cycles_vec(sheet::DirectedAdjacencyList const& adj);
+/// The cycles of each sheet are searched in parallel and concatenated in the order
+/// of the sheets.
+CyclesVec gen_cycles_vec(sheet::DirectedAdjacencyList const& adj,
+                         unsigned const n_threads = 0);
 
 } // namespace cycles
 
@@ -129,7 +134,7 @@ public:
 
 namespace rpo {
 int get_resnum(pdb::SSES const& sses, std::size_t const serial_str_id, std::size_t const serial_res_id);
-void residue_pair_out(table::TBLResiduePair & tbl,
+void residue_pair_out(std::vector<stride2top::ResiduePair> & residue_pairs,
                       sheet::DirectedAdjacencyList const& adj);
 
 
@@ -5,28 +5,57 @@
 #define HANDEDNESS_H_
 
 #include <ostream>
+#include <string>
 #include <vector>
-#include <boost/program_options.hpp>
 
 #include "sheet/directed_adjacency_list.h"
 #include "bab/filter.h"
 
-namespace bpo = boost::program_options;
-
 namespace rare {
 
-/// @brief  A helper function of output_handedness. Actually print all left-handed
-///         beta-alpha-beta, beta-loop-beta, or beta-beta(on other sheet)-beta.
+/// One connection between 2 parallel Sub-Strands found by get_handedness().
+struct Handedness {
+  /// The serial names of the Sub-Strands (sheet::SubStrand::string()), as in the table.
+  std::string substr_0{""};
+  std::string substr_1{""};
+  /// @brief  The names of the Sub-Strands in the other tables (out::substr2str::str()),
+  ///         e.g. in the members of the sheets.
+  std::string name_0{""};
+  std::string name_1{""};
+  /// The left-handedness score (bab::BabFilterResult::left_score).
+  double score{0.0};
+  unsigned mid_residues{0};
+  unsigned mid_strands{0};
+  /// "beta-alpha-beta", "beta-loop-beta", "beta-beta-beta" or "beta-alpha(+beta)-beta"
+  std::string type{""};
+  unsigned jump{0};
+};
+
+
+/// The number of pairs of Sub-Strands evaluated by a batch in get_handedness() (at least).
+#define HANDEDNESS_BATCH_SIZE 4096
+
+/// @brief  Run \c bab_filter on all the ranges of SSEs and return the results of the
+///         ranges which are beta-alpha-beta, beta-loop-beta, or beta-beta(on other
+///         sheet)-beta units, no matter whether left-handed or not.
+///         The pairs of Sub-Strands of the ranges are evaluated in batches of
+///         HANDEDNESS_BATCH_SIZE (BabFilter::evaluate_batch()), and the result of each
+///         range is the same as that of BabFilter::evaluate().
+/// @param  n_threads  The number of threads. 0 for the number of cores.
 std::vector<bab::BabFilterResult> get_handedness(sheet::DirectedAdjacencyList const& adj,
-                                                 bab::BabFilter & bab_filter);
+                                                 bab::BabFilter const& bab_filter,
+                                                 unsigned const n_threads = 0);
+
 
+/// @brief  Same as get_handedness(), but return the results as Handedness objects.
+std::vector<Handedness> find_handedness(sheet::DirectedAdjacencyList const& adj,
+                                        bab::BabFilter const& bab_filter,
+                                        unsigned const n_threads = 0);
 
 
-/// @brief  Read the arguments and generate bab::BabFilter object, and then,
-///         call print_handedness() to output the results.
+/// @brief  Write \c found as the mmcif-like 'handedness' section.
 /// @return If there is at least 1 connection to output.
-bool output_handedness(std::ostream & os, sheet::DirectedAdjacencyList const& adj,
-                       bpo::variables_map const& vm);
+bool output_handedness(std::ostream & os, std::vector<Handedness> const& found);
 
 } // namespace rare
 
@@ -0,0 +1,121 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "profile.h"
+
+namespace parallel {
+
+// **************************************************************************
+// Function n_workers()
+// **************************************************************************
+
+/// @brief  Decide the number of worker threads.
+/// @param  requested  The number of threads requested. 0 for the number of cores.
+/// @param  n_tasks    The number of tasks to run. No more threads than this are used.
+/// @return A value in [1, max(n_tasks, 1)].
+inline unsigned n_workers(unsigned const requested, std::size_t const n_tasks) {
+  unsigned n = requested != 0 ? requested : std::thread::hardware_concurrency();
+  if (n_tasks < n) {
+    n = static_cast<unsigned>(n_tasks);
+  }
+  return std::max(n, 1u);
+} // function n_workers()
+
+
+
+namespace detail {
+
+/// @brief  Call \c task(k) for every k in [0, n_tasks) on the calling thread and at most
+///         \c max_helpers threads of the pool shared by the process, and return when all
+///         the calls have returned. \c task must not throw.
+void run_on_pool(std::size_t const n_tasks, unsigned const max_helpers,
+                 std::function<void(std::size_t)> const& task);
+
+} // namespace detail
+
+
+
+// **************************************************************************
+// Function for_each_task()
+// **************************************************************************
+
+/// @brief  Call \c func(k) for every k in [0, n_tasks) using \c n_threads threads
+///         (including the calling thread).
+///         Tasks are handed out one at a time from a shared counter, so a thread that
+///         finished early takes over the remaining tasks of the others.
+///         The order in which the tasks run is unspecified. Callers that need a
+///         deterministic output should store the result of task k at index k.
+///         The threads tag their stages with the structure of the calling thread
+///         (profile::StructureScope) and allocate from its memory resource
+///         (arena::ResourceScope).
+///
+///         The other threads are taken from a pool shared by the whole process, which
+///         grows up to the largest \c n_threads - 1 requested. A nested call (e.g. the
+///         pair scoring in a stage of run_stages(), or a request of the server) gets
+///         the threads of the pool as they become idle instead of starting its own, so
+///         the threads are not multiplied by the nesting. The pool must not be used
+///         before fork() if the child process uses it.
+/// @exception  If any call of \c func throws, the exception thrown by the task with
+///             the smallest k is rethrown after all the tasks have finished.
+template <class Func>
+void for_each_task(std::size_t const n_tasks, unsigned const n_threads, Func func) {
+  auto const n = n_workers(n_threads, n_tasks);
+
+  std::mutex error_mutex;
+  std::size_t error_task = std::numeric_limits<std::size_t>::max();
+  std::exception_ptr error{nullptr};
+
+  auto const structure = profile::structure();
+  auto const resource = arena::default_resource();
+  std::function<void(std::size_t)> const task = [&](std::size_t const k) {
+    profile::StructureScope const scope{structure};
+    arena::ResourceScope const memory{resource};
+    try {
+      func(k);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{error_mutex};
+      if (k < error_task) {
+        error_task = k;
+        error = std::current_exception();
+      }
+    }
+  };
+  detail::run_on_pool(n_tasks, n - 1, task);
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+} // function for_each_task()
+
+
+
+// **************************************************************************
+// Function run_stages()
+// **************************************************************************
+
+/// @brief  Run independent stages concurrently on \c n_threads threads.
+///         A stage that depends on another should be put together into one stage.
+///         With 1 thread, the stages run in the order of \c stages .
+/// @exception  Same as for_each_task(). The exception of the earliest stage is rethrown,
+///             as it would be if the stages ran one after another.
+inline void run_stages(std::vector<std::function<void()>> const& stages,
+                       unsigned const n_threads) {
+  for_each_task(stages.size(), n_threads, [&stages](std::size_t const k) { stages[k](); });
+} // function run_stages()
+
+} // namespace parallel
+
+#endif // ifndef PARALLEL_H_
@@ -5,6 +5,8 @@
 #define PARSE_ARGUMENT_H_
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
@@ -53,6 +55,12 @@ bpo::variables_map parse_cmd_arg(int const argc, char* const * argv,
 bpo::variables_map parse_arguments(int const argc, char* const * argv);
 
 
+/// @brief  Parse the arguments of a request in the server mode. Unlike parse_arguments(),
+///         nothing is written to the standard streams and PDB_FILE is not required.
+/// @throw  argument_error
+bpo::variables_map parse_request_arguments(std::vector<std::string> const& args);
+
+
 /// A function object to output help message.
 class Help {
 public:
@@ -83,6 +91,10 @@ private:
 pdb::stride_stream stride_from_argument(bpo::variables_map const& vm);
 
 
+/// Whether every MODEL is to be analyzed ('--models all').
+bool all_models(bpo::variables_map const& vm);
+
+
 } // namespace arg
 
 #endif // ifndef PARSE_ARGUMENT_H_
@@ -40,6 +40,11 @@ public:
   explicit ATOM(Eigen::Vector3d const& xyz_):
     xyz{xyz_}, pdb{false} {}
 
+  /// Constructs from a 3D Eigen vector, with real coordinates if \c pdb_ is true
+  /// (e.g. the coordinates given in memory instead of a PDB line).
+  ATOM(Eigen::Vector3d const& xyz_, bool const pdb_):
+    xyz{xyz_}, pdb{pdb_} {}
+
 
   bool operator==(ATOM const& other) const {
     return xyz == other.xyz and pdb == other.pdb;
@@ -160,5 +160,18 @@ public:
 
 
 
+// *******************************************************************
+// Exception class too_many_sses
+// *******************************************************************
+//
+class too_many_sses: public fatal_error_base {
+public:
+  too_many_sses(std::size_t const n, std::size_t const max):
+    fatal_error_base{"TOO MANY SSEs: " + std::to_string(n) + " "
+                     "(MAX = " + std::to_string(max) + ")"} {}
+}; // Exception class too_many_sses
+
+
+
 } // namespace pdb
 #endif // ifndef PDB_EXCEPTIONS_H_
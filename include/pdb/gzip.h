@@ -0,0 +1,103 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef PDB_GZIP_H_
+#define PDB_GZIP_H_
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "exceptions.h"
+
+namespace pdb {
+
+// **************************************************************************
+// Exception class gzip_error
+// **************************************************************************
+
+class gzip_error: public fatal_error_base {
+public:
+  explicit gzip_error(std::string const& msg_):
+    fatal_error_base{"GZIP: " + msg_} {}
+}; // Exception class gzip_error
+
+
+
+class Inflater;
+
+// **************************************************************************
+// Class decompress_buf
+// **************************************************************************
+
+/// @brief  A read-only stream buffer over \c src , which decompresses the data if it starts
+///         with the gzip magic bytes (RFC 1952, any number of members) and passes it
+///         through as it is otherwise. The data is decompressed on demand, a buffer at a
+///         time, with a self-contained inflate (RFC 1951).
+class decompress_buf: public std::streambuf {
+public:
+  explicit decompress_buf(std::streambuf * const src);
+  ~decompress_buf();
+
+  decompress_buf(decompress_buf const&) = delete;
+  decompress_buf & operator=(decompress_buf const&) = delete;
+
+protected:
+  /// @throw  gzip_error  If the compressed data is broken or truncated.
+  int_type underflow() override;
+
+  /// Only rewinding (to the position 0) is supported, if \c src can seek.
+  pos_type seekpos(pos_type const pos, std::ios::openmode const which) override;
+
+private:
+  /// Start the next gzip member. @return false at the end of the data.
+  bool start_member();
+
+  std::unique_ptr<Inflater> inflater;
+  std::vector<char> buffer;
+  /// Unknown until the first read.
+  enum class Mode {Unknown, Plain, Gzip, End} mode{Mode::Unknown};
+  std::uint32_t crc{0};
+  std::uint32_t size{0};
+};
+
+
+
+// **************************************************************************
+// Class input_stream
+// **************************************************************************
+
+/// @brief  An input stream of a file or another stream, which is decompressed if gzipped
+///         (see decompress_buf). Used by the PDB and STRIDE readers in place of
+///         std::ifstream.
+class input_stream: public std::istream {
+public:
+  /// @throw  open_file_error  If \c filename can not be opened.
+  explicit input_stream(std::string const& filename);
+
+  /// Read \c is (e.g. std::cin).
+  explicit input_stream(std::istream & is);
+
+private:
+  std::filebuf file;
+  decompress_buf buf;
+};
+
+
+/// @return Whether \c data starts with the gzip magic bytes.
+bool is_gzip(std::string const& data);
+
+/// @return \c data decompressed if gzipped, or \c data as it is.
+/// @throw  gzip_error  If the compressed data is broken or truncated.
+std::string decompress(std::string data);
+
+/// @return Whether the file \c filename is gzipped.
+bool is_gzip_file(std::string const& filename);
+
+} // namespace pdb
+
+#endif // ifndef PDB_GZIP_H_
@@ -23,9 +23,8 @@ public:
   // Public Member Functions
   // *********************************************************************************
 
-  LOOP(int const i, int const e, IndexType const ind,
-       std::unordered_map<int, std::string> const& ca_lines):
-    SSE_Base{i, e, ind, ca_lines}, zero_size{false}
+  LOOP(int const i, int const e, IndexType const ind, CAAtoms const& ca_atoms):
+    SSE_Base{i, e, ind, ca_atoms}, zero_size{false}
    {}
 
   LOOP(int const i, int const e, IndexType const ind):
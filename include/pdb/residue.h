@@ -0,0 +1,113 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef PDB_RESIDUE_H_
+#define PDB_RESIDUE_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace pdb {
+
+// ************************************************************************
+// Struct ResidueKey
+// ************************************************************************
+
+/// A residue as it is written in the PDB and STRIDE files.
+struct ResidueKey {
+  /// The chain ID (' ' if blank)
+  char chain{' '};
+  /// The residue sequence number (decoded from hybrid-36)
+  int seq{0};
+  /// The insertion code (' ' if blank)
+  char icode{' '};
+
+  bool operator==(ResidueKey const& other) const {
+    return chain == other.chain and seq == other.seq and icode == other.icode;
+  }
+
+  bool operator<(ResidueKey const& other) const {
+    if (chain != other.chain) { return chain < other.chain; }
+    if (seq != other.seq) { return seq < other.seq; }
+    return icode < other.icode;
+  }
+}; // struct ResidueKey
+
+
+
+/// @brief  Decode a 4-column residue sequence number field of a PDB file,
+///         in decimal or in hybrid-36 (A000 = 10000, ..., a000 = 10000 + 26 * 36^3, ...)
+///         for the structures with more than 9999 residues in a chain.
+/// @throw  std::invalid_argument  If \c field is not a number.
+int decode_hybrid36(std::string const& field);
+
+
+/// @brief  Read the residue written as a token (like "52", "52A" or "A0B1") which starts
+///         at or after \c pos of \c line (e.g. the STRIDE records).
+/// @throw  std::invalid_argument  If there is no number there.
+ResidueKey parse_residue_token(std::string const& line, std::size_t const pos,
+                               char const chain);
+
+
+
+// ************************************************************************
+// Class ResidueNumbering
+// ************************************************************************
+
+/// @brief  Give the residues (chain, sequence number and insertion code) the internal
+///         residue numbers, which the analysis uses for the ranges of the SSEs and the
+///         hbonds.
+///
+///         The numbers increase in the order of the residues in the file. The gaps in a
+///         chain are kept, and the chains are separated by a gap, so that the residues
+///         of different chains are never adjacent. The internal number of a structure
+///         with one chain and without insertion codes is its sequence number.
+///
+///         The gap alone does not tell a chain break from missing residues, so the
+///         first internal number of each chain is recorded as well (see chain_index()).
+class ResidueNumbering {
+public:
+  using Residues = std::vector<std::pair<int, ResidueKey>>;
+
+  /// @brief  Add the residue \c key after the ones already added, if not added yet.
+  /// @return The internal number of \c key .
+  int add(ResidueKey const& key);
+
+  /// @brief  The internal number of \c key . A residue not added (e.g. one without the
+  ///         CA atom) is numbered from the nearest residue of the same chain. A blank
+  ///         chain ID (or '-') matches the only chain.
+  /// @return boost::none if the chain of \c key is unknown.
+  boost::optional<int> find(ResidueKey const& key) const;
+
+  /// The residues in the order added, with their internal numbers.
+  Residues const& residues() const { return residues_data; }
+
+  /// Whether the internal numbers are the sequence numbers (see the class description).
+  bool identity() const { return is_identity; }
+
+  /// @brief  The index of the chain of the internal number \c number , counted in the
+  ///         order of the chains in the file (a chain which appears again after another
+  ///         chain counts again). 0 if nothing is added.
+  std::size_t chain_index(int const number) const;
+
+private:
+  /// The chain ID which \c chain stands for.
+  char resolve_chain(char const chain) const;
+
+  std::map<ResidueKey, int> numbers{};
+  Residues residues_data{};
+  /// The chain IDs in the order added
+  std::string chains{};
+  /// The internal number of the first residue of each chain, in the order added
+  std::vector<int> chain_starts{};
+  bool is_identity{true};
+}; // class ResidueNumbering
+
+} // namespace pdb
+
+#endif // ifndef PDB_RESIDUE_H_
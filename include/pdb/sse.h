@@ -10,6 +10,9 @@
 #include <vector>
 
 #include <Eigen/Core>
+#include <boost/optional.hpp>
+
+#include "arena.h"
 
 #include "pdb/constants.h"
 #include "pdb/exceptions.h"
@@ -19,7 +22,10 @@
 namespace pdb {
 
 
-using ATOM_vec_iter = std::vector<ATOM>::const_iterator;
+using ATOM_vec_iter = arena::vector<ATOM>::const_iterator;
+
+/// The CA ATOMs of a structure (key = residue number).
+using CAAtoms = arena::unordered_map<int, ATOM>;
 
 
 // ************************************************************************
@@ -34,8 +40,8 @@ public:
   SSEReprInfo(char const type, unsigned const intrvl_) :
     len{type == 'H' ? 4u : 2u},
     coeff{type == 'H' ?
-            std::vector<double>{{0.74, 1.0, 1.0, 0.74}} :
-            std::vector<double>{{1.0, 1.0}}},
+            arena::vector<double>{{0.74, 1.0, 1.0, 0.74}} :
+            arena::vector<double>{{1.0, 1.0}}},
     div{type == 'H' ? 3.48 : 2.0},
     intrvl{intrvl_}
   {
@@ -45,7 +51,7 @@ public:
   }
 
   unsigned const len{0};
-  std::vector<double> const coeff{0};
+  arena::vector<double> const coeff{0};
   double const div{0.0};
   unsigned const intrvl{0};
 }; // struct SSEReprInfo
@@ -76,13 +82,12 @@ struct SSE_Header {
 // ************************************************************************
 class SSE_Base {
 public:
-  SSE_Base(int const i, int const e, IndexType const ind,
-           std::unordered_map<int, std::string> const& ca_lines):
+  SSE_Base(int const i, int const e, IndexType const ind, CAAtoms const& ca_atoms):
     init{i},
     end{e < init ?
       throw invalid_sse_range(init, e, "In constructor of class SSE"): e},
-    index{ind}, entire{entirety_check(ca_lines)},
-    atoms{read_pdb_atom(ca_lines)},
+    index{ind}, entire{entirety_check(ca_atoms)},
+    atoms{read_pdb_atom(ca_atoms)},
     n_pdb{count_real_atoms()}
   {}
 
@@ -108,18 +113,18 @@ public:
 
 
   /// Stores the ATOM class objects of the input PDB file.
-  std::vector<ATOM> const atoms{};
+  arena::vector<ATOM> const atoms{};
 
   /// The total number of real ATOMs (not padding atoms, ATOM::pdb == true)
   unsigned const n_pdb{0};
 
 protected:
   /// Check whether this SSE has all the ATOMs or not
-  bool entirety_check(std::unordered_map<int, std::string> const& ca_lines) const;
+  bool entirety_check(CAAtoms const& ca_atoms) const;
 
 
-  /// Read ca_lines and generate a vector of ATOMs
-  std::vector<ATOM> read_pdb_atom(std::unordered_map<int, std::string> const& ca_lines) const;
+  /// Pick the ATOMs in range from ca_atoms, padded for the missing residues.
+  arena::vector<ATOM> read_pdb_atom(CAAtoms const& ca_atoms) const;
 
   /// Count the number of pdb ATOMs to initialize n_pdb.
   unsigned count_real_atoms() const;
@@ -139,7 +144,7 @@ public:
   // ************************************************************************
 
   /// A vector of SSE_Header (std::tuple<char, int, int>)
-  using SSE_Header_vec = std::vector<SSE_Header>;
+  using SSE_Header_vec = arena::vector<SSE_Header>;
 
   using vec_str_itr = std::vector<std::string>::const_iterator;
 
@@ -150,8 +155,8 @@ public:
 
   /// @brief constructor
   SSE(SSE_Header const& header, IndexType const index_,
-      std::unordered_map<int, std::string> const& ca_lines, unsigned const intrvl=1) :
-    SSE_Base{header.init, header.end, index_, ca_lines},
+      CAAtoms const& ca_atoms, unsigned const intrvl=1) :
+    SSE_Base{header.init, header.end, index_, ca_atoms},
 
     type{header.type != 'H' and header.type != 'E' ?
       throw unknown_sse_type(header.type, "In constructor of class SSE") : header.type},
@@ -275,7 +280,8 @@ protected:
 
 
   /// Generate one representative ATOM object begins with resnum first.
-  ATOM gen_representative_atom(int const first) const;
+  /// @return boost::none if a padding ATOM is found in the range.
+  boost::optional<ATOM> gen_representative_atom(int const first) const;
 
 
   /// @brief  Check if the representative atoms were generated properly.
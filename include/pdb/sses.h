@@ -7,8 +7,13 @@
 #include <string>
 #include <vector>
 
+#include <boost/optional.hpp>
+
+
+#include "arena.h"
 #include "pdb/constants.h"
 #include "pdb/loop.h"
+#include "pdb/residue.h"
 #include "pdb/sse.h"
 #include "pdb/stride_stream.h"
 
@@ -17,7 +22,7 @@ namespace pdb {
 /// Compare the range of an SSE and the resnum
 class ResnumSSEComp {
 public:
-  ResnumSSEComp(std::vector<SSE> const& data_, int const n_offset_, int const c_offset_):
+  ResnumSSEComp(arena::vector<SSE> const& data_, int const n_offset_, int const c_offset_):
     data{data_}, n_offset{n_offset_}, c_offset{c_offset_} {}
 
   bool operator() (IndexType const id, int const resnum) const {
@@ -29,7 +34,7 @@ public:
   }
 
 protected:
-  std::vector<SSE> const& data;
+  arena::vector<SSE> const& data;
   int const n_offset;
   int const c_offset;
 };
@@ -56,6 +61,7 @@ public:
     loops_data{},
     #endif // WITH_LOOP
 
+    numbering_data{},
     data{read_pdb(stride)},
     size{data.size()},
     index_vec{init_index_vec()},
@@ -70,6 +76,53 @@ public:
   }
 
 
+  /// @brief  Read the PDB data from \c pdb_is instead of a file (e.g. the contents
+  ///         received by the server mode).
+  /// @param  name  Stored as pdb_file. Only used in the messages.
+  SSES(std::istream & pdb_is, std::string const& name,
+       stride_stream & stride=empty_stride_stream) :
+    pdb_file{name},
+    #if defined(DRYRUN) || defined(NATIVE_DRYRUN)
+    pdb_basename{basename(pdb_file)},
+    answer{""},
+    #endif // DRYRUN
+
+    #ifdef WITH_LOOP
+    loops_data{},
+    #endif // WITH_LOOP
+
+    numbering_data{},
+    data{read_pdb(pdb_is, stride)},
+    size{data.size()},
+    index_vec{init_index_vec()},
+    serial_strand_id{init_serial_strand_id()}
+  {}
+
+
+  /// @brief  Construct from the data in memory instead of the PDB and stride text
+  ///         (see stride2top::analyze()).
+  /// @param  headers   The SSEs, in any order.
+  /// @param  ca_atoms  The CA ATOMs (key = residue number).
+  /// @param  name      Stored as pdb_file. Only used in the messages.
+  SSES(SSE::SSE_Header_vec headers, CAAtoms const& ca_atoms, std::string const& name) :
+    pdb_file{name},
+    #if defined(DRYRUN) || defined(NATIVE_DRYRUN)
+    pdb_basename{basename(pdb_file)},
+    answer{""},
+    #endif // DRYRUN
+
+    #ifdef WITH_LOOP
+    loops_data{},
+    #endif // WITH_LOOP
+
+    numbering_data{},
+    data{build(sort_headers(std::move(headers)), ca_atoms)},
+    size{data.size()},
+    index_vec{init_index_vec()},
+    serial_strand_id{init_serial_strand_id()}
+  {}
+
+
   /// Member Access Operator
   SSE const& operator[](IndexType const i) const {
     return data[i];
@@ -94,6 +147,14 @@ public:
   IndexType sse_ind_of(int const resnum, char const type, int const offset,
                     bool const with_too_short, char const hbond_atom) const;
 
+  /// @brief  Non-throwing version of sse_ind_of() for the callers which expect loop
+  ///         residues as a normal case.
+  /// @return boost::none if \c resnum is not found in any SSEs.
+  /// @throw  pdb::unkown_sse_type If parameter 'type' is none of {'H', 'E', or 'A'}.
+  boost::optional<IndexType> find_sse_ind(int const resnum, char const type,
+                                          int const offset, bool const with_too_short,
+                                          char const hbond_atom) const;
+
 
   /// @brief  Generate a vector of \c IndexType s for the specified type
   /// @param type             Type of SSEs to generate the index vector. Must be one of
@@ -104,9 +165,21 @@ public:
   #ifdef WITH_LOOP
   /// Access loops_data with range check.
   LOOP const& loop(IndexType const n) const;
-  std::vector<LOOP> const& loops() const { return loops_data; }
+  arena::vector<LOOP> const& loops() const { return loops_data; }
   #endif // WITH_LOOP
 
+  /// @brief  The internal residue numbers of the residues in the PDB data (empty if
+  ///         constructed from the data in memory). All the residue numbers in the SSEs
+  ///         and the hbonds are these numbers.
+  ResidueNumbering const& numbering() const { return numbering_data; }
+
+  /// @brief  Whether the SSEs \c i and \c j are on the same chain. Always true if
+  ///         constructed from the data in memory, which has no chain.
+  bool same_chain(IndexType const i, IndexType const j) const {
+    return numbering_data.chain_index(data[i].init) ==
+           numbering_data.chain_index(data[j].init);
+  }
+
 
   // *********************************************************************************
   // Protected Member Variables
@@ -123,13 +196,18 @@ public:
 
   #ifdef WITH_LOOP
 protected:
-  std::vector<LOOP> loops_data{};
+  arena::vector<LOOP> loops_data{};
 
 public:
   #endif // RWITH_LOOP
 
+protected:
+  /// Filled by read_ca_atoms().
+  ResidueNumbering numbering_data{};
+
+public:
 
-  std::vector<SSE> const data{};
+  arena::vector<SSE> const data{};
   std::size_t const size{0};
 
   std::vector<std::vector<IndexType>> const index_vec{};
@@ -144,13 +222,23 @@ protected:
 
   /// @brief  Read the SSE header (or stride file) and ATOM lines of pdb_file.
   /// @return sse_vec
-  std::vector<SSE> read_pdb(stride_stream & stride);
+  arena::vector<SSE> read_pdb(stride_stream & stride);
+
+  /// @brief  A version of read_pdb() that reads the PDB data from \c pdb_is .
+  arena::vector<SSE> read_pdb(std::istream & pdb_is, stride_stream & stride);
+
+  /// @brief  Generate the SSEs (and the loops between them) from the sorted \c headers .
+  /// @throw  pdb::too_many_sses  If the SSEs can not be indexed by IndexType.
+  arena::vector<SSE> build(SSE::SSE_Header_vec const& headers, CAAtoms const& ca_atoms);
+
+  /// Sort \c headers by the initial residue number.
+  static SSE::SSE_Header_vec sort_headers(SSE::SSE_Header_vec headers);
 
 
   /// @brief  A helper function of read_pdb() to properly get SSE headers.
-  ///         Get from PDB file if a stride file is not available.
+  ///         Get from PDB data \c pdb_is if a stride file is not available.
   ///         If available, read from the stride file.
-  SSE::SSE_Header_vec read_sse_header(stride_stream & stride) const;
+  SSE::SSE_Header_vec read_sse_header(std::istream & pdb_is, stride_stream & stride) const;
 
 
   /// @brief  Read the SSE header
@@ -165,10 +253,17 @@ protected:
 
 
 
-  /// @brief  Rewad the CA ATOM records from the pdb_file
-  /// @return ca_line_dict a dictionary (key = residue number, value = ATOM line)
-  /// @param  ifs in_file_stream of the input pdb_file
-  std::unordered_map<int, std::string> read_atom_lines(std::ifstream & ifs);
+  /// @brief  Add the SSE from \c init to \c end to \c sse_headers , numbered by
+  ///         numbering_data. An SSE on an unknown chain is skipped.
+  void add_sse_header(SSE::SSE_Header_vec & sse_headers, char const type,
+                      ResidueKey const& init, ResidueKey const& end) const;
+
+
+  /// @brief  Read the CA ATOM records of the first model from the pdb_file, and number
+  ///         the residues (numbering_data).
+  /// @return ca_atoms a dictionary (key = internal residue number, value = ATOM)
+  /// @param  is input stream of the pdb_file
+  CAAtoms read_ca_atoms(std::istream & is);
 
 
   /// @brief  Initialize serial_strand_id
@@ -7,6 +7,7 @@
 #include <sstream>
 #include "tools.h"
 #include "exceptions.h"
+#include "gzip.h"
 
 namespace pdb {
 
@@ -17,17 +18,17 @@ public:
   /// Construct Empty Object
   stride_stream() = default;
 
-  /// Read directly from a stream.
+  /// Read directly from a stream (decompressed if gzipped).
   stride_stream(std::istream & is):
     empty{false}, ss{} {
-      is2ss(is, ss);
+      input_stream in{is};
+      is2ss(in, ss);
     }
 
-  /// Stride file mode
+  /// Stride file mode (decompressed if gzipped)
   explicit stride_stream(std::string const& stride_file):
     empty{false}, ss{} {
-    std::ifstream ifs;
-    open_input(ifs, stride_file);
+    input_stream ifs{stride_file};
     is2ss(ifs, ss);
   }
 
@@ -86,6 +86,23 @@ void warning(std::string);
 #endif // ifndef QUIET
 
 
+/// @brief  Collect the warnings of the calling thread into \c sink instead of writing
+///         them while alive, so that the work run in parallel can write its warnings
+///         afterwards in a fixed order.
+class WarningCapture {
+public:
+  explicit WarningCapture(std::vector<std::string> & sink);
+  ~WarningCapture();
+
+  WarningCapture(WarningCapture const&) = delete;
+  WarningCapture& operator=(WarningCapture const&) = delete;
+
+private:
+  /// The sink of the enclosing capture, restored on the destruction.
+  std::vector<std::string> * const previous;
+};
+
+
 
 /// for dryrunmode
 #ifdef NATIVE_DRYRUN
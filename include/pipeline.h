@@ -0,0 +1,56 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <iostream>
+#include <string>
+
+#include "parse_argument.h"
+#include "stride2top.h"
+
+namespace pipeline {
+
+/// @brief  Read the input files given in \c vm , run the whole analysis and write the
+///         results to \c out_stream in the format selected by '--format-type'.
+///         The graphviz file (if any) is written as well. In the graphviz-only mode
+///         ('--graphviz -'), the dot file is written to standard output instead and
+///         nothing is written to \c out_stream .
+///         With '--cache-dir', the files are read into memory and passed to the version
+///         below.
+void run(bpo::variables_map const& vm, std::ostream & out_stream);
+
+
+/// The options of stride2top::analyze() given in \c vm .
+stride2top::Options analysis_options(bpo::variables_map const& vm);
+
+
+/// The contents of the input files, for the runs without the files on disk.
+struct Input {
+  /// The name of the PDB file. Only used in the messages.
+  std::string pdb_name;
+  std::string pdb_text;
+  /// The output of 'stride -h'.
+  std::string stride_text;
+};
+
+/// Read the input files given in \c vm (or the standard input) into memory.
+Input read_input(bpo::variables_map const& vm);
+
+/// @brief  Same as above, but read the input from \c input instead of the files (or the
+///         standard input) given in \c vm . The file options in \c vm are ignored.
+///         With '--cache-dir' (and without '--graphviz'), the output is looked up in the
+///         cache by the contents of \c input and the options which change the output,
+///         and the analysis is skipped if found.
+void run(bpo::variables_map const& vm, Input const& input, std::ostream & out_stream);
+
+
+/// @brief  Run 'stride -h' for \c pdb_file whose contents are \c pdb_text , and return
+///         the output. With '--cache-dir', the output is cached by \c pdb_text .
+std::string run_stride(bpo::variables_map const& vm, std::string const& pdb_file,
+                       std::string const& pdb_text);
+
+} // namespace pipeline
+
+#endif // ifndef PIPELINE_H_
@@ -0,0 +1,211 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief  Run-time profiling of the pipeline stages (the '--profile' and '--trace'
+///         options). Nothing is recorded until enable() or enable_trace() is called,
+///         so the instrumentation can stay in the release build.
+namespace profile {
+
+/// Counters reported in the '_profile_counter' loop.
+enum class Counter : std::size_t {
+  /// The number of searches for a path between two Sub-Strands.
+  BfsInvocations,
+  /// The number of the rows of the path search reused from the previous frame
+  /// (the incremental constructor of sheet::DirectedAdjacencyList).
+  BfsRowsReused,
+  /// The number of the strand components (of more than one strand) carried over from
+  /// the previous frame by the incremental constructor.
+  ComponentsReused,
+  /// The number of hydrogen bonds examined while deciding the strict zone.
+  HbondsProcessed,
+  /// The number of CA atom vs. triangle tests in the handedness filter.
+  TriangleTests,
+  /// The number of the exceptions caught: the errors of the structures (the command,
+  /// and each entry of an archive or model of an ensemble) and the Sub-Strands erased
+  /// while filtering the pairs (sheet::SubStrandErased).
+  Exceptions,
+  /// The number of the entries found in the cache of '--cache-dir' (stride and results).
+  CacheHits,
+  /// The number of the entries computed and stored in the cache.
+  CacheMisses,
+
+  /// The number of the counters. Not a counter.
+  N_COUNTERS
+};
+
+
+/// @brief  The name of a structure, interned by StructureScope. Valid until the end of
+///         the program. nullptr for no structure.
+using StructureTag = std::string const *;
+
+
+namespace detail {
+extern std::atomic<bool> is_enabled;
+extern std::array<std::atomic<std::size_t>,
+                  static_cast<std::size_t>(Counter::N_COUNTERS)> counters;
+/// The structure of the stages started in this thread (see StructureScope).
+extern thread_local StructureTag current_structure;
+} // namespace detail
+
+
+
+/// Start recording the stages and the counters for report().
+void enable();
+
+/// Start recording the stages for write_trace().
+void enable_trace();
+
+/// Stop recording. The runs recorded so far are kept. For the benchmarks.
+void disable();
+
+
+/// @return true if either enable() or enable_trace() has been called.
+inline bool enabled() {
+  return detail::is_enabled.load(std::memory_order_relaxed);
+}
+
+
+/// Add \c n to the counter \c c if enabled. Thread safe.
+inline void count(Counter const c, std::size_t const n = 1) {
+  if (enabled()) {
+    detail::counters[static_cast<std::size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+  }
+}
+
+
+/// @return The structure of the calling thread, to tag the threads it starts with.
+inline StructureTag structure() {
+  return detail::current_structure;
+}
+
+
+
+// **************************************************************************
+// Class StructureScope
+// **************************************************************************
+
+/// @brief  Tags the stages started in the calling thread with a structure in the trace,
+///         from the construction to the destruction, when the previous one is restored.
+///         Each entry of an archive, each model of an ensemble and each request of the
+///         server has its own scope, so that the stages of the structures processed at
+///         the same time are told apart. parallel::for_each_task() gives its threads the
+///         structure of the calling thread.
+class StructureScope {
+public:
+  /// @brief  Tag with \c name . The name is interned (under a lock) only if profiling
+  ///         is enabled; otherwise the stages are not recorded anyway.
+  explicit StructureScope(std::string const& name);
+
+  /// Tag with \c tag , taken by structure() in another thread.
+  explicit StructureScope(StructureTag const tag):
+    previous{detail::current_structure}
+  {
+    detail::current_structure = tag;
+  }
+
+  StructureScope(StructureScope const&) = delete;
+  StructureScope& operator=(StructureScope const&) = delete;
+
+  ~StructureScope() { detail::current_structure = previous; }
+
+private:
+  StructureTag const previous;
+};
+
+
+
+// **************************************************************************
+// Class Scope
+// **************************************************************************
+
+/// @brief  Measures the wall clock and the CPU time from the construction to finish()
+///         (or the destruction) and records it as one run of the stage \c name .
+///         Does nothing if profiling is not enabled at the construction.
+///         Each thread records into its own buffer, so no lock is taken except the
+///         first time a thread records a stage.
+///         The CPU time is that of the calling thread (CLOCK_THREAD_CPUTIME_ID), so the
+///         stages running at the same time in other threads are not included, and
+///         neither is the work the stage hands to other threads. finish() must be called
+///         in the thread that constructed the scope.
+class Scope {
+public:
+  /// @param  name_  The name of the stage. Must be a string literal (not copied).
+  explicit Scope(char const * const name_):
+    name{name_}, active{enabled()}
+  {
+    if (active) {
+      structure = detail::current_structure;
+      wall_start = std::chrono::steady_clock::now();
+      cpu_start = thread_cpu_ms();
+    }
+  }
+
+  Scope(Scope const&) = delete;
+  Scope& operator=(Scope const&) = delete;
+
+  ~Scope() { finish(); }
+
+  /// End the measurement before the destruction. Does nothing if called twice.
+  void finish();
+
+  /// The CPU time consumed by the calling thread in milliseconds.
+  static double thread_cpu_ms();
+
+private:
+  char const * const name;
+  bool active;
+  /// The structure of the thread at the construction.
+  StructureTag structure{nullptr};
+  std::chrono::steady_clock::time_point wall_start{};
+  double cpu_start{0.0};
+};
+
+
+
+/// The total of the recorded runs of one stage.
+struct StageSummary {
+  std::string stage;
+  std::size_t calls;
+  double wall_ms;
+  double cpu_ms;
+};
+
+/// @brief  Sum up the recorded runs by stage, in the order of the first run.
+///         Must not be called while any Scope is running in other threads.
+std::vector<StageSummary> summary();
+
+/// @return The current value of the counter \c c .
+std::size_t counter(Counter const c);
+
+/// @brief  Discard all the recorded runs and zero the counters. For the benchmarks.
+///         Must not be called while any Scope is running in other threads.
+void reset();
+
+
+/// @brief  Write the recorded stages and the counters as mmcif-like loops.
+///         '_profile' has one row per stage (in the order of the first run), and
+///         '_profile_counter' has the counters and the peak resident set size.
+///         Must not be called while any Scope is running in other threads.
+void report(std::ostream & os);
+
+
+/// @brief  Write all the recorded runs of the stages in the Chrome trace event format
+///         (JSON, viewable in chrome://tracing or Perfetto). Each run is a complete
+///         event tagged with the thread and the structure name (see StructureScope).
+///         Must not be called while any Scope is running in other threads.
+void write_trace(std::ostream & os);
+
+} // namespace profile
+
+#endif // ifndef PROFILE_H_
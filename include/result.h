@@ -0,0 +1,132 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef RESULT_H_
+#define RESULT_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace stride2top {
+
+// The objects of the tables of the output of the STRIDE2TOP command, as analyze() makes
+// them and write() formats them. The Sub-Strands are given by their names in the output
+// (e.g. "3_0").
+
+/// A Sub-Strand. ('substrand')
+struct SubStrand {
+  std::string name{""};
+  std::size_t sheet_id{0};
+  /// The residue numbers of the first and the last residue.
+  int ini{0};
+  int end{0};
+};
+
+
+/// A helix. ('helix')
+struct Helix {
+  std::size_t sse_id{0};
+  int ini{0};
+  int end{0};
+};
+
+
+/// A sheet. ('sheet')
+struct Sheet {
+  std::size_t sheet_id{0};
+  std::size_t n_cycles{0};
+  bool undirected{false};
+  bool with_branch{false};
+  /// Whether the Sub-Strands adjacent in the sequence are adjacent in the sheet.
+  bool consecutive{false};
+  bool all_parallel{false};
+  bool all_antiparallel{false};
+  /// The Sub-Strands in the order of the sequence. 'N_strands' is the size.
+  std::vector<std::string> members{};
+  /// The topology in the Richardson and the Cohen nomenclature.
+  std::string nomenclature_r{""};
+  std::string nomenclature_c{""};
+};
+
+
+/// A set of adjacent Sub-Strands extracted from a sheet. ('EXT_Sheet')
+struct ExtractedSheet {
+  std::size_t sheet_id{0};
+  /// Whether the set is the whole sheet.
+  bool same_as_original{false};
+  /// The Sub-Strands in the order of the sequence. 'N_strands' is the size.
+  std::vector<std::string> members{};
+  std::string nomenclature_c{""};
+};
+
+
+/// A cycle of Sub-Strands in a sheet. ('cycle')
+struct Cycle {
+  std::size_t sheet_id{0};
+  /// The Sub-Strands along the cycle. 'N_strands' is the size.
+  std::vector<std::string> members{};
+};
+
+
+/// A pair of Sub-Strands. ('substrands_pair')
+struct SubStrandsPair {
+  /// The shortest path from one Sub-Strand of the pair to the other in their sheet.
+  struct Path {
+    /// Whether the Sub-Strands share a cycle, and whether the sheet is undirected.
+    bool in_cycle{false};
+    bool undirected{false};
+    /// Whether the path goes from substr_0 to substr_1 ('-->') or back ('<--').
+    /// None in an undirected cycle ('?').
+    boost::optional<bool> forward{};
+    bool parallel{false};
+    /// The jump of the path (0 if adjacent).
+    std::size_t jump{0};
+    /// The residue differences and the number of bridges if adjacent (jump == 0).
+    boost::optional<int> delta_1{};
+    boost::optional<int> delta_2{};
+    boost::optional<std::size_t> bridges{};
+    /// The left-handedness score, if the beta-alpha-beta filter succeeded.
+    boost::optional<double> score{};
+  };
+
+  std::string substr_0{""};
+  std::string substr_1{""};
+  bool same_sheet{false};
+  /// None if on other sheets, or if neither can be reached from the other.
+  boost::optional<Path> path{};
+  /// The SSEs between them ("b-a-b", ...) and the number of residues between them.
+  /// None if on other sheets or on different chains.
+  boost::optional<std::string> sses_lbts{};
+  boost::optional<std::size_t> numres_lbts{};
+};
+
+
+/// A bridge between 2 residues. ('residue_pair')
+struct ResiduePair {
+  int resnum_0{0};
+  int resnum_1{0};
+  bool parallel{false};
+  /// "A" or "B" if parallel, "H-bonded" or "Non-H-bonded" if anti-parallel.
+  std::string type{""};
+  /// Whether the side chain of resnum_0 is on the front side of the sheet.
+  bool front{false};
+};
+
+
+/// A residue of the PDB data with its internal residue number. ('residue')
+struct ResidueNumber {
+  /// The residue number in the other tables.
+  int resnum{0};
+  /// ' ' if blank.
+  char chain{' '};
+  int seq{0};
+  /// ' ' if blank.
+  char icode{' '};
+};
+
+} // namespace stride2top
+
+#endif // ifndef RESULT_H_
@@ -0,0 +1,79 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "arena.h"
+#include "parse_argument.h"
+#include "pdb/exceptions.h"
+
+/// @brief  The server mode ('--serve SOCKET').
+///
+///         A client connects to the Unix domain socket and sends any number of requests,
+///         each answered by one response. Both are sequences of fields:
+///
+///             <tag> <length>\n<length bytes>
+///
+///         A request has the fields
+///           - 'arg'    : one command line argument (repeated, in order),
+///           - 'pdb'    : the contents of the PDB file (optional),
+///           - 'stride' : the output of 'stride -h' (optional),
+///         and ends with 'end 0\n'. Without 'pdb' or 'stride', the files given in the
+///         arguments are read by the server.
+///         A response is a single field whose header also carries the exit status of
+///         a normal run:
+///
+///             status <code> <length>\n<output, or the error message if code != 0>
+namespace server {
+
+// **************************************************************************
+// Exception class server_error
+// **************************************************************************
+
+class server_error: public pdb::fatal_error_base {
+public:
+  explicit server_error(std::string const& msg_):
+    pdb::fatal_error_base{"SERVER: " + msg_} {}
+}; // Exception class server_error
+
+
+
+/// One request from a client.
+struct Request {
+  std::vector<std::string> args;
+  boost::optional<std::string> pdb;
+  boost::optional<std::string> stride;
+};
+
+
+/// The answer to a Request.
+struct Response {
+  /// The exit status of a normal run with the same arguments.
+  int status;
+  /// The output, or the error message if status != 0.
+  std::string body;
+};
+
+
+/// @brief  Run one request. The options in \c defaults (the command line of the server)
+///         are used unless the request gives them. The structure is allocated from
+///         \c memory , which is released before returning.
+///         Never throws; errors are reported in the Response.
+Response handle(Request const& request, bpo::variables_map const& defaults,
+                arena::StructureArena & memory);
+
+
+/// @brief  Listen on \c socket_path and serve the requests on vm["threads"] worker
+///         threads until SIGINT or SIGTERM.
+/// @throw  server_error  If the socket can not be opened.
+void serve(std::string const& socket_path, bpo::variables_map const& vm);
+
+} // namespace server
+
+#endif // ifndef SERVER_H_
@@ -11,6 +11,7 @@
 #include <unordered_set>
 #include <boost/functional/hash.hpp>
 
+#include "arena.h"
 #include "pdb/sses.h"
 #include "sheet/common.h"
 
@@ -169,16 +170,16 @@ struct SubStrandsPairKeyHasher {
 
 // Data type
 
-using AdjListWithSubData = std::unordered_map<SubStrandsPairKey, SubStrandsPairNode,
-                                              SubStrandsPairKeyHasher>;
+using AdjListWithSubData = arena::unordered_map<SubStrandsPairKey, SubStrandsPairNode,
+                                                SubStrandsPairKeyHasher>;
 
-using AdjSubVec = std::unordered_map<SubStrand, std::vector<SubStrandsPairKey>,
-                                     SubStrandHasher>;
+using AdjSubVec = arena::unordered_map<SubStrand, arena::vector<SubStrandsPairKey>,
+                                       SubStrandHasher>;
 
 /// A vector contains the keys to the elements of AdjListWithSubData in the same sheet.
-using SubStrandsPairKeyVec = std::vector<SubStrandsPairKey>;
+using SubStrandsPairKeyVec = arena::vector<SubStrandsPairKey>;
 
-using SubStrandSet = std::unordered_set<SubStrand, SubStrandHasher>;
+using SubStrandSet = arena::unordered_set<SubStrand, SubStrandHasher>;
 
 
 /// Adjacency List with sub_strands.
@@ -191,6 +192,20 @@ public:
 
   void add_sheet();
 
+  /// @brief  Add the last sheet of \c other as a new sheet, with the Sub-Strands of the
+  ///         keys converted by \c conv . The pairs are inserted in the order \c other
+  ///         registered them, so the result is the same as that of building the sheet
+  ///         here.
+  template <class Conv>
+  void add_sheet(AdjListWithSub const& other, Conv const& conv) {
+    add_sheet();
+    for (auto const& key : other.sheets_key_vec.back()) {
+      SubStrandsPairKey const new_key{conv(key.sub0()), conv(key.sub1())};
+      data.insert({new_key, other.data.at(key)});
+      register_key_vec(new_key);
+    }
+  }
+
   /// @brief    Erase the edges that contain too short node.
   /// @return   Wheter the erasing has occured.
   bool erase_too_short(SubStrandSet const& short_subs);
@@ -201,7 +216,7 @@ public:
 
 
   /// Change the id of SubStrands in keys, after sorting the substrands based on resnums.
-  void update_key_substr(std::unordered_map<SubStrand, SubStrand, SubStrandHasher> const& conv);
+  void update_key_substr(arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> const& conv);
 
 
   /// @brief  Remove the smaller connections
@@ -305,15 +320,15 @@ protected:
   AdjSubVec adj_sub_vec{};
 
   /// A vector of sheets
-  std::vector<SubStrandsPairKeyVec> sheets_key_vec{};
+  arena::vector<SubStrandsPairKeyVec> sheets_key_vec{};
 
   /// Whether the corresponding sheet in \c sheets_key_vec is directed.
   /// \c true for directeed, \c false otherwise.
-  std::vector<bool> sheets_directed{};
+  arena::vector<bool> sheets_directed{};
 
 
   /// A vector of keys that were removed in remove().
-  std::vector<SubStrandsPairKey> removed_keys{};
+  SubStrandsPairKeyVec removed_keys{};
 
 
   // ***************************************************************************
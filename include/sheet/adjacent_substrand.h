@@ -10,7 +10,7 @@
 
 namespace sheet {
 
-using SubStrandVectors = std::array<std::vector<SubStrand>, 2>;
+using SubStrandVectors = std::array<arena::vector<SubStrand>, 2>;
 
 class AdjacentSubStrands {
 public:
@@ -28,6 +28,20 @@ public:
   }
 
 
+  /// @brief  Add the relations of \c other , with the Sub-Strands converted by \c conv ,
+  ///         after the relations already added.
+  template <class Conv>
+  void merge(AdjacentSubStrands const& other, Conv const& conv) {
+    for (auto const& key_value : other.data) {
+      for (IndexType side = 0; side < 2; ++side) {
+        for (auto const& ss : key_value.second[side]) {
+          add_helper(conv(key_value.first), conv(ss), side);
+        }
+      }
+    }
+  }
+
+
   /// Given adj_list_with_sub and sheets (with cycle information)
   /// remove some unneeded paths and make the undirected graph partialy directed.
   void fix_undirected_paths(AdjListWithSub & adj_sub, Sheets const& sheets) const {
@@ -127,7 +141,7 @@ protected:
   /// data.at(i_substr): An array of 2 (1 for each h-bonded side of a Sub-Strand) elements,
   ///                 which store the list of adjacent Sub-Strands.
   /// Sub-Strands in data.at(i_substr)[0] and data.at(i_substr)[1] are on the other side.
-  std::unordered_map<SubStrand, SubStrandVectors, SubStrandHasher> data{};
+  arena::unordered_map<SubStrand, SubStrandVectors, SubStrandHasher> data{};
 };
 
 
@@ -5,6 +5,12 @@
 #define SHEET_CB_SIDE_H_
 
 #include <array>
+#include <exception>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <stdexcept>
 
@@ -16,6 +22,7 @@
 #include "sheet/common.h"
 #include "sheet/pairs.h"
 #include "sheet/exceptions.h"
+#include "sheet/residue_bitmap.h"
 #include "sheet/sub_strands_range.h"
 #include "sheet/zone_residue.h"
 
@@ -28,16 +35,21 @@ struct ZoneInfo {
   enum SideStatus: char {Undefined = -1, Upper = 1, Lower = 0};
   enum BridgeType: char {NoBridge, ParallelHbonds, ParallelNoHbonds, SmallRing, LargeRing};
 
+  /// Value of adj_residues which is not set yet.
+  static constexpr DenseIndex no_residue = std::numeric_limits<DenseIndex>::max();
+
+  /// @param  residue  The dense index of the paired residue.
   /// @retval true  If adding succeeded.
   /// @retval false Otherwise.
-  bool add_pair(ZoneResidue const& residue, bool const hbonded,
+  bool add_pair(DenseIndex const residue, bool const hbonded,
                 BridgeType const bridge_type);
 
   bool colored{false};
   SideStatus side{Undefined};
 
-  /// [paired residue on non-hbonded side, hbonded side]
-  std::array<ZoneResidue, 2> adj_residues{{ZoneResidue{}, ZoneResidue{}}};
+  /// Dense indices of [paired residue on non-hbonded side, hbonded side].
+  /// Use StrictZone::residue_of() to get the ZoneResidue.
+  std::array<DenseIndex, 2> adj_residues{{no_residue, no_residue}};
 
   /// Store if the corresponding adj_residue item has already been initialized.
   std::array<bool, 2> adj_set{{false, false}};
@@ -53,9 +65,9 @@ struct StrictZone {
   // Public Member Types
   // *************************************************************
 
-  /// @brief  An unordered_set of ZoneResidues.
+  /// @brief  A set of ZoneResidues by their dense indices.
   ///         Used as a set of remainders or a set of queue contents.
-  using ZoneResidueSet = std::unordered_set<ZoneResidue, ZoneResidueHasher>;
+  using ZoneResidueSet = ResidueBitmap;
 
 
   /// Store the relative direction of each strand against the base strand
@@ -66,7 +78,21 @@ struct StrictZone {
   enum RelDir: char {NotSet = -1, AntiParallel = 0, Parallel = 1};
 
   /// A vector of \c RelDir
-  using RelativeDirsVec = std::vector<RelDir>;
+  using RelativeDirsVec = arena::vector<RelDir>;
+
+
+  /// A bridge between a residue on a base strand and its partner on a Sub-Strand.
+  struct BridgeToSubStrand {
+    /// serial_res_id of the residue on the base strand.
+    unsigned base_res;
+    /// The paired residue on the Sub-Strand.
+    ZoneResidue partner;
+  };
+
+  /// key   : A Sub-Strand the partners belong to.
+  /// value : Bridges to the Sub-Strand sorted by \c base_res .
+  using BridgesMap = arena::unordered_map<SubStrand, arena::vector<BridgeToSubStrand>,
+                                          SubStrandHasher>;
 
 
 
@@ -77,7 +103,7 @@ struct StrictZone {
   StrictZone(pdb::SSES const& sses_, SubStrandsRange & sub_strands_ref,
              AdjacentSubStrands & adj_substrands_ref):
     sses{sses_}, strand_indices{sses.gen_index_vec('E')}, strict{init_strict()},
-    sub_strands{sub_strands_ref}, adj_substrands{adj_substrands_ref}
+    dense_offsets{init_dense_offsets()}, sub_strands{sub_strands_ref}, adj_substrands{adj_substrands_ref}
   {}
 
   /// @param  sse_id  SSE ID of the target residue
@@ -92,8 +118,27 @@ struct StrictZone {
               ZoneInfo::BridgeType const bridge_type);
 
 
-  /// Run BFS (Breadth First Search) and set the side data for all registered residues.
-  AdjListWithSub decide_side(AdjList const& undirected_adj_list);
+  /// @brief  Copy the rows of \c strict of the strands \c carried_strands (by the serial
+  ///         strand IDs) from \c previous , for the incremental construction. The
+  ///         components of these strands must be the same as in \c previous , and they
+  ///         are not searched again by decide_side(). Call before gen_strict_zone() is
+  ///         run for the other strands.
+  void carry_over(StrictZone const& previous, arena::vector<bool> const& carried_strands);
+
+
+  /// @brief  Run BFS (Breadth First Search) and set the side data for all registered
+  ///         residues. The consistent sheet regions are found first and searched in
+  ///         parallel, then merged in the order of the regions, which gives the
+  ///         Sub-Strand IDs. The result and the warnings are the same for any
+  ///         \c n_threads .
+  /// @param  n_threads  The number of threads. 0 for the number of cores.
+  /// @param  previous   The StrictZone given to carry_over(), if any. Its regions and
+  ///                    the gaps of \c previous_pairs (the pairs of the Sub-Strands it
+  ///                    gave) on the carried strands are reused.
+  AdjListWithSub decide_side(AdjList const& undirected_adj_list,
+                             unsigned const n_threads = 0,
+                             StrictZone const* const previous = nullptr,
+                             AdjListWithSubData const* const previous_pairs = nullptr);
 
 
   /// @brief  Accessor to the this->strict using a ZoneResidue class object
@@ -109,6 +154,21 @@ struct StrictZone {
   ZoneInfo & strict_info(ZoneResidue const& zone_res);
 
 
+  /// @brief  The index of the residue unique in this StrictZone.
+  DenseIndex dense_index(ZoneResidue const& zone_res) const {
+    return dense_offsets[zone_res.serial_str_id] + zone_res.serial_res_id;
+  }
+
+  /// @brief  The number of residues on all the strands.
+  std::size_t n_dense() const { return dense_offsets.back(); }
+
+  /// @brief  The serial strand id of the residue of the dense index \c i .
+  IndexType strand_of(DenseIndex const i) const;
+
+  /// @brief  Convert a dense index back to a ZoneResidue.
+  ZoneResidue residue_of(DenseIndex const i) const;
+
+
 
 
 #ifdef LOGGING
@@ -135,7 +195,11 @@ struct StrictZone {
   /// Data storage for zone info. Convert the SSE_ID to the serial SSE_ID when accessing.
   /// 2-dimensional vector
   /// N_SSE * N_res_SSE
-  std::vector<std::vector<ZoneInfo>> strict{};
+  arena::vector<arena::vector<ZoneInfo>> strict{};
+
+  /// dense_offsets[str] : The dense index of the first residue of the serial strand str.
+  /// The last element is the number of residues on all the strands.
+  arena::vector<DenseIndex> dense_offsets{};
 
 
   /// Just resize the vector by the number of strands
@@ -147,24 +211,106 @@ struct StrictZone {
 
 protected:
 
+  // *************************************************************
+  // Protected Member Types
+  // *************************************************************
+
+  /// @brief  The result of bfs() for one consistent sheet region. The Sub-Strand of the
+  ///         region on each strand has the ID 0 until merge_region() gives it the ID
+  ///         in \c sub_strands .
+  struct Region {
+    /// @brief  Extend the range of the Sub-Strand on the strand of \c res ,
+    ///         as SubStrandsRange::extend_substrand() does.
+    void extend(ZoneResidue const& res);
+
+    /// key   : A serial strand ID.
+    /// value : The resnums of the first and the last residue of the Sub-Strand.
+    arena::map<IndexType, std::array<int, 2>> ranges{};
+
+    /// The pairs of the Sub-Strands in one sheet, in the order of the insertion.
+    /// The too short Sub-Strands are erased by merge_region().
+    AdjListWithSub adj_list{};
+
+    AdjacentSubStrands adj_substrands{};
+
+    /// Whether the region fell back to an undirected graph.
+    bool fallback{false};
+
+    /// The warnings of bfs(), written by decide_side() in the order of the regions.
+    std::vector<std::string> warnings{};
+
+    /// The exception thrown by bfs(), if any.
+    std::exception_ptr error{nullptr};
+
+    /// The dense index of the first residue, which gives the order of the regions.
+    DenseIndex seed{0};
+  };
+
+
+
   // *************************************************************
   // Protected Member Functions
   // *************************************************************
 
-  std::vector<std::vector<ZoneInfo>> init_strict() const;
+  arena::vector<arena::vector<ZoneInfo>> init_strict() const;
+
+  arena::vector<DenseIndex> init_dense_offsets() const;
 
 
+  /// Whether the serial strand \c str is carried over by carry_over().
+  bool is_carried(IndexType const str) const {
+    return str < carried.size() and carried[str];
+  }
+
   // Helper functions for decide_side
-  /// @brief  Generate a set of unproccessed and colored residues
+  /// @brief  Generate a set of unproccessed and colored residues, on the strands not
+  ///         carried over.
   void collect_colored(ZoneResidueSet & set) const;
 
 
-  /// Calculate the gap (the number of residue differences) between paired strands.
-  void calc_deltas(AdjListWithSub & adj_list) const;
+  /// @brief  The residues of \c colored in the order the BFS seeds are taken: the
+  ///         order of the dense indices, from N-term to C-term, strand by strand.
+  ///         The seed of each sheet is defined as 'Upper', so this order fixes the
+  ///         orientation of the sheets in the output: the first residue of a sheet in
+  ///         the sequence is on the upper side. It depends only on the residues of the
+  ///         sheet itself, not on the other sheets.
+  std::vector<DenseIndex> seed_order(ZoneResidueSet const& colored) const;
+
+
+  /// @brief  Find the consistent sheet regions: the residues bfs() reaches from each
+  ///         seed in \c seeds not in an earlier region. Writes no warning.
+  /// @param  region_of  Set to the region of each colored residue (the maximum value
+  ///                    for the others), and must have n_dense() elements.
+  /// @return The seed of each region.
+  std::vector<DenseIndex> find_regions(ZoneResidueSet const& colored,
+                                       std::vector<DenseIndex> const& seeds,
+                                       std::vector<std::size_t> & region_of) const;
+
+
+  /// @brief  Add the Sub-Strands and the pairs of \c region to \c sub_strands ,
+  ///         \c adj_substrands and \c adj_list as a new sheet, as bfs() used to do on
+  ///         them directly. The regions must be merged in their order.
+  void merge_region(Region const& region, AdjListWithSub & adj_list);
+
+
+  /// @brief  Build \c colored_prefix and \c bridges_to from the final \c strict and
+  ///         \c sub_strands . Must be called after the Sub-Strands are finished and
+  ///         before calc_deltas(). The strands are indexed in parallel.
+  ///         The rows of the carried strands are copied from \c previous , if given.
+  void build_delta_index(unsigned const n_threads, StrictZone const* const previous);
+
+
+  /// @brief  Calculate the gap (the number of residue differences) between paired
+  ///         strands. The pairs are counted in parallel. The gaps of the pairs on the
+  ///         carried strands are copied from \c previous_pairs , if found in it.
+  /// @exception  The exception of the first pair in the order of \c adj_list.map() .
+  void calc_deltas(AdjListWithSub & adj_list, unsigned const n_threads,
+                   AdjListWithSubData const* const previous_pairs) const;
 
 
   /// @brief  Helper function for calc_deltas(). Get the first residue that resides in the
   ///         bridge between the base Sub-Strand and the Sub-Strand adjacent to the base.
+  ///         Looks up \c bridges_to instead of walking the residues.
   /// @param  zres_base_start  The first residue on the base Sub-Strand to start counting.
   /// @param  toward_c_term    Whether to search from start (zres_base_start) toward
   ///                          C-term side of base.
@@ -182,26 +328,36 @@ protected:
 
   /// @brief Count the number of colored residues (residues inside the strict hydrogen
   ///        bonding pattern) from \c start to \c last. Both \c start and \c last must be
-  ///        belong to the same Sub-Strand.
+  ///        belong to the same Sub-Strand. Calculated from \c colored_prefix .
   /// @param  start  The first residue to start counting.
   /// @param  step   A step value to move at one count. This value should be 1 or -1.
   ///                If 1, count to the C-term side, otherwise N-term side.
   /// @param  last   The final residue where the counting should stop. This residue will
-  ///                be included in the count.
+  ///                not be included in the count.
   /// @return The number of residues between \c start and \c last .
+  /// @exception  std::out_of_range  If \c last can not be reached from \c start .
   int count_delta_adj(ZoneResidue const& start, int const step,
                       ZoneResidue const& last) const;
 
 
+  /// @brief  Make a ZoneResidue on the serial strand \c str without searching the SSE.
+  ///         \c resnum must be inside the strand (e.g. a terminal of a Sub-Strand).
+  ZoneResidue zone_residue_on(IndexType const str, int const resnum) const;
+
+
   int count_delta_1(SubStrand const& ss_base, SubStrand const& ss_adj,
                     bool const dir) const;
   int count_delta_2(SubStrand const& ss_base, SubStrand const& ss_adj,
                     bool const dir) const;
 
 
-  /// @brief  Run bfs.
-  void bfs(AdjListWithSub & adj_list,
+  /// @brief  Run bfs from \c seed , which must be in \c remainder , and store the
+  ///         consistent sheet region into \c region . Sets the side of the residues of
+  ///         the region only, so the regions can be searched concurrently.
+  /// @param  remainder  The residues of this region and the later ones.
+  void bfs(Region & region,
            ZoneResidueSet & remainder,
+           DenseIndex const seed,
            AdjList const& undirected_adj_list);
 
   // Helper Functions for bfs()
@@ -233,13 +389,15 @@ protected:
                       RelativeDirsVec & relative_directions) const;
 
 
-  /// Generate the key to add into the adj_list hash and the gap between strand positions.
+  /// @brief  Generate the key to add into the adj_list hash and the gap between strand
+  ///         positions. The Sub-Strands are those of the region (ID 0).
   SubStrandsPairKey gen_list_key(ZoneResidue const& res0, ZoneResidue const& res1,
                                  bool const hbonded, RelativeDirsVec const& rel_dir) const;
 
 
-  void add_adj_substrands(ZoneResidue const& res0, ZoneResidue const& res1,
-                          bool const hbonded, bool const rel_dir);
+  void add_adj_substrands(AdjacentSubStrands & region_substrands,
+                          ZoneResidue const& res0, ZoneResidue const& res1,
+                          bool const hbonded, bool const rel_dir) const;
 
 
   /// @brief  Push the paired or the sequentially adjacent residue into the search queue
@@ -247,7 +405,7 @@ protected:
   /// @param  queue     Queue to push.
   /// @param  contents  A set of queue contents.
   /// @param  new_res   A residue to be pushed into queue.
-  void push_into_queue(std::deque<ZoneResidue>& queue,
+  void push_into_queue(ResidueQueue & queue,
                        ZoneResidueSet & contents,
                        ZoneResidue const& new_res) const;
 
@@ -261,8 +419,30 @@ protected:
   /// @param  diff    A difference in residue number between the target and the ba.
   ///                 1 for the next residue, -1 for the previous residue.
   /// @param  remainder  A reference to the list of remaining residue to examine.
+  /// @param  warn       Whether to warn about the continuous bridges ignored.
   ZoneResidue ba_check(ZoneResidue const& target, int const diff,
-                       ZoneResidueSet const& remainder) const;
+                       ZoneResidueSet const& remainder, bool const warn = true) const;
+
+
+
+  // *************************************************************
+  // Protected Member Variables
+  // *************************************************************
+
+  /// colored_prefix[str][k] : The number of colored residues in strict[str][0, k).
+  /// Built by build_delta_index().
+  arena::vector<arena::vector<int>> colored_prefix{};
+
+  /// bridges_to[str] : Bridges from the residues on the serial strand \c str .
+  /// Built by build_delta_index().
+  arena::vector<BridgesMap> bridges_to{};
+
+  /// carried[str] : Whether the serial strand \c str is carried over (see carry_over()).
+  arena::vector<bool> carried{};
+
+  /// The regions merged by decide_side(), in their order. Kept for the incremental
+  /// construction of the next frame.
+  arena::vector<Region> regions{};
 
 };
 
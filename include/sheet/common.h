@@ -4,11 +4,11 @@
 #ifndef SHEET_COMMON_H_
 #define SHEET_COMMON_H_
 
-#include <unordered_map>
 #include <utility>
 
 #include <boost/functional/hash.hpp>
 
+#include "arena.h"
 #include "pdb/constants.h"
 
 namespace sheet {
@@ -37,9 +37,9 @@ struct AdjStrandData {
 
 
 /// AdjList[std::make_pair(i, j)] returns the AdjStrandData for Strand j which is adjacent to i
-using AdjList = std::unordered_map<std::pair<IndexType, IndexType>,
-                                   AdjStrandData,
-                                   boost::hash<std::pair<IndexType, IndexType>>>;
+using AdjList = arena::unordered_map<std::pair<IndexType, IndexType>,
+                                     AdjStrandData,
+                                     boost::hash<std::pair<IndexType, IndexType>>>;
 
 
 
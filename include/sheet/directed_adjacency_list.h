@@ -4,8 +4,15 @@
 #ifndef SHEET_DIRECTED_ADJACENCY_LIST_H_
 #define SHEET_DIRECTED_ADJACENCY_LIST_H_
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "arena.h"
 #include "pdb/sses.h"
 #include "pdb/stride_stream.h"
 
@@ -14,6 +21,7 @@
 #include "sheet/common.h"
 #include "sheet/cb_side.h"
 #include "sheet/pairs.h"
+#include "sheet/residue_strand_map.h"
 #include "sheet/sheets.h"
 #include "sheet/sub_strands_range.h"
 #include "sheet/substr_pair_attr.h"
@@ -40,7 +48,26 @@ struct LastPair {
 
 
 
-using ATOM_vec_iter = std::vector<pdb::ATOM>::const_iterator;
+using ATOM_vec_iter = pdb::ATOM_vec_iter;
+
+
+
+// ***********************************************************************************
+// Enum BridgeEngine
+// ***********************************************************************************
+
+/// How DirectedAdjacencyList detects the bridges registered into the StrictZone.
+enum class BridgeEngine: char {
+  /// Sweep the sorted H-bonds of each strand and compare each with the previous one.
+  Sweep,
+  /// @brief  Same as Sweep, but the strand of each residue is looked up in a table
+  ///         indexed by the residue number (ResidueStrandMap) built once, instead of
+  ///         searching the SSEs for each H-bond and for each comparison of the sort.
+  ///         Gives the same bridges in the same order. It is not measurably faster, as
+  ///         the sort and the sweep dominate; it is kept to cross-check Sweep
+  ///         (scripts/compare_bridge_engines.py).
+  StrandTable
+};
 
 // ***********************************************************************************
 // Class DirectedAdjacencyList
@@ -53,27 +80,88 @@ public:
   // Public Member Types
   // ***************************************************************************
 
-  using AdjIndList = std::unordered_map<IndexType, std::vector<IndexType>>;
-  using AdjAttrMap = std::unordered_map<SubStrandsPairKey, StrandsPairAttribute,
-                                        SubStrandsPairKeyHasher>;
+  using AdjIndList = arena::unordered_map<IndexType, arena::vector<IndexType>>;
+  using AdjAttrMap = arena::unordered_map<SubStrandsPairKey, StrandsPairAttribute,
+                                          SubStrandsPairKeyHasher>;
 
   // ***************************************************************************
   // Public Member Functions
   // ***************************************************************************
 
   /// Constructor
-  DirectedAdjacencyList(pdb::SSES const& sses_, pdb::stride_stream & stride) :
+  /// @param  engine     The algorithm to detect the bridges between strands.
+  /// @param  n_threads  The number of threads for the side assignment and the analysis
+  ///                    of the sheets, and the path search between Sub-Strands.
+  ///                    0 for the number of cores.
+  DirectedAdjacencyList(pdb::SSES const& sses_, pdb::stride_stream & stride,
+                        BridgeEngine const engine = BridgeEngine::Sweep,
+                        unsigned const n_threads = 0) :
     sses{sses_},
     strand_indices{sses.gen_index_vec('E')},
+    pairs{read_pairs(sses, stride)},
     sub_strands_range{strand_indices.size()},
     adj_substrands{},
     strict_zone{sses, sub_strands_range, adj_substrands},
-    adj_list_with_sub(init_list(Pairs{sses, stride})),
+    adj_list_with_sub(init_list(pairs, engine, n_threads)),
     adj_list{translate_sub()},
     adj_index_list{init_adj_index_list()},
     // Run fix_undirected_paths inside init_sheets()
-    sheets{init_sheets()},
-    adj_attr{init_adj_attr()}
+    sheets{init_sheets(n_threads)},
+    adj_attr{init_adj_attr(n_threads)}
+  {}
+
+
+  /// Same as above, but the hydrogen bonds are given as \c dnr (see Pairs::dnr).
+  DirectedAdjacencyList(pdb::SSES const& sses_, Pairs::PairsVec const& dnr,
+                        BridgeEngine const engine = BridgeEngine::Sweep,
+                        unsigned const n_threads = 0) :
+    sses{sses_},
+    strand_indices{sses.gen_index_vec('E')},
+    pairs{read_pairs(sses, dnr)},
+    sub_strands_range{strand_indices.size()},
+    adj_substrands{},
+    strict_zone{sses, sub_strands_range, adj_substrands},
+    adj_list_with_sub(init_list(pairs, engine, n_threads)),
+    adj_list{translate_sub()},
+    adj_index_list{init_adj_index_list()},
+    // Run fix_undirected_paths inside init_sheets()
+    sheets{init_sheets(n_threads)},
+    adj_attr{init_adj_attr(n_threads)}
+  {}
+
+
+  /// @brief  Update \c previous (e.g. of the last frame of a simulation) with the change
+  ///         of the hydrogen bonds \c delta . \c sses_ may have new coordinates.
+  ///         The result is the same as the construction from Pairs::apply(previous.pairs.dnr,
+  ///         delta) (checked by ../check/incremental.cpp).
+  ///         If the strands are the same as those of \c previous , only the strands
+  ///         involved in \c delta read the hydrogen bonds and find the bridges again.
+  ///         The strand components (the strands connected by the bridges) with none of
+  ///         these strands are carried over from \c previous : their strict zone, their
+  ///         consistent sheet regions (the CB sides and the pairs of the Sub-Strands) and
+  ///         their gaps. Only the other components run gen_strict_zone() and the BFS of
+  ///         StrictZone::decide_side(), and all the regions are merged in their order as
+  ///         from scratch. The cycles of a sheet with the same pairs as a sheet of
+  ///         \c previous , and the paths between the Sub-Strands where the part of the
+  ///         graph reachable from the first Sub-Strand is unchanged, are also copied.
+  /// @param  previous  Must be alive with its SSES during the construction.
+  /// @exception HbondNotFound  If a removed hydrogen bond is not in \c previous .
+  DirectedAdjacencyList(pdb::SSES const& sses_, DirectedAdjacencyList const& previous,
+                        Pairs::Delta const& delta,
+                        BridgeEngine const engine = BridgeEngine::Sweep,
+                        unsigned const n_threads = 0) :
+    sses{sses_},
+    strand_indices{sses.gen_index_vec('E')},
+    pairs{read_pairs(sses, previous, delta)},
+    sub_strands_range{strand_indices.size()},
+    adj_substrands{},
+    strict_zone{sses, sub_strands_range, adj_substrands},
+    adj_list_with_sub(init_list(pairs, engine, n_threads, &previous)),
+    adj_list{translate_sub()},
+    adj_index_list{init_adj_index_list()},
+    // Run fix_undirected_paths inside init_sheets()
+    sheets{init_sheets(n_threads, &previous)},
+    adj_attr{init_adj_attr(n_threads, &previous)}
   {}
 
 
@@ -150,8 +238,19 @@ public:
 
   pdb::SSES const& sses;
   std::vector<IndexType> const strand_indices{};
+
+  /// The hydrogen bonds. Kept for the incremental construction of the next frame.
+  Pairs const pairs;
 protected:
 
+  /// The undirected adjacency list of the strands (see init_list()).
+  /// Kept for the incremental construction of the next frame.
+  AdjList undirected_adj_list{};
+
+  /// key : SSE ID of a strand, value : SSE IDs of the strands adjacent to it in
+  /// \c undirected_adj_list .
+  arena::unordered_map<IndexType, arena::unordered_set<IndexType>> undirected_adj_index_map{};
+
   /// will be initialized inside the StrictZone class in init_list()
   SubStrandsRange sub_strands_range{0};
 
@@ -185,16 +284,37 @@ protected:
   // Protected Member Functions
   // ***************************************************************************
 
-  AdjListWithSub init_list(Pairs const& pairs);
+  /// Read the hydrogen bonds from \c stride . (Separated to be measured by '--profile'.)
+  static Pairs read_pairs(pdb::SSES const& sses_, pdb::stride_stream & stride);
+
+  /// A version of read_pairs() for the hydrogen bonds in memory.
+  static Pairs read_pairs(pdb::SSES const& sses_, Pairs::PairsVec const& dnr);
+
+  /// A version of read_pairs() for the incremental constructor.
+  static Pairs read_pairs(pdb::SSES const& sses_, DirectedAdjacencyList const& previous,
+                          Pairs::Delta const& delta);
+
+  /// @brief  Find the bridges and decide the CB sides.
+  /// @param  previous  If given (the incremental constructor) and its strands are the
+  ///                   same, the strand components not involved in the change of the
+  ///                   hydrogen bonds are carried over from it.
+  AdjListWithSub init_list(Pairs const& pairs, BridgeEngine const engine,
+                           unsigned const n_threads,
+                           DirectedAdjacencyList const* const previous = nullptr);
+
+  /// @brief  The strands of the components of \c undirected_adj_index_map with none
+  ///         of the strands \c changed (by the serial strand IDs).
+  /// @return carried[serial_strand_id]
+  arena::vector<bool> carried_strands(arena::vector<bool> const& changed) const;
 
   /// create a undirected adjacency list
-  std::unordered_set<IndexType> add_undirected_adj_list(AdjList & undirected_adj_list, 
-                                                        Pairs::PairsVec const& involved_pairs,
-                                                        pdb::SSE const& e) const;
+  arena::unordered_set<IndexType> add_undirected_adj_list(AdjList & undirected_adj_list, 
+                                                          Pairs::PairsVec const& involved_pairs,
+                                                          pdb::SSE const& e) const;
 
 
   /// generate a vector of sse_ids adjacent to a target SSE
-  std::unordered_set<IndexType> adj_id_set(Pairs::PairsVec const& involved_pairs) const;
+  arena::unordered_set<IndexType> adj_id_set(Pairs::PairsVec const& involved_pairs) const;
 
 
   /// Given the number of votes for parallel and anti-parallel, return the direction
@@ -209,10 +329,13 @@ protected:
   void undirected_adj_symmetry_check(AdjList const& undirected_adj_list) const;
 
 
-  /// Generate directed adjacency list from a undirected adjacency list
+  /// @brief  Generate directed adjacency list from a undirected adjacency list
+  /// @param  strand_map  If not null (BridgeEngine::StrandTable), the strands of the paired
+  ///                     residues are looked up in it instead of searching the SSEs.
   void gen_strict_zone(AdjList const& undirected_adj_list,
                        Pairs const& pairs, std::vector<IndexType>& strands,
-                       std::unordered_map<IndexType, std::unordered_set<IndexType>> const& adj_index_map);
+                       arena::unordered_map<IndexType, arena::unordered_set<IndexType>> const& adj_index_map,
+                       ResidueStrandMap const* const strand_map);
 
 
   /// Translate the AdjListWithSub into AdjList
@@ -223,24 +346,48 @@ protected:
   AdjIndList init_adj_index_list() const;
 
   /// Initialize sheets.
-  Sheets init_sheets();
+  Sheets init_sheets(unsigned const n_threads,
+                     DirectedAdjacencyList const* const previous = nullptr);
 
   /// Initializee adj_attr
-  AdjAttrMap init_adj_attr() const;
+  AdjAttrMap init_adj_attr(unsigned const n_threads,
+                           DirectedAdjacencyList const* const previous = nullptr) const;
+
+  /// @brief  Run search() for all the ordered pairs of Sub-Strands in parallel.
+  ///         The rows of the Sub-Strands for which same_paths() holds are copied from
+  ///         \c previous->adj_attr , if given.
+  /// @return attrs[i * n + j] is the result of search(vec()[i], vec()[j]),
+  ///         where n is the number of Sub-Strands.
+  std::vector<StrandsPairAttribute> search_all(
+      unsigned const n_threads, DirectedAdjacencyList const* const previous = nullptr) const;
+
+  /// @brief  Whether the part of the graph reachable from \c first is the same in
+  ///         \c previous (the same adjacent Sub-Strands in the same order, and the same
+  ///         directions), so that search() from \c first gives the same results.
+  bool same_paths(SubStrand const& first, DirectedAdjacencyList const& previous) const;
+
+  /// Whether \c sses_ has the strands of the same ranges as \c other .
+  static bool same_strands(pdb::SSES const& sses_, pdb::SSES const& other);
 
   // *******************************
   // Helper Functions for search()
   // *******************************
 
-  using PathParents = std::unordered_map<SubStrand, SubStrand, SubStrandHasher>;
+  /// Parents of the nodes found in search_bfs(). Allocated from a per-thread arena.
+  using PathParents = std::unordered_map<SubStrand, SubStrand, SubStrandHasher,
+                                         std::equal_to<SubStrand>,
+                                         arena::Allocator<std::pair<SubStrand const, SubStrand>>>;
 
   /// @return A vector of reversed path
   void search_backtrace(StrandsPairAttribute & attr, PathParents const& parents) const;
 
 
-  /// @return  A path from the \c first to the \c last node.
-  PathParents search_bfs(SubStrand const& first, SubStrand const& last,
-                         AdjSubVec const& adj_sub_vec) const;
+  /// @brief  Fill \c parents with a path from the \c first to the \c last node.
+  ///         \c parents is left empty if \c last is not reachable.
+  ///         The temporary containers are allocated from \c pool .
+  void search_bfs(SubStrand const& first, SubStrand const& last,
+                  AdjSubVec const& adj_sub_vec,
+                  arena::MonotonicArena & pool, PathParents & parents) const;
 
 };
 
@@ -138,6 +138,18 @@ public:
 
 
 
+// *******************************************************************
+// Exception class HbondNotFound
+// *******************************************************************
+class HbondNotFound: public pdb::fatal_error_base {
+public:
+  HbondNotFound(int const donor, int const acceptor):
+    pdb::fatal_error_base("HBOND DELTA: REMOVED HBOND NOT FOUND: N = " +
+                          std::to_string(donor) + ", O = " + std::to_string(acceptor)) {}
+};
+
+
+
 // *******************************************************************
 // Exception class AdjacentSubStrandNotFound
 // *******************************************************************
@@ -11,6 +11,7 @@
 
 #include <boost/functional/hash.hpp>
 
+#include "arena.h"
 #include "pdb/sses.h"
 #include "pdb/stride_stream.h"
 #include "pdb/tools.h"
@@ -19,6 +20,8 @@
 
 namespace sheet {
 
+class ResidueStrandMap;
+
 
 // **************************************************************************************
 // Class definition
@@ -44,7 +47,15 @@ public:
   ///   reverse_flag :
   ///         0 for non-reversed (hbond from res0[N] to res1[O])
   ///         1 for reversed (hbond from res1[N] to res0[O])
-  using PairsVec = std::vector<std::array<int, 3>>;
+  using PairsVec = arena::vector<std::array<int, 3>>;
+
+
+  /// @brief  The change of the hbonds between two frames (e.g. of a simulation).
+  ///         Both are {N_atom_resnum, O_atom_resnum, 0} for each hbond, like dnr.
+  struct Delta {
+    PairsVec added{};
+    PairsVec removed{};
+  };
 
 
   // **********************************************************
@@ -53,20 +64,48 @@ public:
 
 
   Pairs(pdb::SSES const& sses, pdb::stride_stream & stride) :
-    dnr{read_stride_stream(stride.ss)},
+    dnr{read_stride_stream(stride.ss, sses.numbering())},
+    involved_pairs{init_involved_pairs(dnr, sses)} {}
+
+  /// @brief  Construct from the hbonds in memory instead of a stride output.
+  /// @param  dnr_  {N_atom_resnum, O_atom_resnum, 0} for each hbond (like the DNR records).
+  Pairs(pdb::SSES const& sses, PairsVec const& dnr_) :
+    dnr{dnr_},
     involved_pairs{init_involved_pairs(dnr, sses)} {}
 
+  /// @brief  Construct from the hbonds of \c previous changed by \c delta .
+  ///         Only the involved_pairs of the strands which a changed hbond involves are
+  ///         computed again, and the others are copied from \c previous .
+  ///         Same as Pairs{sses, apply(previous.dnr, delta)}.
+  /// @param  sses  Must have the strands of the same ranges as those \c previous was
+  ///               constructed with.
+  /// @exception HbondNotFound  If a removed hbond is not in \c previous .
+  Pairs(pdb::SSES const& sses, Pairs const& previous, Delta const& delta) :
+    dnr{apply(previous.dnr, delta)},
+    involved_pairs{update_involved_pairs(dnr, sses, previous, delta)} {}
+
+  /// @brief  Apply \c delta to \c dnr_ . Each removed hbond cancels one equal hbond
+  ///         of \c dnr_ , and the added ones are appended.
+  /// @exception HbondNotFound  If a removed hbond is not in \c dnr_ .
+  static PairsVec apply(PairsVec dnr_, Delta const& delta);
+
   /// Sort the involved_pairs vector based on the direcion
   /// (Parallel or Anti-Parallel) of the paired Strand.
   PairsVec resort_involved_pairs(IndexType const serial_str_id, AdjList const& adj_list,
                                  pdb::SSES const& sses) const;
 
+  /// @brief  Same as above, but the strands of the paired residues are looked up in
+  ///         \c strand_map instead of searching the SSEs. Gives the same order.
+  PairsVec resort_involved_pairs(IndexType const serial_str_id, AdjList const& adj_list,
+                                 pdb::SSES const& sses,
+                                 ResidueStrandMap const& strand_map) const;
+
 
   // **********************************************************
   // Public Member Variables
   // **********************************************************
   PairsVec const dnr{};
-  std::vector<PairsVec> const involved_pairs{};
+  arena::vector<PairsVec> const involved_pairs{};
 
 protected:
 
@@ -78,8 +117,11 @@ protected:
   ///         This function reads only DNR records.
   /// @return hbond-pair_vector each pair consists of 2 fields [N_atom_resnum, O_atom_resnum]
   /// @retval {{5, 13}, {7, 11}, ...} if N in the resnum 5 and O in the resnum 13 are hbonded
-  /// @param  ifs     in-file-stream of the stride output file in /tmp directory
-  PairsVec read_stride_stream(std::istream & is) const;
+  /// @param  ifs        in-file-stream of the stride output file in /tmp directory
+  /// @param  numbering  The internal residue numbers (an hbond with a residue on an
+  ///                    unknown chain is skipped).
+  PairsVec read_stride_stream(std::istream & is,
+                              pdb::ResidueNumbering const& numbering) const;
 
 
 
@@ -87,7 +129,14 @@ protected:
   /// @brief            Initialize involved_pairs
   /// @return hashmap   map the SSE_ID to PairsVec generated by involve_with()
   /// @param  sses      A vector of SSEs
-  std::vector<PairsVec> init_involved_pairs(PairsVec const& dnr, pdb::SSES const& sses) const;
+  arena::vector<PairsVec> init_involved_pairs(PairsVec const& dnr, pdb::SSES const& sses) const;
+
+
+  /// @brief  init_involved_pairs() for the incremental constructor. Copy the ones of
+  ///         \c previous for the strands not involved in \c delta .
+  arena::vector<PairsVec> update_involved_pairs(PairsVec const& dnr, pdb::SSES const& sses,
+                                              Pairs const& previous,
+                                              Delta const& delta) const;
 
 
 
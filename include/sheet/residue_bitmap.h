@@ -0,0 +1,111 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef SHEET_RESIDUE_BITMAP_H_
+#define SHEET_RESIDUE_BITMAP_H_
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "arena.h"
+
+namespace sheet {
+
+/// @brief  Index of a strand residue which is unique in a StrictZone.
+///         Residues of a strand are numbered consecutively from N-term to C-term,
+///         and the strands follow each other in the order of the serial strand id.
+/// @sa     StrictZone::dense_index()
+using DenseIndex = std::uint32_t;
+
+
+
+/// A set of DenseIndex with a fixed number of elements. One bit per residue.
+class ResidueBitmap {
+public:
+  /// Returned by find_first() if the set is empty.
+  static constexpr DenseIndex npos = std::numeric_limits<DenseIndex>::max();
+
+  /// Make an empty set which can hold the indices in [0, n_bits).
+  explicit ResidueBitmap(std::size_t const n_bits):
+    words((n_bits + word_bits - 1) / word_bits, 0)
+  {}
+
+  bool test(DenseIndex const i) const {
+    return ((words[i / word_bits] >> (i % word_bits)) & 1u) != 0;
+  }
+
+  void set(DenseIndex const i) {
+    words[i / word_bits] |= Word{1} << (i % word_bits);
+  }
+
+  void reset(DenseIndex const i) {
+    words[i / word_bits] &= ~(Word{1} << (i % word_bits));
+  }
+
+  /// @return The smallest index in the set, or \c npos if the set is empty.
+  DenseIndex find_first() const {
+    for (std::size_t w = 0; w < words.size(); ++w) {
+      if (words[w] == 0) {
+        continue;
+      }
+      Word word = words[w];
+      DenseIndex bit = 0;
+      while ((word & 1u) == 0) {
+        word >>= 1;
+        ++bit;
+      }
+      return static_cast<DenseIndex>(w * word_bits) + bit;
+    }
+    return npos;
+  }
+
+  bool any() const { return find_first() != npos; }
+
+private:
+  using Word = std::uint64_t;
+  static constexpr std::size_t word_bits = 64;
+
+  arena::vector<Word> words;
+};
+
+
+
+/// @brief  FIFO queue of DenseIndex on a ring buffer of a fixed capacity.
+///         Never allocates after the construction.
+class ResidueQueue {
+public:
+  /// @param  capacity  The maximum number of elements in the queue at the same time.
+  explicit ResidueQueue(std::size_t const capacity):
+    buffer(capacity == 0 ? 1 : capacity)
+  {}
+
+  bool empty() const { return n_elements == 0; }
+
+  DenseIndex front() const {
+    assert(not empty());
+    return buffer[head];
+  }
+
+  void push_back(DenseIndex const i) {
+    assert(n_elements < buffer.size());
+    buffer[(head + n_elements) % buffer.size()] = i;
+    ++n_elements;
+  }
+
+  void pop_front() {
+    assert(not empty());
+    head = (head + 1) % buffer.size();
+    --n_elements;
+  }
+
+private:
+  arena::vector<DenseIndex> buffer;
+  std::size_t head{0};
+  std::size_t n_elements{0};
+};
+
+} // namespace sheet
+
+#endif // ifndef SHEET_RESIDUE_BITMAP_H_
@@ -0,0 +1,44 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef SHEET_RESIDUE_STRAND_MAP_H_
+#define SHEET_RESIDUE_STRAND_MAP_H_
+
+#include <array>
+#include <vector>
+
+#include "arena.h"
+#include "pdb/sses.h"
+#include "sheet/common.h"
+
+namespace sheet {
+
+
+// ************************************************************************
+// Class ResidueStrandMap
+// ************************************************************************
+
+/// @brief  The strand (with too short ones) each residue belongs to, for both of the
+///         N atom and the O atom. Precomputed result of
+///         SSES::sse_ind_of(resnum, 'E', 1, true, hbond_atom) over a residue range.
+class ResidueStrandMap {
+public:
+  /// @brief  Returned by operator() if the residue is not on a strand. Not an SSE ID,
+  ///         because an SSES has at most 255 SSEs (see pdb::too_many_sses).
+  static constexpr IndexType none = 255u;
+
+  ResidueStrandMap(pdb::SSES const& sses, int const first, int const last);
+
+  /// @param  hbond_atom  'N' or 'C' (the side of O atom) like SSES::sse_ind_of().
+  /// @return The SSE ID, or \c none .
+  IndexType operator()(int const resnum, char const hbond_atom) const;
+
+protected:
+  int first_res{0};
+  /// [resnum - first_res][0 for 'N', 1 for 'C']
+  arena::vector<std::array<IndexType, 2>> data{};
+};
+
+} // namespace sheet
+
+#endif // ifndef SHEET_RESIDUE_STRAND_MAP_H_
@@ -8,12 +8,15 @@
 #include <vector>
 #include <boost/range/irange.hpp>
 
+#include "parallel.h"
 #include "sheet/adj_list_with_sub.h"
 #include "sheet/find_cycle.h"
 #include "sheet/substr_pair_attr.h"
 
 namespace sheet {
 
+class Sheets;
+
 
 /// @brief  Check if the given vector of keys is undirected (by fallback mode) or not.
 /// @param  this_key_vec  A vector of Keys that should be an output of keys().
@@ -38,8 +41,11 @@ public:
   /// Merges other Sheet object into this Sheet.
   void merge(Sheet const& other);
 
-  /// Run the final processes.
-  void finish(SubStrandsPairKeyVec const& all_key_vec);
+  /// @brief  Run the final processes.
+  /// @param  previous  If given, the cycles are copied from a sheet of it with the same
+  ///                   keys in the same order, if any, instead of searched again.
+  void finish(SubStrandsPairKeyVec const& all_key_vec,
+              Sheets const* const previous = nullptr);
 
   /// Generates a set of Sub-Strands that are in any cycles.
   SubStrandSet subs_in_cycles() const;
@@ -71,8 +77,9 @@ protected:
   SubStrandsPairKeyVec keys(SubStrandsPairKeyVec const& all_key_vec) const;
 
 
-  /// Check if there is any cycles in this sheet.
-  void cycle_check(SubStrandsPairKeyVec const& this_key_vec);
+  /// @brief  Check if there is any cycles in this sheet.
+  /// @param  same  A sheet with the same keys, whose cycles are copied if not null.
+  void cycle_check(SubStrandsPairKeyVec const& this_key_vec, Sheet const* const same);
 
 
   // *******************************
@@ -101,6 +108,10 @@ protected:
   /// Keys of the AdjListWithSub inside this sheet.
   SubStrandsPairKeyVec substr_pair_keys{};
 
+  /// The keys the cycles were searched from by finish(), in their order.
+  /// Kept for the incremental construction of the next frame.
+  SubStrandsPairKeyVec cycle_keys{};
+
 };
 
 
@@ -119,7 +130,12 @@ public:
     reconstruct();
   }
 
-  void cycle_check(AdjListWithSubData const& adj_map) {
+  /// @brief  Run Sheet::finish() for all the sheets.
+  ///         The sheets are independent of each other, so they are finished in parallel.
+  /// @param  n_threads  The number of threads. 0 for the number of cores.
+  /// @param  previous   The sheets of the previous frame, if any (see Sheet::finish()).
+  void cycle_check(AdjListWithSubData const& adj_map, unsigned const n_threads = 0,
+                   Sheets const* const previous = nullptr) {
     // Prepare a vector of all keys
     SubStrandsPairKeyVec keys;
     keys.reserve(adj_map.size());
@@ -127,9 +143,10 @@ public:
       keys.push_back(pair.first);
     }
 
-    for (auto & sheet : data) {
-      sheet.finish(keys);
-    }
+    parallel::for_each_task(data.size(), n_threads, [this, &keys,
+                                                     previous](std::size_t const k) {
+      data[k].finish(keys, previous);
+    });
   }
 
 
@@ -167,7 +184,7 @@ public:
   auto cend() const { return data.cend(); }
 
 
-  using SheetVecConstIter = std::vector<Sheet>::const_iterator;
+  using SheetVecConstIter = arena::vector<Sheet>::const_iterator;
 
   /// @brief  const version of find_sheet() and argument is a 1 Sub-Strand
   SheetVecConstIter find_sheet(SubStrand const& sub) const {
@@ -183,11 +200,11 @@ public:
 
 protected:
 
-  using SheetVecIter = std::vector<Sheet>::iterator;
+  using SheetVecIter = arena::vector<Sheet>::iterator;
 
   /// @return Iterator to the first sheet that contains common Sub-Strand in \c substrs.
   ///         data.cend() if not found.
-  SheetVecIter find_sheet(std::vector<SubStrand> const& substrs) {
+  SheetVecIter find_sheet(arena::vector<SubStrand> const& substrs) {
     for (SheetVecIter iter = data.begin(); iter != data.end(); ++iter) {
       if (std::find_first_of(iter->member().cbegin(), iter->member().cend(),
                              substrs.cbegin(), substrs.cend()) != iter->member().cend()) {
@@ -216,7 +233,7 @@ protected:
     }
   }
 
-  std::vector<Sheet> data{};
+  arena::vector<Sheet> data{};
 };
 
 
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "sheet/adj_list_with_sub.h"
@@ -22,7 +23,7 @@ public:
   // *********************************************************************************
 
   struct SubStrandsIters {
-    using SubStrandsIdxIter = std::vector<SubStrand>::const_iterator;
+    using SubStrandsIdxIter = arena::vector<SubStrand>::const_iterator;
     explicit SubStrandsIters(SubStrandsIdxIter const f_, SubStrandsIdxIter const l_):
       f{f_}, l{l_}, erased{f == l} {}
     auto begin() const {return f;}
@@ -43,7 +44,7 @@ public:
 
   /// Initialize data with 1 \c default_range sub strand for each strand.
   SubStrandsRange(std::size_t const n_strands):
-    data{n_strands, std::vector<std::array<int, 2>>{1, default_range}}
+    data{n_strands, arena::vector<std::array<int, 2>>{1, default_range}}
   {}
 
 
@@ -52,6 +53,13 @@ public:
   void extend_substrand(ZoneResidue const& res);
 
 
+  /// @brief  Add the Sub-Strand of a sheet region on the strand \c str_id , whose
+  ///         resnums are \c range , as extend_substrand() and cleanup_sheet() do.
+  /// @return The Sub-Strand, and whether it is too short (and was not added).
+  std::pair<SubStrand, bool> add_substrand(IndexType const str_id,
+                                           std::array<int, 2> const& range);
+
+
   /// @brief    * Add new default_ranges for the next iteration of bfs.
   ///           * Remove the ranges that are too short.
   /// @return   A set of too short sub_strands.
@@ -61,7 +69,7 @@ public:
   /// * Remove the last default_range from all sub_strands
   /// * Sort the Sub-Strands based on the initial resnum.
   /// * Set up index_vec and sub_strands_iters_vec.
-  std::unordered_map<SubStrand, SubStrand, SubStrandHasher> finish();
+  arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> finish();
 
 
   // ********************************************
@@ -124,11 +132,11 @@ protected:
   // *********************************************************************************
 
   /// Helper function of finish(). Generates a vector of indices of sorted SubStrands.
-  std::vector<IndexType> sorted_indices(std::vector<std::array<int, 2>> const& substrs);
+  std::vector<IndexType> sorted_indices(arena::vector<std::array<int, 2>> const& substrs);
 
 
   /// Helper function of finish(). Convert index vector into a map of SubStrands.
-  std::unordered_map<SubStrand, SubStrand, SubStrandHasher> convert_to_substrand(std::vector<std::vector<IndexType>> const& changed_index_map) const;
+  arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> convert_to_substrand(std::vector<std::vector<IndexType>> const& changed_index_map) const;
 
   /// Helper function of finish(). Generates a vector of SubStrands.
   void init_index_vec();
@@ -158,15 +166,15 @@ protected:
 
 
   /// Store the range data
-  std::vector<std::vector<std::array<int, 2>>> data{};
+  arena::vector<arena::vector<std::array<int, 2>>> data{};
 
 
   /// A vector of SubStrands. SubStrands are sequentially sorted.
-  std::vector<SubStrand> index_vec{};
+  arena::vector<SubStrand> index_vec{};
 
   /// A vector of SubStrandsIters.
   /// Each element is for accessing index_vec by range-based-for loops.
-  std::vector<SubStrandsIters> sub_strands_iters_vec{};
+  arena::vector<SubStrandsIters> sub_strands_iters_vec{};
 };
 
 
@@ -38,7 +38,7 @@ struct StrandsPairAttribute {
   bool direction{true};
 
   /// A vector of jumped Sub-Strands.
-  std::vector<SubStrand> jumped_substrs{};
+  arena::vector<SubStrand> jumped_substrs{};
 };
 
 
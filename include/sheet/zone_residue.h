@@ -6,6 +6,7 @@
 
 #include <cassert>
 #include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
 
 #include "pdb/sses.h"
 #include "sheet/common.h"
@@ -27,6 +28,23 @@ struct ZoneResidue {
                     throw zone_info_failure{sse_id, resnum}
     }, has_value{true} {}
 
+  /// @brief  Non-throwing version of the constructor above.
+  /// @return boost::none if \c resnum is not on the SSE \c sse_id_ .
+  static boost::optional<ZoneResidue> make(IndexType const sse_id_, int const resnum_,
+                                           pdb::SSES const& sses) {
+    auto const found = sses.find_sse_ind(resnum_, 'E', 0, true, 'A');
+    if (not found or *found != sse_id_ or resnum_ < sses.data[sse_id_].init) {
+      return boost::none;
+    }
+    ZoneResidue ret;
+    ret.sse_id = sse_id_;
+    ret.resnum = resnum_;
+    ret.serial_str_id = sses.serial_strand_id[sse_id_];
+    ret.serial_res_id = static_cast<unsigned>(resnum_ - sses.data[sse_id_].init);
+    ret.has_value = true;
+    return ret;
+  }
+
   bool operator==(ZoneResidue const& other) const {
     return sse_id == other.sse_id and resnum == other.resnum;
   }
@@ -14,7 +14,8 @@
 #include "sheet/directed_adjacency_list.h"
 
 #include "data_store.h"
-#include "table.h"
+#include "functions.h"
+#include "result.h"
 
 namespace sheets_out {
 
@@ -23,8 +24,16 @@ namespace sheets_out {
 // **************************************************************************
 
 /// @brief  Output information of each sheet in a mmcif-like format.
-void print_sheet(table::Table<table::Sheet> & tbl,
-                 sheet::DirectedAdjacencyList const& adj);
+///         The sheets are generated in parallel and added in the order of the sheets.
+/// @param  n_threads  The number of threads. 0 for the number of cores.
+void print_sheet(std::vector<stride2top::Sheet> & sheets,
+                 sheet::DirectedAdjacencyList const& adj,
+                 unsigned const n_threads = 0);
+
+/// @brief  Helper function of print_sheet(). Generate the information of one sheet.
+stride2top::Sheet sheet_row(std::size_t const sheet_id, sheet::Sheet const& sheet,
+                            sheet::DirectedAdjacencyList const& adj,
+                            out::substr2str const& ss_writer);
 
 // Helper Functions for print_sheet()
 
@@ -46,9 +55,14 @@ std::tuple<bool, bool> check_all_pap(sheet::Sheet const& sheet, sheet::DirectedA
 // Print Extracted Sheets and Topology String
 // **************************************************************************
 
-void extracted_adjacent_substr_out(table::TBLExtractedSheet & tbl,
+/// @brief  Extract \c n adjacent Sub-Strands from each sheet and output their topology.
+///         The sheets and the extracted sets of Sub-Strands are processed in parallel.
+///         The sets are added in the order of the sheets.
+/// @param  n_threads  The number of threads. 0 for the number of cores.
+void extracted_adjacent_substr_out(std::vector<stride2top::ExtractedSheet> & extracted_sheets,
                                    unsigned const n,
-                                   sheet::DirectedAdjacencyList const& adj);
+                                   sheet::DirectedAdjacencyList const& adj,
+                                   unsigned const n_threads = 0);
 
 
 /// @brief  Check if the given vector of Sub-Strands has any cycles in it.
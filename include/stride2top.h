@@ -0,0 +1,128 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef STRIDE2TOP_H_
+#define STRIDE2TOP_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "adj_out.h"
+#include "handedness.h"
+#include "result.h"
+
+#include "pdb/sse.h"
+#include "sheet/directed_adjacency_list.h"
+
+/// @brief  The library interface (libstride2top).
+///
+///         analyze() runs the whole analysis on a structure given in memory (the SSEs,
+///         the CA coordinates and the backbone hydrogen bonds) and returns the results
+///         as plain objects, without any PDB or stride text in between.
+///         write() formats a Result exactly like the STRIDE2TOP command.
+///
+///         Most errors are thrown as the exceptions derived from pdb::fatal_error_base,
+///         but not all of them (see analyze()).
+namespace stride2top {
+
+/// The CA atom of a residue.
+struct Residue {
+  int resnum{0};
+  double x{0.0};
+  double y{0.0};
+  double z{0.0};
+};
+
+
+/// A backbone hydrogen bond N-H...O=C (the DNR records of 'stride -h').
+struct HBond {
+  /// The residue number of the N-H
+  int donor{0};
+  /// The residue number of the C=O
+  int acceptor{0};
+};
+
+
+/// A structure to analyze.
+struct Structure {
+  /// Only used in the messages.
+  std::string name{""};
+  /// The helices ('H') and strands ('E') in any order.
+  std::vector<pdb::SSE_Header> sses{};
+  /// The CA atoms. Residues without CA atoms are treated as missing.
+  std::vector<Residue> residues{};
+  std::vector<HBond> hbonds{};
+};
+
+
+/// The options of analyze(). The defaults are the same as the command line options.
+struct Options {
+  /// The number of threads. 0 for the number of cores. ('--threads')
+  unsigned threads{0};
+  /// Look up the strands of the residues in a table to detect the bridges
+  /// (sheet::BridgeEngine::StrandTable). ('--strand-table-bridges')
+  bool strand_table_bridges{false};
+  /// Extract the sheets with the given number of strands. ('--extract-sheets')
+  boost::optional<std::size_t> extract_sheets{};
+
+  // The options of the beta-alpha-beta filter (see bab::BabFilter).
+  unsigned max_mid_residues{60};
+  unsigned max_mid_strands{1};
+  double cutoff_left_score{0.6};
+  double min_side_dist{1.0};
+  bool with_stat{true};
+  bool with_loop{true};
+
+  /// Fill Result::adjacency.
+  bool adjacency{true};
+  /// Fill Result::handedness.
+  bool handedness{true};
+};
+
+
+/// The results of analyze().
+struct Result {
+  std::vector<SubStrand> substrands{};
+  std::vector<Helix> helices{};
+  std::vector<Sheet> sheets{};
+  /// Empty unless Options::extract_sheets is given.
+  std::vector<ExtractedSheet> extracted_sheets{};
+  std::vector<Cycle> cycles{};
+  std::vector<SubStrandsPair> substrands_pairs{};
+  std::vector<ResiduePair> residue_pairs{};
+  /// The residues of the PDB data with their internal residue numbers, which the other
+  /// tables use (see pdb::ResidueNumbering). Empty if they are the sequence numbers.
+  std::vector<ResidueNumber> residues{};
+  std::vector<adj_out::Adjacency> adjacency{};
+  std::vector<rare::Handedness> handedness{};
+};
+
+
+/// @brief  Analyze \c structure .
+/// @throw  pdb::fatal_error_base  If the structure can not be analyzed
+///                                (e.g. pdb::too_many_sses).
+/// @throw  std::runtime_error     If the direction of a pair of strands can not be
+///                                decided (as many parallel as anti-parallel bridges).
+/// @throw  std::out_of_range      If a Sub-Strand belongs to no sheet.
+Result analyze(Structure const& structure, Options const& options = Options{});
+
+
+/// @brief  Same as above, for a structure already read into \c adj
+///         (e.g. from the PDB and stride files).
+///         Options::strand_table_bridges is not used (the bridges are already in \c adj ).
+/// @throw  pdb::fatal_error_base, std::out_of_range  As above.
+Result analyze(sheet::DirectedAdjacencyList const& adj, Options const& options);
+
+
+/// @brief  Write \c result in the format \c format_type (0 for PDB like, 1 for mmcif
+///         like, the same as '--format-type').
+/// @throw  arg::argument_error  If \c format_type is unknown.
+void write(std::ostream & os, Result const& result, std::size_t const format_type);
+
+} // namespace stride2top
+
+#endif // ifndef STRIDE2TOP_H_
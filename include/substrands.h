@@ -8,7 +8,7 @@
 #include <unordered_map>
 
 #include "functions.h"
-#include "table.h"
+#include "result.h"
 #include "pdb/exceptions.h"
 #include "sheet/directed_adjacency_list.h"
 #include "bab/filter.h"
@@ -21,7 +21,7 @@ using SubStrandStr2SheetIdxMap = std::unordered_map<std::string, std::size_t>;
 
 
 /// @brief  Output the Sub-Strands and the resnum range of them.
-void substrands_out(table::Table<table::SubStrand> & tbl,
+void substrands_out(std::vector<stride2top::SubStrand> & substrands,
                     sheet::DirectedAdjacencyList const& adj,
                     SubStrandStr2SheetIdxMap const& sheet_id_map);
 
@@ -30,14 +30,72 @@ void substrands_out(table::Table<table::SubStrand> & tbl,
 SubStrandStr2SheetIdxMap gen_sheet_id_map(sheet::DirectedAdjacencyList const& adj);
 
 /// @brief  Output helices
-void helices_out(table::Table<table::Helix> & tbl,
+void helices_out(std::vector<stride2top::Helix> & helices,
                  sheet::DirectedAdjacencyList const& adj);
 
+/// @brief  Prefix counts to classify the connection between two Sub-Strands
+///         (SSEs_LBTS) in constant time. Built once per structure.
+///         The result is the same as check_connection_type().
+class ConnectionTypeIndex {
+public:
+  ConnectionTypeIndex(sheet::DirectedAdjacencyList const& adj);
+
+  /// @brief  Classify the connection from the \c idx0 -th to the \c idx1 -th
+  ///         Sub-Strand in adj.substrs().vec(). \c idx0 must be less than \c idx1 .
+  std::string operator()(std::size_t const idx0, std::size_t const idx1) const;
+
+  /// @brief  The number of helices between the SSEs \c sse_id_0 and \c sse_id_1 .
+  std::size_t n_helices_between(std::size_t const sse_id_0, std::size_t const sse_id_1) const;
+
+  /// @brief  The number of Sub-Strands between the \c idx0 -th and the \c idx1 -th
+  ///         Sub-Strand that belong to the sheet \c sheet_id .
+  std::size_t n_substrs_between(std::size_t const idx0, std::size_t const idx1,
+                                std::size_t const sheet_id) const;
+
+  /// The index of the sheet that the \c idx -th Sub-Strand belongs to.
+  std::size_t sheet_of(std::size_t const idx) const { return substr_sheet[idx]; }
+
+private:
+  sheet::DirectedAdjacencyList const& adj;
+
+  /// helix_prefix[k]: The number of helices whose SSE ID is less than k.
+  std::vector<std::size_t> helix_prefix{};
+
+  /// substr_sheet[i]: The sheet ID of the i-th Sub-Strand.
+  std::vector<std::size_t> substr_sheet{};
+
+  /// sheet_prefix[s][i]: The number of Sub-Strands in the sheet s among the first i.
+  std::vector<std::vector<std::size_t>> sheet_prefix{};
+};
+
+
+/// The number of Sub-Strand pairs processed at once by a thread in substrands_pair_out().
+#define PAIR_TILE_SIZE 64
+
 /// @brief  Output Sub-Strand Pairs
-void substrands_pair_out(table::TBLSubStrandsPair & tbl,
+///         The upper triangle of the pairs is split into tiles of PAIR_TILE_SIZE
+///         pairs, which are processed in parallel. The pairs are added to \c pairs in
+///         the same order as the sequential loop over (i, j > i).
+/// @param  n_threads  The number of threads. 0 for the number of cores.
+void substrands_pair_out(std::vector<stride2top::SubStrandsPair> & pairs,
                          sheet::DirectedAdjacencyList const& adj,
                          SubStrandStr2SheetIdxMap const& sheet_id_map,
-                         bab::BabFilter & bab);
+                         bab::BabFilter const& bab,
+                         unsigned const n_threads=0);
+
+
+/// @brief  Generate the Sub-Strands pair (ss0, ss1) for substrands_pair_out().
+/// @param  pseudo_seq  A sequence of SSE IDs {0, 1, ..., adj.sses.size - 1}.
+/// @exception one_directional_cycle_exception
+/// @param  idx0, idx1  Indices of the Sub-Strands in adj.substrs().vec(). (idx0 < idx1)
+stride2top::SubStrandsPair substrands_pair_row(std::size_t const idx0,
+                                               std::size_t const idx1,
+                                               sheet::DirectedAdjacencyList const& adj,
+                                               SubStrandStr2SheetIdxMap const& sheet_id_map,
+                                               bab::BabFilter const& bab,
+                                               out::substr2str const& ss_writer,
+                                               ConnectionTypeIndex const& ctype_index,
+                                               std::vector<pdb::IndexType> const& pseudo_seq);
 
 /// @brief  Return true if both ss0 and ss1 belong to the same cycle
 bool in_cycle(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
@@ -45,6 +103,8 @@ bool in_cycle(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
 
 
 /// @brief  Check the connection type from ss0 to ss1. Internnaly call gen_sses_lbts.
+///         This version scans the SSEs and Sub-Strands between ss0 and ss1.
+///         ConnectionTypeIndex gives the same result in constant time.
 std::string check_connection_type(sheet::SubStrand const& ss0,
                                   sheet::SubStrand const& ss1,
                                   sheet::DirectedAdjacencyList const& adj,
@@ -54,8 +114,8 @@ std::string check_connection_type(sheet::SubStrand const& ss0,
 
 /// @brief  Check if the substrands between itr0 and itr1 go to other sheets.
 /// @retval true if cmp returns true, false otherwise.
-bool check_middle_ss_sheet(std::vector<sheet::SubStrand>::const_iterator itr0,
-                           std::vector<sheet::SubStrand>::const_iterator itr1,
+bool check_middle_ss_sheet(arena::vector<sheet::SubStrand>::const_iterator itr0,
+                           arena::vector<sheet::SubStrand>::const_iterator itr1,
                            std::function<bool(std::size_t, std::size_t)> cmp,
                            SubStrandStr2SheetIdxMap const& sheet_id_map,
                            out::substr2str const& ss_writer);
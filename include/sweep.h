@@ -0,0 +1,74 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "parse_argument.h"
+#include "stride2top.h"
+#include "table.h"
+#include "pdb/exceptions.h"
+#include "sheet/directed_adjacency_list.h"
+
+/// @brief  The handedness of the connections for many cut-off values in one run
+///         ('--sweep'), to calibrate '--min-side-dist', '--cutoff-left-score',
+///         '--max-mid-residues' and '--max-mid-strands'.
+///
+///         The sheets and the triangles between the strands do not depend on these
+///         values, and the filter examines each connection once, recording the signed
+///         distance of each CA atom from each triangle (see bab::BabFilterRaw). The result
+///         for every combination of the values is derived from the recorded values, and
+///         is the same as that of a separate run with the values.
+namespace sweep {
+
+// **************************************************************************
+// Exception class sweep_error
+// **************************************************************************
+
+class sweep_error: public pdb::fatal_error_base {
+public:
+  explicit sweep_error(std::string const& msg_):
+    pdb::fatal_error_base{"SWEEP: " + msg_} {}
+}; // Exception class sweep_error
+
+
+
+/// The values of the cut-off options to combine.
+struct Grid {
+  std::vector<double> min_side_dist{};
+  std::vector<double> cutoff_left_score{};
+  std::vector<unsigned> max_mid_residues{};
+  std::vector<unsigned> max_mid_strands{};
+};
+
+
+/// @brief  The grid given by '--sweep' in \c vm ('NAME=V1,V2,...' for each option to
+///         sweep). The options not given take the value of the option itself.
+/// @throw  sweep_error  If an entry is not of a known option or a value is invalid.
+Grid parse_grid(bpo::variables_map const& vm);
+
+
+/// @brief  The handedness of the connections of \c adj for each combination in \c grid ,
+///         in the order of min-side-dist, max-mid-residues, max-mid-strands and
+///         cutoff-left-score (the last one changes first). The other values are taken
+///         from \c options .
+std::vector<table::Sweep> evaluate(sheet::DirectedAdjacencyList const& adj,
+                                   stride2top::Options const& options, Grid const& grid);
+
+
+/// Write the 'sweep' table of \c rows in the format \c format_type .
+void sweep_out(std::ostream & os, std::vector<table::Sweep> const& rows,
+               std::size_t const format_type);
+
+
+/// @brief  Analyze PDB_FILE given in \c vm and write the 'sweep' table of the grid of
+///         '--sweep' to \c out_stream , instead of the other results.
+void run(bpo::variables_map const& vm, std::ostream & out_stream);
+
+} // namespace sweep
+
+#endif // ifndef SWEEP_H_
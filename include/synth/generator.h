@@ -0,0 +1,105 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#ifndef SYNTH_GENERATOR_H_
+#define SYNTH_GENERATOR_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+/// @brief  Generator of synthetic beta structures (CA-only PDB and STRIDE LOC/DNR records)
+///         with a known topology, for the scaling benchmarks and the stress tests.
+namespace synth {
+
+// **************************************************************************
+// Params
+// **************************************************************************
+
+struct Params {
+  /// The number of sheets (or barrels).
+  std::size_t sheets{1};
+
+  /// The number of strands in each sheet.
+  std::size_t strands{8};
+
+  /// The number of residues of each strand.
+  std::size_t strand_len{6};
+
+  /// @brief  The orientation of each pair of neighbouring strands in a sheet.
+  ///         'a' for antiparallel, 'p' for parallel. Repeated cyclically, so "a" makes
+  ///         all-antiparallel sheets and "ap" alternates. "random" picks each pair at random.
+  std::string pattern{"a"};
+
+  /// Close each sheet into a barrel (the last strand is paired with the first one).
+  bool barrel{false};
+
+  /// Insert a helix after every this many strands along the chain. 0 for no helices.
+  std::size_t helix_every{0};
+
+  /// The number of residues of each helix.
+  std::size_t helix_len{12};
+
+  /// The number of residues of each loop between two SSEs.
+  std::size_t loop_len{3};
+
+  /// @brief  Visit the strands in a random order along the chain, instead of sheet by sheet
+  ///         from one edge to the other (meander).
+  bool shuffle{false};
+
+  /// @brief  The number of extra pairs between non-neighbouring strands of the same sheet.
+  ///         They make the sheet graph full of cycles.
+  std::size_t cross_links{0};
+
+  /// The seed of the random choices ("random" pattern, shuffle and cross_links).
+  unsigned seed{1};
+};
+
+
+
+// **************************************************************************
+// Structure
+// **************************************************************************
+
+/// The generated files.
+struct Structure {
+  /// CA-only ATOM records.
+  std::string pdb;
+
+  /// STRIDE LOC and DNR records.
+  std::string stride;
+
+  /// @brief  The ground truth in the same loop_ format as the output of STRIDE2TOP.
+  ///         Strands are identified by their SSE indices (as in _substrand.SubStrand_ID).
+  std::string truth;
+
+  /// The number of SSEs (strands and helices).
+  std::size_t n_sses{0};
+};
+
+
+
+// **************************************************************************
+// Exception class invalid_params
+// **************************************************************************
+
+class invalid_params: public std::invalid_argument {
+public:
+  explicit invalid_params(std::string const& msg):
+    std::invalid_argument{"Invalid generator parameters: " + msg} {}
+}; // Exception class invalid_params
+
+
+
+/// @brief  Generate a structure described by \c params .
+/// @throw  invalid_params  If \c params is inconsistent or the residue numbers do not fit
+///                         in the 4 columns of the PDB and STRIDE records.
+Structure generate(Params const& params);
+
+/// @brief  Write \c structure to \c prefix + ".pdb", ".stride" and ".truth".
+/// @throw  pdb::open_file_error
+void write(Structure const& structure, std::string const& prefix);
+
+} // namespace synth
+
+#endif // ifndef SYNTH_GENERATOR_H_
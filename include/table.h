@@ -12,6 +12,8 @@
 
 #include <boost/format.hpp>
 
+#include "arena.h"
+
 namespace table {
 
 // ********************************************************************
@@ -36,7 +38,8 @@ using Cycle = std::tuple<std::size_t, std::size_t, std::string>;
 // Sheet       : std::string; "same", "not"
 // Dir         : std::string; "-->", "?"
 // PorA        : std::string; "para", "anti". ? if Sheet == "not"
-// SSEs_LBTS   : std::string; one of following if not Sheet == "not"
+// SSEs_LBTS   : std::string; one of following if not Sheet == "not", and "" if B1 and
+//               B2 are on different chains
 //                b-c-b
 //                b-a-b
 //                b-b-b
@@ -49,7 +52,8 @@ using Cycle = std::tuple<std::size_t, std::size_t, std::string>;
 // D1, D2      : int; ? if Sheet == "not" or jump != 0
 // Bridge      : std::size_t; ? if Sheet == "not" jump != 0
 // Score       : double; ? if Sheet == "not" PorA == "para"
-// NumRes_LBTS : std::size_t; ? if Sheet == "not"
+// NumRes_LBTS : std::size_t; ? if Sheet == "not", and 0 if B1 and B2 are on different
+//               chains
 using SubStrandsPair = std::tuple<std::string, std::string,
                                   std::string, std::string, std::string,
                                   std::size_t, int, int, std::size_t,
@@ -61,6 +65,29 @@ using SubStrandsPair = std::tuple<std::string, std::string,
 // ForB
 using ResiduePair = std::tuple<int, int, std::string, std::string, std::string>;
 
+// internal residue number (the one in the other tables)
+// chain ID
+// sequence number
+// insertion code
+using ResidueNumber = std::tuple<int, char, int, char>;
+
+// model serial number
+// number of sheets
+// Member of each sheet, separated by ';'
+// Nomenclature_C of each sheet, separated by ';'
+// left-handed connections (SubStrand_0-SubStrand_1), separated by ','
+using Timeline = std::tuple<int, std::size_t, std::string, std::string, std::string>;
+
+// min-side-dist
+// cutoff-left-score
+// max-mid-residues
+// max-mid-strands
+// number of the connections examined (the rows of the handedness section)
+// number of the left-handed connections
+// left-handed connections (SubStrand_0-SubStrand_1), separated by ','
+using Sweep = std::tuple<double, double, unsigned, unsigned, std::size_t, std::size_t,
+                         std::string>;
+
 
 // ********************************************************************
 // Helper Templates for Formatting Tuples
@@ -176,6 +203,10 @@ public:
   }
 
 
+  /// The rows added so far.
+  arena::vector<Tuple> const& rows() const { return data; }
+
+
   std::string const name{""};
   std::vector<std::string> const col_names{};
 
@@ -192,6 +223,9 @@ protected:
                             std::size_t const end) const {
     boost::format fmt{fmt_str};
     assert(static_cast<std::size_t>(fmt.expected_args()) <= col_names.size());
+    // Turn the too_many_args exception off (like format_tuple()),
+    // so that an empty format string skips the header.
+    fmt.exceptions(boost::io::all_error_bits ^ boost::io::too_many_args_bit);
 
     for (std::size_t i = first; i < end; ++i) {
       add_header_format(fmt, col_names[i]);
@@ -217,7 +251,7 @@ protected:
   }
 
   /// Stores the actual data
-  std::vector<Tuple> data{};
+  arena::vector<Tuple> data{};
 };
 
 /// Given one tuple from Table::data, return a suitable boost::format object
@@ -244,6 +278,9 @@ using TBLExtractedSheet = Table<ExtractedSheet>;
 using TBLCycle = Table<Cycle>;
 using TBLSubStrandsPair = Table<SubStrandsPair>;
 using TBLResiduePair = Table<ResiduePair>;
+using TBLResidueNumber = Table<ResidueNumber>;
+using TBLTimeline = Table<Timeline>;
+using TBLSweep = Table<Sweep>;
 
 using Set = std::tuple<TBLSubStrand, TBLHelix, TBLSheet,
                        TBLExtractedSheet, TBLCycle, TBLSubStrandsPair,
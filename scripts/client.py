@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# Distributed under the MIT License.
+# See LICENSE.txt for details.
+
+"""A client of the server mode of STRIDE2TOP ('--serve SOCKET').
+
+Usage:
+  client.py SOCKET [--inline] [--repeat N] -- [STRIDE2TOP ARGUMENTS...]
+
+The arguments after '--' are sent as they are. With '--inline', the PDB_FILE and
+STRIDE_FILE given as the two positional arguments are read by this script and sent
+in the request, so that the server does not need to see the files.
+The output is written to standard output and the exit status is that of the request.
+"""
+
+import argparse
+import socket
+import sys
+
+
+def field(tag, value=b""):
+    return tag.encode() + b" " + str(len(value)).encode() + b"\n" + value
+
+
+def read_response(stream):
+    header = stream.readline()
+    if not header:
+        raise RuntimeError("the server closed the connection")
+    tag, status, length = header.split()
+    if tag != b"status":
+        raise RuntimeError("unexpected response: %r" % header)
+    return int(status), stream.read(int(length))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("socket")
+    parser.add_argument("--inline", action="store_true",
+                        help="send the contents of PDB_FILE and STRIDE_FILE")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="send the same request N times on one connection")
+    argv = sys.argv[1:]
+    args = []
+    if "--" in argv:
+        args = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    opts = parser.parse_args(argv)
+
+    request = b""
+    if opts.inline:
+        if len(args) < 2:
+            parser.error("--inline needs PDB_FILE and STRIDE_FILE as the last arguments")
+        files = args[-2:]
+        args = args[:-2]
+        for tag, path in zip(("pdb", "stride"), files):
+            with open(path, "rb") as f:
+                request += field(tag, f.read())
+    request = b"".join(field("arg", a.encode()) for a in args) + request + field("end")
+
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(opts.socket)
+        stream = sock.makefile("rb")
+        for _ in range(opts.repeat):
+            sock.sendall(request)
+            status, body = read_response(stream)
+        (sys.stdout if status == 0 else sys.stderr).buffer.write(body)
+        return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Distributed under the MIT License.
+# See LICENSE.txt for details.
+
+"""Diff the output of the two bridge detection engines of STRIDE2TOP.
+
+Usage:
+  compare_bridge_engines.py STRIDE2TOP DATA_DIR [--seeds N] [--drop F ...]
+
+Every NAME.pdb in DATA_DIR with NAME.stride is analyzed with and without
+'--strand-table-bridges', in both output formats. Each input is also perturbed: for
+each fraction F and each seed in [0, N), that fraction of the DNR records (H-bonds) is
+dropped at random, which gives the irregular H-bond patterns the engines could
+disagree on. The standard output, the standard error and the exit status must be
+the same. The differing runs are listed and the exit status is 1 if any.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+
+def run(binary, pdb, stride, extra):
+    proc = subprocess.run([binary, "-f", pdb, "-s", stride, "-e", "3", "-j", "1"] + extra,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    return proc.returncode, proc.stdout, proc.stderr
+
+
+def perturbed(stride_lines, fraction, seed):
+    """The STRIDE lines with the fraction of the DNR lines dropped."""
+    dnr = [i for i, line in enumerate(stride_lines) if line.startswith("DNR")]
+    rng = random.Random(seed)
+    dropped = set(rng.sample(dnr, int(len(dnr) * fraction)))
+    return [line for i, line in enumerate(stride_lines) if i not in dropped]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("binary")
+    parser.add_argument("data_dir")
+    parser.add_argument("--seeds", type=int, default=30,
+                        help="the number of perturbed inputs for each fraction")
+    parser.add_argument("--drop", type=float, action="append",
+                        help="the fraction of the H-bonds to drop (default: 0.1, 0.25)")
+    args = parser.parse_args()
+    fractions = args.drop or [0.1, 0.25]
+
+    names = sorted(f[:-len(".pdb")] for f in os.listdir(args.data_dir)
+                   if f.endswith(".pdb") and
+                   os.path.exists(os.path.join(args.data_dir, f[:-len(".pdb")] + ".stride")))
+    if not names:
+        sys.exit("no NAME.pdb and NAME.stride in " + args.data_dir)
+
+    n_runs = 0
+    failed = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in names:
+            pdb = os.path.join(args.data_dir, name + ".pdb")
+            stride = os.path.join(args.data_dir, name + ".stride")
+            with open(stride) as f:
+                lines = f.readlines()
+
+            cases = [("original", stride)]
+            for fraction in fractions:
+                for seed in range(args.seeds):
+                    path = os.path.join(tmp, "%s.%g.%d.stride" % (name, fraction, seed))
+                    with open(path, "w") as f:
+                        f.writelines(perturbed(lines, fraction, seed))
+                    cases.append(("drop %g seed %d" % (fraction, seed), path))
+
+            for label, stride_path in cases:
+                for format_type in ("0", "1"):
+                    flags = ["-t", format_type]
+                    n_runs += 1
+                    if run(args.binary, pdb, stride_path, flags) != \
+                       run(args.binary, pdb, stride_path, flags + ["--strand-table-bridges"]):
+                        failed.append("%s (%s, -t %s)" % (name, label, format_type))
+
+    for case in failed:
+        print("DIFFERENT: " + case)
+    print("%d of %d runs differ" % (len(failed), n_runs))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,9 +1,11 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "adj_out.h"
 #include "functions.h"
@@ -19,22 +21,29 @@ namespace adj_out {
 // Function adj_list_out()
 // **********************************************************************************
 
-void adj_list_out(std::ostream & os, sheet::DirectedAdjacencyList const& adj) {
+void adj_list_out(std::ostream & os, std::vector<Adjacency> const& adj_list) {
   mmcif::mmcif_like const out{os, "adjacency_list"};
 
-  auto const adj_vec = gen_adj_list_vec(adj);
-  out.key_value("num", adj_vec.size());
+  out.key_value("num", adj_list.size());
 
   // if no adj_lists
-  if (adj_vec.size() == 0) {
+  if (adj_list.size() == 0) {
     return;
   }
 
   out.loop_head({"sheet_id", "direction", "delta_1", "delta_2", "num_bridges",
                  "substr_0", "substr_1"});
 
-  for (auto const str : adj_vec) {
-    os << str << "\n";
+  for (auto const& row : adj_list) {
+    os << boost::format("%3d  %13s %3d %3d %3d  %5s %5s")
+            % row.sheet_id
+            % (row.parallel ? "Parallel" : "Anti-Parallel")
+            % row.delta_1
+            % row.delta_2
+            % row.num_bridges
+            % row.substr_0
+            % row.substr_1
+       << "\n";
   }
 
 } // function adj_list_out()
@@ -42,36 +51,26 @@ void adj_list_out(std::ostream & os, sheet::DirectedAdjacencyList const& adj) {
 
 
 // **********************************************************************************
-// Function gen_adj_list_vec()
+// Function gen_adj_list()
 // **********************************************************************************
 
-std::vector<std::string> gen_adj_list_vec(sheet::DirectedAdjacencyList const& adj) {
-  std::vector<std::string> adj_vec;
+std::vector<Adjacency> gen_adj_list(sheet::DirectedAdjacencyList const& adj) {
+  std::vector<Adjacency> adj_list;
 
   auto const n_sheets = adj.sheets.size();
-  out::substr2str ss_writer(std::make_shared<sheet::DirectedAdjacencyList>(adj));
-
-  unsigned counter = 0;
-  for (unsigned sheet_idx = 0; sheet_idx < n_sheets; ++sheet_idx) {
+  for (std::size_t sheet_idx = 0; sheet_idx < n_sheets; ++sheet_idx) {
     auto const& sheet = adj.sheets[sheet_idx];
     for (auto const& pair_key : sheet.substr_keys()) {
       auto const& data = adj.adj_sub().map().at(pair_key);
-      auto const str = (boost::format("%3d  %13s %3d %3d %3d  %5s %5s")
-                                % sheet_idx
-                                % (data.direction ? "Parallel" : "Anti-Parallel")
-                                % data.delta_1
-                                % data.delta_2
-                                % data.residue_pairs
-                                % ss_writer(pair_key.sub0())
-                                % ss_writer(pair_key.sub1())
-                       ).str();
-      adj_vec.push_back(str);
-      ++counter;
+      adj_list.push_back(Adjacency{sheet_idx, data.direction, data.delta_1, data.delta_2,
+                                   data.residue_pairs,
+                                   out::substr2str::str(pair_key.sub0(), adj),
+                                   out::substr2str::str(pair_key.sub1(), adj)});
     }
   }
 
-  return adj_vec;
-} // function gen_adj_list_vec()
+  return adj_list;
+} // function gen_adj_list()
 
 
 } // namespace adj_out
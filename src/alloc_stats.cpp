@@ -0,0 +1,73 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_stats.h"
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> bytes{0};
+
+void * counted_malloc(std::size_t const size) {
+  if (counting.load(std::memory_order_relaxed)) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  if (void * const ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+} // namespace
+
+
+
+// Replacement of the global allocation functions.
+// The array and nothrow forms are forwarded to these by the standard library.
+void * operator new(std::size_t const size) {
+  return counted_malloc(size);
+}
+
+void * operator new[](std::size_t const size) {
+  return counted_malloc(size);
+}
+
+void operator delete(void * const ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void * const ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void * const ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void * const ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+
+
+namespace alloc_stats {
+
+void enable() {
+  counting.store(true, std::memory_order_relaxed);
+}
+
+std::size_t n_allocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t n_bytes() {
+  return bytes.load(std::memory_order_relaxed);
+}
+
+} // namespace alloc_stats
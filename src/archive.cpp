@@ -0,0 +1,562 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "archive.h"
+#include "pipeline.h"
+#include "profile.h"
+
+#include "pdb/gzip.h"
+#include "pdb/tools.h"
+
+namespace archive {
+
+namespace {
+
+/// The size of a block of a tar archive.
+constexpr std::size_t block_size = 512;
+
+/// The most files waiting for their pair in a tar archive.
+constexpr std::size_t max_pending_files = 4096;
+
+/// The most entries read ahead of the analysis.
+constexpr std::size_t queue_capacity = 4;
+
+
+/// The NUL-terminated string in the field [offset, offset + length) of a tar header.
+std::string header_field(char const * const header, std::size_t const offset,
+                         std::size_t const length) {
+  auto const begin = header + offset;
+  return std::string(begin, std::find(begin, begin + length, '\0'));
+}
+
+
+/// @brief  The number in the field [offset, offset + length) of a tar header: octal, or
+///         big-endian binary if the first bit is set (GNU, for the sizes over 8 GB).
+std::uint64_t header_number(char const * const header, std::size_t const offset,
+                            std::size_t const length) {
+  auto const field = reinterpret_cast<unsigned char const *>(header + offset);
+  std::uint64_t value = 0;
+  if (field[0] & 0x80) {
+    value = field[0] & 0x7f;
+    for (std::size_t i = 1; i < length; ++i) {
+      value = value << 8 | field[i];
+    }
+    return value;
+  }
+  for (std::size_t i = 0; i < length; ++i) {
+    if ('0' <= field[i] and field[i] <= '7') {
+      value = value * 8 + (field[i] - '0');
+    } else if (field[i] != ' ' or value != 0) {
+      break;
+    }
+  }
+  return value;
+}
+
+
+/// @brief  Whether the checksum of the tar header matches: the sum of its bytes with the
+///         checksum field as spaces (unsigned, or signed as some old tars wrote it).
+bool valid_checksum(char const * const header) {
+  std::uint64_t unsigned_sum = 0;
+  std::int64_t signed_sum = 0;
+  for (std::size_t i = 0; i < block_size; ++i) {
+    auto const c = (148 <= i and i < 156) ? ' ' : header[i];
+    unsigned_sum += static_cast<unsigned char>(c);
+    signed_sum += static_cast<signed char>(c);
+  }
+  auto const stored = header_number(header, 148, 8);
+  return stored == unsigned_sum or static_cast<std::int64_t>(stored) == signed_sum;
+}
+
+
+/// The 'path' in the pax extended header \c data ('LENGTH KEY=VALUE\n' records).
+std::string pax_path(std::string const& data) {
+  for (std::size_t pos = 0; pos < data.size();) {
+    auto const space = data.find(' ', pos);
+    if (space == std::string::npos) {
+      break;
+    }
+    auto const length = std::stoul(data.substr(pos, space - pos));
+    if (length == 0 or data.size() < pos + length) {
+      break;
+    }
+    auto const record = data.substr(space + 1, pos + length - space - 2);
+    auto const eq = record.find('=');
+    if (record.substr(0, eq) == "path") {
+      return record.substr(eq + 1);
+    }
+    pos += length;
+  }
+  return "";
+}
+
+
+/// The name of the entry of the PDB data \c pdb_text : the ID code in HEADER, or \c fallback .
+std::string entry_name(std::string const& pdb_text, std::string const& fallback) {
+  std::istringstream iss{pdb_text};
+  for (std::string line; std::getline(iss, line);) {
+    if (line.compare(0, 6, "HEADER") == 0 and 66 <= line.size()) {
+      auto const id = line.substr(62, 4);
+      if (id.find_first_not_of(' ') != std::string::npos) {
+        return id;
+      }
+    }
+  }
+  return fallback;
+}
+
+
+/// The record name of a line of PDB data (e.g. "END" for "END   ").
+std::string record_name(std::string const& line) {
+  auto const record = line.substr(0, 6);
+  return record.substr(0, record.find_last_not_of(" \r") + 1);
+}
+
+
+/// Whether \c text has nothing but white spaces.
+bool is_blank(std::string const& text) {
+  return text.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+
+
+/// An entry read from the input, to be analyzed.
+struct Entry {
+  pipeline::Input input;
+  /// The name in the header of the output.
+  std::string name;
+};
+
+
+/// @brief  The entries read by the reader thread and waiting for the analysis. At most
+///         \c capacity are kept, so that the reader does not run far ahead.
+class EntryQueue {
+public:
+  explicit EntryQueue(std::size_t const capacity_): capacity{capacity_} {}
+
+  /// Add \c entry , waiting for room. Does nothing if the analysis was stopped.
+  void push(Entry && entry) {
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [this]() { return entries.size() < capacity or stopped; });
+    if (not stopped) {
+      entries.push_back(std::move(entry));
+      cv.notify_all();
+    }
+  }
+
+  /// @brief  Take the next entry, waiting for it.
+  /// @return false after the reader finished and all the entries were taken.
+  bool pop(Entry & entry) {
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [this]() { return not entries.empty() or finished; });
+    if (entries.empty()) {
+      return false;
+    }
+    entry = std::move(entries.front());
+    entries.pop_front();
+    cv.notify_all();
+    return true;
+  }
+
+  /// The reader finished (with the exception \c error_ , if any).
+  void finish(std::exception_ptr const error_) {
+    std::lock_guard<std::mutex> lock{mutex};
+    finished = true;
+    error = error_;
+    cv.notify_all();
+  }
+
+  /// The analysis stopped: let the reader finish without waiting.
+  void stop() {
+    std::lock_guard<std::mutex> lock{mutex};
+    stopped = true;
+    cv.notify_all();
+  }
+
+  /// The exception of the reader, if any.
+  std::exception_ptr reader_error() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return error;
+  }
+
+private:
+  std::size_t const capacity;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Entry> entries;
+  bool finished{false};
+  bool stopped{false};
+  std::exception_ptr error{nullptr};
+};
+
+
+/// @brief  Analyze the entries which \c read pushes to the queue, and write the results.
+///         \c read runs in its own thread, so that the reading (and the decompression) of
+///         the next entries overlaps with the analysis.
+/// @return The number of the entries which failed, plus the return value of \c read .
+template <class Reader>
+std::size_t run_entries(bpo::variables_map const& vm, std::ostream & out_stream,
+                        Reader read) {
+  auto const format_type = vm["format-type"].as<std::size_t>();
+
+  EntryQueue queue{queue_capacity};
+  std::size_t n_skipped = 0;
+  std::thread reader{[&]() {
+    try {
+      n_skipped = read(queue);
+      queue.finish(nullptr);
+    } catch (...) {
+      queue.finish(std::current_exception());
+    }
+  }};
+
+  std::size_t n_failed = 0;
+  // the memory of each entry, reused by the next one
+  arena::StructureArena memory;
+  try {
+    Entry entry;
+    while (queue.pop(entry)) {
+      // The output is buffered, so that a failed entry writes nothing.
+      std::ostringstream oss;
+      try {
+        profile::StructureScope const structure_scope{entry.name};
+        arena::StructureScope const memory_scope{memory};
+        pipeline::run(vm, entry.input, oss);
+      } catch (std::exception const& e) {
+        profile::count(profile::Counter::Exceptions);
+        std::cerr << entry.input.pdb_name << ": " << e.what() << std::endl;
+        ++n_failed;
+        continue;
+      }
+      if (format_type == 1) {
+        out_stream << "data_" << entry.name << "\n" << oss.str();
+      } else {
+        out_stream << "ENTRY     " << entry.name << "\n" << oss.str() << "END\n";
+      }
+      out_stream.flush();
+    }
+  } catch (...) {
+    queue.stop();
+    reader.join();
+    throw;
+  }
+  reader.join();
+
+  if (auto const error = queue.reader_error()) {
+    std::rethrow_exception(error);
+  }
+  return n_failed + n_skipped;
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Class TarReader
+// **************************************************************************
+
+bool TarReader::next(Member & member) {
+  // from the GNU long name or the pax header before the member
+  std::string long_name;
+
+  for (;;) {
+    char header[block_size];
+    is.read(header, block_size);
+    // the end without the two zero blocks
+    if (is.gcount() == 0) {
+      return false;
+    }
+    if (static_cast<std::size_t>(is.gcount()) != block_size) {
+      throw archive_error{"TRUNCATED TAR HEADER"};
+    }
+    // the end of the archive
+    if (std::all_of(header, header + block_size, [](char const c) { return c == '\0'; })) {
+      return false;
+    }
+    if (not valid_checksum(header)) {
+      throw archive_error{"BROKEN TAR HEADER (CHECKSUM MISMATCH)"};
+    }
+
+    auto const size = static_cast<std::size_t>(header_number(header, 124, 12));
+    auto const type = header[156];
+    switch (type) {
+      // GNU long name of the next member
+      case 'L': {
+        auto const data = read_data(size);
+        long_name = data.substr(0, data.find('\0'));
+        continue;
+      }
+
+      // pax extended header of the next member
+      case 'x': {
+        auto const path = pax_path(read_data(size));
+        if (not path.empty()) {
+          long_name = path;
+        }
+        continue;
+      }
+
+      // regular files
+      case '0': case '\0': case '7': {
+        if (long_name.empty()) {
+          long_name = header_field(header, 0, 100);
+          auto const prefix = header_field(header, 345, 155);
+          if (header_field(header, 257, 5) == "ustar" and not prefix.empty()) {
+            long_name = prefix + "/" + long_name;
+          }
+        }
+        member.name = long_name;
+        member.contents = read_data(size);
+        return true;
+      }
+
+      // directories, links, global pax headers, ...
+      default:
+        read_data(size);
+        long_name.clear();
+    }
+  }
+} // public member function next()
+
+
+
+std::string TarReader::read_data(std::size_t const size) {
+  std::string data(size, '\0');
+  is.read(&data[0], static_cast<std::streamsize>(size));
+  if (static_cast<std::size_t>(is.gcount()) != size) {
+    throw archive_error{"TRUNCATED TAR MEMBER"};
+  }
+  is.ignore(static_cast<std::streamsize>((block_size - size % block_size) % block_size));
+  return data;
+} // private member function read_data()
+
+
+
+// **************************************************************************
+// Class EntryReader
+// **************************************************************************
+
+bool EntryReader::next(std::string & text) {
+  text.clear();
+  bool in_model = false;
+
+  for (std::string line; std::getline(is, line);) {
+    auto const record = record_name(line);
+    bool separator = false;
+    if (record == "MODEL") {
+      in_model = true;
+    } else if (record == "ENDMDL") {
+      separator = not in_model;
+      in_model = false;
+    } else if (record == "END") {
+      separator = true;
+    }
+
+    if (not separator) {
+      text += line;
+      text += '\n';
+    } else if (is_blank(text)) {
+      // consecutive separators
+      text.clear();
+    } else {
+      return true;
+    }
+  }
+  return not is_blank(text);
+} // public member function next()
+
+
+
+// **************************************************************************
+// Class Pairer
+// **************************************************************************
+
+bool Pairer::add(Member && member, pipeline::Input & input) {
+  auto const kind = classify(member.name);
+  if (kind.first.empty()) {
+    return false;
+  }
+  auto const& id = kind.second;
+  bool const is_pdb = kind.first == "pdb";
+
+  auto const pair = index.find({id, not is_pdb});
+  if (pair != index.end()) {
+    auto & other = pair->second->member;
+    auto & pdb = is_pdb ? member : other;
+    auto & stride = is_pdb ? other : member;
+    input.pdb_name = std::move(pdb.name);
+    input.pdb_text = std::move(pdb.contents);
+    input.stride_text = std::move(stride.contents);
+    pending.erase(pair->second);
+    index.erase(pair);
+    return true;
+  }
+
+  // A second file of the same kind replaces the first one.
+  auto const same = index.find({id, is_pdb});
+  if (same != index.end()) {
+    dropped.push_back(same->second->member.name);
+    pending.erase(same->second);
+    index.erase(same);
+  }
+
+  pending.push_back(Pending{id, is_pdb, std::move(member)});
+  index[{id, is_pdb}] = std::prev(pending.end());
+
+  if (max_pending < pending.size()) {
+    auto const& oldest = pending.front();
+    dropped.push_back(oldest.member.name);
+    index.erase({oldest.id, oldest.is_pdb});
+    pending.pop_front();
+  }
+  return false;
+} // public member function add()
+
+
+
+std::vector<std::string> Pairer::take_dropped() {
+  std::vector<std::string> ret;
+  ret.swap(dropped);
+  return ret;
+} // public member function take_dropped()
+
+
+
+std::vector<std::string> Pairer::unpaired() const {
+  std::vector<std::string> names;
+  for (auto const& file : pending) {
+    names.push_back(file.member.name);
+  }
+  return names;
+} // public member function unpaired()
+
+
+
+// **************************************************************************
+// Function classify()
+// **************************************************************************
+
+std::pair<std::string, std::string> classify(std::string const& name) {
+  auto base = pdb::basename(name);
+  // gzipped (decompressed by the reader)
+  if (3 < base.size() and base.compare(base.size() - 3, 3, ".gz") == 0) {
+    base.erase(base.size() - 3);
+  }
+  auto const dot = base.find_last_of('.');
+  if (dot == std::string::npos or dot == 0) {
+    return {"", ""};
+  }
+  auto const ext = base.substr(dot);
+  auto id = base.substr(0, dot);
+
+  if (ext == ".pdb") {
+    return {"pdb", id};
+  }
+  // the file names of the PDB archive: pdbXXXX.ent
+  if (ext == ".ent") {
+    if (id.compare(0, 3, "pdb") == 0 and 3 < id.size()) {
+      id.erase(0, 3);
+    }
+    return {"pdb", id};
+  }
+  if (ext == ".stride" or ext == ".str") {
+    return {"stride", id};
+  }
+  return {"", ""};
+} // function classify()
+
+
+
+// **************************************************************************
+// Function run()
+// **************************************************************************
+
+std::size_t run(bpo::variables_map const& vm, std::ostream & out_stream) {
+  // ***************
+  // tar archive
+  // ***************
+  if (vm.count("tar")) {
+    auto const tar_file = vm["tar"].as<std::string>();
+    return run_entries(vm, out_stream, [&tar_file](EntryQueue & queue) {
+      std::unique_ptr<pdb::input_stream> const is{
+          tar_file == "-" ? new pdb::input_stream{std::cin} : new pdb::input_stream{tar_file}};
+      TarReader reader{*is};
+      Pairer pairer{max_pending_files};
+      std::size_t n_unpaired = 0;
+      auto const give_up = [&n_unpaired](std::vector<std::string> const& names) {
+        for (auto const& name : names) {
+          pdb::warning("No pair of '" + name + "' in the archive. Skipped.");
+          ++n_unpaired;
+        }
+      };
+
+      Member member;
+      Entry entry;
+      while (reader.next(member)) {
+        // the members may be gzipped themselves (e.g. pdbXXXX.ent.gz)
+        member.contents = pdb::decompress(std::move(member.contents));
+        if (pairer.add(std::move(member), entry.input)) {
+          entry.name = classify(entry.input.pdb_name).second;
+          queue.push(std::move(entry));
+        }
+        give_up(pairer.take_dropped());
+      }
+      give_up(pairer.unpaired());
+      return n_unpaired;
+    });
+  }
+
+  // ***************
+  // concatenated entries
+  // ***************
+  if (vm["with-stride"].as<bool>()) {
+    throw arg::argument_error{"'--with-stride' can not be used with '--concatenated'."};
+  }
+  return run_entries(vm, out_stream, [&vm](EntryQueue & queue) {
+    auto const pdb_file = vm["pdb-file"].as<std::string>();
+    pdb::input_stream pdb_is{pdb_file};
+    std::unique_ptr<pdb::input_stream> const stride_is{
+        vm.count("stride-file") ?
+          new pdb::input_stream{vm["stride-file"].as<std::string>()} :
+          new pdb::input_stream{std::cin}};
+    EntryReader pdbs{pdb_is};
+    EntryReader strides{*stride_is};
+
+    Entry entry;
+    for (std::size_t i = 1;; ++i) {
+      bool const has_pdb = pdbs.next(entry.input.pdb_text);
+      bool const has_stride = strides.next(entry.input.stride_text);
+      if (not has_pdb and not has_stride) {
+        break;
+      }
+      if (has_pdb != has_stride) {
+        throw archive_error{std::string{has_pdb ? "STRIDE_FILE" : "PDB_FILE"} +
+                            " ENDS AFTER " + std::to_string(i - 1) + " ENTRIES"};
+      }
+      auto const fallback = pdb_file + ":" + std::to_string(i);
+      entry.name = entry_name(entry.input.pdb_text, fallback);
+      entry.input.pdb_name = entry.name == fallback ? fallback : pdb_file + ":" + entry.name;
+      queue.push(std::move(entry));
+    }
+    return std::size_t{0};
+  });
+} // function run()
+
+} // namespace archive
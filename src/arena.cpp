@@ -0,0 +1,43 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <cstddef>
+#include <new>
+
+#include "arena.h"
+
+namespace arena {
+
+namespace detail {
+thread_local MemoryResource * current_resource{nullptr};
+} // namespace detail
+
+
+namespace {
+
+/// The resource of new_delete_resource().
+class NewDeleteResource : public MemoryResource {
+protected:
+  void * do_allocate(std::size_t const bytes, std::size_t) override {
+    return ::operator new(bytes);
+  }
+
+  void do_deallocate(void * const p, std::size_t, std::size_t) override {
+    ::operator delete(p);
+  }
+};
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function new_delete_resource()
+// **************************************************************************
+
+MemoryResource * new_delete_resource() noexcept {
+  static NewDeleteResource resource;
+  return &resource;
+} // function new_delete_resource()
+
+} // namespace arena
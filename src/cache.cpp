@@ -0,0 +1,218 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/format.hpp>
+#include <boost/optional.hpp>
+
+#include "cache.h"
+#include "pdb/tools.h"
+
+namespace cache {
+
+namespace {
+
+constexpr std::uint32_t round_constants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline std::uint32_t rotr(std::uint32_t const x, unsigned const n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+
+/// mkdir() which succeeds if \c dir already exists.
+void make_dir(std::string const& dir) {
+  if (::mkdir(dir.c_str(), 0777) != 0 and errno != EEXIST) {
+    throw cache_error{"CANNOT CREATE THE DIRECTORY '" + dir + "': " + std::strerror(errno)};
+  }
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Class Sha256
+// **************************************************************************
+
+Sha256::Sha256():
+  state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+  buffer{}
+{} // constructor
+
+
+
+Sha256 & Sha256::update(std::string const& data) {
+  auto const * p = reinterpret_cast<unsigned char const *>(data.data());
+  auto n = data.size();
+  length += n;
+
+  // fill the partial block first
+  if (buffered != 0) {
+    auto const take = std::min(n, sizeof(buffer) - buffered);
+    std::memcpy(buffer + buffered, p, take);
+    buffered += take;
+    p += take;
+    n -= take;
+    if (buffered < sizeof(buffer)) {
+      return *this;
+    }
+    compress(buffer);
+    buffered = 0;
+  }
+
+  for (; n >= sizeof(buffer); p += sizeof(buffer), n -= sizeof(buffer)) {
+    compress(p);
+  }
+  std::memcpy(buffer, p, n);
+  buffered = n;
+  return *this;
+} // public member function update()
+
+
+
+Sha256 & Sha256::field(std::string const& data) {
+  return update(std::to_string(data.size()) + ":").update(data);
+} // public member function field()
+
+
+
+std::string Sha256::hex() const {
+  // pad a copy, so that more data can be appended to this one
+  Sha256 last{*this};
+  std::uint64_t const bits = length * 8;
+  std::string padding(1, '\x80');
+  padding.append((119 - buffered) % 64, '\0');
+  for (int i = 7; 0 <= i; --i) {
+    padding.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+  }
+  last.update(padding);
+
+  std::string ret;
+  for (auto const word : last.state) {
+    ret += (boost::format("%08x") % word).str();
+  }
+  return ret;
+} // public member function hex()
+
+
+
+void Sha256::compress(unsigned char const * const block) {
+  std::uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = static_cast<std::uint32_t>(block[4 * i]) << 24 |
+           static_cast<std::uint32_t>(block[4 * i + 1]) << 16 |
+           static_cast<std::uint32_t>(block[4 * i + 2]) << 8 |
+           static_cast<std::uint32_t>(block[4 * i + 3]);
+  }
+  for (int i = 16; i < 64; ++i) {
+    auto const s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    auto const s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  auto a = state[0], b = state[1], c = state[2], d = state[3];
+  auto e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    auto const t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) +
+                    round_constants[i] + w[i];
+    auto const t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+  state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+} // private member function compress()
+
+
+
+// **************************************************************************
+// Function sha256()
+// **************************************************************************
+
+std::string sha256(std::string const& data) {
+  return Sha256{}.update(data).hex();
+} // function sha256()
+
+
+
+// **************************************************************************
+// Class Store
+// **************************************************************************
+
+Store::Store(std::string const& dir_): dir{dir_} {
+  make_dir(dir);
+} // constructor
+
+
+
+boost::optional<std::string> Store::get(std::string const& kind,
+                                        std::string const& key) const {
+  std::ifstream ifs{path(kind, key), std::ios::binary};
+  if (not ifs) {
+    return boost::none;
+  }
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+} // public member function get()
+
+
+
+void Store::put(std::string const& kind, std::string const& key,
+                std::string const& contents) const {
+  make_dir(dir + "/" + kind);
+
+  // Write a temporary file in the same directory, then rename it into place atomically.
+  auto const final_path = path(kind, key);
+  auto const tmp_path = final_path + ".tmp." + std::to_string(::getpid()) + "." +
+                        pdb::rand_str(8);
+  {
+    std::ofstream ofs{tmp_path, std::ios::binary};
+    ofs << contents;
+    ofs.close();
+    if (not ofs) {
+      std::remove(tmp_path.c_str());
+      throw cache_error{"CANNOT WRITE '" + tmp_path + "'"};
+    }
+  }
+  if (std::rename(tmp_path.c_str(), final_path.c_str()) != 0) {
+    auto const error = std::strerror(errno);
+    std::remove(tmp_path.c_str());
+    throw cache_error{"CANNOT RENAME '" + tmp_path + "': " + error};
+  }
+} // public member function put()
+
+
+
+std::string Store::path(std::string const& kind, std::string const& key) const {
+  return dir + "/" + kind + "/" + key;
+} // private member function path()
+
+} // namespace cache
@@ -0,0 +1,430 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include "corpus.h"
+#include "ensemble.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "sweep.h"
+
+namespace corpus {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// The longest error message passed from a child to the parent.
+constexpr std::size_t max_message = 4096;
+
+
+/// A structure being analyzed in a child process.
+struct Job {
+  Entry entry;
+  /// The output file, written as out_file + ".part" until the child finishes.
+  std::string out_file;
+  Clock::time_point start;
+  /// The read end of the pipe for the error message.
+  int message_fd;
+  bool timed_out;
+};
+
+
+/// The result of a Job, as recorded in the journal.
+struct Outcome {
+  std::string status;
+  std::string error_class;
+  std::string message;
+};
+
+
+/// @return The demangled name of the dynamic type of \c e .
+std::string class_name(std::exception const& e) {
+  int status = 0;
+  char * const demangled = abi::__cxa_demangle(typeid(e).name(), nullptr, nullptr, &status);
+  std::string const name = status == 0 ? demangled : typeid(e).name();
+  std::free(demangled);
+  return name;
+}
+
+
+/// Make \c str fit in one field of the journal (no colors, tabs or newlines).
+std::string journal_field(std::string const& str) {
+  static std::regex const color{"\033\\[[0-9;]*m"};
+  static std::regex const space{"[\t\r\n]+"};
+  return std::regex_replace(std::regex_replace(str, color, ""), space, " ");
+}
+
+
+/// The options of one structure: those of the corpus, with the input files of \c entry .
+bpo::variables_map entry_options(bpo::variables_map const& vm, Entry const& entry) {
+  auto options = vm;
+  auto & map = static_cast<std::map<std::string, bpo::variable_value> &>(options);
+  map["pdb-file"] = bpo::variable_value{entry.pdb_file, false};
+  map.erase("stride-file");
+  if (not entry.stride_file.empty()) {
+    map["stride-file"] = bpo::variable_value{entry.stride_file, false};
+  } else if (not vm["with-stride"].as<bool>()) {
+    throw arg::argument_error{"No STRIDE_FILE for '" + entry.pdb_file +
+                              "' and '--with-stride' is not given."};
+  }
+  // The structures run in parallel processes instead.
+  map["threads"] = bpo::variable_value{1u, false};
+  return options;
+}
+
+
+/// @brief  The body of a child process: analyze \c entry and exit. The error message
+///         (class, tab, message) is written to \c message_fd .
+[[noreturn]] void run_child(bpo::variables_map const& vm, Entry const& entry,
+                            std::string const& out_file, int const message_fd) {
+  auto const memory_mb = vm["memory-limit"].as<std::size_t>();
+  if (memory_mb != 0) {
+    rlim_t const bytes = static_cast<rlim_t>(memory_mb) * 1024 * 1024;
+    struct rlimit const limit{bytes, bytes};
+    setrlimit(RLIMIT_AS, &limit);
+  }
+
+  auto const part_file = out_file + ".part";
+  std::string error;
+  try {
+    std::ofstream ofs{part_file};
+    if (not ofs) {
+      throw corpus_error{"CANNOT OPEN '" + part_file + "'"};
+    }
+    auto const options = entry_options(vm, entry);
+    if (options.count("sweep")) {
+      sweep::run(options, ofs);
+    } else if (not arg::all_models(options)) {
+      pipeline::run(options, ofs);
+    } else if (ensemble::run(options, ofs) != 0) {
+      throw corpus_error{"SOME MODELS FAILED"};
+    }
+    ofs.close();
+    if (not ofs) {
+      throw corpus_error{"CANNOT WRITE '" + part_file + "'"};
+    }
+    if (std::rename(part_file.c_str(), out_file.c_str()) != 0) {
+      throw corpus_error{"CANNOT RENAME '" + part_file + "': " + std::strerror(errno)};
+    }
+  } catch (std::exception const& e) {
+    error = class_name(e) + "\t" + e.what();
+  } catch (...) {
+    error = "unknown\t";
+  }
+
+  if (error.empty()) {
+    _exit(0);
+  }
+  std::remove(part_file.c_str());
+  error.resize(std::min(error.size(), max_message));
+  for (std::size_t written = 0; written < error.size();) {
+    auto const n = ::write(message_fd, error.data() + written, error.size() - written);
+    if (n <= 0) {
+      break;
+    }
+    written += static_cast<std::size_t>(n);
+  }
+  _exit(2);
+}
+
+
+/// Read the error message of a finished child.
+std::string read_message(int const fd) {
+  std::string message;
+  char buffer[512];
+  for (;;) {
+    auto const n = ::read(fd, buffer, sizeof(buffer));
+    if (n < 0 and errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    message.append(buffer, static_cast<std::size_t>(n));
+  }
+  return message;
+}
+
+
+/// The name of the signal \c sig (e.g. "SIGSEGV").
+std::string signal_name(int const sig) {
+  switch (sig) {
+    case SIGABRT: return "SIGABRT";
+    case SIGBUS:  return "SIGBUS";
+    case SIGFPE:  return "SIGFPE";
+    case SIGILL:  return "SIGILL";
+    case SIGKILL: return "SIGKILL";
+    case SIGSEGV: return "SIGSEGV";
+    case SIGTERM: return "SIGTERM";
+    case SIGXCPU: return "SIGXCPU";
+    default:      return "SIG" + std::to_string(sig);
+  }
+}
+
+
+/// The Outcome of a child which exited with \c wait_status .
+Outcome outcome_of(Job const& job, int const wait_status) {
+  auto const message = read_message(job.message_fd);
+  if (job.timed_out) {
+    return Outcome{"timeout", "-", "exceeded the time limit"};
+  }
+  if (WIFSIGNALED(wait_status)) {
+    auto const sig = WTERMSIG(wait_status);
+    return Outcome{"crashed", signal_name(sig), strsignal(sig)};
+  }
+  if (WEXITSTATUS(wait_status) == 0) {
+    return Outcome{"ok", "-", "-"};
+  }
+  auto const tab = message.find('\t');
+  if (tab == std::string::npos) {
+    return Outcome{"failed", "unknown", message};
+  }
+  return Outcome{"failed", message.substr(0, tab), message.substr(tab + 1)};
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function read_list()
+// **************************************************************************
+
+std::vector<Entry> read_list(std::string const& list_file) {
+  std::ifstream ifs{list_file};
+  if (not ifs) {
+    throw corpus_error{"CANNOT OPEN THE LIST '" + list_file + "'"};
+  }
+
+  std::vector<Entry> entries;
+  for (std::string line; std::getline(ifs, line);) {
+    std::istringstream iss{line};
+    Entry entry;
+    if (not (iss >> entry.pdb_file) or entry.pdb_file[0] == '#') {
+      continue;
+    }
+    iss >> entry.stride_file;
+    entries.push_back(entry);
+  }
+  return entries;
+} // function read_list()
+
+
+
+// **************************************************************************
+// Function select_shard()
+// **************************************************************************
+
+std::vector<Entry> select_shard(std::vector<Entry> const& entries, std::string const& shard) {
+  std::smatch match;
+  if (not std::regex_match(shard, match, std::regex{"([0-9]+)/([0-9]+)"})) {
+    throw arg::argument_error{"'--shard' must be K/N: '" + shard + "'"};
+  }
+  auto const k = std::stoul(match[1]);
+  auto const n = std::stoul(match[2]);
+  if (n == 0 or n <= k) {
+    throw arg::argument_error{"'--shard' must be K/N with 0 <= K < N: '" + shard + "'"};
+  }
+
+  std::vector<Entry> selected;
+  for (std::size_t i = k; i < entries.size(); i += n) {
+    selected.push_back(entries[i]);
+  }
+  return selected;
+} // function select_shard()
+
+
+
+// **************************************************************************
+// Function read_journal()
+// **************************************************************************
+
+std::set<std::string> read_journal(std::string const& journal_file) {
+  std::set<std::string> done;
+  std::ifstream ifs{journal_file};
+  for (std::string line; std::getline(ifs, line);) {
+    // without a newline
+    if (ifs.eof()) {
+      break;
+    }
+    auto const tab = line.find('\t');
+    if (tab != std::string::npos) {
+      done.insert(line.substr(0, tab));
+    }
+  }
+  return done;
+} // function read_journal()
+
+
+
+// **************************************************************************
+// Function out_file_name()
+// **************************************************************************
+
+std::string out_file_name(std::string const& pdb_file) {
+  std::string name;
+  for (auto const c : pdb_file) {
+    switch (c) {
+      case '%': name += "%25"; break;
+      case '/': name += "%2F"; break;
+      default:  name += c;
+    }
+  }
+  return name + ".out";
+} // function out_file_name()
+
+
+
+// **************************************************************************
+// Function run()
+// **************************************************************************
+
+std::size_t run(bpo::variables_map const& vm) {
+  auto const out_dir = vm["corpus-out"].as<std::string>();
+  if (::mkdir(out_dir.c_str(), 0777) != 0 and errno != EEXIST) {
+    throw corpus_error{"CANNOT CREATE THE DIRECTORY '" + out_dir + "': " +
+                       std::strerror(errno)};
+  }
+  auto const journal_file = vm.count("journal") ? vm["journal"].as<std::string>() :
+                                                  out_dir + "/journal.tsv";
+
+  auto const entries = select_shard(read_list(vm["corpus"].as<std::string>()),
+                                    vm["shard"].as<std::string>());
+  auto done = read_journal(journal_file);
+  auto const n_done = done.size();
+  std::vector<Entry> pending;
+  for (auto const& entry : entries) {
+    // The journal has one line per PDB_FILE, so a repeated one is run only once.
+    if (done.insert(entry.pdb_file).second) {
+      pending.push_back(entry);
+    }
+  }
+
+  std::ofstream journal{journal_file, std::ios::app};
+  if (not journal) {
+    throw corpus_error{"CANNOT OPEN THE JOURNAL '" + journal_file + "'"};
+  }
+  // Terminate the interrupted last line, so that it is not joined with the next one.
+  {
+    std::ifstream ifs{journal_file, std::ios::binary | std::ios::ate};
+    if (ifs.tellg() > 0) {
+      ifs.seekg(-1, std::ios::end);
+      if (ifs.get() != '\n') {
+        journal << "\n";
+      }
+    }
+  }
+
+  std::clog << "stride2top corpus: " << entries.size() << " structures, "
+            << n_done << " already in '" << journal_file << "'"
+            << std::endl;
+
+  auto const n_workers = parallel::n_workers(vm["threads"].as<unsigned>(), pending.size());
+  auto const time_limit = std::chrono::duration<double>{vm["time-limit"].as<double>()};
+  std::map<pid_t, Job> running;
+  std::map<std::string, std::size_t> n_status;
+  std::size_t next = 0;
+
+  while (next < pending.size() or not running.empty()) {
+    // Start the structures up to n_workers at once.
+    while (next < pending.size() and running.size() < n_workers) {
+      auto const& entry = pending[next++];
+      auto const out_file = out_dir + "/" + out_file_name(entry.pdb_file);
+      // close-on-exec, so that the STRIDE run by the child does not keep it open
+      int fds[2];
+      if (::pipe2(fds, O_CLOEXEC) != 0) {
+        throw corpus_error{std::string{"pipe2() FAILED: "} + std::strerror(errno)};
+      }
+      std::cout.flush();
+      std::clog.flush();
+      auto const pid = ::fork();
+      if (pid < 0) {
+        throw corpus_error{std::string{"fork() FAILED: "} + std::strerror(errno)};
+      }
+      if (pid == 0) {
+        // its own process group, to kill the STRIDE run by it with it
+        ::setpgid(0, 0);
+        ::close(fds[0]);
+        run_child(vm, entry, out_file, fds[1]);
+      }
+      ::close(fds[1]);
+      running.emplace(pid, Job{entry, out_file, Clock::now(), fds[0], false});
+    }
+
+    // Reap the finished ones.
+    int wait_status = 0;
+    auto const pid = ::waitpid(-1, &wait_status, WNOHANG);
+    if (pid > 0) {
+      auto const found = running.find(pid);
+      if (found == running.end()) {
+        continue;
+      }
+      auto const outcome = outcome_of(found->second, wait_status);
+      ::close(found->second.message_fd);
+      journal << journal_field(found->second.entry.pdb_file) << "\t" << outcome.status
+              << "\t" << journal_field(outcome.error_class)
+              << "\t" << journal_field(outcome.message) << "\n";
+      journal.flush();
+      ++n_status[outcome.status];
+      if (outcome.status != "ok") {
+        // left by a child which was killed or crashed
+        std::remove((found->second.out_file + ".part").c_str());
+        std::clog << "stride2top corpus: " << outcome.status << " "
+                  << found->second.entry.pdb_file << ": "
+                  << journal_field(outcome.message) << std::endl;
+      }
+      running.erase(found);
+      continue;
+    }
+
+    // Kill the ones over the time limit.
+    if (0 < time_limit.count()) {
+      auto const now = Clock::now();
+      for (auto & job : running) {
+        if (not job.second.timed_out and now - job.second.start > time_limit) {
+          job.second.timed_out = true;
+          ::kill(-job.first, SIGKILL);
+          ::kill(job.first, SIGKILL);
+        }
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  }
+
+  std::clog << "stride2top corpus:";
+  for (auto const& status : n_status) {
+    std::clog << " " << status.first << " " << status.second;
+  }
+  std::clog << std::endl;
+
+  return pending.size() - n_status["ok"];
+} // function run()
+
+} // namespace corpus
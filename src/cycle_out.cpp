@@ -7,51 +7,43 @@
 
 #include <boost/format.hpp>
 
-#include "table.h"
 #include "functions.h"
-#include "table.h"
+#include "parallel.h"
 
 namespace cycles {
 
-void output_cycles(table::Table<table::Cycle> & tbl,
-                   sheet::DirectedAdjacencyList const& adj) {
+void output_cycles(std::vector<stride2top::Cycle> & cycles_out,
+                   sheet::DirectedAdjacencyList const& adj,
+                   unsigned const n_threads) {
 
-  auto const cycles = gen_cycles_vec(adj);
-  auto const n_cycle = cycles.size();
+  auto const cycles = gen_cycles_vec(adj, n_threads);
 
-  // if no cycle
-  if (n_cycle == 0) {
-    return;
-  }
-
-  out::substr2str ss_writer{std::make_shared<sheet::DirectedAdjacencyList>(adj)};
-
-  for (std::size_t i = 0; i < n_cycle; ++i) {
-    std::size_t const orig_sheet_id = std::get<0>(cycles[i]);
-    auto const& c_vec = std::get<1>(cycles[i]);
-
-    // A comma separated list of member substrands
-    auto const member_list = "'" +
-                             out::join(c_vec.cbegin(), c_vec.cend(), ",",
-                                       [&ss_writer](auto a){return ss_writer(*a);}) +
-                             "'";
-
-    tbl.add(std::make_tuple(orig_sheet_id, c_vec.size(), member_list));
+  for (auto const& cycle : cycles) {
+    stride2top::Cycle row;
+    row.sheet_id = std::get<0>(cycle);
+    for (auto const& ss : std::get<1>(cycle)) {
+      row.members.push_back(out::substr2str::str(ss, adj));
+    }
+    cycles_out.push_back(row);
   }
 }
 
 
-CyclesVec gen_cycles_vec(sheet::DirectedAdjacencyList const& adj) {
+CyclesVec gen_cycles_vec(sheet::DirectedAdjacencyList const& adj,
+                         unsigned const n_threads) {
 
-  CyclesVec cycles_vec;
-  std::size_t sheet_id = 0;
-  for (auto const sheet : adj.sheets) {
-    sheet::FindCycle const cycle{sheet.substr_keys()};
+  std::vector<CyclesVec> cycles_in_sheets(adj.sheets.size());
+  parallel::for_each_task(adj.sheets.size(), n_threads, [&](std::size_t const sheet_id) {
+    sheet::FindCycle const cycle{adj.sheets[sheet_id].substr_keys()};
     for (auto const& one_cycle : cycle.cycles) {
-      cycles_vec.push_back(std::make_tuple(sheet_id, rotate_to_smallest(one_cycle.cbegin(),
-                                                                        one_cycle.cend())));
+      cycles_in_sheets[sheet_id].push_back(
+          std::make_tuple(sheet_id, rotate_to_smallest(one_cycle.cbegin(), one_cycle.cend())));
     }
-    ++sheet_id;
+  });
+
+  CyclesVec cycles_vec;
+  for (auto const& cycles : cycles_in_sheets) {
+    cycles_vec.insert(cycles_vec.end(), cycles.cbegin(), cycles.cend());
   }
   return cycles_vec;
 }
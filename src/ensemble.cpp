@@ -0,0 +1,316 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "archive.h"
+#include "ensemble.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "stride2top.h"
+#include "table.h"
+
+#include "pdb/gzip.h"
+#include "pdb/sses.h"
+#include "pdb/stride_stream.h"
+#include "pdb/tools.h"
+#include "sheet/directed_adjacency_list.h"
+
+namespace ensemble {
+
+namespace {
+
+/// The record name of a line of PDB data (e.g. "END" for "END   ").
+std::string record_name(std::string const& line) {
+  auto const record = line.substr(0, 6);
+  return record.substr(0, record.find_last_not_of(" \r") + 1);
+}
+
+
+/// @return The whole contents of \c is , decompressed if gzipped.
+std::string read_all(std::istream & is) {
+  pdb::input_stream in{is};
+  std::stringstream ss;
+  pdb::is2ss(in, ss);
+  return ss.str();
+}
+
+
+/// @brief  The stride outputs in STRIDE_FILE (or the standard input), separated by 'END'
+///         records: one for all the models, or one per model.
+std::vector<std::string> read_strides(bpo::variables_map const& vm,
+                                      std::size_t const n_models) {
+  std::string text;
+  if (vm.count("stride-file")) {
+    pdb::input_stream is{vm["stride-file"].as<std::string>()};
+    text = read_all(is);
+  } else {
+    text = read_all(std::cin);
+  }
+
+  std::istringstream iss{text};
+  archive::EntryReader reader{iss};
+  std::vector<std::string> strides;
+  for (std::string entry; reader.next(entry);) {
+    strides.push_back(std::move(entry));
+  }
+  if (strides.size() != 1 and strides.size() != n_models) {
+    throw ensemble_error{"STRIDE_FILE HAS " + std::to_string(strides.size()) +
+                         " ENTRIES FOR " + std::to_string(n_models) + " MODELS"};
+  }
+  return strides;
+}
+
+
+/// Run stride for \c model of \c pdb_file , through a temporary file.
+std::string model_stride(bpo::variables_map const& vm, std::string const& pdb_file,
+                         Model const& model) {
+  std::string const tmp_file = "./model_" + pdb::basename(pdb_file) + "_" +
+                               std::to_string(model.serial) + "_" + pdb::rand_str(10) +
+                               ".pdb";
+  {
+    std::ofstream ofs{tmp_file};
+    ofs << model.pdb_text;
+    if (not ofs) {
+      std::remove(tmp_file.c_str());
+      throw ensemble_error{"CANNOT WRITE '" + tmp_file + "'"};
+    }
+  }
+
+  try {
+    auto stride_text = pipeline::run_stride(vm, tmp_file, model.pdb_text);
+    std::remove(tmp_file.c_str());
+    return stride_text;
+  } catch (...) {
+    std::remove(tmp_file.c_str());
+    throw;
+  }
+}
+
+
+/// Analyze a model with the stride output \c stride_text (see pipeline::run()).
+stride2top::Result analyze_model(bpo::variables_map const& vm,
+                                 stride2top::Options const& options,
+                                 std::string const& name, Model const& model,
+                                 std::string const& stride_text) {
+  profile::Scope parse_scope{"parse"};
+  std::istringstream stride_is{stride_text};
+  pdb::stride_stream stride{stride_is};
+
+  // If no-stride-sse, use the SSE headers in the PDB data
+  std::istringstream pdb_is{model.pdb_text};
+  auto const sses = vm["no-stride-sse"].as<bool>() ? pdb::SSES{pdb_is, name} :
+                                                     pdb::SSES{pdb_is, name, stride};
+  parse_scope.finish();
+
+  sheet::DirectedAdjacencyList const adj{
+      sses, stride, options.strand_table_bridges ? sheet::BridgeEngine::StrandTable :
+                                                   sheet::BridgeEngine::Sweep,
+      options.threads};
+  return stride2top::analyze(adj, options);
+}
+
+
+/// Write the 'timeline' table of \c rows in the format \c format_type .
+void timeline_out(std::ostream & os, std::vector<table::Timeline> const& rows,
+                  std::size_t const format_type) {
+  table::TBLTimeline tbl{"timeline",
+                         {"Model", "N_sheets", "Member", "Nomenclature_C", "Left_handed"}};
+  for (auto const& row : rows) {
+    tbl.add(row);
+  }
+
+  std::array<table::FormatStrings, 2> const formats{{
+    table::FormatStrings{"REMARK %|18t|%5s  %8s  %s  %s  %s\n",
+                         "TIMELINE %|18t|%5d  %8d  %s  %s  %s\n"},
+    table::FormatStrings{"#\nloop_\n_timeline.%s\n_timeline.%s\n_timeline.%s\n"
+                         "_timeline.%s\n_timeline.%s\n",
+                         "%5d %3d %s %s %s\n", 1}
+  }};
+  os << tbl.format(formats[format_type]) << "\n";
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function split_models()
+// **************************************************************************
+
+std::vector<Model> split_models(std::string const& pdb_text) {
+  std::istringstream iss{pdb_text};
+  std::string header;
+  std::string body;
+  std::vector<Model> models;
+  bool in_model = false;
+  int serial = 0;
+
+  for (std::string line; std::getline(iss, line);) {
+    auto const record = record_name(line);
+    if (record == "MODEL") {
+      if (in_model) {
+        throw ensemble_error{"MODEL " + std::to_string(serial) + " IS NOT CLOSED BY ENDMDL"};
+      }
+      in_model = true;
+      body.clear();
+      // the serial number, or the position if it is missing
+      try {
+        serial = std::stoi(line.substr(6));
+      } catch (std::exception const&) {
+        serial = static_cast<int>(models.size()) + 1;
+      }
+    } else if (record == "ENDMDL") {
+      if (in_model) {
+        models.push_back(Model{serial, header + body + "END\n"});
+      }
+      in_model = false;
+    } else if (in_model) {
+      body += line + "\n";
+    } else if (models.empty()) {
+      header += line + "\n";
+    }
+    // The records after the last model (e.g. CONECT) are dropped.
+  }
+
+  if (in_model) {
+    throw ensemble_error{"MODEL " + std::to_string(serial) + " IS NOT CLOSED BY ENDMDL"};
+  }
+  if (models.empty()) {
+    models.push_back(Model{1, pdb_text});
+  }
+  return models;
+} // function split_models()
+
+
+
+// **************************************************************************
+// Function timeline_row()
+// **************************************************************************
+
+table::Timeline timeline_row(int const serial, stride2top::Result const& result,
+                             double const cutoff_left_score) {
+  // '-' for none, so that the columns are never empty
+  auto const joined = [](std::vector<std::string> const& values, char const separator) {
+    std::string str;
+    for (auto const& value : values) {
+      str += (str.empty() ? "" : std::string(1, separator)) + value;
+    }
+    return str.empty() ? std::string{"-"} : str;
+  };
+
+  std::vector<std::string> members;
+  std::vector<std::string> topologies;
+  for (auto const& sheet : result.sheets) {
+    members.push_back(joined(sheet.members, ','));
+    topologies.push_back(sheet.nomenclature_c);
+  }
+
+  std::vector<std::string> left_handed;
+  for (auto const& handedness : result.handedness) {
+    if (handedness.score > cutoff_left_score) {
+      // the names of the members, so that the two columns can be compared
+      left_handed.push_back(handedness.name_0 + "-" + handedness.name_1);
+    }
+  }
+
+  return table::Timeline{serial, result.sheets.size(), joined(members, ';'),
+                         joined(topologies, ';'), joined(left_handed, ',')};
+} // function timeline_row()
+
+
+
+// **************************************************************************
+// Function run()
+// **************************************************************************
+
+std::size_t run(bpo::variables_map const& vm, std::ostream & out_stream) {
+  if (vm.count("graphviz")) {
+    throw ensemble_error{"'--graphviz' CAN NOT BE USED WITH ALL THE MODELS"};
+  }
+  auto const format_type = vm["format-type"].as<std::size_t>();
+  if (1 < format_type) {
+    std::cerr << "Fatal error: Unknown format type '" << format_type << "'." << std::endl;
+    throw arg::argument_error{"unknown type"};
+  }
+  auto const pdb_file = vm["pdb-file"].as<std::string>();
+  auto const id = archive::classify(pdb_file).second;
+  auto const name = id.empty() ? pdb::basename(pdb_file) : id;
+
+  // The file is read once, and the models share its header records.
+  profile::Scope parse_scope{"parse"};
+  pdb::input_stream pdb_is{pdb_file};
+  auto const models = split_models(read_all(pdb_is));
+  bool const with_stride = vm["with-stride"].as<bool>();
+  auto const strides = with_stride ? std::vector<std::string>{} :
+                                     read_strides(vm, models.size());
+  parse_scope.finish();
+
+  // The models run in parallel instead of the stages of each.
+  auto options = pipeline::analysis_options(vm);
+  options.threads = 1;
+  options.handedness = true;
+
+  std::vector<std::string> outputs(models.size());
+  std::vector<table::Timeline> rows(models.size());
+  std::vector<std::string> errors(models.size());
+  auto const n_threads = parallel::n_workers(vm["threads"].as<unsigned>(), models.size());
+  parallel::for_each_task(models.size(), n_threads, [&](std::size_t const k) {
+    auto const& model = models[k];
+    auto const model_name = pdb_file + ":" + std::to_string(model.serial);
+    profile::StructureScope const structure_scope{model_name};
+    // the memory of each model, reused by the next one of the thread
+    thread_local arena::StructureArena memory;
+    arena::StructureScope const memory_scope{memory};
+    try {
+      auto const stride_text = with_stride ? model_stride(vm, pdb_file, model) :
+                                             strides[strides.size() == 1 ? 0 : k];
+      auto const result = analyze_model(vm, options, model_name, model, stride_text);
+
+      profile::Scope const scope{"format_out"};
+      std::ostringstream oss;
+      stride2top::write(oss, result, format_type);
+      outputs[k] = oss.str();
+      rows[k] = timeline_row(model.serial, result, options.cutoff_left_score);
+    } catch (std::exception const& e) {
+      profile::count(profile::Counter::Exceptions);
+      errors[k] = e.what();
+    }
+  });
+
+  std::size_t n_failed = 0;
+  std::vector<table::Timeline> timeline;
+  for (std::size_t k = 0; k < models.size(); ++k) {
+    auto const serial = std::to_string(models[k].serial);
+    if (not errors[k].empty()) {
+      std::cerr << pdb_file << ": MODEL " << serial << ": " << errors[k] << std::endl;
+      ++n_failed;
+      continue;
+    }
+    if (format_type == 1) {
+      out_stream << "data_" << name << "_model_" << serial << "\n" << outputs[k];
+    } else {
+      out_stream << "MODEL     " << serial << "\n" << outputs[k] << "ENDMDL\n";
+    }
+    timeline.push_back(rows[k]);
+  }
+
+  if (format_type == 1) {
+    out_stream << "data_" << name << "_timeline\n";
+  }
+  timeline_out(out_stream, timeline, format_type);
+  out_stream.flush();
+  return n_failed;
+} // function run()
+
+} // namespace ensemble
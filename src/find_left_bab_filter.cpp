@@ -1,8 +1,13 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <vector>
 
+#include "parallel.h"
+#include "profile.h"
 #include "sheet/filter.h"
 #include "bab/filter.h"
 #include "bab/side.h"
@@ -15,26 +20,15 @@ namespace bab {
 // ************************************************************************************
 
 bool BabFilter::operator()(SeqIter const first, SeqIter const last, unsigned const reverse) {
-  // if not strands
-  if (sses[*first].type != 'E' or sses[*(last-1)].type != 'E') {
-
-    #ifdef WITH_STAT
-    last_result = BabFilterResult{};
-    last_result.non_bab_reason = 1;
-    #endif // WITH_STAT
+  auto const result = evaluate(first, last, reverse);
 
-    return false;
+  #ifdef WITH_STAT
+  if (policy.stat) {
+    last_result = result;
   }
+  #endif // WITH_STAT
 
-  for (auto const& sub_first: adj.substrs().vec(sses.serial_strand_id[*first])) {
-    for (auto const& sub_last: adj.substrs().vec(sses.serial_strand_id[*(last-1)])) {
-      // If filtering failed.
-      if (operator()(sub_first, sub_last, first, last, reverse)) {
-        return true;
-      }
-    }
-  }
-  return false;
+  return passed(result);
 } // public member function operator()()
 
 
@@ -47,18 +41,141 @@ bool BabFilter::operator()(SeqIter const first, SeqIter const last, unsigned con
 bool BabFilter::operator()(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
                        SeqIter const first, SeqIter const last,
                        unsigned const reverse) {
+  auto const result = evaluate(ss0, ss1, first, last, reverse);
+
   #ifdef WITH_STAT
-  last_result = BabFilterResult{ss0, ss1};
+  if (policy.stat) {
+    last_result = result;
+  }
   #endif // WITH_STAT
 
-  auto const cond = non_bab_condition(first, last);
-  if (cond != 0) {
+  return passed(result);
+} // public member function operator()()
+
+
+
+
+// ************************************************************************************
+// Public Member Function evaluate()
+// ************************************************************************************
+
+BabFilterResult BabFilter::evaluate(SeqIter const first, SeqIter const last,
+                                    unsigned const reverse) const {
+  BabFilterResult result{};
+
+  // if not strands
+  if (sses[*first].type != 'E' or sses[*(last-1)].type != 'E') {
+    if (policy.stat) {
+      result.non_bab_reason = 1;
+    }
+    return result;
+  }
+
+  for (auto const& sub_first: adj.substrs().vec(sses.serial_strand_id[*first])) {
+    for (auto const& sub_last: adj.substrs().vec(sses.serial_strand_id[*(last-1)])) {
+      result = evaluate(sub_first, sub_last, first, last, reverse);
+      if (passed(result)) {
+        return result;
+      }
+    }
+  }
+  return result;
+} // public member function evaluate()
+
+
+
+
+// ************************************************************************************
+// Public Member Function evaluate()
+// ************************************************************************************
+
+BabFilterResult BabFilter::evaluate(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                                    SeqIter const first, SeqIter const last,
+                                    unsigned const reverse) const {
+  return (this->*evaluate_func)(ss0, ss1, first, last, reverse);
+} // public member function evaluate()
+
+
+
+
+// ************************************************************************************
+// Public Member Function evaluate_batch()
+// ************************************************************************************
 
-    #ifdef WITH_STAT
-    last_result.non_bab_reason = cond;
-    #endif // WITH_STAT
+std::vector<BabFilterResult>
+BabFilter::evaluate_batch(std::vector<BabFilterRequest> const& requests,
+                          unsigned const n_threads) const {
+  std::vector<BabFilterResult> results(requests.size());
 
-    return false;
+  // Each task writes only to its own element of results.
+  parallel::for_each_task(requests.size(), n_threads,
+                          [this, &requests, &results](auto const k) {
+    auto const& r = requests[k];
+    results[k] = evaluate(r.ss0, r.ss1, r.first, r.last, r.reverse);
+  });
+  return results;
+} // public member function evaluate_batch()
+
+
+
+
+// ************************************************************************************
+// Public Member Function evaluate_raw()
+// ************************************************************************************
+
+BabFilterRaw BabFilter::evaluate_raw(sheet::SubStrand const& ss0, sheet::SubStrand const& ss1,
+                                     SeqIter const first, SeqIter const last,
+                                     unsigned const max_res_len, unsigned const max_mid_str,
+                                     unsigned const reverse) const {
+  #ifdef WITH_LOOP
+  if (policy.loop) {
+    return evaluate_raw_unit<LoopOn>(ss0, ss1, first, last, max_res_len, max_mid_str,
+                                     reverse);
+  }
+  #endif // WITH_LOOP
+
+  return evaluate_raw_unit<LoopOff>(ss0, ss1, first, last, max_res_len, max_mid_str,
+                                    reverse);
+} // public member function evaluate_raw()
+
+
+
+
+// ************************************************************************************
+// Protected Static Member Function select_evaluate()
+// ************************************************************************************
+
+BabFilter::EvaluateFunc BabFilter::select_evaluate(BabPolicy const& p) {
+  #ifdef WITH_LOOP
+  if (p.loop) {
+    return p.stat ? &BabFilter::evaluate_unit<StatOn, LoopOn>
+                  : &BabFilter::evaluate_unit<StatOff, LoopOn>;
+  }
+  #endif // WITH_LOOP
+
+  return p.stat ? &BabFilter::evaluate_unit<StatOn, LoopOff>
+                : &BabFilter::evaluate_unit<StatOff, LoopOff>;
+} // protected static member function select_evaluate()
+
+
+
+
+// ************************************************************************************
+// Protected Member Function evaluate_unit()
+// ************************************************************************************
+
+template <class Stat, class Loop>
+BabFilterResult BabFilter::evaluate_unit(sheet::SubStrand const& ss0,
+                                         sheet::SubStrand const& ss1,
+                                         SeqIter const first, SeqIter const last,
+                                         unsigned const reverse) const {
+  auto const cond = non_bab_condition<Loop>(first, last);
+  if (cond != 0) {
+    BabFilterResult result{ss0, ss1};
+    if (Stat::enabled) {
+      result.non_bab_reason = cond;
+    }
+    return result;
   }
 
   // adj.attr will also check the reachability in inversed direction (ss1, ss0).
@@ -67,25 +184,19 @@ bool BabFilter::operator()(sheet::SubStrand const& ss0, sheet::SubStrand const&
   bool const reversed_last = reverse & (1u << *(last - 1));
   if (not attr.reachable
       or sheet::direction_with_reverse(attr.direction, reversed_first, reversed_last)) {
-
-    #ifdef WITH_STAT
-    last_result.non_bab_reason = 3;
-    #endif // WITH_STAT
-
-    return false;
+    BabFilterResult result{ss0, ss1};
+    if (Stat::enabled) {
+      result.non_bab_reason = 3;
+    }
+    return result;
   }
-  auto const result = filter_one_unit(ss0, ss1, reversed_first, reversed_last, first, last);
-
-  #ifdef WITH_STAT
-  // If the last_result has any value (such as non_bab_reason), control never reaches here.
-  last_result = result;
-  last_result.jump = attr.jump;
-  #endif // WITH_STAT
-
-  // If success is false, comp need not be evaluated.
-  return result.success and comp(result.left_score, cut_off_left_score);
-
-} // public member function operator()()
+  auto result = filter_one_unit<Stat, Loop>(ss0, ss1, reversed_first, reversed_last,
+                                            first, last);
+  if (Stat::enabled) {
+    result.jump = attr.jump;
+  }
+  return result;
+} // protected member function evaluate_unit()
 
 
 
@@ -95,6 +206,7 @@ bool BabFilter::operator()(sheet::SubStrand const& ss0, sheet::SubStrand const&
 // ************************************************************************************
 
 SidesMap BabFilter::init_sides_map() const {
+  profile::Scope const scope{"BabFilter_sides"};
   SidesMap map;
 
   auto const n_substr = adj.substrs().vec().size();
@@ -182,12 +294,14 @@ std::tuple<unsigned, unsigned> BabFilter::count_left_tri(sheet::SubStrand const&
 
   auto const end_sides_0 = sides_0.cend();
   auto const end_sides_1 = sides_1.cend();
+  std::size_t n_tests = 0;
 
   for (auto& mid_a_itr = a_begin; mid_a_itr != a_end; ++mid_a_itr) {
     // if this is a padding atom.
     if (not mid_a_itr->pdb) {
       continue;
     }
+    n_tests += sides_0.size() + sides_1.size();
 
     for (auto itr = sides_0.cbegin(); itr != end_sides_0; ++itr) {
       bool on_left, is_distant;
@@ -214,6 +328,7 @@ std::tuple<unsigned, unsigned> BabFilter::count_left_tri(sheet::SubStrand const&
     }
   }
 
+  profile::count(profile::Counter::TriangleTests, n_tests);
   return std::make_tuple(left_counter, total_counter);
 }
 
@@ -223,25 +338,28 @@ std::tuple<unsigned, unsigned> BabFilter::count_left_tri(sheet::SubStrand const&
 // Protected Member Function filter_one_unit()
 // ************************************************************************************
 
+template <class Stat, class Loop>
 BabFilterResult BabFilter::filter_one_unit(sheet::SubStrand const& b0,
                                            sheet::SubStrand const& b1,
                                            bool const b0_reverse, bool const b1_reverse,
-                                           SeqIter const first, SeqIter const last) {
+                                           SeqIter const first, SeqIter const last) const {
   BabFilterResult result{b0, b1};
 
   #ifdef WITH_LOOP
-  // the first loop right after the first strand.
-  auto const& first_loop = sses.loop(*first);
-  auto const counts_l = count_left_tri(b0, b1, b0_reverse, b1_reverse,
-                                     first_loop.atoms.cbegin(), first_loop.atoms.cend());
-  result.left_score += std::get<0>(counts_l);
-  result.tri_atom_count += std::get<1>(counts_l);
-  result.n_pdb_atoms += first_loop.n_pdb;
-
-  result.mid_res_len += first_loop.atoms.size();
-  // ON: Loop Bit, if loop is not empty
-  if (first_loop.n_pdb) {
-    result.connection_type |= 2u;
+  if (Loop::enabled) {
+    // the first loop right after the first strand.
+    auto const& first_loop = sses.loop(*first);
+    auto const counts_l = count_left_tri(b0, b1, b0_reverse, b1_reverse,
+                                         first_loop.atoms.cbegin(), first_loop.atoms.cend());
+    result.left_score += std::get<0>(counts_l);
+    result.tri_atom_count += std::get<1>(counts_l);
+    result.n_pdb_atoms += first_loop.n_pdb;
+
+    result.mid_res_len += first_loop.atoms.size();
+    // ON: Loop Bit, if loop is not empty
+    if (first_loop.n_pdb) {
+      result.connection_type |= 2u;
+    }
   }
   #endif // WITH_LOOP
 
@@ -253,9 +371,9 @@ BabFilterResult BabFilter::filter_one_unit(sheet::SubStrand const& b0,
     // If the total residue length of mid-part exceeds the limit
     if (cut_off_res_len < result.mid_res_len) {
 
-      #ifdef WITH_STAT
-      result.non_bab_reason = 4;
-      #endif // WITH_STAT
+      if (Stat::enabled) {
+        result.non_bab_reason = 4;
+      }
 
       return result;
     }
@@ -285,9 +403,9 @@ BabFilterResult BabFilter::filter_one_unit(sheet::SubStrand const& b0,
 
           if (cut_off_mid_str < result.n_mid_str) {
 
-            #ifdef WITH_STAT
-            result.non_bab_reason = 5;
-            #endif // WITH_STAT
+            if (Stat::enabled) {
+              result.non_bab_reason = 5;
+            }
 
             return result;
           }
@@ -311,24 +429,26 @@ BabFilterResult BabFilter::filter_one_unit(sheet::SubStrand const& b0,
 
 
     #ifdef WITH_LOOP
-    // Filter LOOPs
-    auto const& target_loop = sses.loop(*sse_id_itr);
-    auto const counts = count_left_tri(b0, b1, b0_reverse, b1_reverse,
-                                       target_loop.atoms.cbegin(),
-                                       target_loop.atoms.cend());
-    result.left_score += std::get<0>(counts);
-    result.tri_atom_count += std::get<1>(counts);
-    result.n_pdb_atoms += target_loop.n_pdb;
-    result.mid_res_len += target_loop.atoms.size();
+    if (Loop::enabled) {
+      // Filter LOOPs
+      auto const& target_loop = sses.loop(*sse_id_itr);
+      auto const counts = count_left_tri(b0, b1, b0_reverse, b1_reverse,
+                                         target_loop.atoms.cbegin(),
+                                         target_loop.atoms.cend());
+      result.left_score += std::get<0>(counts);
+      result.tri_atom_count += std::get<1>(counts);
+      result.n_pdb_atoms += target_loop.n_pdb;
+      result.mid_res_len += target_loop.atoms.size();
+    }
     #endif // WITH_LOOP
   }
 
   // Mid-res-len check
   if (cut_off_res_len < result.mid_res_len) {
 
-    #ifdef WITH_STAT
-    result.non_bab_reason = 4;
-    #endif // WITH_STAT
+    if (Stat::enabled) {
+      result.non_bab_reason = 4;
+    }
 
     return result;
   }
@@ -349,10 +469,192 @@ BabFilterResult BabFilter::filter_one_unit(sheet::SubStrand const& b0,
 
 
 
+// ************************************************************************************
+// Protected Member Function collect_left_distances()
+// ************************************************************************************
+
+void BabFilter::collect_left_distances(sheet::SubStrand const& b0,
+                                       sheet::SubStrand const& b1,
+                                       bool const b0_reverse, bool const b1_reverse,
+                                       ATOM_vec_iter a_begin, ATOM_vec_iter const a_end,
+                                       std::vector<double> & distances) const {
+  auto const& sides_0 = sides_map.at(sheet::SubStrandsPairKey{b0, b1});
+  auto const& sides_1 = sides_map.at(sheet::SubStrandsPairKey{b1, b0});
+  std::size_t n_tests = 0;
+
+  for (auto& mid_a_itr = a_begin; mid_a_itr != a_end; ++mid_a_itr) {
+    // if this is a padding atom.
+    if (not mid_a_itr->pdb) {
+      continue;
+    }
+    n_tests += sides_0.size() + sides_1.size();
+
+    // NaN (from a degenerate triangle) is neither left nor counted by count_left_tri().
+    for (auto const& side : sides_0) {
+      auto const dist = side.left_distance(mid_a_itr->xyz, b0_reverse, true);
+      if (not std::isnan(dist)) {
+        distances.push_back(dist);
+      }
+    }
+    for (auto const& side : sides_1) {
+      auto const dist = side.left_distance(mid_a_itr->xyz, b1_reverse, false);
+      if (not std::isnan(dist)) {
+        distances.push_back(dist);
+      }
+    }
+  }
+
+  profile::count(profile::Counter::TriangleTests, n_tests);
+} // protected member function collect_left_distances()
+
+
+
+
+// ************************************************************************************
+// Protected Member Function evaluate_raw_unit()
+// ************************************************************************************
+
+template <class Loop>
+BabFilterRaw BabFilter::evaluate_raw_unit(sheet::SubStrand const& ss0,
+                                          sheet::SubStrand const& ss1,
+                                          SeqIter const first, SeqIter const last,
+                                          unsigned const max_res_len,
+                                          unsigned const max_mid_str,
+                                          unsigned const reverse) const {
+  // The same conditions as evaluate_unit()
+  if (non_bab_condition<Loop>(first, last) != 0) {
+    return BabFilterRaw{ss0, ss1};
+  }
+
+  auto const& attr = adj.attr(ss0, ss1);
+  bool const reversed_first = reverse & (1u << *first);
+  bool const reversed_last = reverse & (1u << *(last - 1));
+  if (not attr.reachable
+      or sheet::direction_with_reverse(attr.direction, reversed_first, reversed_last)) {
+    return BabFilterRaw{ss0, ss1};
+  }
+
+  auto raw = filter_one_unit_raw<Loop>(ss0, ss1, reversed_first, reversed_last,
+                                       first, last, max_res_len, max_mid_str);
+  std::sort(raw.left_distances.begin(), raw.left_distances.end());
+  return raw;
+} // protected member function evaluate_raw_unit()
+
+
+
+
+// ************************************************************************************
+// Protected Member Function filter_one_unit_raw()
+// ************************************************************************************
+
+template <class Loop>
+BabFilterRaw BabFilter::filter_one_unit_raw(sheet::SubStrand const& b0,
+                                            sheet::SubStrand const& b1,
+                                            bool const b0_reverse, bool const b1_reverse,
+                                            SeqIter const first, SeqIter const last,
+                                            unsigned const max_res_len,
+                                            unsigned const max_mid_str) const {
+  BabFilterRaw raw{b0, b1};
+  raw.examined = true;
+  auto & distances = raw.left_distances;
+
+  #ifdef WITH_LOOP
+  if (Loop::enabled) {
+    auto const& first_loop = sses.loop(*first);
+    collect_left_distances(b0, b1, b0_reverse, b1_reverse,
+                           first_loop.atoms.cbegin(), first_loop.atoms.cend(), distances);
+    raw.mid_res_len += first_loop.atoms.size();
+  }
+  #endif // WITH_LOOP
+
+  // Same as filter_one_unit(), but stop only if any cut-off value up to the limits fails.
+  auto const mid_sse_end = last - 1;
+  for (auto sse_id_itr = first + 1; sse_id_itr != mid_sse_end; ++sse_id_itr) {
+    raw.mid_res_len += sses[*sse_id_itr].atoms.size();
+    if (max_res_len < raw.mid_res_len) {
+      return raw;
+    }
+
+    auto const& target_sse = sses[*sse_id_itr];
+    if (target_sse.type == 'H') {
+      collect_left_distances(b0, b1, b0_reverse, b1_reverse,
+                             target_sse.atoms.cbegin(), target_sse.atoms.cend(), distances);
+
+    } else if (target_sse.type == 'E') {
+      for (auto const& ss : adj.substrs().vec(sses.serial_strand_id[*sse_id_itr])) {
+        // skip the strands in the same sheet
+        if (adj.attr(b0, ss).reachable) {
+          ++raw.n_mid_str;
+          if (max_mid_str < raw.n_mid_str) {
+            return raw;
+          }
+          continue;
+        }
+
+        collect_left_distances(b0, b1, b0_reverse, b1_reverse,
+                               target_sse.atom_vec_iter(adj.substrs().n_term_res(ss)),
+                               target_sse.atom_vec_iter(adj.substrs().c_term_res(ss)) + 1,
+                               distances);
+      }
+    }
+
+    #ifdef WITH_LOOP
+    if (Loop::enabled) {
+      auto const& target_loop = sses.loop(*sse_id_itr);
+      collect_left_distances(b0, b1, b0_reverse, b1_reverse,
+                             target_loop.atoms.cbegin(), target_loop.atoms.cend(),
+                             distances);
+      raw.mid_res_len += target_loop.atoms.size();
+    }
+    #endif // WITH_LOOP
+  }
+
+  return raw;
+} // protected member function filter_one_unit_raw()
+
+
+
+
+// ************************************************************************************
+// Member Function BabFilterRaw::result()
+// ************************************************************************************
+
+BabFilterResult BabFilterRaw::result(unsigned const c_res_len, unsigned const c_mid_str,
+                                     double const c_side_min_dist) const {
+  BabFilterResult result{sub_first, sub_last};
+
+  // mid_res_len and n_mid_str only increase in filter_one_unit(), so it fails
+  // if and only if the totals exceed the cut-off values.
+  if (not examined or c_res_len < mid_res_len or c_mid_str < n_mid_str) {
+    return result;
+  }
+  result.mid_res_len = mid_res_len;
+  result.n_mid_str = n_mid_str;
+
+  // The numbers counted by count_left_tri():
+  // left if c_side_min_dist < d, and counted if c_side_min_dist < |d|.
+  auto const begin = left_distances.cbegin();
+  auto const end = left_distances.cend();
+  auto const n_left = static_cast<unsigned>(
+      end - std::upper_bound(begin, end, c_side_min_dist));
+  auto const n_counted = c_side_min_dist < 0.0 ?
+      static_cast<unsigned>(left_distances.size()) :
+      n_left + static_cast<unsigned>(std::lower_bound(begin, end, -c_side_min_dist) - begin);
+
+  result.tri_atom_count = n_counted;
+  result.left_score = n_counted != 0 ? static_cast<double>(n_left) / n_counted : 0.0;
+  result.success = true;
+  return result;
+} // member function BabFilterRaw::result()
+
+
+
+
 // ************************************************************************************
 // Protected Member Function bab_condition()
 // ************************************************************************************
 
+template <class Loop>
 unsigned BabFilter::non_bab_condition(SeqIter first, SeqIter last) const {
   auto const dist = std::distance(first, last);
   switch (dist) {
@@ -360,16 +662,22 @@ unsigned BabFilter::non_bab_condition(SeqIter first, SeqIter last) const {
     case 0:
     case 1: return 2;
 
-    #ifdef WITH_LOOP
     // loop between *first and *(last-1)
-    case 2: return 0;
-
-    #else
-    case 2: return 2;
-    #endif // WITH_LOOP
+    case 2:
+      #ifdef WITH_LOOP
+      if (not Loop::enabled) {
+        return 2;
+      }
+      break;
+      #else
+      return 2;
+      #endif // WITH_LOOP
 
-    default: return 0;
+    default: break;
   }
+
+  // the mid-part would run across a chain break
+  return sses.same_chain(*first, *(last - 1)) ? 0 : 6;
 } // protected member function bab_condition()
 
 } // namespace bab
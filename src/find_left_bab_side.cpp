@@ -53,16 +53,23 @@ Eigen::Vector3d const& Side::base_point(bool const reversed) const {
 std::tuple<bool, bool> Side::on_left_side(Eigen::Vector3d const& v,
                                           bool const reversed, bool const myside,
                                           double const min_dist) const {
-  auto const dist = normal(reversed).dot(v - base_point(reversed));
-  bool const is_distant = min_dist < std::fabs(dist);
- if (myside) {
-    return std::make_tuple(dist < - min_dist, is_distant);
-  } else {
-    return std::make_tuple(dist > min_dist, is_distant);
-  }
+  auto const dist = left_distance(v, reversed, myside);
+  return std::make_tuple(min_dist < dist, min_dist < std::fabs(dist));
 } // public member function on_left_side()
 
 
+
+// *************************************************************************
+// Public Member Function left_distance()
+// *************************************************************************
+
+double Side::left_distance(Eigen::Vector3d const& v, bool const reversed,
+                           bool const myside) const {
+  auto const dist = normal(reversed).dot(v - base_point(reversed));
+  return myside ? -dist : dist;
+} // public member function left_distance()
+
+
 // *************************************************************************
 // Protected Member Function init_max_angle()
 // *************************************************************************
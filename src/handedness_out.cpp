@@ -1,10 +1,12 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <cassert>
+
 #include <numeric>
 #include <ostream>
+#include <string>
 #include <vector>
-#include <boost/program_options.hpp>
 
 #include "pdb/tools.h"
 #include "sheet/directed_adjacency_list.h"
@@ -12,37 +14,70 @@
 #include "functions.h"
 #include "handedness.h"
 
-namespace bpo = boost::program_options;
-
 namespace rare {
  
 // **********************************************************************************
-// Function print_handedness()
+// Function get_handedness()
 // **********************************************************************************
 
 std::vector<bab::BabFilterResult> get_handedness(sheet::DirectedAdjacencyList const& adj,
-                                                 bab::BabFilter & bab_filter) {
+                                                 bab::BabFilter const& bab_filter,
+                                                 unsigned const n_threads) {
   std::vector<bab::BabFilterResult> found_bab{};
 
-  auto const n_sse = adj.sses.size;
+  auto const& sses = adj.sses;
+  auto const n_sse = sses.size;
   std::vector<pdb::IndexType> pseudo_seq(n_sse);
   std::iota(pseudo_seq.begin(), pseudo_seq.end(), 0);
 
   auto const b = pseudo_seq.cbegin();
 
+  // The pairs of Sub-Strands of the edge strands of the ranges, in the order
+  // BabFilter::evaluate() tries them. The requests of the k-th range are
+  // [range_ends[k - 1], range_ends[k]). A range whose edges are not strands has none.
+  std::vector<bab::BabFilterRequest> requests;
+  std::vector<std::size_t> range_ends;
+
+  // Take the first pair that passed, or the last pair tried, as BabFilter::evaluate().
+  auto const flush = [&]() {
+    auto const results = bab_filter.evaluate_batch(requests, n_threads);
+    std::size_t first = 0;
+    for (auto const last : range_ends) {
+      auto k = first;
+      while (k + 1 < last and not bab_filter.passed(results[k])) {
+        ++k;
+      }
+      // If the filter ran correctly,
+      // no matter whether the Beta-Alpha-Beta is right handed or not.
+      if (first != last and results[k].success) {
+        found_bab.push_back(results[k]);
+      }
+      first = last;
+    }
+    requests.clear();
+    range_ends.clear();
+  };
+
   // b+i: an iterator to the i-th element in pseudo_seq.
   for (auto const i : pdb::range(n_sse)) {
     // b+j: past the end iterator
     for (auto const j : boost::irange(i+1, n_sse+1)) {
-      bab_filter(b+i, b+j);
-      auto const& result = bab_filter.result();
-      // If the filter ran correctly,
-      // no matter whether the Beta-Alpha-Beta is right handed or not.
-      if (result.success) {
-        found_bab.push_back(result);
+      if (sses[i].type == 'E' and sses[j - 1].type == 'E') {
+        for (auto const& sub_first: adj.substrs().vec(sses.serial_strand_id[i])) {
+          for (auto const& sub_last: adj.substrs().vec(sses.serial_strand_id[j - 1])) {
+            requests.emplace_back(sub_first, sub_last, b + i, b + j);
+          }
+        }
       }
+      range_ends.push_back(requests.size());
+    }
+
+    // in batches of the ranges from some SSEs, to bound the memory
+    if (HANDEDNESS_BATCH_SIZE <= requests.size()) {
+      flush();
     }
   }
+  flush();
 
   return found_bab;
 } // function get_handedness().
@@ -50,56 +85,68 @@ std::vector<bab::BabFilterResult> get_handedness(sheet::DirectedAdjacencyList co
 
 
 // **********************************************************************************
-// Function output_handedness()
+// Function find_handedness()
 // **********************************************************************************
 
-bool output_handedness(std::ostream & os, sheet::DirectedAdjacencyList const& adj,
-                       bpo::variables_map const& vm) {
-  bab::BabFilter bab_filter{adj, std::greater<double>(),
-                            vm["max-mid-residues"].as<unsigned>(),
-                            vm["max-mid-strands"].as<unsigned>(),
-                            vm["cutoff-left-score"].as<double>(),
-                            vm["min-side-dist"].as<double>()};
+std::vector<Handedness> find_handedness(sheet::DirectedAdjacencyList const& adj,
+                                        bab::BabFilter const& bab_filter,
+                                        unsigned const n_threads) {
+  std::vector<Handedness> found;
+
+  for (auto const& result : get_handedness(adj, bab_filter, n_threads)) {
+    assert(result.connection_type);
+
+    std::string type_string = "";
+    switch (result.connection_type) {
+      case 1:
+      case 3:
+        type_string = "beta-alpha-beta";
+        break;
+      case 2:
+        type_string = "beta-loop-beta";
+        break;
+      case 4:
+      case 6:
+        type_string = "beta-beta-beta";
+        break;
+      case 5:
+      case 7:
+        type_string = "beta-alpha(+beta)-beta";
+        break;
+    }
+
+    found.push_back(Handedness{result.sub_first.string(), result.sub_last.string(),
+                               out::substr2str::str(result.sub_first, adj),
+                               out::substr2str::str(result.sub_last, adj),
+                               result.left_score, result.mid_res_len, result.n_mid_str,
+                               type_string, result.jump});
+  }
+  return found;
+} // function find_handedness().
+
+
 
-  auto const found_bab = get_handedness(adj, bab_filter);
+// **********************************************************************************
+// Function output_handedness()
+// **********************************************************************************
 
+bool output_handedness(std::ostream & os, std::vector<Handedness> const& found) {
   mmcif::mmcif_like mmcif_out{os, "handedness"};
-  mmcif_out.key_value("num", found_bab.size());
+  mmcif_out.key_value("num", found.size());
 
-  if (found_bab.size()) {
+  if (found.size()) {
     mmcif_out.loop_head({"SubStrand_0", "SubStrand_1", "score", "mid_residues",
                          "mid_strands", "type", "jump"});
 
-    for (auto const& result : found_bab) {
-      assert(result.connection_type);
-
-      std::string type_string = "";
-      switch (result.connection_type) {
-        case 1:
-        case 3:
-          type_string = "beta-alpha-beta";
-          break;
-        case 2:
-          type_string = "beta-loop-beta";
-          break;
-        case 4:
-        case 6:
-          type_string = "beta-beta-beta";
-          break;
-        case 5:
-        case 7:
-          type_string = "beta-alpha(+beta)-beta";
-          break;
-      }
-
+    for (auto const& row : found) {
       os << boost::format("%s %|8t|%s %|16t|%4.2f %3d %2d %22s %d\n")
-             % result.sub_first.string()
-             % result.sub_last.string()
-             % result.left_score
-             % result.mid_res_len
-             % result.n_mid_str
-             % type_string
-             % result.jump;
+             % row.substr_0
+             % row.substr_1
+             % row.score
+             % row.mid_residues
+             % row.mid_strands
+             % row.type
+             % row.jump;
     }
     return true;
   } else {
@@ -108,4 +155,3 @@ bool output_handedness(std::ostream & os, sheet::DirectedAdjacencyList const& ad
 } // function output_handedness().
 
 } // namespace rare
-
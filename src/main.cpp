@@ -1,25 +1,19 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <fstream>
 #include <iostream>
-#include <functional>
 #include <string>
-#include <tuple>
-#include <vector>
 
-#include "adj_out.h"
-#include "data_store.h"
-#include "functions.h"
-#include "handedness.h"
+#include "arena.h"
+#include "archive.h"
+#include "corpus.h"
+#include "ensemble.h"
 #include "parse_argument.h"
-#include "sheets_out.h"
-#include "substrands.h"
-
-#include "pdb/sses.h"
-#include "pdb/tools.h"
-#include "bab/filter.h"
-#include "sheet/directed_adjacency_list.h"
-#include "sheet/filter.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "server.h"
+#include "sweep.h"
 
 
 #ifdef DEBUG
@@ -60,6 +54,7 @@ void print_arguments(boost::program_options::variables_map const& vm) {
   opt_to_clog.print<std::string>("pdb-file");
   opt_to_clog.print<std::string>("graphviz");
   opt_to_clog.print<bool>("no-stride-sse");
+  opt_to_clog.print<unsigned>("threads");
   opt_to_clog.print<std::string>("output-file");
   opt_to_clog.print<std::string>("stride-file");
   opt_to_clog.print<bool>("with-stride");
@@ -68,6 +63,21 @@ void print_arguments(boost::program_options::variables_map const& vm) {
   opt_to_clog.print<unsigned>("max-mid-strands");
   opt_to_clog.print<double>("cutoff-left-score");
   opt_to_clog.print<double>("min-side-dist");
+  opt_to_clog.print<bool>("strand-table-bridges");
+  opt_to_clog.print<bool>("profile");
+  opt_to_clog.print<std::string>("trace");
+  opt_to_clog.print<std::string>("cache-dir");
+  opt_to_clog.print<std::string>("corpus");
+  opt_to_clog.print<std::string>("corpus-out");
+  opt_to_clog.print<std::string>("journal");
+  opt_to_clog.print<std::string>("shard");
+  opt_to_clog.print<double>("time-limit");
+  opt_to_clog.print<std::size_t>("memory-limit");
+  opt_to_clog.print<std::string>("tar");
+  opt_to_clog.print<bool>("concatenated");
+  opt_to_clog.print<std::string>("models");
+  opt_to_clog.print_no_type("sweep");
+  opt_to_clog.print<std::string>("serve");
   opt_to_clog.print<unsigned>("apj-max-allowed-jump");
   opt_to_clog.print<unsigned>("pcc-min-allowed-jump");
 }
@@ -80,65 +90,30 @@ int main(int const argc, char* const * argv) {
     // Boost Variables Map
     auto const vm = arg::parse_arguments(argc, argv);
 
-    #ifdef DEBUG
-    print_arguments(vm);
-    #endif
-
-    // Prepare the Directed Adjacency List object
-    auto stride = arg::stride_from_argument(vm);
-
-    // If no-stride-sse, use the SSE headers in PDB_FILE
-    auto const sses = vm["no-stride-sse"].as<bool>() ?
-                        pdb::SSES{vm["pdb-file"].as<std::string>()} :
-                        pdb::SSES{vm["pdb-file"].as<std::string>(), stride};
-
-    sheet::DirectedAdjacencyList const dir_adj_list{sses, stride};
-    auto const sheet_id_map = substrands::gen_sheet_id_map(dir_adj_list);
-
-
-    // ***************
-    // Graphviz
-    // ***************
-    if (vm.count("graphviz")) {
-      // graphviz-only mode
-      if (vm["graphviz"].as<std::string>() == "-") {
-        graphviz::adj_list_to_dot(std::cout, dir_adj_list);
-        return 0;
-
-      // continue to other output
-      } else {
-        std::ofstream ofs_graphviz{vm["graphviz"].as<std::string>()};
-        graphviz::adj_list_to_dot(ofs_graphviz, dir_adj_list);
-      }
+    // server mode
+    if (vm.count("serve")) {
+      server::serve(vm["serve"].as<std::string>(), vm);
+      return 0;
     }
 
+    // corpus mode
+    if (vm.count("corpus")) {
+      return corpus::run(vm) == 0 ? 0 : 3;
+    }
 
-    // Prepare an object to store the all output data
-    data_store::Data<table::Set> output_data{std::make_tuple(
-        table::TBLSubStrand{"substrand",
-                            {"SubStrand_ID", "Sheet_ID", "Ini", "End"}},
-
-        table::TBLHelix{"helix", {"SSE_ID", "Ini", "End"}},
-
-        table::TBLSheet{"sheet",
-                        {"Sheet_ID", "N_strands", "Cycle", "Undirected",
-                         "With_branch", "Consecutive", "All_para", "All_anti",
-                         "Member", "Nomenclature_R", "Nomenclature_C"}},
-
-        table::TBLExtractedSheet{"EXT_Sheet",
-                                 {"Sheet_ID", "N_strands",
-                                  "Same_as_Original", "Member",
-                                  "Nomenclature_C"}},
-
-        table::TBLCycle{"cycle", {"Sheet_ID", "N_strands", "Member"}},
+    if (vm["profile"].as<bool>()) {
+      profile::enable();
+    }
+    if (vm.count("trace")) {
+      profile::enable_trace();
+    }
+    // the entries of an archive and the models of an ensemble have their own ones
+    profile::StructureScope const structure_scope{
+        vm.count("tar") ? vm["tar"].as<std::string>() : vm["pdb-file"].as<std::string>()};
 
-        table::TBLSubStrandsPair{"substrands_pair",
-                                 {"B1", "B2", "Sheet", "Dir", "PorA",
-                                  "Jump", "D1", "D2", "Bridge",
-                                  "Score", "SSEs_LBTS", "NumRes_LBTS"}},
-        table::TBLResiduePair{"residue_pair", {"ResNum1", "ResNum2",
-                                               "PorA", "Pair-type", "ForB"}}
-    )};
+    #ifdef DEBUG
+    print_arguments(vm);
+    #endif
 
     // set default out (if out_stdout)
 
@@ -150,56 +125,30 @@ int main(int const argc, char* const * argv) {
     }
     std::ostream & out_stream = out_stdout ? std::cout : ofs;
 
-
-    // ***************
-    // Cycles
-    // ***************
-    cycles::output_cycles(output_data.table<table::Cycle>(), dir_adj_list);
-
-
-    // ***************
-    // Default Output
-    // ***************
-    substrands::substrands_out(output_data.table<table::SubStrand>(), dir_adj_list,
-                               sheet_id_map);
-    substrands::helices_out(output_data.table<table::Helix>(), dir_adj_list);
-    sheets_out::print_sheet(output_data.table<table::Sheet>(), dir_adj_list);
-
-    auto bab_filter = bab::BabFilter{dir_adj_list, std::greater<double>(),
-                                     vm["max-mid-residues"].as<unsigned>(),
-                                     vm["max-mid-strands"].as<unsigned>(),
-                                     vm["cutoff-left-score"].as<double>(),
-                                     vm["min-side-dist"].as<double>()};
-
-    substrands::substrands_pair_out(output_data.table<table::SubStrandsPair>(),
-                                    dir_adj_list, sheet_id_map, bab_filter);
-
-
-    // ***************
-    // Extract Sheet
-    // ***************
-    if (vm.count("extract-sheets")) {
-      sheets_out::extracted_adjacent_substr_out(output_data.table<table::ExtractedSheet>(),
-                                                vm["extract-sheets"].as<std::size_t>(),
-                                                dir_adj_list);
+    // many entries in one input
+    int status = 0;
+    if (vm.count("tar") or vm["concatenated"].as<bool>()) {
+      status = archive::run(vm, out_stream) == 0 ? 0 : 3;
+    } else if (arg::all_models(vm)) {
+      status = ensemble::run(vm, out_stream) == 0 ? 0 : 3;
+    } else {
+      arena::StructureArena memory;
+      arena::StructureScope const memory_scope{memory};
+      if (vm.count("sweep")) {
+        sweep::run(vm, out_stream);
+      } else {
+        pipeline::run(vm, out_stream);
+      }
     }
 
-
-    // ***************
-    // Residue Pairs
-    // ***************
-    rpo::residue_pair_out(output_data.table<table::ResiduePair>(), dir_adj_list);
-
-
-    // Actually output the results
-    output_data.format_out(out_stream, vm["format-type"].as<std::size_t>());
-
-    // if mmcif output
-    if (vm["format-type"].as<std::size_t>() == 1) {
-      adj_out::adj_list_out(out_stream, dir_adj_list);
-      rare::output_handedness(out_stream, dir_adj_list, vm);
+    profile::report(std::cerr);
+    if (vm.count("trace")) {
+      std::ofstream ofs_trace{vm["trace"].as<std::string>()};
+      profile::write_trace(ofs_trace);
     }
 
+    return status;
+
 
   // if help mode ('--help')
   } catch (arg::help_mode const&) {
@@ -219,7 +168,9 @@ int main(int const argc, char* const * argv) {
 
   // For Other Possible Errors
   } catch (std::exception const& e) {
+    profile::count(profile::Counter::Exceptions);
     std::cerr << e.what() << std::endl;
+    profile::report(std::cerr);
     return 2;
 
   // For Unknown Errors
@@ -0,0 +1,159 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+namespace parallel {
+
+namespace {
+
+/// The tasks of one call of run_on_pool().
+class Job {
+public:
+  Job(std::size_t const n_tasks_, unsigned const max_helpers_,
+      std::function<void(std::size_t)> const& task_):
+    n_tasks{n_tasks_}, max_helpers{max_helpers_}, task{task_} {}
+
+  /// Run the tasks not taken yet, one at a time.
+  void work() {
+    for (std::size_t k = next++; k < n_tasks; k = next++) {
+      task(k);
+      std::lock_guard<std::mutex> lock{mutex};
+      if (++n_finished == n_tasks) {
+        finished.notify_all();
+      }
+    }
+  }
+
+  /// Wait for the tasks taken by the other threads.
+  void wait() {
+    std::unique_lock<std::mutex> lock{mutex};
+    finished.wait(lock, [this]() { return n_finished == n_tasks; });
+  }
+
+  /// Whether all the tasks have been taken.
+  bool exhausted() const { return n_tasks <= next.load(); }
+
+  std::size_t const n_tasks;
+  unsigned const max_helpers;
+  /// The threads of the pool working on this job. Guarded by the mutex of the pool.
+  unsigned n_helpers{0};
+
+private:
+  /// Owned by the caller of run_on_pool(), which does not return before n_finished ==
+  /// n_tasks. A helper may still increment next after that, but never calls it.
+  std::function<void(std::size_t)> const& task;
+  std::atomic<std::size_t> next{0};
+  std::mutex mutex{};
+  std::condition_variable finished{};
+  std::size_t n_finished{0};
+};
+
+
+/// @brief  The threads shared by all the calls of run_on_pool(). They are started as
+///         the calls request them and wait for the jobs until the end of the program.
+class Pool {
+public:
+  Pool() = default;
+  Pool(Pool const&) = delete;
+  Pool& operator=(Pool const&) = delete;
+
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      stopping = true;
+    }
+    available.notify_all();
+    for (auto & t : threads) {
+      t.join();
+    }
+  }
+
+  /// Run \c job on the calling thread and the idle threads of the pool.
+  void run(std::shared_ptr<Job> const& job) {
+    if (job->max_helpers != 0 and 1 < job->n_tasks) {
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        while (threads.size() < job->max_helpers) {
+          threads.emplace_back([this]() { help(); });
+        }
+        jobs.push_back(job);
+      }
+      available.notify_all();
+    }
+
+    job->work();
+    job->wait();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto itr = jobs.begin(); itr != jobs.end(); ++itr) {
+      if (*itr == job) {
+        jobs.erase(itr);
+        break;
+      }
+    }
+  }
+
+private:
+  /// The body of a thread of the pool.
+  void help() {
+    for (;;) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        available.wait(lock, [this]() { return stopping or take_front(); });
+        if (stopping) {
+          return;
+        }
+        job = jobs.front();
+        // The helpers leave a job only when it is exhausted, so a full one is done with.
+        if (++job->n_helpers == job->max_helpers) {
+          jobs.pop_front();
+        }
+      }
+      job->work();
+    }
+  }
+
+  /// @brief  Drop the exhausted jobs at the front of the queue.
+  /// @return Whether a job is left. The mutex must be locked.
+  bool take_front() {
+    while (not jobs.empty() and jobs.front()->exhausted()) {
+      jobs.pop_front();
+    }
+    return not jobs.empty();
+  }
+
+  std::mutex mutex{};
+  std::condition_variable available{};
+  /// The jobs with tasks not taken yet, in the order of the calls.
+  std::deque<std::shared_ptr<Job>> jobs{};
+  std::vector<std::thread> threads{};
+  bool stopping{false};
+};
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function detail::run_on_pool()
+// **************************************************************************
+
+void detail::run_on_pool(std::size_t const n_tasks, unsigned const max_helpers,
+                         std::function<void(std::size_t)> const& task) {
+  static Pool pool;
+  pool.run(std::make_shared<Job>(n_tasks, max_helpers, task));
+} // function detail::run_on_pool()
+
+} // namespace parallel
@@ -2,6 +2,7 @@
 // See LICENSE.txt for details.
 
 #include "parse_argument.h"
+#include "sweep.h"
 
 namespace arg {
 
@@ -35,6 +36,10 @@ void define_options(bpo::options_description & opts,
      "instead of ones from the STRIDE_FILE. Hydrogen bonding information will be read "
      "from the STRIDE_FILE either way.")
 
+    ("threads,j", bpo::value<unsigned>()->default_value(0),
+     "The number of threads to use. If 0, use as many threads as the number of cores. "
+     "The output does not depend on this value.")
+
     ("output-file,o", bpo::value<std::string>(),
      "Output file to write the results. If not specified, output to standard output.")
 
@@ -67,6 +72,102 @@ void define_options(bpo::options_description & opts,
      "The minimum distance between a triangle between strands and a CA atom to judge the "
      "handedness. CA atoms nearer than this distance to a triangle will NOT be counted.")
 
+    ("without-stat", bpo::bool_switch()->default_value(false),
+     "Run the handedness filter without recording the statistics (the cause of failure "
+     "and the jump). The jump in the handedness output will be 0.")
+
+    ("without-loop", bpo::bool_switch()->default_value(false),
+     "Ignore the loop regions between SSEs in the handedness filter. Connections with "
+     "no SSEs between the first and the last strand will not be examined.")
+
+    ("strand-table-bridges", bpo::bool_switch()->default_value(false),
+     "Detect the bridges between strands with a residue-indexed table of the strands "
+     "instead of searching the SSEs for each hydrogen bond. Gives the same bridges and "
+     "is not faster; it is a cross-check (scripts/compare_bridge_engines.py).")
+
+    ("profile", bpo::bool_switch()->default_value(false),
+     "Write the wall clock and CPU time of each stage, some counters (e.g. the number "
+     "of path searches and of allocations) and the peak memory usage to standard error "
+     "as mmcif-like '_profile' and '_profile_counter' loops.")
+
+    ("trace", bpo::value<std::string>(),
+     "Write the start and the duration of each stage in each thread to the given file "
+     "in the Chrome trace event format (JSON). Open it with chrome://tracing or "
+     "Perfetto to see how the stages overlap.")
+
+    ("cache-dir", bpo::value<std::string>(),
+     "Cache the output of stride ('--with-stride') and the results in the given "
+     "directory, keyed by the SHA-256 of the contents of the input files and of the "
+     "options which change the results. A run whose results are cached only reads the "
+     "files. The directory can be shared by concurrent runs. Not used with '--graphviz'.")
+
+    ("corpus", bpo::value<std::string>(),
+     "Analyze the structures listed in the given file (one 'PDB_FILE [STRIDE_FILE]' per "
+     "line) instead of PDB_FILE, each in its own process and '--threads' at once. The "
+     "output of each is written to '--corpus-out'. A structure which fails, crashes or "
+     "exceeds the limits is recorded in the journal and the others go on. The "
+     "structures already in the journal are skipped, so an interrupted run can be "
+     "resumed by running the same command again. The exit status is 3 if any structure "
+     "did not succeed.")
+
+    ("corpus-out", bpo::value<std::string>()->default_value("corpus_out"),
+     "The directory of the output of '--corpus' (PDB_FILE + '.out', with '/' as '%2F').")
+
+    ("journal", bpo::value<std::string>(),
+     "The journal of '--corpus': one line per finished structure with its status "
+     "(ok, failed, timeout or crashed), the error class and the message. "
+     "[default: CORPUS_OUT/journal.tsv]")
+
+    ("shard", bpo::value<std::string>()->default_value("0/1"),
+     "Run only the K-th of N shards ('K/N') of the list of '--corpus', e.g. to split it "
+     "between machines.")
+
+    ("time-limit", bpo::value<double>()->default_value(0.0, "0"),
+     "The limit of the wall clock time in seconds of each structure of '--corpus'. "
+     "0 for no limit.")
+
+    ("memory-limit", bpo::value<std::size_t>()->default_value(0),
+     "The limit of the address space in MB of each structure of '--corpus'. "
+     "0 for no limit.")
+
+    ("tar", bpo::value<std::string>(),
+     "Analyze the structures in the given uncompressed tar archive ('-' for the standard "
+     "input) instead of PDB_FILE, without extracting it. 'ID.pdb' (or 'pdbID.ent') is "
+     "paired with 'ID.stride' (or '.str') in any directory. The results are written one "
+     "after another, each headed by 'ENTRY ID' (or 'data_ID' in the mmcif format). "
+     "The exit status is 3 if any structure failed or had no pair.")
+
+    ("concatenated", bpo::bool_switch()->default_value(false),
+     "PDB_FILE and STRIDE_FILE hold many entries, each ending with an 'END' record (or "
+     "an 'ENDMDL' without 'MODEL'). The n-th entries of the two are analyzed together, "
+     "and the results are written as with '--tar'.")
+
+    ("models", bpo::value<std::string>()->default_value("first"),
+     "'first' to analyze the first MODEL of PDB_FILE, or 'all' to analyze every MODEL "
+     "(e.g. an NMR ensemble or the snapshots of a simulation), '--threads' models at "
+     "once. STRIDE_FILE holds either one stride output for all the models or one per "
+     "model separated by 'END' records; with '--with-stride', stride is run for each "
+     "model. The results are written per model ('MODEL n' ... 'ENDMDL', or "
+     "'data_ID_model_n' in the mmcif format), followed by the 'timeline' table of the "
+     "sheets and the left-handed connections of each model. The exit status is 3 if "
+     "any model failed.")
+
+    ("sweep", bpo::value<std::vector<std::string>>()->composing(),
+     "Write the 'sweep' table of the handedness of the connections for every "
+     "combination of the values of the cut-off options instead of the other results. "
+     "Given as 'NAME=V1,V2,...' once for each of 'min-side-dist', 'cutoff-left-score', "
+     "'max-mid-residues' and 'max-mid-strands' to sweep; the others take the value of "
+     "the option itself. Each row has the number of the connections examined (the "
+     "'handedness' section of the mmcif format) and the left-handed ones, the same as "
+     "a separate run with the values, but each connection is examined only once.")
+
+    ("serve", bpo::value<std::string>(),
+     "Run as a server listening on the given Unix domain socket instead of reading "
+     "PDB_FILE. Each request carries the command line arguments and optionally the "
+     "contents of the PDB and STRIDE files, and is answered with the output of a normal "
+     "run. The options given with '--serve' are the defaults of the requests, and "
+     "'--threads' is the number of requests served at once. See scripts/client.py.")
+
     ("apj-max-allowed-jump", bpo::value<unsigned>()->default_value(1),
      "Anti-Parallel strands with larger jumps than this value will be output "
      "as 'rare topology' when '-a' option is specified.")
@@ -131,7 +232,34 @@ bpo::variables_map parse_arguments(int const argc, char* const * argv) {
       throw help_mode{};
     }
 
-    bpo::notify(vm);
+    // PDB_FILE comes with each request in the server mode, and from the list in the
+    // corpus mode.
+    if (vm.count("serve") == 0 and vm.count("corpus") == 0 and vm.count("tar") == 0) {
+      bpo::notify(vm);
+    }
+
+    auto const models = vm["models"].as<std::string>();
+    if (models != "first" and models != "all") {
+      throw bpo::error{"the argument ('" + models + "') for option '--models' is "
+                       "invalid: must be 'first' or 'all'"};
+    }
+    if (models == "all" and (vm.count("serve") or vm.count("tar") or
+                             vm["concatenated"].as<bool>() or vm.count("graphviz"))) {
+      throw bpo::error{"'--models all' can not be used with '--serve', '--tar', "
+                       "'--concatenated' or '--graphviz'"};
+    }
+    if (vm.count("sweep")) {
+      if (vm.count("serve") or vm.count("tar") or vm["concatenated"].as<bool>() or
+          models == "all" or vm.count("graphviz")) {
+        throw bpo::error{"'--sweep' can not be used with '--serve', '--tar', "
+                         "'--concatenated', '--models all' or '--graphviz'"};
+      }
+      try {
+        sweep::parse_grid(vm);
+      } catch (sweep::sweep_error const& e) {
+        throw bpo::error{e.what()};
+      }
+    }
     return vm;
 
   } catch (bpo::error const& e) {
@@ -143,6 +271,28 @@ bpo::variables_map parse_arguments(int const argc, char* const * argv) {
 } // function parse_arguments()
 
 
+// *********************************************************************************
+// Function parse_request_arguments()
+// *********************************************************************************
+
+bpo::variables_map parse_request_arguments(std::vector<std::string> const& args) {
+  bpo::options_description opts;
+  bpo::options_description advanced_opts;
+  bpo::positional_options_description p_opts;
+  define_options(opts, advanced_opts, p_opts);
+  opts.add(advanced_opts);
+
+  try {
+    bpo::variables_map vm;
+    bpo::store(bpo::command_line_parser(args).options(opts).positional(p_opts).run(), vm);
+    return vm;
+  } catch (bpo::error const& e) {
+    throw argument_error{e.what()};
+  }
+} // function parse_request_arguments()
+
+
+
 // *********************************************************************************
 // Class Help
 // *********************************************************************************
@@ -257,4 +407,14 @@ pdb::stride_stream stride_from_argument(bpo::variables_map const& vm) {
 } // function stride_stream_from_argument()
 
 
+
+// *********************************************************************************
+// Function all_models()
+// *********************************************************************************
+
+bool all_models(bpo::variables_map const& vm) {
+  return vm["models"].as<std::string>() == "all";
+} // function all_models()
+
+
 } // namespace arg
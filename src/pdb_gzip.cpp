@@ -0,0 +1,651 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pdb/gzip.h"
+
+namespace pdb {
+
+namespace {
+
+/// The size of the buffers of the compressed and the decompressed data.
+constexpr std::size_t buffer_size = 1 << 16;
+
+/// The size of the window of the back references.
+constexpr std::size_t window_size = 1 << 15;
+
+constexpr unsigned char magic[2] = {0x1f, 0x8b};
+
+// The base values and the extra bits of the lengths (257..285) and the distances (0..29).
+constexpr std::uint16_t length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::uint8_t length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::uint16_t dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::uint8_t dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/// The order of the code lengths of the code length alphabet.
+constexpr std::uint8_t length_order[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+
+std::array<std::uint32_t, 256> make_crc_table() {
+  std::array<std::uint32_t, 256> table;
+  for (std::uint32_t n = 0; n < 256; ++n) {
+    auto c = n;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+    }
+    table[n] = c;
+  }
+  return table;
+}
+
+
+/// Update the CRC-32 (of gzip) \c crc with \c n bytes at \c p .
+std::uint32_t crc32(std::uint32_t crc, char const * const p, std::size_t const n) {
+  static auto const table = make_crc_table();
+  crc = ~crc;
+  for (std::size_t i = 0; i < n; ++i) {
+    crc = table[(crc ^ static_cast<unsigned char>(p[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+
+
+// **************************************************************************
+// Class Huffman
+// **************************************************************************
+
+/// A canonical Huffman code, decoded by a table of the first bits and then bit by bit.
+struct Huffman {
+  static constexpr unsigned max_bits = 15;
+  static constexpr unsigned fast_bits = 9;
+
+  /// @brief  Build the code from the code length of each symbol.
+  /// @throw  gzip_error  If the lengths are over-subscribed.
+  void build(std::uint8_t const * const lengths, std::size_t const n) {
+    std::fill(std::begin(count), std::end(count), 0);
+    for (std::size_t s = 0; s < n; ++s) {
+      ++count[lengths[s]];
+    }
+    count[0] = 0;
+
+    int left = 1;
+    std::uint16_t offsets[max_bits + 2] = {};
+    for (unsigned len = 1; len <= max_bits; ++len) {
+      left = (left << 1) - count[len];
+      if (left < 0) {
+        throw gzip_error{"BROKEN DATA (OVER-SUBSCRIBED CODE)"};
+      }
+      offsets[len + 1] = offsets[len] + count[len];
+    }
+    for (std::size_t s = 0; s < n; ++s) {
+      if (lengths[s] != 0) {
+        symbol[offsets[lengths[s]]++] = static_cast<std::uint16_t>(s);
+      }
+    }
+
+    // The codes are stored from the first bit, so the table is indexed by the reversed code.
+    std::fill(std::begin(fast), std::end(fast), 0);
+    unsigned code = 0;
+    std::size_t index = 0;
+    for (unsigned len = 1; len <= fast_bits; ++len) {
+      for (unsigned k = 0; k < count[len]; ++k, ++code, ++index) {
+        unsigned reversed = 0;
+        for (unsigned b = 0; b < len; ++b) {
+          reversed |= ((code >> b) & 1) << (len - 1 - b);
+        }
+        for (unsigned i = reversed; i < (1u << fast_bits); i += 1u << len) {
+          fast[i] = static_cast<std::uint16_t>(symbol[index] | len << 12);
+        }
+      }
+      code <<= 1;
+    }
+  }
+
+  std::uint16_t count[max_bits + 1];
+  std::uint16_t symbol[288];
+  /// The symbol | the length << 12, or 0 for the longer codes.
+  std::uint16_t fast[1 << fast_bits];
+};
+
+} // namespace
+
+
+
+// **************************************************************************
+// Class Inflater
+// **************************************************************************
+
+/// @brief  Decompress the deflate streams read from a stream buffer, a part at a time.
+///         Also reads the bytes around them (the gzip headers and trailers).
+class Inflater {
+public:
+  explicit Inflater(std::streambuf * const src_):
+    src{src_}, in(buffer_size), window(window_size) {}
+
+  /// Whether the next bytes are the gzip magic bytes. Nothing is consumed.
+  bool peek_magic() {
+    align();
+    while (end - pos < 2 and fill()) {}
+    return end - pos >= 2 and static_cast<unsigned char>(in[pos]) == magic[0] and
+           static_cast<unsigned char>(in[pos + 1]) == magic[1];
+  }
+
+  /// Whether all the bytes have been read.
+  bool at_end() {
+    align();
+    return pos == end and not fill();
+  }
+
+  /// @brief  Read a byte.
+  /// @throw  gzip_error  At the end of the data.
+  unsigned byte() {
+    align();
+    if (pos == end and not fill()) {
+      throw gzip_error{"TRUNCATED DATA"};
+    }
+    return static_cast<unsigned char>(in[pos++]);
+  }
+
+  /// Read up to \c n bytes as they are. @return The number of the bytes read (0 at the end).
+  std::size_t read_raw(char * const out, std::size_t const n) {
+    align();
+    if (pos == end and not fill()) {
+      return 0;
+    }
+    auto const k = std::min(n, end - pos);
+    std::memcpy(out, in.data() + pos, k);
+    pos += k;
+    return k;
+  }
+
+  /// @brief  Go back to the beginning of the source.
+  /// @return false if the source can not seek.
+  bool rewind() {
+    if (src->pubseekpos(0, std::ios::in) != std::streampos{0}) {
+      return false;
+    }
+    pos = 0;
+    end = 0;
+    bit_buffer = 0;
+    n_bits = 0;
+    return true;
+  }
+
+  /// Start a new deflate stream.
+  void reset() {
+    state = State::Header;
+    last = false;
+    total = 0;
+    copy_length = 0;
+  }
+
+  /// @brief  Decompress up to \c n bytes of the current deflate stream.
+  /// @return The number of the bytes written (0 at the end of the stream).
+  /// @throw  gzip_error  If the data is broken or truncated.
+  std::size_t inflate(char * const out, std::size_t const n) {
+    std::size_t written = 0;
+    while (written < n) {
+      // the rest of a back reference
+      for (; copy_length != 0 and written < n; --copy_length) {
+        put(out, written, window[(total - copy_distance) & (window_size - 1)]);
+      }
+      if (written == n) {
+        break;
+      }
+
+      switch (state) {
+        case State::Header:
+          if (last) {
+            state = State::Done;
+            break;
+          }
+          read_block_header();
+          break;
+
+        case State::Stored:
+          for (; stored_left != 0 and written < n; --stored_left) {
+            put(out, written, static_cast<char>(byte()));
+          }
+          if (stored_left == 0) {
+            state = State::Header;
+          }
+          break;
+
+        case State::Huffman: {
+          auto const sym = decode(literal_code);
+          if (sym < 256) {
+            put(out, written, static_cast<char>(sym));
+          } else if (sym == 256) {
+            state = State::Header;
+          } else {
+            if (285 < sym) {
+              throw gzip_error{"BROKEN DATA (INVALID LENGTH CODE)"};
+            }
+            copy_length = length_base[sym - 257] + bits(length_extra[sym - 257]);
+            auto const dist_sym = decode(distance_code);
+            if (29 < dist_sym) {
+              throw gzip_error{"BROKEN DATA (INVALID DISTANCE CODE)"};
+            }
+            copy_distance = dist_base[dist_sym] + bits(dist_extra[dist_sym]);
+            if (std::min<std::uint64_t>(total, window_size) < copy_distance) {
+              throw gzip_error{"BROKEN DATA (DISTANCE TOO FAR BACK)"};
+            }
+          }
+          break;
+        }
+
+        case State::Done:
+          return written;
+      }
+    }
+    return written;
+  }
+
+private:
+  enum class State {Header, Stored, Huffman, Done};
+
+  /// @brief  Read more compressed data. The last bytes before pos are kept, so that
+  ///         align() can give back the bytes in bit_buffer.
+  /// @return false at the end of the data.
+  bool fill() {
+    auto const keep = std::min<std::size_t>(pos, sizeof(bit_buffer));
+    if (keep != pos) {
+      std::memmove(in.data(), in.data() + pos - keep, end - pos + keep);
+      end -= pos - keep;
+      pos = keep;
+    }
+    auto const n = src->sgetn(in.data() + end, static_cast<std::streamsize>(in.size() - end));
+    if (n <= 0) {
+      return false;
+    }
+    end += static_cast<std::size_t>(n);
+    return true;
+  }
+
+  /// Have at least \c n bits in bit_buffer, if not at the end of the data.
+  void need(unsigned const n) {
+    while (n_bits < n) {
+      if (pos == end and not fill()) {
+        return;
+      }
+      bit_buffer |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[pos++])) << n_bits;
+      n_bits += 8;
+    }
+  }
+
+  /// Read \c n bits (the first bit lowest).
+  unsigned bits(unsigned const n) {
+    if (n == 0) {
+      return 0;
+    }
+    need(n);
+    if (n_bits < n) {
+      throw gzip_error{"TRUNCATED DATA"};
+    }
+    auto const value = static_cast<unsigned>(bit_buffer & ((1u << n) - 1));
+    bit_buffer >>= n;
+    n_bits -= n;
+    return value;
+  }
+
+  /// Drop the bits up to the byte boundary, and give the whole bytes back to the input.
+  void align() {
+    bit_buffer >>= n_bits % 8;
+    n_bits -= n_bits % 8;
+    pos -= n_bits / 8;
+    bit_buffer = 0;
+    n_bits = 0;
+  }
+
+  unsigned decode(Huffman const& h) {
+    need(Huffman::fast_bits);
+    if (Huffman::fast_bits <= n_bits) {
+      auto const entry = h.fast[bit_buffer & ((1u << Huffman::fast_bits) - 1)];
+      if (entry != 0) {
+        bits(entry >> 12);
+        return entry & 0xfff;
+      }
+    }
+
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned len = 1; len <= Huffman::max_bits; ++len) {
+      code |= static_cast<int>(bits(1));
+      int const count = h.count[len];
+      if (code - count < first) {
+        return h.symbol[index + (code - first)];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+    throw gzip_error{"BROKEN DATA (INVALID HUFFMAN CODE)"};
+  }
+
+  void read_block_header() {
+    last = bits(1) == 1;
+    switch (bits(2)) {
+      case 0: {
+        align();
+        auto const len = byte() | byte() << 8;
+        auto const nlen = byte() | byte() << 8;
+        if (len != (~nlen & 0xffff)) {
+          throw gzip_error{"BROKEN DATA (STORED BLOCK LENGTH)"};
+        }
+        stored_left = len;
+        state = State::Stored;
+        return;
+      }
+
+      case 1: {
+        std::uint8_t lengths[288 + 30];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        std::fill(lengths + 288, lengths + 318, 5);
+        literal_code.build(lengths, 288);
+        distance_code.build(lengths + 288, 30);
+        state = State::Huffman;
+        return;
+      }
+
+      case 2:
+        read_dynamic_codes();
+        state = State::Huffman;
+        return;
+
+      default:
+        throw gzip_error{"BROKEN DATA (INVALID BLOCK TYPE)"};
+    }
+  }
+
+  void read_dynamic_codes() {
+    auto const n_literal = bits(5) + 257;
+    auto const n_distance = bits(5) + 1;
+    auto const n_length = bits(4) + 4;
+    if (286 < n_literal or 30 < n_distance) {
+      throw gzip_error{"BROKEN DATA (TOO MANY CODES)"};
+    }
+
+    std::uint8_t lengths[288 + 32] = {};
+    for (unsigned i = 0; i < n_length; ++i) {
+      lengths[length_order[i]] = static_cast<std::uint8_t>(bits(3));
+    }
+    Huffman length_code;
+    length_code.build(lengths, 19);
+
+    std::fill(std::begin(lengths), std::end(lengths), 0);
+    for (unsigned i = 0; i < n_literal + n_distance;) {
+      auto const sym = decode(length_code);
+      if (sym < 16) {
+        lengths[i++] = static_cast<std::uint8_t>(sym);
+        continue;
+      }
+      std::uint8_t value = 0;
+      unsigned repeat = 0;
+      if (sym == 16) {
+        if (i == 0) {
+          throw gzip_error{"BROKEN DATA (REPEAT WITHOUT A LENGTH)"};
+        }
+        value = lengths[i - 1];
+        repeat = 3 + bits(2);
+      } else if (sym == 17) {
+        repeat = 3 + bits(3);
+      } else {
+        repeat = 11 + bits(7);
+      }
+      if (n_literal + n_distance < i + repeat) {
+        throw gzip_error{"BROKEN DATA (TOO MANY LENGTHS)"};
+      }
+      std::fill(lengths + i, lengths + i + repeat, value);
+      i += repeat;
+    }
+    if (lengths[256] == 0) {
+      throw gzip_error{"BROKEN DATA (NO END OF BLOCK CODE)"};
+    }
+
+    literal_code.build(lengths, n_literal);
+    distance_code.build(lengths + n_literal, n_distance);
+  }
+
+  void put(char * const out, std::size_t & written, char const c) {
+    out[written++] = c;
+    window[total & (window_size - 1)] = c;
+    ++total;
+  }
+
+  std::streambuf * const src;
+  std::vector<char> in;
+  std::size_t pos{0};
+  std::size_t end{0};
+  std::uint64_t bit_buffer{0};
+  unsigned n_bits{0};
+
+  State state{State::Header};
+  bool last{false};
+  std::size_t stored_left{0};
+  Huffman literal_code;
+  Huffman distance_code;
+  std::size_t copy_length{0};
+  std::size_t copy_distance{0};
+
+  std::vector<char> window;
+  /// The number of the bytes written in this stream.
+  std::uint64_t total{0};
+};
+
+
+
+// **************************************************************************
+// Class decompress_buf
+// **************************************************************************
+
+decompress_buf::decompress_buf(std::streambuf * const src):
+  inflater{new Inflater{src}}, buffer(buffer_size) {
+  setg(buffer.data(), buffer.data(), buffer.data());
+} // constructor
+
+
+
+decompress_buf::~decompress_buf() = default;
+
+
+
+decompress_buf::int_type decompress_buf::underflow() {
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  if (mode == Mode::Unknown) {
+    mode = inflater->peek_magic() ? (start_member() ? Mode::Gzip : Mode::End) : Mode::Plain;
+  }
+
+  std::size_t n = 0;
+  while (n == 0 and mode != Mode::End) {
+    if (mode == Mode::Plain) {
+      n = inflater->read_raw(buffer.data(), buffer.size());
+      if (n == 0) {
+        mode = Mode::End;
+      }
+      break;
+    }
+
+    n = inflater->inflate(buffer.data(), buffer.size());
+    crc = crc32(crc, buffer.data(), n);
+    size += static_cast<std::uint32_t>(n);
+    if (n != 0) {
+      break;
+    }
+
+    // the trailer of the member: CRC-32 and the size, little endian
+    std::uint32_t stored_crc = 0;
+    std::uint32_t stored_size = 0;
+    for (int i = 0; i < 4; ++i) {
+      stored_crc |= static_cast<std::uint32_t>(inflater->byte()) << (8 * i);
+    }
+    for (int i = 0; i < 4; ++i) {
+      stored_size |= static_cast<std::uint32_t>(inflater->byte()) << (8 * i);
+    }
+    if (stored_crc != crc or stored_size != size) {
+      throw gzip_error{"BROKEN DATA (CRC OR SIZE MISMATCH)"};
+    }
+
+    // Another member may follow. Anything else (e.g. zero padding) is ignored, like gzip.
+    if (not (inflater->peek_magic() and start_member())) {
+      mode = Mode::End;
+    }
+  }
+
+  if (n == 0) {
+    return traits_type::eof();
+  }
+  setg(buffer.data(), buffer.data(), buffer.data() + n);
+  return traits_type::to_int_type(*gptr());
+} // protected member function underflow()
+
+
+
+decompress_buf::pos_type decompress_buf::seekpos(pos_type const pos,
+                                                 std::ios::openmode const which) {
+  if (pos != pos_type{0} or not (which & std::ios::in) or not inflater->rewind()) {
+    return pos_type{off_type{-1}};
+  }
+  mode = Mode::Unknown;
+  setg(buffer.data(), buffer.data(), buffer.data());
+  return pos;
+} // protected member function seekpos()
+
+
+
+bool decompress_buf::start_member() {
+  if (inflater->at_end()) {
+    return false;
+  }
+
+  // ID1 ID2 CM FLG MTIME(4) XFL OS
+  unsigned header[10];
+  for (auto & b : header) {
+    b = inflater->byte();
+  }
+  if (header[2] != 8) {
+    throw gzip_error{"UNSUPPORTED COMPRESSION METHOD " + std::to_string(header[2])};
+  }
+  auto const flags = header[3];
+  // FEXTRA
+  if (flags & 0x04) {
+    auto const length = inflater->byte() | inflater->byte() << 8;
+    for (unsigned i = 0; i < length; ++i) {
+      inflater->byte();
+    }
+  }
+  // FNAME and FCOMMENT
+  for (unsigned const flag : {0x08u, 0x10u}) {
+    if (flags & flag) {
+      while (inflater->byte() != 0) {}
+    }
+  }
+  // FHCRC
+  if (flags & 0x02) {
+    inflater->byte();
+    inflater->byte();
+  }
+
+  inflater->reset();
+  crc = 0;
+  size = 0;
+  return true;
+} // private member function start_member()
+
+
+
+// **************************************************************************
+// Class input_stream
+// **************************************************************************
+
+input_stream::input_stream(std::string const& filename):
+  std::istream{nullptr}, file{}, buf{&file} {
+  if (file.open(filename, std::ios::in | std::ios::binary) == nullptr) {
+    throw open_file_error(filename);
+  }
+  rdbuf(&buf);
+  // Let the errors of the decompression out of the readers.
+  exceptions(std::ios::badbit);
+} // constructor
+
+
+
+input_stream::input_stream(std::istream & is):
+  std::istream{nullptr}, file{}, buf{is.rdbuf()} {
+  rdbuf(&buf);
+  exceptions(std::ios::badbit);
+} // constructor
+
+
+
+// **************************************************************************
+// Function is_gzip()
+// **************************************************************************
+
+bool is_gzip(std::string const& data) {
+  return 2 <= data.size() and static_cast<unsigned char>(data[0]) == magic[0] and
+         static_cast<unsigned char>(data[1]) == magic[1];
+} // function is_gzip()
+
+
+
+// **************************************************************************
+// Function decompress()
+// **************************************************************************
+
+std::string decompress(std::string data) {
+  if (not is_gzip(data)) {
+    return data;
+  }
+  std::stringbuf compressed{std::move(data), std::ios::in};
+  decompress_buf buf{&compressed};
+  std::string ret;
+  char chunk[buffer_size];
+  for (std::streamsize n; (n = buf.sgetn(chunk, sizeof(chunk))) > 0;) {
+    ret.append(chunk, static_cast<std::size_t>(n));
+  }
+  return ret;
+} // function decompress()
+
+
+
+// **************************************************************************
+// Function is_gzip_file()
+// **************************************************************************
+
+bool is_gzip_file(std::string const& filename) {
+  std::ifstream ifs{filename, std::ios::binary};
+  char head[2] = {};
+  ifs.read(head, 2);
+  return ifs.gcount() == 2 and is_gzip(std::string(head, 2));
+} // function is_gzip_file()
+
+} // namespace pdb
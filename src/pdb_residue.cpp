@@ -0,0 +1,206 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <cctype>
+#include <cstdlib>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "pdb/residue.h"
+
+namespace pdb {
+
+namespace {
+
+/// 10 * 36^3, the value of "A000" in base 36.
+constexpr int hybrid36_upper_offset = 466560;
+/// 26 * 36^3, the number of the values of "A000" to "ZZZZ".
+constexpr int hybrid36_upper_count = 1213056;
+
+
+/// @return The value of the hybrid-36 digit \c c , or -1.
+int hybrid36_digit(char const c, bool const upper) {
+  if (std::isdigit(static_cast<unsigned char>(c))) {
+    return c - '0';
+  }
+  if (upper and 'A' <= c and c <= 'Z') {
+    return c - 'A' + 10;
+  }
+  if (not upper and 'a' <= c and c <= 'z') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+} // namespace
+
+
+
+// ****************************************************************************************
+// Function decode_hybrid36()
+// ****************************************************************************************
+
+int decode_hybrid36(std::string const& field) {
+  auto const first = field.find_first_not_of(' ');
+  if (first == std::string::npos or
+      not std::isalpha(static_cast<unsigned char>(field[first]))) {
+    return std::stoi(field);
+  }
+
+  // A letter first: 4 digits of base 36, in upper or lower case
+  if (field.size() - first != 4) {
+    throw std::invalid_argument{"decode_hybrid36: '" + field + "'"};
+  }
+  bool const upper = std::isupper(static_cast<unsigned char>(field[first]));
+  int value = 0;
+  for (auto const c : field.substr(first)) {
+    auto const digit = hybrid36_digit(c, upper);
+    if (digit < 0) {
+      throw std::invalid_argument{"decode_hybrid36: '" + field + "'"};
+    }
+    value = value * 36 + digit;
+  }
+  return value - hybrid36_upper_offset + 10000 + (upper ? 0 : hybrid36_upper_count);
+} // function decode_hybrid36()
+
+
+
+// ****************************************************************************************
+// Function parse_residue_token()
+// ****************************************************************************************
+
+ResidueKey parse_residue_token(std::string const& line, std::size_t const pos,
+                               char const chain) {
+  auto const first = line.find_first_not_of(' ', pos);
+  if (first == std::string::npos) {
+    throw std::invalid_argument{"parse_residue_token: no residue number"};
+  }
+  auto const last = line.find(' ', first);
+  auto token = line.substr(first, last == std::string::npos ? last : last - first);
+
+  // The sequence number, and the insertion code if any.
+  char icode = ' ';
+  if (std::isalpha(static_cast<unsigned char>(token[0])) and 4 <= token.size()) {
+    if (token.size() == 5) {
+      icode = token[4];
+    }
+    token.resize(4);
+  } else if (1 < token.size() and std::isalpha(static_cast<unsigned char>(token.back()))) {
+    icode = token.back();
+    token.pop_back();
+  }
+  return ResidueKey{chain, decode_hybrid36(token), icode};
+} // function parse_residue_token()
+
+
+
+// ****************************************************************************************
+// Public Member function ResidueNumbering::add()
+// ****************************************************************************************
+
+int ResidueNumbering::add(ResidueKey const& key) {
+  auto const found = numbers.find(key);
+  if (found != numbers.end()) {
+    return found->second;
+  }
+
+  int number = key.seq;
+  if (not residues_data.empty()) {
+    auto const& prev = residues_data.back();
+    if (prev.second.chain == key.chain) {
+      // keep the gap (the missing residues) in the chain
+      number = prev.first + std::max(1, key.seq - prev.second.seq);
+    } else {
+      // a gap between the chains
+      number = prev.first + 2;
+      chain_starts.push_back(number);
+    }
+  } else {
+    chain_starts.push_back(number);
+  }
+
+  if (chains.find(key.chain) == std::string::npos) {
+    chains += key.chain;
+  }
+  if (number != key.seq or key.icode != ' ' or 1 < chains.size()) {
+    is_identity = false;
+  }
+  numbers.emplace(key, number);
+  residues_data.emplace_back(number, key);
+  return number;
+} // public member function ResidueNumbering::add()
+
+
+
+// ****************************************************************************************
+// Public Member function ResidueNumbering::find()
+// ****************************************************************************************
+
+boost::optional<int> ResidueNumbering::find(ResidueKey const& key) const {
+  // nothing read: the sequence numbers as they are
+  if (numbers.empty()) {
+    return key.seq;
+  }
+
+  ResidueKey const resolved{resolve_chain(key.chain), key.seq, key.icode};
+  auto const found = numbers.lower_bound(resolved);
+  if (found != numbers.end() and found->first == resolved) {
+    return found->second;
+  }
+
+  // The nearest residue of the same chain
+  auto nearest = numbers.end();
+  if (found != numbers.end() and found->first.chain == resolved.chain) {
+    nearest = found;
+  }
+  if (found != numbers.begin()) {
+    auto const prev = std::prev(found);
+    if (prev->first.chain == resolved.chain and
+        (nearest == numbers.end() or
+         resolved.seq - prev->first.seq <= nearest->first.seq - resolved.seq)) {
+      nearest = prev;
+    }
+  }
+  if (nearest == numbers.end()) {
+    return boost::none;
+  }
+  return nearest->second + (resolved.seq - nearest->first.seq);
+} // public member function ResidueNumbering::find()
+
+
+
+// ****************************************************************************************
+// Public Member function ResidueNumbering::chain_index()
+// ****************************************************************************************
+
+std::size_t ResidueNumbering::chain_index(int const number) const {
+  auto const found = std::upper_bound(chain_starts.cbegin(), chain_starts.cend(), number);
+  return found == chain_starts.cbegin() ? 0 : std::distance(chain_starts.cbegin(), found) - 1;
+} // public member function ResidueNumbering::chain_index()
+
+
+
+// ****************************************************************************************
+// Private Member function ResidueNumbering::resolve_chain()
+// ****************************************************************************************
+
+char ResidueNumbering::resolve_chain(char const chain) const {
+  if (chains.find(chain) != std::string::npos) {
+    return chain;
+  }
+  // STRIDE writes '-' for a blank chain ID, and some files omit the chain ID.
+  if (chain == ' ' or chain == '-') {
+    if (chains.find(' ') != std::string::npos) {
+      return ' ';
+    }
+    if (chains.size() == 1) {
+      return chains[0];
+    }
+  }
+  return chain;
+} // private member function ResidueNumbering::resolve_chain()
+
+} // namespace pdb
@@ -8,6 +8,8 @@
 
 #include <Eigen/Core>
 
+#include "arena.h"
+
 #include "pdb/constants.h"
 #include "pdb/atom.h"
 #include "pdb/sse.h"
@@ -32,9 +34,9 @@ ATOM_vec_iter SSE_Base::atom_vec_iter(int const resnum) const {
 // Protected Member Function entirety_check()
 // *********************************************************************
 
-bool SSE_Base::entirety_check(std::unordered_map<int, std::string> const& ca_lines) const {
+bool SSE_Base::entirety_check(CAAtoms const& ca_atoms) const {
   for (int i = init; i <= end; ++i) {
-    if (ca_lines.count(i) == 0) {
+    if (ca_atoms.count(i) == 0) {
       log("RESNUM '" + std::to_string(i) + "' IS MISSING IN SSE or LOOP: index = " +
           std::to_string(index));
       return false;
@@ -49,15 +51,16 @@ bool SSE_Base::entirety_check(std::unordered_map<int, std::string> const& ca_lin
 // Protected Member Function read_pdb_atom()
 // *********************************************************************
 
-std::vector<ATOM> SSE_Base::read_pdb_atom(std::unordered_map<int, std::string> const& ca_lines) const {
-  std::vector<ATOM> tmp_atoms;
+arena::vector<ATOM> SSE_Base::read_pdb_atom(CAAtoms const& ca_atoms) const {
+  arena::vector<ATOM> tmp_atoms;
   tmp_atoms.reserve(static_cast<unsigned>(end - init + 1));
 
   for (int i = init; i <= end; ++i) {
-    if (ca_lines.count(i) == 0) {
+    auto const found = ca_atoms.find(i);
+    if (found == ca_atoms.end()) {
       tmp_atoms.push_back(ATOM{});
     } else {
-      tmp_atoms.push_back(ATOM{ca_lines.at(i)});
+      tmp_atoms.push_back(found->second);
     }
   }
 
@@ -171,13 +174,15 @@ bool SSE::too_short_check() const noexcept {
 
 std::array<ATOM, 2> SSE::gen_representative(int const first) const {
   if (rep.len + rep.intrvl <= static_cast<unsigned>(end - init + 1)) {
-    try {
-      return std::array<ATOM, 2>({{gen_representative_atom(first),
-                                   gen_representative_atom(first + rep.intrvl)}});
-    } catch (padding_atom_found const& p) {
-      log(p.what());
+    auto const rep0 = gen_representative_atom(first);
+    auto const rep1 = rep0 ? gen_representative_atom(first + rep.intrvl) : boost::none;
+    if (not rep1) {
+      #ifdef LOGGING
+      log(padding_atom_found{}.what());
+      #endif // ifdef LOGGING
       return std::array<ATOM, 2>();
     }
+    return std::array<ATOM, 2>({{*rep0, *rep1}});
   } else {
     return std::array<ATOM, 2>();
   }
@@ -189,12 +194,12 @@ std::array<ATOM, 2> SSE::gen_representative(int const first) const {
 // Protected Member Function gen_representative_atom()
 // *********************************************************************
 
-ATOM SSE::gen_representative_atom(int const first) const {
+boost::optional<ATOM> SSE::gen_representative_atom(int const first) const {
   Eigen::Vector3d rep_atom(0.0, 0.0, 0.0);
 
   for (unsigned i = 0; i < rep.len; ++i) {
     if (atoms[first+i].pdb ==false) {
-      throw padding_atom_found{};
+      return boost::none;
     }
 
     rep_atom += atoms[first+i].xyz * rep.coeff[i];
@@ -5,15 +5,36 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 
+#include "arena.h"
 #include "pdb/exceptions.h"
+#include "pdb/gzip.h"
 #include "pdb/sses.h"
 #include "pdb/tools.h"
 
 namespace pdb {
 
+namespace {
+
+/// The character at \c pos of \c line , or ' ' if \c line is shorter.
+char column(std::string const& line, std::size_t const pos) {
+  return pos < line.size() ? line[pos] : ' ';
+}
+
+
+/// @brief  The residue in the columns of a PDB record: the chain ID at \c chain_col ,
+///         the sequence number from \c seq_col (4 columns) and the insertion code next.
+ResidueKey residue_at(std::string const& line, std::size_t const chain_col,
+                      std::size_t const seq_col) {
+  return ResidueKey{column(line, chain_col), decode_hybrid36(line.substr(seq_col, 4)),
+                    column(line, seq_col + 4)};
+}
+
+} // namespace
+
 
 // *****************************************************************************
 // Public Member gen_index_vec()
@@ -59,7 +80,24 @@ LOOP const& SSES::loop(IndexType const n) const {
 
 IndexType SSES::sse_ind_of(int const resnum, char const type, int const offset,
                         bool const with_too_short, char const hbond_atom) const {
+  auto const ind = find_sse_ind(resnum, type, offset, with_too_short, hbond_atom);
+  if (not ind) {
+    throw pdb::non_sse_resnum(resnum, "In sse_ind_of().");
+  }
+  return *ind;
+} // public member function sse_ind_of()
+
+
+
 
+// *****************************************************************************
+// Public Member function find_sse_ind()
+// *****************************************************************************
+
+boost::optional<IndexType> SSES::find_sse_ind(int const resnum, char const type,
+                                              int const offset,
+                                              bool const with_too_short,
+                                              char const hbond_atom) const {
 
   // type check
   if (type != 'H' and type != 'E' and type != 'A') {
@@ -82,12 +120,12 @@ IndexType SSES::sse_ind_of(int const resnum, char const type, int const offset,
   // If the first IndexType that is not less than resnum equals
   // the first IndexType that is greater than resnum, resnum is in the loop region.
   if (r.first == r.second) {
-    throw pdb::non_sse_resnum(resnum, "In sse_ind_of().");
+    return boost::none;
   }
 
   return *r.first;
 
-} // private member function sse_ind_of()
+} // public member function find_sse_ind()
 
 
 
@@ -96,37 +134,67 @@ IndexType SSES::sse_ind_of(int const resnum, char const type, int const offset,
 // Public Member function read_pdb()
 // *****************************************************************************
 
-std::vector<SSE> SSES::read_pdb(stride_stream & stride) {
+arena::vector<SSE> SSES::read_pdb(stride_stream & stride) {
+  // pdb file stream
+  input_stream ifs_pdb{pdb_file};
+  return read_pdb(ifs_pdb, stride);
+} // private member function read_pdb()
+
+
+
+
+// *****************************************************************************
+// Public Member function read_pdb()
+// *****************************************************************************
+
+arena::vector<SSE> SSES::read_pdb(std::istream & pdb_is, stride_stream & stride) {
+
+  // The residues are numbered first, to read the SSE headers with the numbers.
+  auto const ca_atoms = read_ca_atoms(pdb_is);
 
   // read SSE headers
-  auto const headers = read_sse_header(stride);
+  auto const headers = read_sse_header(pdb_is, stride);
+
+  // if there is no SSEs in this structure, just return.
+  if (headers.size() == 0) { return arena::vector<SSE>{}; }
+
+  return build(headers, ca_atoms);
+} // private member function read_pdb()
 
 
+
+
+// *****************************************************************************
+// Protected Member function build()
+// *****************************************************************************
+
+arena::vector<SSE> SSES::build(SSE::SSE_Header_vec const& headers, CAAtoms const& ca_atoms) {
   // if there is no SSEs in this structure, just return.
   // (To avoid invalid memory access. Otherwise, n_loops might be UNSIGNED_MAX.)
-  if (headers.size() == 0) { return std::vector<SSE>{}; }
+  if (headers.size() == 0) { return arena::vector<SSE>{}; }
+
+  // SSEs are indexed by IndexType. The loop below counts up to the number of SSEs
+  // in IndexType, so the largest value can not be an index.
+  std::size_t const max_sses = std::numeric_limits<IndexType>::max();
+  if (headers.size() > max_sses) {
+    throw too_many_sses{headers.size(), max_sses};
+  }
 
   // a vector to be returned
-  std::vector<SSE> sses;
+  arena::vector<SSE> sses;
 
   // prepare the memory for sses
   sses.reserve(headers.size());
 
-  // pdb file stream
-  std::ifstream ifs_pdb;
-  open_input(ifs_pdb, pdb_file);
-
-  // read atom lines
-  auto const atom_lines = read_atom_lines(ifs_pdb);
-
   #ifdef WITH_LOOP
   // Initialize loops_data
   auto const n_loops = headers.size() - 1;
   for (IndexType i = 0; i < n_loops; ++i) {
-    try {
-      loops_data.push_back({headers[i].end + 1, headers[i+1].init - 1, i, atom_lines});
-    } catch (invalid_sse_range const&) {
+    // zero-length loop
+    if (headers[i+1].init - 1 < headers[i].end + 1) {
       loops_data.push_back({headers[i].end, headers[i+1].init, i});
+    } else {
+      loops_data.push_back({headers[i].end + 1, headers[i+1].init - 1, i, ca_atoms});
     }
   }
   #endif // WITH_LOOP
@@ -135,10 +203,23 @@ std::vector<SSE> SSES::read_pdb(stride_stream & stride) {
   // generate the vector of SSEs
   auto const max = headers.size();
   for (IndexType i = 0; i < max; ++i) {
-    sses.emplace_back(headers[i], i, atom_lines);
+    sses.emplace_back(headers[i], i, ca_atoms);
   }
   return sses;
-} // private member function read_pdb()
+} // protected member function build()
+
+
+
+
+// *****************************************************************************
+// Protected Member function sort_headers()
+// *****************************************************************************
+
+SSE::SSE_Header_vec SSES::sort_headers(SSE::SSE_Header_vec headers) {
+  std::sort(headers.begin(), headers.end(),
+              [](SSE_Header const& a, SSE_Header const& b) { return a.init < b.init; });
+  return headers;
+} // protected member function sort_headers()
 
 
 
@@ -147,21 +228,18 @@ std::vector<SSE> SSES::read_pdb(stride_stream & stride) {
 // Protected Member function read_sse_header()
 // *****************************************************************************
 
-SSE::SSE_Header_vec SSES::read_sse_header(stride_stream & stride) const {
+SSE::SSE_Header_vec SSES::read_sse_header(std::istream & pdb_is,
+                                          stride_stream & stride) const {
   SSE::SSE_Header_vec sse_headers;
 
   if (stride.empty) {
-    std::ifstream ifs;
-    open_input(ifs, pdb_file);
-    sse_headers = read_sse_header_pdb(ifs);
+    sse_headers = read_sse_header_pdb(pdb_is);
   } else {
     sse_headers = read_sse_header_stride(stride.ss);
   }
 
   // sort sse_vec by its initial residue number
-  std::sort(sse_headers.begin(), sse_headers.end(),
-              [](SSE_Header const& a, SSE_Header const& b) { return a.init < b.init; });
-  return sse_headers;
+  return sort_headers(std::move(sse_headers));
 } // private member function read_sse_header()
 
 
@@ -175,18 +253,15 @@ SSE::SSE_Header_vec SSES::read_sse_header_pdb(std::istream & is) const {
   SSE::SSE_Header_vec sse_headers;
 
   // put back the reading point to the head of the input stream
+  is.clear();
   is.seekg(0);
 
   for (std::string buff; std::getline(is, buff);) {
     if (buff.substr(0, 5) == "HELIX") {
-      auto const resnum_init = std::stoi(buff.substr(21, 4));
-      auto const resnum_end  = std::stoi(buff.substr(33, 4));
-      sse_headers.emplace_back('H', resnum_init, resnum_end);
+      add_sse_header(sse_headers, 'H', residue_at(buff, 19, 21), residue_at(buff, 31, 33));
 
     } else if (buff.substr(0, 5) == "SHEET") {
-      auto const resnum_init = std::stoi(buff.substr(22, 4));
-      auto const resnum_end  = std::stoi(buff.substr(33, 4));
-      sse_headers.emplace_back('E', resnum_init, resnum_end);
+      add_sse_header(sse_headers, 'E', residue_at(buff, 21, 22), residue_at(buff, 32, 33));
     } else if (buff.substr(0, 4) == "ATOM") {
       break;
     }
@@ -214,15 +289,14 @@ SSE::SSE_Header_vec SSES::read_sse_header_stride(std::istream & is) const {
       continue;
     }
 
+    // The residue numbers may have the insertion codes (like "52A").
     if (buff.substr(5, 10) == "AlphaHelix") {
-      auto const resnum_init = std::stoi(buff.substr(22, 27));
-      auto const resnum_end = std::stoi(buff.substr(40, 45));
-      sse_headers.push_back(SSE_Header{'H', resnum_init, resnum_end});
+      add_sse_header(sse_headers, 'H', parse_residue_token(buff, 22, column(buff, 28)),
+                     parse_residue_token(buff, 40, column(buff, 45)));
 
     } else if (buff.substr(5, 6) == "Strand") {
-      auto const resnum_init = std::stoi(buff.substr(22, 27));
-      auto const resnum_end = std::stoi(buff.substr(40, 45));
-      sse_headers.push_back(SSE_Header{'E', resnum_init, resnum_end});
+      add_sse_header(sse_headers, 'E', parse_residue_token(buff, 22, column(buff, 28)),
+                     parse_residue_token(buff, 40, column(buff, 45)));
     }
   }
   return sse_headers;
@@ -231,16 +305,41 @@ SSE::SSE_Header_vec SSES::read_sse_header_stride(std::istream & is) const {
 
 
 // *****************************************************************************
-// Protected Member function read_atom_lines()
+// Protected Member function add_sse_header()
 // *****************************************************************************
 
-std::unordered_map<int, std::string> SSES::read_atom_lines(std::ifstream & ifs) {
-  ifs.seekg(0);
-  std::unordered_map<int, std::string> atom_lines;
+void SSES::add_sse_header(SSE::SSE_Header_vec & sse_headers, char const type,
+                          ResidueKey const& init, ResidueKey const& end) const {
+  auto const resnum_init = numbering_data.find(init);
+  auto const resnum_end = numbering_data.find(end);
+  if (resnum_init and resnum_end) {
+    sse_headers.emplace_back(type, *resnum_init, *resnum_end);
+  }
+} // protected member function add_sse_header()
+
+
 
-  for (std::string buff; std::getline(ifs, buff);) {
-    if (buff.substr(0, 4) == "ATOM" and buff.substr(12, 4) == " CA ") {
-      atom_lines.insert({std::stoi(buff.substr(22, 4)), buff});
+// *****************************************************************************
+// Protected Member function read_ca_atoms()
+// *****************************************************************************
+
+CAAtoms SSES::read_ca_atoms(std::istream & is) {
+  // the headers may have been read from the same stream
+  is.clear();
+  is.seekg(0);
+  CAAtoms ca_atoms;
+
+  // Only the first model (STRIDE reads only it, too).
+  bool first_model = true;
+  for (std::string buff; std::getline(is, buff);) {
+    if (buff.substr(0, 6) == "ENDMDL") {
+      first_model = false;
+    } else if (first_model and buff.substr(0, 4) == "ATOM" and buff.substr(12, 4) == " CA ") {
+      // the first one of the alternate locations
+      auto const resnum = numbering_data.add(residue_at(buff, 21, 22));
+      if (ca_atoms.count(resnum) == 0) {
+        ca_atoms.emplace(resnum, ATOM{buff});
+      }
 
     #ifdef DRYRUN // This part prevents this function to be const.
     } else if (buff.substr(0, 6) == "ANSWER") {
@@ -249,8 +348,8 @@ std::unordered_map<int, std::string> SSES::read_atom_lines(std::ifstream & ifs)
 
     }
   }
-  return atom_lines;
-} // protected member function read_atom_lines()
+  return ca_atoms;
+} // protected member function read_ca_atoms()
 
 
 
@@ -1,6 +1,9 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <fstream>
+
+#include "pdb/gzip.h"
 #include "pdb/stride_stream.h"
 
 namespace pdb {
@@ -17,14 +20,27 @@ stride_stream pdb2stride_stream(std::string const& pdb_file) {
   }
 
   // set the filename of the stride output
-  std::string const outfile = "./stride_" + pdb::basename(pdb_file) + "_" +
-                              pdb::rand_str(10) + ".stride";
+  std::string const tmp_prefix = "./stride_" + pdb::basename(pdb_file) + "_" +
+                                 pdb::rand_str(10);
+  std::string const outfile = tmp_prefix + ".stride";
+
+  // stride can not read gzipped files, so give it a decompressed copy
+  std::string const infile = is_gzip_file(pdb_file) ? tmp_prefix + ".pdb" : pdb_file;
+  if (infile != pdb_file) {
+    input_stream is{pdb_file};
+    std::stringstream ss;
+    is2ss(is, ss);
+    std::ofstream{infile} << ss.rdbuf();
+  }
 
   // run stride
-  std::string const cmd = "stride -h " + pdb_file + " >" + outfile;
+  std::string const cmd = "stride -h " + infile + " >" + outfile;
 
   // check the return code of stride command
   auto const ret_code = std::system(cmd.c_str());
+  if (infile != pdb_file) {
+    std::remove(infile.c_str());
+  }
   if (ret_code) {
     // remove tmp file (because the destructor will not be called)
     std::remove(outfile.c_str());
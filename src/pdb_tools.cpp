@@ -117,7 +117,11 @@ bool is_file_exist(std::string const& filename) {
 // ****************************************************************************************
 
 void is2ss(std::istream & is, std::stringstream & ss) {
-  ss << is.rdbuf();
+  // read() rather than 'ss << is.rdbuf()', which would swallow the errors of is
+  char buffer[1 << 16];
+  while (is.read(buffer, sizeof(buffer)) or 0 < is.gcount()) {
+    ss.write(buffer, is.gcount());
+  }
 }
 
 
@@ -161,8 +165,21 @@ void debug_log(std::string) {}
 // Function warning()
 // ****************************************************************************************
 
+namespace {
+
+/// The sink of the innermost WarningCapture of the thread, if any.
+thread_local std::vector<std::string> * warning_sink = nullptr;
+
+} // namespace
+
+
 #ifndef QUIET
 void warning(std::string const& msg) {
+  if (warning_sink) {
+    warning_sink->push_back(msg);
+    return;
+  }
+
   constexpr char const start[] = "\033[1;38;5;185m";
   constexpr char const end[] = "\033[00m";
   std::clog << start << "[WARNING] " << end
@@ -175,6 +192,22 @@ void warning(std::string) {}
 
 
 
+// ****************************************************************************************
+// Class WarningCapture
+// ****************************************************************************************
+
+WarningCapture::WarningCapture(std::vector<std::string> & sink):
+  previous{warning_sink} {
+  warning_sink = &sink;
+}
+
+WarningCapture::~WarningCapture() {
+  warning_sink = previous;
+}
+
+
+
+
 // ****************************************************************************************
 // Function gen_seq_file()
 // ****************************************************************************************
@@ -0,0 +1,261 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/format.hpp>
+
+#include "cache.h"
+#include "functions.h"
+#include "parse_argument.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "stride2top.h"
+
+#include "pdb/gzip.h"
+#include "pdb/sses.h"
+#include "pdb/tools.h"
+#include "sheet/directed_adjacency_list.h"
+
+namespace pipeline {
+
+// *********************************************************************************
+// Function analysis_options()
+// *********************************************************************************
+
+stride2top::Options analysis_options(bpo::variables_map const& vm) {
+  stride2top::Options options;
+  options.threads = vm["threads"].as<unsigned>();
+  options.strand_table_bridges = vm["strand-table-bridges"].as<bool>();
+  if (vm.count("extract-sheets")) {
+    options.extract_sheets = vm["extract-sheets"].as<std::size_t>();
+  }
+  options.max_mid_residues = vm["max-mid-residues"].as<unsigned>();
+  options.max_mid_strands = vm["max-mid-strands"].as<unsigned>();
+  options.cutoff_left_score = vm["cutoff-left-score"].as<double>();
+  options.min_side_dist = vm["min-side-dist"].as<double>();
+  options.with_stat = not vm["without-stat"].as<bool>();
+  options.with_loop = not vm["without-loop"].as<bool>();
+
+  // only written in the mmcif format
+  bool const mmcif_out = vm["format-type"].as<std::size_t>() == 1;
+  options.adjacency = mmcif_out;
+  options.handedness = mmcif_out;
+  return options;
+} // function analysis_options()
+
+
+
+namespace {
+
+/// @brief  Run the analysis on the parsed input and write the results (see run()).
+void analyze(bpo::variables_map const& vm, pdb::SSES const& sses, pdb::stride_stream & stride,
+             std::ostream & out_stream) {
+  auto const options = analysis_options(vm);
+
+  sheet::DirectedAdjacencyList const dir_adj_list{
+      sses, stride, options.strand_table_bridges ? sheet::BridgeEngine::StrandTable :
+                                                   sheet::BridgeEngine::Sweep,
+      options.threads};
+
+
+  // ***************
+  // Graphviz
+  // ***************
+  if (vm.count("graphviz")) {
+    profile::Scope const scope{"graphviz"};
+    // graphviz-only mode
+    if (vm["graphviz"].as<std::string>() == "-") {
+      graphviz::adj_list_to_dot(std::cout, dir_adj_list);
+      return;
+
+    // continue to other output
+    } else {
+      std::ofstream ofs_graphviz{vm["graphviz"].as<std::string>()};
+      graphviz::adj_list_to_dot(ofs_graphviz, dir_adj_list);
+    }
+  }
+
+  auto const result = stride2top::analyze(dir_adj_list, options);
+
+
+  // Actually output the results
+  profile::Scope format_scope{"format_out"};
+  stride2top::write(out_stream, result, vm["format-type"].as<std::size_t>());
+  out_stream.flush();
+  format_scope.finish();
+}
+
+/// Same as analyze() above, reading the input from \c input .
+void analyze(bpo::variables_map const& vm, Input const& input, std::ostream & out_stream) {
+  profile::Scope parse_scope{"parse"};
+
+  std::istringstream stride_is{input.stride_text};
+  pdb::stride_stream stride{stride_is};
+
+  // If no-stride-sse, use the SSE headers in the PDB data
+  std::istringstream pdb_is{input.pdb_text};
+  auto const sses = vm["no-stride-sse"].as<bool>() ?
+                      pdb::SSES{pdb_is, input.pdb_name} :
+                      pdb::SSES{pdb_is, input.pdb_name, stride};
+  parse_scope.finish();
+
+  analyze(vm, sses, stride, out_stream);
+}
+
+
+/// @return The whole contents of \c file , decompressed if gzipped.
+std::string read_file(std::string const& file) {
+  pdb::input_stream is{file};
+  std::stringstream ss;
+  pdb::is2ss(is, ss);
+  return ss.str();
+}
+
+
+
+
+/// @brief  The key of the results in the cache: everything the output depends on.
+///         The options which do not change the output (e.g. '--threads') are left out.
+std::string result_key(bpo::variables_map const& vm, Input const& input) {
+  cache::Sha256 hash;
+  hash.field(cache::results_version)
+      .field(std::to_string(vm["format-type"].as<std::size_t>()))
+      .field(vm.count("extract-sheets") ?
+               std::to_string(vm["extract-sheets"].as<std::size_t>()) : "-")
+      .field(std::to_string(vm["no-stride-sse"].as<bool>()))
+      .field(std::to_string(vm["max-mid-residues"].as<unsigned>()))
+      .field(std::to_string(vm["max-mid-strands"].as<unsigned>()))
+      .field((boost::format("%.17g") % vm["cutoff-left-score"].as<double>()).str())
+      .field((boost::format("%.17g") % vm["min-side-dist"].as<double>()).str())
+      .field(std::to_string(vm["without-stat"].as<bool>()))
+      .field(std::to_string(vm["without-loop"].as<bool>()))
+      .field(input.pdb_text)
+      .field(input.stride_text);
+  return hash.hex();
+}
+
+} // namespace
+
+
+
+// *********************************************************************************
+// Function run()
+// *********************************************************************************
+
+void run(bpo::variables_map const& vm, std::ostream & out_stream) {
+  // The keys of the cache are the contents of the input.
+  if (vm.count("cache-dir")) {
+    run(vm, read_input(vm), out_stream);
+    return;
+  }
+
+  profile::Scope parse_scope{"parse"};
+
+  // Prepare the Directed Adjacency List object
+  auto stride = arg::stride_from_argument(vm);
+
+  // If no-stride-sse, use the SSE headers in PDB_FILE
+  auto const sses = vm["no-stride-sse"].as<bool>() ?
+                      pdb::SSES{vm["pdb-file"].as<std::string>()} :
+                      pdb::SSES{vm["pdb-file"].as<std::string>(), stride};
+  parse_scope.finish();
+
+  analyze(vm, sses, stride, out_stream);
+} // function run()
+
+
+
+// *********************************************************************************
+// Function run()
+// *********************************************************************************
+
+void run(bpo::variables_map const& vm, Input const& input, std::ostream & out_stream) {
+  // The graphviz file is not cached, so run the analysis to write it.
+  if (vm.count("cache-dir") and vm.count("graphviz") == 0) {
+    profile::Scope lookup_scope{"cache"};
+    cache::Store const store{vm["cache-dir"].as<std::string>()};
+    auto const key = result_key(vm, input);
+    if (auto const cached = store.get("result", key)) {
+      profile::count(profile::Counter::CacheHits);
+      out_stream << *cached;
+      out_stream.flush();
+      return;
+    }
+    lookup_scope.finish();
+
+    profile::count(profile::Counter::CacheMisses);
+    std::ostringstream oss;
+    analyze(vm, input, oss);
+
+    profile::Scope store_scope{"cache"};
+    store.put("result", key, oss.str());
+    out_stream << oss.str();
+    out_stream.flush();
+    return;
+  }
+
+  analyze(vm, input, out_stream);
+} // function run()
+
+
+
+// *********************************************************************************
+// Function read_input()
+// *********************************************************************************
+
+Input read_input(bpo::variables_map const& vm) {
+  profile::Scope const scope{"parse"};
+
+  Input input;
+  input.pdb_name = vm["pdb-file"].as<std::string>();
+  input.pdb_text = read_file(input.pdb_name);
+
+  if (vm["with-stride"].as<bool>()) {
+    input.stride_text = run_stride(vm, input.pdb_name, input.pdb_text);
+  } else if (vm.count("stride-file")) {
+    input.stride_text = read_file(vm["stride-file"].as<std::string>());
+  } else {
+    pdb::input_stream is{std::cin};
+    std::stringstream ss;
+    pdb::is2ss(is, ss);
+    input.stride_text = ss.str();
+  }
+  return input;
+} // function read_input()
+
+
+
+
+// *********************************************************************************
+// Function run_stride()
+// *********************************************************************************
+
+std::string run_stride(bpo::variables_map const& vm, std::string const& pdb_file,
+                       std::string const& pdb_text) {
+  if (vm.count("cache-dir") == 0) {
+    return pdb::pdb2stride_stream(pdb_file).ss.str();
+  }
+
+  profile::Scope lookup_scope{"cache"};
+  cache::Store const store{vm["cache-dir"].as<std::string>()};
+  auto const key = cache::sha256(pdb_text);
+  if (auto const cached = store.get("stride", key)) {
+    profile::count(profile::Counter::CacheHits);
+    return *cached;
+  }
+  lookup_scope.finish();
+
+  profile::count(profile::Counter::CacheMisses);
+  auto stride_text = pdb::pdb2stride_stream(pdb_file).ss.str();
+
+  profile::Scope store_scope{"cache"};
+  store.put("stride", key, stride_text);
+  return stride_text;
+} // function run_stride()
+
+} // namespace pipeline
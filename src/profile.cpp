@@ -0,0 +1,333 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "alloc_stats.h"
+#include "profile.h"
+
+namespace profile {
+
+namespace detail {
+std::atomic<bool> is_enabled{false};
+std::array<std::atomic<std::size_t>, static_cast<std::size_t>(Counter::N_COUNTERS)> counters{};
+thread_local StructureTag current_structure{nullptr};
+} // namespace detail
+
+
+namespace {
+
+/// One run of a stage.
+struct Run {
+  char const * name;
+  /// The structure of the thread when the stage started. Never nullptr.
+  StructureTag structure;
+  std::chrono::steady_clock::time_point start;
+  double wall_ms;
+  double cpu_ms;
+  unsigned tid;
+};
+
+
+/// The runs recorded by one thread. Only the owner thread writes to it.
+struct ThreadBuffer {
+  explicit ThreadBuffer(unsigned const tid_): tid{tid_} {}
+  unsigned const tid;
+  std::vector<Run> runs{};
+};
+
+
+bool report_enabled{false};
+bool trace_enabled{false};
+
+/// The origin of the time stamps in the trace.
+auto const origin = std::chrono::steady_clock::now();
+
+/// The buffers of all the threads that have recorded a stage.
+/// They are kept after the threads exit, until the end of the program.
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+/// All the names interned by StructureScope. Never shrinks, so the tags stay valid.
+std::vector<std::unique_ptr<std::string const>> structure_names;
+std::string const no_structure{""};
+
+
+/// @return The buffer of the calling thread. Registered at the first call in each thread.
+ThreadBuffer & local_buffer() {
+  thread_local ThreadBuffer * buffer = nullptr;
+  if (buffer == nullptr) {
+    std::lock_guard<std::mutex> lock{registry_mutex};
+    registry.push_back(std::make_unique<ThreadBuffer>(static_cast<unsigned>(registry.size())));
+    buffer = registry.back().get();
+  }
+  return *buffer;
+}
+
+
+/// @return The runs of all the threads sorted by the start time.
+std::vector<Run> collect_runs() {
+  std::vector<Run> runs;
+  {
+    std::lock_guard<std::mutex> lock{registry_mutex};
+    for (auto const& buffer : registry) {
+      runs.insert(runs.end(), buffer->runs.cbegin(), buffer->runs.cend());
+    }
+  }
+  std::stable_sort(runs.begin(), runs.end(),
+                   [](Run const& a, Run const& b) { return a.start < b.start; });
+  return runs;
+}
+
+
+/// @return The peak resident set size of this process in kB, or 0 if not available.
+long peak_rss_kb() {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // ru_maxrss is in kB on Linux.
+  return usage.ru_maxrss;
+}
+
+
+/// Escape \c str to be written in a JSON string.
+std::string json_escape(std::string const& str) {
+  std::string ret;
+  for (auto const c : str) {
+    if (c == '"' or c == '\\') {
+      ret += '\\';
+      ret += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ret += (boost::format("\\u%04x") % static_cast<unsigned>(c)).str();
+    } else {
+      ret += c;
+    }
+  }
+  return ret;
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function enable()
+// **************************************************************************
+
+void enable() {
+  report_enabled = true;
+  alloc_stats::enable();
+  detail::is_enabled.store(true, std::memory_order_relaxed);
+} // function enable()
+
+
+
+// **************************************************************************
+// Function enable_trace()
+// **************************************************************************
+
+void enable_trace() {
+  trace_enabled = true;
+  detail::is_enabled.store(true, std::memory_order_relaxed);
+} // function enable_trace()
+
+
+
+// **************************************************************************
+// Function disable()
+// **************************************************************************
+
+void disable() {
+  detail::is_enabled.store(false, std::memory_order_relaxed);
+} // function disable()
+
+
+
+// **************************************************************************
+// Constructor StructureScope::StructureScope()
+// **************************************************************************
+
+StructureScope::StructureScope(std::string const& name):
+  previous{detail::current_structure}
+{
+  if (enabled()) {
+    std::lock_guard<std::mutex> lock{registry_mutex};
+    structure_names.push_back(std::make_unique<std::string const>(name));
+    detail::current_structure = structure_names.back().get();
+  }
+} // constructor StructureScope::StructureScope()
+
+
+
+// **************************************************************************
+// Member Function Scope::finish()
+// **************************************************************************
+
+void Scope::finish() {
+  if (not active) {
+    return;
+  }
+  active = false;
+
+  auto const wall = std::chrono::steady_clock::now() - wall_start;
+  double const wall_ms = std::chrono::duration<double, std::milli>(wall).count();
+  double const cpu_ms = thread_cpu_ms() - cpu_start;
+
+  auto & buffer = local_buffer();
+  buffer.runs.push_back(Run{name, structure != nullptr ? structure : &no_structure,
+                            wall_start, wall_ms, cpu_ms, buffer.tid});
+} // member function Scope::finish()
+
+
+
+// **************************************************************************
+// Static Member Function Scope::thread_cpu_ms()
+// **************************************************************************
+
+double Scope::thread_cpu_ms() {
+  timespec ts{};
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0.0;
+  }
+  return 1000.0 * static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1.0e6;
+} // static member function Scope::thread_cpu_ms()
+
+
+
+// **************************************************************************
+// Function summary()
+// **************************************************************************
+
+std::vector<StageSummary> summary() {
+  std::vector<StageSummary> rows;
+  for (auto const& run : collect_runs()) {
+    auto const row = std::find_if(rows.begin(), rows.end(),
+                                  [&run](StageSummary const& r) { return r.stage == run.name; });
+    if (row == rows.end()) {
+      rows.push_back(StageSummary{run.name, 1, run.wall_ms, run.cpu_ms});
+    } else {
+      ++row->calls;
+      row->wall_ms += run.wall_ms;
+      row->cpu_ms += run.cpu_ms;
+    }
+  }
+  return rows;
+} // function summary()
+
+
+
+// **************************************************************************
+// Function counter()
+// **************************************************************************
+
+std::size_t counter(Counter const c) {
+  return detail::counters[static_cast<std::size_t>(c)].load(std::memory_order_relaxed);
+} // function counter()
+
+
+
+// **************************************************************************
+// Function reset()
+// **************************************************************************
+
+void reset() {
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  for (auto & buffer : registry) {
+    buffer->runs.clear();
+  }
+  for (auto & c : detail::counters) {
+    c.store(0, std::memory_order_relaxed);
+  }
+} // function reset()
+
+
+
+// **************************************************************************
+// Function report()
+// **************************************************************************
+
+void report(std::ostream & os) {
+  if (not report_enabled) {
+    return;
+  }
+
+  os << "#\nloop_\n_profile.Stage\n_profile.Calls\n_profile.Wall_ms\n_profile.CPU_ms\n";
+  for (auto const& row : summary()) {
+    os << boost::format("%-16s %6d %12.3f %12.3f\n")
+          % row.stage % row.calls % row.wall_ms % row.cpu_ms;
+  }
+
+  os << "#\nloop_\n_profile_counter.Name\n_profile_counter.Value\n";
+  auto const counter_row = boost::format("%-16s %12d\n");
+  os << boost::format(counter_row) % "BFS" % counter(Counter::BfsInvocations)
+     << boost::format(counter_row) % "BFS_rows_reused" % counter(Counter::BfsRowsReused)
+     << boost::format(counter_row) % "Comps_reused" % counter(Counter::ComponentsReused)
+     << boost::format(counter_row) % "HBonds" % counter(Counter::HbondsProcessed)
+     << boost::format(counter_row) % "Triangle_tests" % counter(Counter::TriangleTests)
+     << boost::format(counter_row) % "Exceptions" % counter(Counter::Exceptions)
+     << boost::format(counter_row) % "Cache_hits" % counter(Counter::CacheHits)
+     << boost::format(counter_row) % "Cache_misses" % counter(Counter::CacheMisses);
+
+  os << boost::format(counter_row) % "Allocations" % alloc_stats::n_allocations()
+     << boost::format(counter_row) % "Allocated_bytes" % alloc_stats::n_bytes();
+
+  os << boost::format(counter_row) % "Peak_RSS_kB" % peak_rss_kb();
+} // function report()
+
+
+
+// **************************************************************************
+// Function write_trace()
+// **************************************************************************
+
+void write_trace(std::ostream & os) {
+  if (not trace_enabled) {
+    return;
+  }
+
+  auto const runs = collect_runs();
+
+  unsigned n_threads = 0;
+  {
+    std::lock_guard<std::mutex> lock{registry_mutex};
+    n_threads = static_cast<unsigned>(registry.size());
+  }
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+  // Name the threads. tid 0 is the first thread that recorded a stage (usually main).
+  for (unsigned tid = 0; tid < n_threads; ++tid) {
+    os << boost::format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                        "\"args\":{\"name\":\"%s\"}},\n")
+          % tid % (tid == 0 ? std::string{"main"} : "worker " + std::to_string(tid));
+  }
+
+  bool first = true;
+  for (auto const& run : runs) {
+    double const ts = std::chrono::duration<double, std::micro>(run.start - origin).count();
+    os << (first ? "" : ",\n")
+       << boost::format("{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,"
+                        "\"dur\":%.3f,\"pid\":1,\"tid\":%d,"
+                        "\"args\":{\"structure\":\"%s\",\"cpu_ms\":%.3f}}")
+          % run.name % ts % (run.wall_ms * 1000.0) % run.tid
+          % json_escape(*run.structure) % run.cpu_ms;
+    first = false;
+  }
+  os << "\n]}\n";
+} // function write_trace()
+
+} // namespace profile
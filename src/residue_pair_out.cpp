@@ -1,7 +1,7 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
-#include <array>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -9,7 +9,6 @@
 #include <boost/format.hpp>
 
 #include "functions.h"
-#include "table.h"
 
 namespace rpo {
 
@@ -20,11 +19,9 @@ int get_resnum(pdb::SSES const& sses, std::size_t const serial_str_id, std::size
 }
 
 
-void residue_pair_out(table::TBLResiduePair & tbl,
+void residue_pair_out(std::vector<stride2top::ResiduePair> & residue_pairs,
                       sheet::DirectedAdjacencyList const& adj) {
-  std::array<std::string, 5> type = {{"NoBridge", "ParallelHbonds", "ParallelNoHBonds", "SmallRing", "LargeRing"}};
-
-  std::vector<table::ResiduePair> residue_pairs;
+  auto const first = residue_pairs.size();
 
   unsigned sse_count = 0;
   for (auto const& strict_strand : adj.get_strict_zone().strict) {
@@ -42,21 +39,20 @@ void residue_pair_out(table::TBLResiduePair & tbl,
           assert(zi.side != sheet::ZoneInfo::SideStatus::Undefined);
           assert(zi.bridge_type[i] != sheet::ZoneInfo::BridgeType::NoBridge);
 
+          auto const partner = adj.get_strict_zone().residue_of(zi.adj_residues[i]);
           auto const res1 =
-            get_resnum(adj.sses,
-                       zi.adj_residues[i].serial_str_id,
-                       zi.adj_residues[i].serial_res_id);
+            get_resnum(adj.sses, partner.serial_str_id, partner.serial_res_id);
 
           auto const lambda_switch_PorA = [&res0, &res1](sheet::ZoneInfo::BridgeType const t){
             switch (t) {
               case sheet::ZoneInfo::BridgeType::ParallelNoHbonds:
-                  return std::make_tuple("para", "A");
+                  return std::make_tuple(true, "A");
               case sheet::ZoneInfo::BridgeType::ParallelHbonds:
-                  return std::make_tuple("para", "B");
+                  return std::make_tuple(true, "B");
               case sheet::ZoneInfo::BridgeType::LargeRing:
-                  return std::make_tuple("anti", "Non-H-bonded");
+                  return std::make_tuple(false, "Non-H-bonded");
               case sheet::ZoneInfo::BridgeType::SmallRing:
-                  return std::make_tuple("anti", "H-bonded");
+                  return std::make_tuple(false, "H-bonded");
               default:
                   throw invalid_zone_info_exception{"No Bridge found between residue[" +
                     std::to_string(res0) +
@@ -68,11 +64,11 @@ void residue_pair_out(table::TBLResiduePair & tbl,
 
           auto const PorA_and_type = lambda_switch_PorA(zi.bridge_type[i]);
 
-          residue_pairs.push_back(std::make_tuple(
+          residue_pairs.push_back(stride2top::ResiduePair{
                 res0, res1,
                 std::get<0>(PorA_and_type),
                 std::get<1>(PorA_and_type),
-                zi.side  ? "Front" : "Back"));
+                static_cast<bool>(zi.side)});
         }
       }
 
@@ -81,21 +77,17 @@ void residue_pair_out(table::TBLResiduePair & tbl,
     ++sse_count;
   }
 
-  std::sort(residue_pairs.begin(), residue_pairs.end(),
+  std::sort(residue_pairs.begin() + first, residue_pairs.end(),
             [](auto const& a, auto const& b){
-              if (std::get<0>(a) < std::get<0>(b)) {
+              if (a.resnum_0 < b.resnum_0) {
                 return true;
-              } else if (std::get<0>(a) == std::get<0>(b)) {
-                if (std::get<1>(a) < std::get<1>(b)) {
+              } else if (a.resnum_0 == b.resnum_0) {
+                if (a.resnum_1 < b.resnum_1) {
                   return true;
                 }
               }
               return false;
             });
-
-  for (auto const& rp : residue_pairs) {
-    tbl.add(rp);
-  }
 }
 
 } // namespace rpo
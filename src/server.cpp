@@ -0,0 +1,473 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "server.h"
+
+#include "pdb/gzip.h"
+#include "pdb/stride_stream.h"
+#include "pdb/tools.h"
+
+namespace server {
+
+namespace {
+
+/// Fields larger than this are refused, and the connection is closed.
+constexpr std::size_t max_field_size = std::size_t{1} << 28;
+
+/// Set by the signal handler to stop the server.
+volatile std::sig_atomic_t stop_requested = 0;
+
+extern "C" void on_stop_signal(int) {
+  stop_requested = 1;
+}
+
+
+/// A malformed request or a closed connection. The connection is closed.
+class protocol_error: public std::runtime_error {
+public:
+  explicit protocol_error(std::string const& msg): std::runtime_error{msg} {}
+};
+
+
+// **************************************************************************
+// Class Connection
+// **************************************************************************
+
+/// Buffered reading and writing of the fields on a connected socket.
+class Connection {
+public:
+  explicit Connection(int const fd_): fd{fd_} {}
+
+  /// @brief  Read a request.
+  /// @return boost::none if the client closed the connection between requests.
+  /// @throw  protocol_error
+  boost::optional<Request> read_request() {
+    Request request;
+    for (bool first = true;; first = false) {
+      std::string tag;
+      std::size_t length = 0;
+      if (not read_header(tag, length)) {
+        if (first) {
+          return boost::none;
+        }
+        throw protocol_error{"connection closed in a request"};
+      }
+      if (tag == "end") {
+        return request;
+      }
+
+      auto value = read_bytes(length);
+      if (tag == "arg") {
+        request.args.push_back(std::move(value));
+      } else if (tag == "pdb") {
+        request.pdb = std::move(value);
+      } else if (tag == "stride") {
+        request.stride = std::move(value);
+      } else {
+        throw protocol_error{"unknown field '" + tag + "'"};
+      }
+    }
+  }
+
+  /// @throw  protocol_error  If the client has gone.
+  void write_response(Response const& response) {
+    auto const frame = "status " + std::to_string(response.status) + " " +
+                       std::to_string(response.body.size()) + "\n" + response.body;
+    for (std::size_t sent = 0; sent < frame.size();) {
+      auto const n = ::send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+      if (n < 0 and errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        throw protocol_error{"cannot write the response"};
+      }
+      sent += static_cast<std::size_t>(n);
+    }
+  }
+
+private:
+  /// @brief  Read "<tag> <length>\n".
+  /// @return false if the connection is closed before the first byte.
+  bool read_header(std::string & tag, std::size_t & length) {
+    std::string line;
+    for (char c; read_char(c);) {
+      if (c == '\n') {
+        std::istringstream iss{line};
+        if (not (iss >> tag >> length) or length > max_field_size) {
+          throw protocol_error{"malformed field header '" + line + "'"};
+        }
+        return true;
+      }
+      line += c;
+      if (line.size() > 64) {
+        throw protocol_error{"malformed field header"};
+      }
+    }
+    if (not line.empty()) {
+      throw protocol_error{"connection closed in a field header"};
+    }
+    return false;
+  }
+
+  std::string read_bytes(std::size_t const length) {
+    std::string ret;
+    ret.reserve(length);
+    while (ret.size() < length) {
+      if (begin == end and not fill()) {
+        throw protocol_error{"connection closed in a field"};
+      }
+      auto const n = std::min(end - begin, length - ret.size());
+      ret.append(buffer + begin, n);
+      begin += n;
+    }
+    return ret;
+  }
+
+  bool read_char(char & c) {
+    if (begin == end and not fill()) {
+      return false;
+    }
+    c = buffer[begin++];
+    return true;
+  }
+
+  /// @return false on the end of the connection.
+  bool fill() {
+    while (true) {
+      auto const n = ::recv(fd, buffer, sizeof(buffer), 0);
+      if (n < 0 and errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      begin = 0;
+      end = static_cast<std::size_t>(n);
+      return true;
+    }
+  }
+
+  int const fd;
+  char buffer[65536];
+  std::size_t begin{0};
+  std::size_t end{0};
+};
+
+
+// **************************************************************************
+// Request handling
+// **************************************************************************
+
+/// @return The whole contents of \c file , decompressed if gzipped.
+std::string read_file(std::string const& file) {
+  pdb::input_stream is{file};
+  std::stringstream ss;
+  pdb::is2ss(is, ss);
+  return ss.str();
+}
+
+
+/// @brief  Check the options that can not be used in a request, and fill the options not
+///         given in the request with the ones of the server.
+void merge_defaults(bpo::variables_map & vm, bpo::variables_map const& defaults) {
+  // Options which write to the files or the standard streams of the server, or which
+  // belong to the server itself.
+  static char const * const forbidden[] = {
+    "help", "help-all", "serve", "output-file", "graphviz", "trace", "cache-dir",
+    "corpus", "corpus-out", "journal", "shard", "time-limit", "memory-limit", "tar",
+    "concatenated", "models", "sweep"
+  };
+  for (auto const option : forbidden) {
+    if (vm.count(option) != 0 and not vm[option].defaulted()) {
+      throw arg::argument_error{"'--" + std::string{option} + "' is not allowed in a request."};
+    }
+  }
+  if (vm["profile"].as<bool>()) {
+    throw arg::argument_error{"'--profile' is not allowed in a request."};
+  }
+
+  // Not inherited from the server.
+  static char const * const own[] = {
+    "pdb-file", "stride-file", "threads", "serve", "output-file", "graphviz", "trace",
+    "profile"
+  };
+  auto & map = static_cast<std::map<std::string, bpo::variable_value> &>(vm);
+  for (auto const& option : defaults) {
+    if (option.second.defaulted() or
+        std::find_if(std::begin(own), std::end(own), [&option](char const * const o) {
+          return option.first == o;
+        }) != std::end(own)) {
+      continue;
+    }
+    if (vm.count(option.first) == 0 or vm[option.first].defaulted()) {
+      map[option.first] = option.second;
+    }
+  }
+
+  // The requests are run concurrently, so each request uses one thread by default.
+  if (vm["threads"].defaulted()) {
+    map["threads"] = bpo::variable_value{1u, false};
+  }
+}
+
+
+/// @return The input of \c request , reading the files given in \c vm if not included.
+pipeline::Input gather_input(Request const& request, bpo::variables_map const& vm) {
+  pipeline::Input input;
+  input.pdb_name = vm.count("pdb-file") ? vm["pdb-file"].as<std::string>() : "-";
+
+  if (request.pdb) {
+    input.pdb_text = pdb::decompress(*request.pdb);
+  } else if (vm.count("pdb-file")) {
+    input.pdb_text = read_file(input.pdb_name);
+  } else {
+    throw arg::argument_error{"Neither the 'pdb' field nor PDB_FILE is given."};
+  }
+
+  if (request.stride) {
+    input.stride_text = pdb::decompress(*request.stride);
+  } else if (vm["with-stride"].as<bool>()) {
+    if (request.pdb) {
+      throw arg::argument_error{"'--with-stride' needs PDB_FILE on the server."};
+    }
+    input.stride_text = pipeline::run_stride(vm, input.pdb_name, input.pdb_text);
+  } else if (vm.count("stride-file")) {
+    input.stride_text = read_file(vm["stride-file"].as<std::string>());
+  } else {
+    throw arg::argument_error{"Neither the 'stride' field nor STRIDE_FILE is given."};
+  }
+  return input;
+}
+
+
+// **************************************************************************
+// Class ConnectionQueue
+// **************************************************************************
+
+/// The accepted connections waiting for a worker.
+class ConnectionQueue {
+public:
+  void push(int const fd) {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      fds.push_back(fd);
+    }
+    cv.notify_one();
+  }
+
+  /// @return -1 after close().
+  int pop() {
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [this]() { return closed or not fds.empty(); });
+    if (fds.empty()) {
+      return -1;
+    }
+    auto const fd = fds.front();
+    fds.pop_front();
+    active.insert(fd);
+    return fd;
+  }
+
+  /// Called by a worker when it has closed \c fd .
+  void done(int const fd) {
+    std::lock_guard<std::mutex> lock{mutex};
+    active.erase(fd);
+  }
+
+  /// Wake up all the workers, and end the connections being served.
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      closed = true;
+      for (auto const fd : fds) {
+        ::close(fd);
+      }
+      fds.clear();
+      for (auto const fd : active) {
+        ::shutdown(fd, SHUT_RDWR);
+      }
+    }
+    cv.notify_all();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<int> fds{};
+  std::set<int> active{};
+  bool closed{false};
+};
+
+
+/// @brief  Serve the requests on \c fd until the client closes the connection. The
+///         structures are allocated from \c memory , the arena of the worker.
+void serve_connection(int const fd, bpo::variables_map const& defaults,
+                      arena::StructureArena & memory) {
+  Connection connection{fd};
+  try {
+    while (auto const request = connection.read_request()) {
+      connection.write_response(handle(*request, defaults, memory));
+    }
+  } catch (protocol_error const& e) {
+    std::cerr << "stride2top server: " << e.what() << std::endl;
+  }
+}
+
+
+/// @return A socket listening on \c socket_path .
+int listen_on(std::string const& socket_path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw server_error{"the socket path '" + socket_path + "' is too long."};
+  }
+  std::strcpy(addr.sun_path, socket_path.c_str());
+
+  int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw server_error{std::string{"socket(): "} + std::strerror(errno)};
+  }
+
+  auto const bind_socket = [&]() {
+    return ::bind(fd, reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) == 0;
+  };
+  if (not bind_socket()) {
+    // A socket left by a server which is no longer running is replaced.
+    bool stale = false;
+    if (errno == EADDRINUSE) {
+      int const probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      stale = ::connect(probe, reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) != 0
+              and errno == ECONNREFUSED;
+      ::close(probe);
+    }
+    if (not stale or ::unlink(socket_path.c_str()) != 0 or not bind_socket()) {
+      auto const msg = std::string{"cannot bind '"} + socket_path + "': " + std::strerror(errno);
+      ::close(fd);
+      throw server_error{msg};
+    }
+  }
+
+  if (::listen(fd, SOMAXCONN) != 0) {
+    auto const msg = std::string{"listen(): "} + std::strerror(errno);
+    ::close(fd);
+    throw server_error{msg};
+  }
+  return fd;
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function handle()
+// **************************************************************************
+
+Response handle(Request const& request, bpo::variables_map const& defaults,
+                arena::StructureArena & memory) {
+  try {
+    auto vm = arg::parse_request_arguments(request.args);
+    merge_defaults(vm, defaults);
+
+    auto const input = gather_input(request, vm);
+    profile::StructureScope const structure_scope{input.pdb_name};
+    arena::StructureScope const memory_scope{memory};
+    std::ostringstream out;
+    pipeline::run(vm, input, out);
+    return Response{0, out.str()};
+
+  } catch (arg::argument_error const& e) {
+    return Response{1, e.what()};
+  } catch (std::exception const& e) {
+    return Response{2, e.what()};
+  } catch (...) {
+    return Response{2, "Unknown Error"};
+  }
+} // function handle()
+
+
+
+// **************************************************************************
+// Function serve()
+// **************************************************************************
+
+void serve(std::string const& socket_path, bpo::variables_map const& vm) {
+  int const listen_fd = listen_on(socket_path);
+
+  // Stop on SIGINT and SIGTERM. Without SA_RESTART, poll() returns with EINTR.
+  struct sigaction action{};
+  action.sa_handler = on_stop_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  auto const n_workers = parallel::n_workers(vm["threads"].as<unsigned>(),
+                                             std::numeric_limits<std::size_t>::max());
+  std::cerr << "stride2top server: listening on '" << socket_path << "' with "
+            << n_workers << " workers" << std::endl;
+
+  // The workers keep their arenas (of the structures and of the path search) warm
+  // across the requests.
+  ConnectionQueue queue;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < n_workers; ++i) {
+    workers.emplace_back([&queue, &vm]() {
+      arena::StructureArena memory;
+      for (int fd; (fd = queue.pop()) >= 0;) {
+        serve_connection(fd, vm, memory);
+        queue.done(fd);
+        ::close(fd);
+      }
+    });
+  }
+
+  while (stop_requested == 0) {
+    pollfd pfd{listen_fd, POLLIN, 0};
+    auto const ready = ::poll(&pfd, 1, 500);
+    if (ready <= 0) {
+      continue;
+    }
+    int const fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd >= 0) {
+      queue.push(fd);
+    }
+  }
+
+  ::close(listen_fd);
+  ::unlink(socket_path.c_str());
+  queue.close();
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  std::cerr << "stride2top server: stopped" << std::endl;
+} // function serve()
+
+} // namespace server
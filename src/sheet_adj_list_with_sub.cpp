@@ -45,7 +45,7 @@ bool AdjListWithSub::erase_too_short(SubStrandSet const& short_subs) {
 // ********************************************************************
 
 void AdjListWithSub::ensure_undirected() {
-  std::vector<SubStrandsPairKey> to_add;
+  SubStrandsPairKeyVec to_add;
   for (auto const key : sheets_key_vec.back()) {
     if (data.count(key.reverse()) == 0) {
       to_add.push_back(key);
@@ -65,10 +65,10 @@ void AdjListWithSub::ensure_undirected() {
 // Public Member Function update_key_substr()
 // ********************************************************************
 
-void AdjListWithSub::update_key_substr(std::unordered_map<SubStrand, SubStrand, SubStrandHasher> const& conv) {
+void AdjListWithSub::update_key_substr(arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> const& conv) {
   std::unordered_map<SubStrandsPairKey, SubStrandsPairNode,
                      SubStrandsPairKeyHasher> to_add;
-  std::vector<SubStrandsPairKey> to_remove;
+  SubStrandsPairKeyVec to_remove;
   for (auto const& key_value : data) {
     auto const& ss0 = key_value.first.sub0();
     auto const& ss1 = key_value.first.sub1();
@@ -202,7 +202,7 @@ void AdjListWithSub::gen_adj_sub_vec() {
     SubStrand const ss1{pair.first.str1, pair.first.substr1};
 
     if (adj_sub_vec.count(ss0) == 0) {
-      adj_sub_vec.insert({ss0, std::vector<SubStrandsPairKey>()});
+      adj_sub_vec.insert({ss0, arena::vector<SubStrandsPairKey>()});
     }
     adj_sub_vec[ss0].push_back(pair.first);
   }
@@ -3,9 +3,10 @@
 
 #include <algorithm>
 #include <array>
-#include <deque>
+#include <iterator>
 #include <limits>
 #include <set>
+#include <stdexcept>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -15,6 +16,8 @@
 
 #include <boost/format.hpp>
 
+#include "parallel.h"
+#include "profile.h"
 #include "sheet/adj_list_with_sub.h"
 #include "sheet/common.h"
 #include "sheet/exceptions.h"
@@ -31,7 +34,7 @@ namespace sheet {
 // ********************************************************************
 // Public Member Function add_pair()
 // ********************************************************************
-bool ZoneInfo::add_pair(ZoneResidue const& residue, bool const hbonded,
+bool ZoneInfo::add_pair(DenseIndex const residue, bool const hbonded,
                         BridgeType const b_type) {
   IndexType const index = hbonded ? 1 : 0;
 
@@ -72,24 +75,21 @@ void StrictZone::On(IndexType const sse_id, int const resnum,
                           % +paired_sse_id % +sses.serial_strand_id[paired_sse_id] % paired_resnum).str());
   #endif
 
-  try {
-    On_one(ZoneResidue{sse_id, resnum, sses}, ZoneResidue{paired_sse_id, paired_resnum, sses}, hbonded, bridge_type);
-  } catch (pdb::non_sse_resnum const& e) {
+  auto const residue = ZoneResidue::make(sse_id, resnum, sses);
+  auto const paired = ZoneResidue::make(paired_sse_id, paired_resnum, sses);
+  if (not residue or not paired) {
 
     #if defined(LOGGING) && defined(LOG_SHEET)
-    pdb::log(e.what() + std::string("\nADDING SKIPPED"));
-    #endif
-
-    return ;
-  } catch (zone_info_failure const& e) {
-
-    #if defined(LOGGING) && defined(LOG_SHEET)
-    pdb::log(e.what() + std::string("\nADDING SKIPPED"));
+    pdb::log(zone_info_failure{residue ? paired_sse_id : sse_id,
+                               residue ? paired_resnum : resnum}.what() +
+             std::string("\nADDING SKIPPED"));
     #endif
 
     return ;
   }
 
+  On_one(*residue, *paired, hbonded, bridge_type);
+
 } // public member function On()
 
 
@@ -98,23 +98,75 @@ void StrictZone::On(IndexType const sse_id, int const resnum,
 // ********************************************************************
 // Public Member Function decide_side()
 // ********************************************************************
-AdjListWithSub StrictZone::decide_side(AdjList const& undirected_adj_list) {
+AdjListWithSub StrictZone::decide_side(AdjList const& undirected_adj_list,
+                                       unsigned const n_threads,
+                                       StrictZone const* const previous,
+                                       AdjListWithSubData const* const previous_pairs) {
+  profile::Scope const scope{"decide_side"};
   AdjListWithSub adj_sub;
 
   // get the set of colored ZoneResidues
-  ZoneResidueSet remainder;
-  collect_colored(remainder);
-
-  // Each iteration corresponds to each consistent sheet region.
-  while (remainder.size() != 0) {
-    bfs(adj_sub, remainder, undirected_adj_list);
-
-    #if defined(LOGGING) && defined(LOG_SHEET)
-    sub_strands.print(strand_indices);
-    #endif // ifdef LOGGING
-
+  ZoneResidueSet colored{n_dense()};
+  collect_colored(colored);
+  std::vector<std::size_t> region_of(n_dense());
+  auto const seeds = find_regions(colored, seed_order(colored), region_of);
+
+  // Each region corresponds to each consistent sheet region. A region sees the residues
+  // of the later regions as remaining, so that it warns as if searched after the
+  // earlier regions. A region is in one strand component, so the carried ones need not
+  // be remaining.
+  std::vector<Region> searched(seeds.size());
+  parallel::for_each_task(searched.size(), n_threads, [&](std::size_t const k) {
+    auto & region = searched[k];
+    region.seed = seeds[k];
+    pdb::WarningCapture const capture{region.warnings};
+    try {
+      ZoneResidueSet remainder{n_dense()};
+      for (DenseIndex i = 0; i < n_dense(); ++i) {
+        if (k <= region_of[i] and region_of[i] < searched.size()) {
+          remainder.set(i);
+        }
+      }
+      bfs(region, remainder, seeds[k], undirected_adj_list);
+    } catch (...) {
+      region.error = std::current_exception();
+    }
+  });
+
+  // The regions of the carried strands (with their warnings) are taken from previous,
+  // and put in the order of the seeds with the searched ones.
+  std::vector<Region> carried_regions;
+  if (previous != nullptr) {
+    for (auto const& region : previous->regions) {
+      if (is_carried(strand_of(region.seed))) {
+        carried_regions.push_back(region);
+      }
+    }
+  }
+  regions.clear();
+  regions.reserve(searched.size() + carried_regions.size());
+  std::merge(std::make_move_iterator(searched.begin()),
+             std::make_move_iterator(searched.end()),
+             std::make_move_iterator(carried_regions.begin()),
+             std::make_move_iterator(carried_regions.end()),
+             std::back_inserter(regions),
+             [](Region const& a, Region const& b) { return a.seed < b.seed; });
+
+  // The Sub-Strand IDs are given in the order of the regions.
+  for (auto const& region : regions) {
+    for (auto const& msg : region.warnings) {
+      pdb::warning(msg);
+    }
+    if (region.error) {
+      std::rethrow_exception(region.error);
+    }
+    merge_region(region, adj_sub);
   }
 
+  #if defined(LOGGING) && defined(LOG_SHEET)
+  sub_strands.print(strand_indices);
+  #endif // ifdef LOGGING
+
   // * Remove default_range in the last element of each strand.
   // * Sort SubStrands inside their strand based on the residue numbers.
   // * Update the SubStrand ids in the adjacency map keys.
@@ -128,8 +180,8 @@ AdjListWithSub StrictZone::decide_side(AdjList const& undirected_adj_list) {
   sub_strands.print(strand_indices);
   #endif // ifdef LOGGING
 
-
-  calc_deltas(adj_sub);
+  build_delta_index(n_threads, previous);
+  calc_deltas(adj_sub, n_threads, previous_pairs);
 
 
   #if defined(LOGGING) && defined(LOG_SHEET)
@@ -148,6 +200,23 @@ AdjListWithSub StrictZone::decide_side(AdjList const& undirected_adj_list) {
 
 
 
+// ********************************************************************
+// Public Member Function carry_over()
+// ********************************************************************
+void StrictZone::carry_over(StrictZone const& previous,
+                            arena::vector<bool> const& carried_strands) {
+  assert(previous.strict.size() == strict.size());
+  carried = carried_strands;
+  for (std::size_t str = 0; str < strict.size(); ++str) {
+    if (is_carried(static_cast<IndexType>(str))) {
+      strict[str] = previous.strict[str];
+    }
+  }
+} // public member function carry_over()
+
+
+
+
 // ********************************************************************
 // Public Member Function strict_info()
 // ********************************************************************
@@ -168,6 +237,36 @@ ZoneInfo & StrictZone::strict_info(ZoneResidue const& zone_res) {
 
 
 
+// ********************************************************************
+// Public Member Function strand_of()
+// ********************************************************************
+IndexType StrictZone::strand_of(DenseIndex const i) const {
+  assert(i < n_dense());
+  auto const next = std::upper_bound(dense_offsets.begin(), dense_offsets.end(), i);
+  return static_cast<IndexType>(std::distance(dense_offsets.begin(), next) - 1);
+} // public member function strand_of()
+
+
+
+
+// ********************************************************************
+// Public Member Function residue_of()
+// ********************************************************************
+ZoneResidue StrictZone::residue_of(DenseIndex const i) const {
+  auto const str = strand_of(i);
+
+  ZoneResidue zres;
+  zres.sse_id = strand_indices[str];
+  zres.serial_str_id = str;
+  zres.serial_res_id = i - dense_offsets[str];
+  zres.resnum = sses.data[zres.sse_id].init + static_cast<int>(zres.serial_res_id);
+  zres.has_value = true;
+  return zres;
+} // public member function residue_of()
+
+
+
+
 #if defined(LOGGING) && defined(LOG_SHEET)
 // ********************************************************************
 // Public Member Function PrintZone()
@@ -253,13 +352,15 @@ void StrictZone::PrintList(AdjListWithSub const& adj_list) const {
 void StrictZone::On_one(ZoneResidue const& res0, ZoneResidue const& res1,
                         bool const hbonded, ZoneInfo::BridgeType const bridge_type) {
 
-  if (strict_info(res0).add_pair(res1, hbonded, bridge_type)
+  if (strict_info(res0).add_pair(dense_index(res1), hbonded, bridge_type)
       == false) {
     auto const& zone_info = strict_c_info(res0);
+    auto const adj0 = zone_info.adj_set[0] ? residue_of(zone_info.adj_residues[0]) : ZoneResidue{};
+    auto const adj1 = zone_info.adj_set[1] ? residue_of(zone_info.adj_residues[1]) : ZoneResidue{};
     throw third_pair_found{res0.sse_id, res0.resnum,
                            res1.sse_id, res1.resnum,
-                           zone_info.adj_residues[0].sse_id, zone_info.adj_residues[0].resnum,
-                           zone_info.adj_residues[1].sse_id, zone_info.adj_residues[1].resnum};
+                           adj0.sse_id, adj0.resnum,
+                           adj1.sse_id, adj1.resnum};
   }
 } // protected member function On_one
 
@@ -270,9 +371,9 @@ void StrictZone::On_one(ZoneResidue const& res0, ZoneResidue const& res1,
 // Protected Member Function init_strict()
 // ********************************************************************
 
-std::vector<std::vector<ZoneInfo>> StrictZone::init_strict() const {
+arena::vector<arena::vector<ZoneInfo>> StrictZone::init_strict() const {
 
-  std::vector<std::vector<ZoneInfo>> ret(strand_indices.size());
+  arena::vector<arena::vector<ZoneInfo>> ret(strand_indices.size());
   unsigned serial_counter = 0;
   for (auto const& sse_id : strand_indices) {
     ret[serial_counter].resize(static_cast<unsigned>(sses[sse_id].end - sses[sse_id].init + 1));
@@ -284,44 +385,243 @@ std::vector<std::vector<ZoneInfo>> StrictZone::init_strict() const {
 
 
 
+// ********************************************************************
+// Protected Member Function init_dense_offsets()
+// ********************************************************************
+
+arena::vector<DenseIndex> StrictZone::init_dense_offsets() const {
+  arena::vector<DenseIndex> ret(strict.size() + 1, 0);
+  for (std::size_t str = 0; str < strict.size(); ++str) {
+    ret[str + 1] = ret[str] + static_cast<DenseIndex>(strict[str].size());
+  }
+  return ret;
+} // protected member function init_dense_offsets()
+
+
+
+
 // ********************************************************************
 // Protected Member Function collect_colored()
 // ********************************************************************
 
 void StrictZone::collect_colored(ZoneResidueSet & set) const {
 
-  IndexType serial_str_id = 0;
-  for (auto const& one_sse : strict) {
-    unsigned serial_res_id = 0;
-    for (auto const& zone_info : one_sse) {
+  for (std::size_t str = 0; str < strict.size(); ++str) {
+    if (is_carried(static_cast<IndexType>(str))) {
+      continue;
+    }
+    DenseIndex i = dense_offsets[str];
+    for (auto const& zone_info : strict[str]) {
       if (zone_info.colored) {
-        auto const sse_id = strand_indices[serial_str_id];
-        set.insert(ZoneResidue{sse_id, static_cast<int>(serial_res_id) + sses[sse_id].init, sses});
+        set.set(i);
       }
-      ++serial_res_id;
+      ++i;
     }
-
-    ++serial_str_id;
   }
 } // protected member function collect_colored()
 
 
 
 
+// ********************************************************************
+// Protected Member Function seed_order()
+// ********************************************************************
+std::vector<DenseIndex> StrictZone::seed_order(ZoneResidueSet const& colored) const {
+  std::vector<DenseIndex> order;
+  for (DenseIndex i = 0; i < n_dense(); ++i) {
+    if (colored.test(i)) {
+      order.push_back(i);
+    }
+  }
+  return order;
+} // protected member function seed_order()
+
+
+
+
+// ********************************************************************
+// Protected Member Function find_regions()
+// ********************************************************************
+std::vector<DenseIndex> StrictZone::find_regions(ZoneResidueSet const& colored,
+                                                 std::vector<DenseIndex> const& seeds,
+                                                 std::vector<std::size_t> & region_of) const {
+  std::vector<DenseIndex> region_seeds;
+  std::fill(region_of.begin(), region_of.end(), std::numeric_limits<std::size_t>::max());
+
+  // The residues not in any region yet, as the remainder of bfs().
+  ZoneResidueSet remainder = colored;
+  std::vector<DenseIndex> stack;
+
+  for (auto const seed : seeds) {
+    if (not remainder.test(seed)) {
+      continue;
+    }
+    auto const region = region_seeds.size();
+    region_seeds.push_back(seed);
+
+    remainder.reset(seed);
+    region_of[seed] = region;
+    stack.push_back(seed);
+
+    // The same edges as bfs() follows.
+    while (not stack.empty()) {
+      ZoneResidue const target = residue_of(stack.back());
+      stack.pop_back();
+
+      std::vector<DenseIndex> next;
+      for (IndexType i = 0; i < 2; ++i) {
+        if (strict_c_info(target).adj_set[i]) {
+          next.push_back(strict_c_info(target).adj_residues[i]);
+        }
+      }
+      for (int const diff : {-1, 1}) {
+        auto const ba = ba_check(target, diff, remainder, false);
+        if (ba.has_value and strict_c_info(ba).colored) {
+          next.push_back(dense_index(ba));
+        }
+      }
+
+      for (auto const i : next) {
+        if (remainder.test(i)) {
+          remainder.reset(i);
+          region_of[i] = region;
+          stack.push_back(i);
+        }
+      }
+    }
+  }
+  return region_seeds;
+} // protected member function find_regions()
+
+
+
+
+// ********************************************************************
+// Protected Member Function merge_region()
+// ********************************************************************
+void StrictZone::merge_region(Region const& region, AdjListWithSub & adj_list) {
+  // key : serial strand ID, value : the Sub-Strand of the region on the strand
+  std::unordered_map<IndexType, SubStrand> conv;
+  SubStrandSet too_short_subs;
+  for (auto const& str_range : region.ranges) {
+    auto const added = sub_strands.add_substrand(str_range.first, str_range.second);
+    conv.insert({str_range.first, added.first});
+    if (added.second) {
+      too_short_subs.insert(added.first);
+    }
+  }
+  auto const to_global = [&conv](SubStrand const& sub) { return conv.at(sub.str); };
+
+  adj_list.add_sheet(region.adj_list, to_global);
+
+  // for all adjacent-pairs, delete the strands pair that contains at least 1
+  // too short sub-strands.
+  adj_list.erase_too_short(too_short_subs);
+  if (region.fallback) {
+    adj_list.ensure_undirected();
+  }
+
+  // Push the fallback status into adj_list
+  adj_list.register_sheet_directed(not region.fallback);
+
+  adj_substrands.merge(region.adj_substrands, to_global);
+} // protected member function merge_region()
+
+
+
+
+// ********************************************************************
+// Protected Member Function Region::extend()
+// ********************************************************************
+void StrictZone::Region::extend(ZoneResidue const& res) {
+  auto const inserted = ranges.insert({res.serial_str_id, {{res.resnum, res.resnum}}});
+  auto & range = inserted.first->second;
+  if (res.resnum < range[0]) {
+    range[0] = res.resnum;
+  } else if (range[1] < res.resnum) {
+    range[1] = res.resnum;
+  }
+} // protected member function Region::extend()
+
+
+
+
+// ********************************************************************
+// Protected Member Function build_delta_index()
+// ********************************************************************
+void StrictZone::build_delta_index(unsigned const n_threads,
+                                   StrictZone const* const previous) {
+  colored_prefix.assign(strict.size(), arena::vector<int>{});
+  bridges_to.assign(strict.size(), BridgesMap{});
+
+  parallel::for_each_task(strict.size(), n_threads, [this,
+                                                     previous](std::size_t const str) {
+    // The Sub-Strands of a carried component are the same as in previous.
+    if (previous != nullptr and is_carried(static_cast<IndexType>(str))) {
+      colored_prefix[str] = previous->colored_prefix[str];
+      bridges_to[str] = previous->bridges_to[str];
+      return;
+    }
+
+    auto const& zone = strict[str];
+    auto & prefix = colored_prefix[str];
+
+    prefix.resize(zone.size() + 1, 0);
+    for (std::size_t res = 0; res < zone.size(); ++res) {
+      prefix[res + 1] = prefix[res] + (zone[res].colored ? 1 : 0);
+
+      // Register the partners to every Sub-Strand they belong to.
+      // base_res is increasing, so the vectors are sorted.
+      for (std::size_t i = 0; i < 2; ++i) {
+        if (not zone[res].adj_set[i]) {
+          continue;
+        }
+        auto const partner = residue_of(zone[res].adj_residues[i]);
+        for (auto const& ss : sub_strands.vec(partner.serial_str_id)) {
+          if (sub_strands.n_term_res(ss) <= partner.resnum and
+              partner.resnum <= sub_strands.c_term_res(ss)) {
+            bridges_to[str][ss].push_back(
+                BridgeToSubStrand{static_cast<unsigned>(res), partner});
+          }
+        }
+      }
+    }
+  });
+} // protected member function build_delta_index()
+
+
+
+
 // ********************************************************************
 // Protected Member Function calc_deltas()
 // ********************************************************************
-void StrictZone::calc_deltas(AdjListWithSub & adj_list) const {
+void StrictZone::calc_deltas(AdjListWithSub & adj_list, unsigned const n_threads,
+                             AdjListWithSubData const* const previous_pairs) const {
   // for all pairs of adjacent Sub-Strands
-  for (auto & pair : adj_list.map()) {
-    auto const& pair_key = pair.first;
-    auto const& pair_node = pair.second;
-    bool const dir = pair_node.direction;
+  std::vector<SubStrandsPairKey> keys;
+  keys.reserve(adj_list.map().size());
+  for (auto const& pair : adj_list.map()) {
+    keys.push_back(pair.first);
+  }
 
-    int const delta_1 = count_delta_1(pair_key.sub0(), pair_key.sub1(), dir);
-    int const delta_2 = count_delta_2(pair_key.sub0(), pair_key.sub1(), dir);
+  std::vector<std::array<int, 2>> deltas(keys.size());
+  parallel::for_each_task(keys.size(), n_threads, [&](std::size_t const k) {
+    auto const& pair_key = keys[k];
+    if (previous_pairs != nullptr and is_carried(pair_key.str0)) {
+      auto const found = previous_pairs->find(pair_key);
+      if (found != previous_pairs->end()) {
+        deltas[k] = {{found->second.delta_1, found->second.delta_2}};
+        return;
+      }
+    }
+    bool const dir = adj_list.map(pair_key).direction;
+
+    deltas[k][0] = count_delta_1(pair_key.sub0(), pair_key.sub1(), dir);
+    deltas[k][1] = count_delta_2(pair_key.sub0(), pair_key.sub1(), dir);
+  });
 
-    adj_list.update_delta(pair_key, delta_1, delta_2);
+  for (std::size_t k = 0; k < keys.size(); ++k) {
+    adj_list.update_delta(keys[k], deltas[k][0], deltas[k][1]);
   }
 } // protected member function calc_deltas()
 
@@ -333,32 +633,40 @@ void StrictZone::calc_deltas(AdjListWithSub & adj_list) const {
 // ********************************************************************
 std::tuple<int, ZoneResidue> StrictZone::count_delta_base(ZoneResidue const& zres_base_start, bool const toward_c_term, SubStrand const& ss_adj) const {
 
-  int delta_base = 0;
-  bool go_next = true;
-  // for zres from [res] to [the most C-term residue of adj_ss]
-  // zres : on the base Sub-Strand
-  for (ZoneResidue zres = zres_base_start; go_next;) {
-
-    // for each residue adjacent (counterpart of the bridge) to zres
-    // adj_candidate_res : on Sub-Strand adjacent to the base Sub-Strand
-    for (auto const& adj_candidate_res : strict_c_info(zres).adj_residues) {
-      auto const resnum = adj_candidate_res.resnum;
-
-      // if all the following conditions are true. 2. may not be necessary.
-      // 1. adj_candidate_res belongs to Sub-Strand 'ss'
-      // 2. the residue number of adj_candidate_res is in range of Sub-Strand 'ss'
-      if (adj_candidate_res.serial_str_id == ss_adj.str and
-          sub_strands.n_term_res(ss_adj) <= resnum and
-          resnum <= sub_strands.c_term_res(ss_adj)) {
-        return std::make_tuple(delta_base, adj_candidate_res);
-      }
-    }
+  auto const& str_bridges = bridges_to[zres_base_start.serial_str_id];
+  auto const found = str_bridges.find(ss_adj);
 
-    // Do not count the residues outside of strict hydrogen bonding zone.
-    if (strict_c_info(zres).colored) {
-      ++delta_base;
+  if (found != str_bridges.end()) {
+    auto const& bridges = found->second;
+    auto const start = zres_base_start.serial_res_id;
+    auto const& prefix = colored_prefix[zres_base_start.serial_str_id];
+
+    // The first bridge whose base residue is not less than start.
+    auto const first = std::lower_bound(
+        bridges.begin(), bridges.end(), start,
+        [](BridgeToSubStrand const& b, unsigned const r) { return b.base_res < r; });
+
+    if (toward_c_term) {
+      // count colored residues in [start, base_res)
+      if (first != bridges.end()) {
+        return std::make_tuple(prefix[first->base_res] - prefix[start], first->partner);
+      }
+    } else {
+      // The last bridge whose base residue is not greater than start.
+      // Among the bridges on the same base residue, take the first registered one.
+      auto last = std::upper_bound(
+          bridges.begin(), bridges.end(), start,
+          [](unsigned const r, BridgeToSubStrand const& b) { return r < b.base_res; });
+      if (last != bridges.begin()) {
+        --last;
+        auto const base_res = last->base_res;
+        while (last != bridges.begin() and std::prev(last)->base_res == base_res) {
+          --last;
+        }
+        // count colored residues in (base_res, start]
+        return std::make_tuple(prefix[start + 1] - prefix[base_res + 1], last->partner);
+      }
     }
-    go_next = toward_c_term ? zres.increment(sses) : zres.decrement(sses);
   }
 
   throw PairedResidueNotFound{zres_base_start.sse_id, zres_base_start.resnum,
@@ -376,26 +684,36 @@ int StrictZone::count_delta_adj(ZoneResidue const& start, int const step,
   assert(start.serial_str_id == last.serial_str_id);
   assert(std::abs(step) == 1);
 
-  auto const serial_strand_id_adj = start.serial_str_id;
+  auto const& prefix = colored_prefix.at(start.serial_str_id);
+  auto const s = start.serial_res_id;
+  auto const l = last.serial_res_id;
 
-  int delta = 0;
+  // count colored residues in [start, last) toward C-term, or (last, start] toward N-term
+  if (step == 1 and s <= l) {
+    return prefix.at(l) - prefix[s];
+  }
+  if (step == -1 and l <= s) {
+    return prefix.at(s + 1) - prefix[l + 1];
+  }
 
-  // for ser_res_id in range [start, last]
-  for (int ser_res_id = start.serial_res_id;
-       static_cast<unsigned>(ser_res_id) != last.serial_res_id;
-       ser_res_id += step) {
+  throw std::out_of_range{"count_delta_adj(): the last residue can not be reached."};
+} // protected member function count_delta_adj
 
-    assert(0 <= ser_res_id);
 
-    // if the target residue is inside the strict hydrogen-bonding pattern,
-    // count up the delta.
-    if (strict.at(serial_strand_id_adj).at(ser_res_id).colored) {
-      ++delta;
-    }
-  }
 
-  return delta;
-} // protected member function count_delta_adj
+
+// ********************************************************************
+// Protected Member Function zone_residue_on()
+// ********************************************************************
+ZoneResidue StrictZone::zone_residue_on(IndexType const str, int const resnum) const {
+  ZoneResidue zres;
+  zres.sse_id = strand_indices[str];
+  zres.resnum = resnum;
+  zres.serial_str_id = str;
+  zres.serial_res_id = static_cast<unsigned>(resnum - sses.data[zres.sse_id].init);
+  zres.has_value = true;
+  return zres;
+} // protected member function zone_residue_on()
 
 
 
@@ -409,8 +727,8 @@ int StrictZone::count_delta_1(SubStrand const& ss_base, SubStrand const& ss_adj,
 
   // The most N-term residue (inside the strict hydrogen bonding pattern)
   // of the base Sub-Strand
-  ZoneResidue const zres_term_base{strand_indices[ss_base.str],
-                                   sub_strands.n_term_res(ss_base), sses};
+  ZoneResidue const zres_term_base = zone_residue_on(ss_base.str,
+                                                     sub_strands.n_term_res(ss_base));
 
   // Find the most N-term side (when seen in direction of base Sub-Strand) residue
   // (on the ss_adj) that consists a bridge with a residue on the ss_base.
@@ -422,7 +740,7 @@ int StrictZone::count_delta_1(SubStrand const& ss_base, SubStrand const& ss_adj,
   // The most N-term residue if Parallel, C-term if Anti-Parallel
   auto const term_res_adj = dir ? sub_strands.n_term_res(ss_adj):
                                   sub_strands.c_term_res(ss_adj);
-  ZoneResidue const zres_term_adj{strand_indices[ss_adj.str], term_res_adj, sses};
+  ZoneResidue const zres_term_adj = zone_residue_on(ss_adj.str, term_res_adj);
 
   // Count the number of residues on ss_adj from the common residue to the edge.
   int const delta_adj = count_delta_adj(zres_bridge_adj, dir ? -1 : 1, zres_term_adj);
@@ -443,8 +761,8 @@ int StrictZone::count_delta_2(SubStrand const& ss_base, SubStrand const& ss_adj,
 
   // The most C-term residue (inside the strict hydrogen bonding pattern)
   // of the base Sub-Strand
-  ZoneResidue const zres_term_base{strand_indices[ss_base.str],
-                                   sub_strands.c_term_res(ss_base), sses};
+  ZoneResidue const zres_term_base = zone_residue_on(ss_base.str,
+                                                     sub_strands.c_term_res(ss_base));
 
   // Find the most C-term side (when seen in direction of base Sub-Strand) residue
   // (on the ss_adj) that consists a bridge with a residue on the ss_base.
@@ -456,7 +774,7 @@ int StrictZone::count_delta_2(SubStrand const& ss_base, SubStrand const& ss_adj,
   // residue number of the most N-term residue if Parallel, C-term if Anti-Parallel
   auto const term_res_adj = dir ? sub_strands.c_term_res(ss_adj):
                                   sub_strands.n_term_res(ss_adj);
-  ZoneResidue const zres_term_adj{strand_indices[ss_adj.str], term_res_adj, sses};
+  ZoneResidue const zres_term_adj = zone_residue_on(ss_adj.str, term_res_adj);
 
   // Count the number of residues on ss_adj from the common residue to the edge.
   int const delta_adj = count_delta_adj(zres_bridge_adj, dir ? 1 : -1, zres_term_adj);
@@ -470,8 +788,9 @@ int StrictZone::count_delta_2(SubStrand const& ss_base, SubStrand const& ss_adj,
 // Protected Member Function bfs()
 // ********************************************************************
 
-void StrictZone::bfs(AdjListWithSub & adj_list,
+void StrictZone::bfs(Region & region,
                      ZoneResidueSet & remainder,
+                     DenseIndex const seed_index,
                      AdjList const& undirected_adj_list) {
 
   // Relative Direction Vector
@@ -481,31 +800,36 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
   std::unordered_set<IndexType> involved_serial_str_ids;
 
   // Initialize the queue (Push the first residue)
-  std::deque<ZoneResidue> queue{*(remainder.begin())};
-  ZoneResidueSet queue_contents;
-  queue_contents.insert(queue.front());
+  // Every residue is in the queue at most once at the same time.
+  ResidueQueue queue{n_dense()};
+  ZoneResidueSet queue_contents{n_dense()};
+  queue.push_back(seed_index);
+  queue_contents.set(queue.front());
 
   // Add new sheet in AdjListWithSub
+  auto & adj_list = region.adj_list;
   adj_list.add_sheet();
 
   // whether this is the fallback mode (generate an undirected graph instead of directed)
-  bool fallback = false;
+  bool & fallback = region.fallback;
 
   // define the first residue as 'Upper'
-  strict_info(queue.front()).side = ZoneInfo::SideStatus::Upper;
+  ZoneResidue const seed = residue_of(queue.front());
+  strict_info(seed).side = ZoneInfo::SideStatus::Upper;
 
   // Initialize the direction of the base strand
-  relative_directions[queue.front().serial_str_id] = Parallel;
+  relative_directions[seed.serial_str_id] = Parallel;
 
   // Start Breadth First Search
-  while (queue.size() != 0) {
+  while (not queue.empty()) {
     // target : the first element of the queue
-    auto const& target = queue.front();
+    DenseIndex const target_index = queue.front();
+    ZoneResidue const target = residue_of(target_index);
 
     involved_serial_str_ids.insert(target.serial_str_id);
 
     // extend the sub_strands of this strand
-    sub_strands.extend_substrand(target);
+    region.extend(target);
 
     #if defined(DEBUG) && defined(LOG_SHEET)
     pdb::debug_log("TARGET = SSE[" + std::to_string(target.sse_id) + "], "
@@ -518,19 +842,22 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
     // i == 0 : non-hbonding
     // i == 1 : hbonding
     for (IndexType i = 0; i < 2; ++i) {
-      auto const& adj = strict_c_info(target).adj_residues[i];
+      // skip if not set
+      if (not strict_c_info(target).adj_set[i]) {
+        continue;
+      }
+      DenseIndex const adj_index = strict_c_info(target).adj_residues[i];
+      ZoneResidue const adj = residue_of(adj_index);
 
 
 #if defined(LOGGING) && defined(LOG_SHEET)
-      if (adj.has_value) {
-        pdb::log("  ADJACENT = SSE[" + std::to_string(adj.sse_id) + "], RESNUM = " +
-                 std::to_string(adj.resnum) +
-                 (remainder.count(adj) == 0 ? "  (ALREADY EXAMINED)" : ""));
-      }
+      pdb::log("  ADJACENT = SSE[" + std::to_string(adj.sse_id) + "], RESNUM = " +
+               std::to_string(adj.resnum) +
+               (remainder.test(adj_index) ? "" : "  (ALREADY EXAMINED)"));
 #endif
 
-      // skip if default initialized empty residue, already examined
-      if (adj.has_value == false or remainder.count(adj) == 0) {
+      // skip if already examined
+      if (not remainder.test(adj_index)) {
         continue;
       }
 
@@ -538,7 +865,7 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
       strict_info(adj).side = strict_c_info(target).side;
 
       // extend the sub_strand region of adj
-      sub_strands.extend_substrand(adj);
+      region.extend(adj);
 
       // ********************************
       // Decide the relative directions
@@ -557,8 +884,7 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
       if (fallback) {
         auto const id0 = target.serial_str_id;
         auto const id1 = adj.serial_str_id;
-        auto const key0 = SubStrandsPairKey(id0, sub_strands.last_substr_id(id0),
-                                            id1, sub_strands.last_substr_id(id1));
+        auto const key0 = SubStrandsPairKey(id0, 0, id1, 0);
         auto const key1 = key0.reverse();
 
         add_adj_list_count(key0, adj_list, direction_to_adj);
@@ -572,7 +898,7 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
       }
 
       // Add to AdjacenctSubStrands
-      add_adj_substrands(target, adj, i, direction_to_adj);
+      add_adj_substrands(region.adj_substrands, target, adj, i, direction_to_adj);
 
 
       // push into the search queue if not in the queue
@@ -589,8 +915,8 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
     before_after.reserve(2);
 
     // Add a residue sequentially before and after the target if they're not out of range.
-    before_after.push_back(ba_check(queue.front(), -1, remainder));
-    before_after.push_back(ba_check(queue.front(), 1, remainder));
+    before_after.push_back(ba_check(target, -1, remainder));
+    before_after.push_back(ba_check(target, 1, remainder));
 
     // for Befor and After the target residue
     for (auto const& ba : before_after) {
@@ -614,31 +940,13 @@ void StrictZone::bfs(AdjListWithSub & adj_list,
 
     } // for Befor and After the target residue
 
-    // delete the used target before poping from the queue.
-    // (target is a reference to the first element of queue.)
-    remainder.erase(target);
-    queue_contents.erase(target);
+    // delete the used target
+    remainder.reset(target_index);
+    queue_contents.reset(target_index);
     queue.pop_front();
-  } // while queue.size() != 0
-
-
-  // **************************
-  // Clean Up: Sub-Strands
-  // **************************
+  } // while queue is not empty
 
-  // Store the sub-strands whose length is too short.
-  SubStrandSet const too_short_subs = sub_strands.cleanup_sheet();
-
-  // for all adjacent-pairs, delete the strands pair that contains at least 1
-  // too short sub-strands.
-  adj_list.erase_too_short(too_short_subs);
-  if (fallback) {
-    adj_list.ensure_undirected();
-  }
-
-
-  // Push the fallback status into adj_list
-  adj_list.register_sheet_directed(not fallback);
+  // The too short Sub-Strands are removed by merge_region().
 
 } // protected member function bfs()
 
@@ -785,15 +1093,9 @@ SubStrandsPairKey StrictZone::gen_list_key(ZoneResidue const& res0,
 
   // if res1 is on the right of res0
   if (rel_dir[res0.serial_str_id] == (side == hbonded)) {
-    return SubStrandsPairKey(res0.serial_str_id,
-                             sub_strands.last_substr_id(res0.serial_str_id),
-                             res1.serial_str_id,
-                             sub_strands.last_substr_id(res1.serial_str_id));
+    return SubStrandsPairKey(res0.serial_str_id, 0, res1.serial_str_id, 0);
   } else {
-    return SubStrandsPairKey(res1.serial_str_id,
-                             sub_strands.last_substr_id(res1.serial_str_id),
-                             res0.serial_str_id,
-                             sub_strands.last_substr_id(res0.serial_str_id));
+    return SubStrandsPairKey(res1.serial_str_id, 0, res0.serial_str_id, 0);
   }
 } // protected member function gen_list_key()
 
@@ -803,8 +1105,9 @@ SubStrandsPairKey StrictZone::gen_list_key(ZoneResidue const& res0,
 // Protected Member Function add_adj_substrands()
 // ********************************************************************
 
-void StrictZone::add_adj_substrands(ZoneResidue const& res0, ZoneResidue const& res1,
-                                    bool const hbonded, bool const rel_dir) {
+void StrictZone::add_adj_substrands(AdjacentSubStrands & region_substrands,
+                                    ZoneResidue const& res0, ZoneResidue const& res1,
+                                    bool const hbonded, bool const rel_dir) const {
 
   auto const str0 = res0.serial_str_id;
   auto const str1 = res1.serial_str_id;
@@ -812,16 +1115,14 @@ void StrictZone::add_adj_substrands(ZoneResidue const& res0, ZoneResidue const&
   // true   if (Upper and HBonded) or (Lower and Non-HBonded)
   // false  if (Upper and Non-HBonded) or (Lower and HBonded)
   bool const right = strict_c_info(res0).side == hbonded;
-  adj_substrands.add(SubStrand{str0, sub_strands.last_substr_id(str0)},
-                     SubStrand{str1, sub_strands.last_substr_id(str1)},
-                     right, rel_dir);
+  region_substrands.add(SubStrand{str0, 0}, SubStrand{str1, 0}, right, rel_dir);
 
   #if defined(DEBUG) && defined(LOG_SHEET)
   auto const str_ind = sses.gen_index_vec('E');
   pdb::debug_log("SubStrand Add: " +
-                 SubStrand{str1, sub_strands.last_substr_id(str1)}.string(str_ind) +
+                 SubStrand{str1, 0}.string(str_ind) +
                  " is on " + (right ? "right" : "left") + " of " +
-                 SubStrand{str0, sub_strands.last_substr_id(str0)}.string(str_ind) +
+                 SubStrand{str0, 0}.string(str_ind) +
                  " : " + (rel_dir ? "Parallel" : "Anti-Parallel")
                  );
   #endif
@@ -835,13 +1136,14 @@ void StrictZone::add_adj_substrands(ZoneResidue const& res0, ZoneResidue const&
 // Protected Member Function push_into_queue()
 // ********************************************************************
 
-void StrictZone::push_into_queue(std::deque<ZoneResidue>& queue,
+void StrictZone::push_into_queue(ResidueQueue & queue,
                                  ZoneResidueSet & contents,
                                  ZoneResidue const& new_res) const {
 
-  if (contents.count(new_res) == 0) {
-    queue.push_back(new_res);
-    contents.insert(new_res);
+  auto const i = dense_index(new_res);
+  if (not contents.test(i)) {
+    queue.push_back(i);
+    contents.set(i);
 
 #if defined(LOGGING) && defined(LOG_SHEET)
     pdb::log("  ADD QUEUE: SSE[" + std::to_string(new_res.sse_id) + "], RESNUM = " +
@@ -859,7 +1161,7 @@ void StrictZone::push_into_queue(std::deque<ZoneResidue>& queue,
 // ********************************************************************
 
 ZoneResidue StrictZone::ba_check(ZoneResidue const& target, int const diff,
-                                 ZoneResidueSet const& remainder) const {
+                                 ZoneResidueSet const& remainder, bool const warn) const {
 
   // Empty ZoneResidue to be returned on failure.
   ZoneResidue const empty{};
@@ -878,10 +1180,10 @@ ZoneResidue StrictZone::ba_check(ZoneResidue const& target, int const diff,
     return empty;
   }
 
-  ZoneResidue const ba{target.sse_id, target.resnum + diff, sses};
+  auto const ba_index = static_cast<DenseIndex>(static_cast<int>(dense_index(target)) + diff);
 
   // if already examined
-  if (remainder.count(ba) == 0) {
+  if (not remainder.test(ba_index)) {
 
 #if defined(LOGGING) && defined(LOG_SHEET)
     pdb::log((boost::format("NOT IN REMAINDER: SSE[%d] RESNUM = %d")
@@ -892,6 +1194,7 @@ ZoneResidue StrictZone::ba_check(ZoneResidue const& target, int const diff,
     return empty;
   }
 
+  ZoneResidue const ba = residue_of(ba_index);
   auto const& info_t = strict_c_info(target);
   auto const& info_ba = strict_c_info(ba);
 
@@ -900,20 +1203,22 @@ ZoneResidue StrictZone::ba_check(ZoneResidue const& target, int const diff,
     if (not info_t.adj_set[i_t_adj]) {
       continue;
     }
-    auto const adj_sse_id = info_t.adj_residues[i_t_adj].sse_id;
+    auto const adj_str_id = strand_of(info_t.adj_residues[i_t_adj]);
     for (unsigned char i_ba_adj = 0; i_ba_adj < 2; ++i_ba_adj) {
       if (not info_ba.adj_set[i_ba_adj]) {
         continue;
       }
 
       // if the adjacent sses are identical and the type of bridge is the same.
-      if (info_ba.adj_residues[i_ba_adj].sse_id == adj_sse_id and
+      if (strand_of(info_ba.adj_residues[i_ba_adj]) == adj_str_id and
           info_t.bridge_type[i_t_adj] == info_ba.bridge_type[i_ba_adj]) {
 
+        if (warn) {
           pdb::warning((boost::format("IGNORING CONTINUOUS BRIDGES OF THE SAME TYPE: "
                                       "BETWEEN TARGET RESIDUE and SSE[%d], RESNUM = %d")
                                       % +ba.sse_id
                                       % ba.resnum).str());
+        }
         return empty;
       }
     }
@@ -1,12 +1,23 @@
 // Distributed under the MIT License.
 // See LICENSE.txt for details.
 
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "parallel.h"
+#include "profile.h"
 #include "pdb/tools.h"
 #include "pdb/exceptions.h"
 
 #include "sheet/adj_list_with_sub.h"
 #include "sheet/cb_side.h"
 #include "sheet/directed_adjacency_list.h"
+#include "sheet/residue_strand_map.h"
 #include "sheet/exceptions.h"
 
 
@@ -89,8 +100,18 @@ StrandsPairAttribute DirectedAdjacencyList::search(SubStrand const& ss0,
 StrandsPairAttribute DirectedAdjacencyList::search(SubStrand const& ss0,
                                                    SubStrand const& ss1,
                                                    AdjSubVec const& adj_sub_vec) const {
+  profile::count(profile::Counter::BfsInvocations);
   StrandsPairAttribute ret{ss0, ss1};
-  auto const parents = search_bfs(ss0, ss1, adj_sub_vec);
+
+  // search() is called for every pair of Sub-Strands, so the temporaries of the BFS
+  // are taken from an arena of each thread. The arena keeps its memory across the
+  // searches (and across the requests in the server mode), so a warm thread does not
+  // allocate at all.
+  thread_local arena::MonotonicArena pool;
+  pool.reset();
+  PathParents parents{0, SubStrandHasher{}, std::equal_to<SubStrand>{},
+                      PathParents::allocator_type{pool}};
+  search_bfs(ss0, ss1, adj_sub_vec, pool, parents);
 
   // if not reachable
   if (parents.size() == 0) {
@@ -164,7 +185,14 @@ void DirectedAdjacencyList::print_list(AdjList const& adj_list_, std::string con
 // Protected Member Function init_list()
 // *************************************************************************************
 
-AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs) {
+AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs,
+                                                BridgeEngine const engine,
+                                                unsigned const n_threads,
+                                                DirectedAdjacencyList const* const previous) {
+  profile::Scope const scope{"init_list"};
+
+  // The serial strand IDs are those of previous only if the strands are the same.
+  bool const incremental = previous != nullptr and same_strands(sses, previous->sses);
 
   // Initialize Undirected Adjacency List
 
@@ -172,14 +200,26 @@ AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs) {
   pdb::log("INITIALIZING: Undirected Adjacency List");
   #endif
 
-  std::unordered_map<IndexType, std::unordered_set<IndexType>> undirected_adj_index_map;
-
-  AdjList undirected_adj_list;
+  // changed[serial_strand_id] : Whether the hbonds of the strand differ from previous.
+  arena::vector<bool> changed(strand_indices.size(), true);
 
   IndexType sse_serial_id = 0;
   for (auto const target_sse_id : strand_indices) {
     auto const& involved_pairs = pairs.involved_pairs.at(sse_serial_id);
 
+    // The adjacent strands of a strand depend only on its own hbonds.
+    if (incremental and involved_pairs == previous->pairs.involved_pairs.at(sse_serial_id)) {
+      changed[sse_serial_id] = false;
+      auto const& adj_index_set = previous->undirected_adj_index_map.at(target_sse_id);
+      for (auto const i : adj_index_set) {
+        auto const key = std::make_pair(target_sse_id, i);
+        undirected_adj_list.insert({key, previous->undirected_adj_list.at(key)});
+      }
+      undirected_adj_index_map.insert({target_sse_id, adj_index_set});
+      ++sse_serial_id;
+      continue;
+    }
+
     // Add undirectred adjacency list
     auto const adj_index_set = add_undirected_adj_list(undirected_adj_list, involved_pairs,
                                                        sses[target_sse_id]);
@@ -206,13 +246,39 @@ AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs) {
   pdb::log("INITIALIZING: Directed Adjacency List");
   #endif
 
-  // indices of strands
-  auto strands = strand_indices;
+  // Decide the strict zone
+  profile::Scope const zone_scope{"StrictZone"};
+  std::unique_ptr<ResidueStrandMap const> strand_map;
+  if (engine == BridgeEngine::StrandTable and pairs.dnr.size() != 0) {
+    // all the residues an hbond can be paired with
+    int first = pairs.dnr.front()[0];
+    int last = first;
+    for (auto const& pair : pairs.dnr) {
+      first = std::min({first, pair[0], pair[1]});
+      last = std::max({last, pair[0], pair[1]});
+    }
+    strand_map.reset(new ResidueStrandMap{sses, first, last});
+  }
 
+  // The strand components with no changed strand are carried over from previous.
+  // gen_strict_zone() marks the residues of one component only, from its first strand.
+  arena::vector<bool> carried;
+  if (incremental) {
+    carried = carried_strands(changed);
+    strict_zone.carry_over(previous->strict_zone, carried);
+  }
+
+  // indices of strands
+  std::vector<IndexType> strands;
+  for (auto const sse_id : strand_indices) {
+    if (carried.empty() or not carried[sses.serial_strand_id[sse_id]]) {
+      strands.push_back(sse_id);
+    }
+  }
 
-  // Decide the strict zone
   while (strands.size() != 0) {
-    gen_strict_zone(undirected_adj_list, pairs, strands, undirected_adj_index_map);
+    gen_strict_zone(undirected_adj_list, pairs, strands, undirected_adj_index_map,
+                    strand_map.get());
   }
 
 
@@ -223,8 +289,116 @@ AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs) {
 
   // Determine the side of CB atom for all defined residues
   // and generates a directed adjacency list with Sub-Strands
-  return strict_zone.decide_side(undirected_adj_list);
-}
+  if (incremental) {
+    return strict_zone.decide_side(undirected_adj_list, n_threads, &previous->strict_zone,
+                                   &previous->adj_list_with_sub.map());
+  }
+  return strict_zone.decide_side(undirected_adj_list, n_threads);
+} // protected member function init_list()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function carried_strands()
+// *************************************************************************************
+
+arena::vector<bool> DirectedAdjacencyList::carried_strands(
+    arena::vector<bool> const& changed) const {
+  arena::vector<bool> carried(strand_indices.size(), false);
+  arena::vector<bool> visited(strand_indices.size(), false);
+
+  for (std::size_t first = 0; first < strand_indices.size(); ++first) {
+    if (visited[first]) {
+      continue;
+    }
+
+    // The serial strand IDs of the component of the first strand
+    std::vector<IndexType> component{static_cast<IndexType>(first)};
+    visited[first] = true;
+    bool unchanged = true;
+    for (std::size_t k = 0; k < component.size(); ++k) {
+      auto const str = component[k];
+      unchanged = unchanged and not changed[str];
+      for (auto const adj : undirected_adj_index_map.at(strand_indices[str])) {
+        auto const adj_str = sses.serial_strand_id[adj];
+        if (not visited[adj_str]) {
+          visited[adj_str] = true;
+          component.push_back(adj_str);
+        }
+      }
+    }
+
+    if (not unchanged) {
+      continue;
+    }
+    if (component.size() != 1) {
+      profile::count(profile::Counter::ComponentsReused);
+    }
+    for (auto const str : component) {
+      carried[str] = true;
+    }
+  }
+  return carried;
+} // protected member function carried_strands()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function read_pairs()
+// *************************************************************************************
+
+Pairs DirectedAdjacencyList::read_pairs(pdb::SSES const& sses_, pdb::stride_stream & stride) {
+  profile::Scope const scope{"Pairs"};
+  return Pairs{sses_, stride};
+} // protected member function read_pairs()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function read_pairs()
+// *************************************************************************************
+
+Pairs DirectedAdjacencyList::read_pairs(pdb::SSES const& sses_, Pairs::PairsVec const& dnr) {
+  profile::Scope const scope{"Pairs"};
+  return Pairs{sses_, dnr};
+} // protected member function read_pairs()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function read_pairs()
+// *************************************************************************************
+
+Pairs DirectedAdjacencyList::read_pairs(pdb::SSES const& sses_,
+                                        DirectedAdjacencyList const& previous,
+                                        Pairs::Delta const& delta) {
+  profile::Scope const scope{"Pairs"};
+  if (same_strands(sses_, previous.sses)) {
+    return Pairs{sses_, previous.pairs, delta};
+  }
+  return Pairs{sses_, Pairs::apply(previous.pairs.dnr, delta)};
+} // protected member function read_pairs()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function same_strands()
+// *************************************************************************************
+
+bool DirectedAdjacencyList::same_strands(pdb::SSES const& sses_, pdb::SSES const& other) {
+  auto const& indices = sses_.gen_index_vec('E', true);
+  if (sses_.size != other.size or indices != other.gen_index_vec('E', true)) {
+    return false;
+  }
+  return std::all_of(indices.cbegin(), indices.cend(), [&sses_, &other](auto const i) {
+    return sses_[i].init == other[i].init and sses_[i].end == other[i].end;
+  });
+} // protected member function same_strands()
 
 
 
@@ -234,7 +408,7 @@ AdjListWithSub DirectedAdjacencyList::init_list(Pairs const& pairs) {
 // *************************************************************************************
 
 /// create a undirected adjacency list
-std::unordered_set<IndexType> DirectedAdjacencyList::add_undirected_adj_list(AdjList & undirected_adj_list, Pairs::PairsVec const& involved_pairs, pdb::SSE const& e) const {
+arena::unordered_set<IndexType> DirectedAdjacencyList::add_undirected_adj_list(AdjList & undirected_adj_list, Pairs::PairsVec const& involved_pairs, pdb::SSE const& e) const {
 
   #if defined(DEBUG) && defined(LOG_SHEET)
   pdb::debug_log("TARGET: SSE[" + std::to_string(e.index) + "]");
@@ -263,12 +437,10 @@ std::unordered_set<IndexType> DirectedAdjacencyList::add_undirected_adj_list(Adj
     #endif
 
     // get the SSE_ID of the paired residue (condition: this SSE is a strand)
-    IndexType sse_id;
-    try {
-      sse_id = sses.sse_ind_of(pair[1], 'E', 1, true, pair[2] == 0 ? 'C' : 'N');
+    auto const found = sses.find_sse_ind(pair[1], 'E', 1, true, pair[2] == 0 ? 'C' : 'N');
 
     // if not found (loop residue)
-    } catch (pdb::non_sse_resnum) {
+    if (not found) {
 
       #if defined(DEBUG) && defined(LOG_SHEET)
       pdb::debug_log(" : NON_SSE_RESNUM " + std::to_string(pair[1]) + "\n");
@@ -276,6 +448,7 @@ std::unordered_set<IndexType> DirectedAdjacencyList::add_undirected_adj_list(Adj
 
       continue;
     }
+    IndexType const sse_id = *found;
 
     // if the target is a HELIX
     if (sses[sse_id].type == 'H') {
@@ -402,17 +575,14 @@ std::unordered_set<IndexType> DirectedAdjacencyList::add_undirected_adj_list(Adj
 // *************************************************************************************
 
 /// generate a vector of sse_ids adjacent to a target SSE
-std::unordered_set<IndexType> DirectedAdjacencyList::adj_id_set(Pairs::PairsVec const& involved_pairs) const {
-  std::unordered_set<IndexType> ret;
+arena::unordered_set<IndexType> DirectedAdjacencyList::adj_id_set(Pairs::PairsVec const& involved_pairs) const {
+  arena::unordered_set<IndexType> ret;
   for (auto const& pair : involved_pairs) {
-    try {
-      // search the sse_id of pair[1] for strands
-      // (if Helix, pdb::non_sse_resnum will be thrown.)
-      auto const sse_id = sses.sse_ind_of(pair[1], 'E', 1, true, pair[2] == 0 ? 'C' : 'N');
-
-      ret.insert(sse_id);
-    } catch (pdb::non_sse_resnum) {
-      continue;
+    // search the sse_id of pair[1] for strands
+    // (if Helix, boost::none will be returned.)
+    auto const sse_id = sses.find_sse_ind(pair[1], 'E', 1, true, pair[2] == 0 ? 'C' : 'N');
+    if (sse_id) {
+      ret.insert(*sse_id);
     }
   }
   return ret;
@@ -501,9 +671,10 @@ void DirectedAdjacencyList::undirected_adj_symmetry_check(AdjList const& undirec
 
 void DirectedAdjacencyList::gen_strict_zone(AdjList const& undirected_adj_list,
                                             Pairs const& pairs, std::vector<IndexType>& strands,
-                                            std::unordered_map<IndexType, std::unordered_set<IndexType>> const& adj_index_map) {
+                                            arena::unordered_map<IndexType, arena::unordered_set<IndexType>> const& adj_index_map,
+                                            ResidueStrandMap const* const strand_map) {
 
-  std::unordered_set<IndexType> finished;
+  arena::unordered_set<IndexType> finished;
   std::deque<IndexType> queue;
   queue.push_back(strands.front());
 
@@ -531,22 +702,29 @@ void DirectedAdjacencyList::gen_strict_zone(AdjList const& undirected_adj_list,
       queue.push_back(i);
     }
 
-    for (auto const& hbond : pairs.resort_involved_pairs(sses.serial_strand_id[target_str],
-                                                         undirected_adj_list, sses)) {
+    auto const serial_str_id = sses.serial_strand_id[target_str];
+    auto const hbonds = strand_map ?
+        pairs.resort_involved_pairs(serial_str_id, undirected_adj_list, sses, *strand_map) :
+        pairs.resort_involved_pairs(serial_str_id, undirected_adj_list, sses);
+    profile::count(profile::Counter::HbondsProcessed, hbonds.size());
+
+    for (auto const& hbond : hbonds) {
 
       #if defined(LOGGING) && defined(LOG_SHEET)
       pdb::log((boost::format("GEN_STRICT_ZONE: PROCESSING %3d %3d : %d") % hbond[0] % hbond[1] % hbond[2] ).str());
       #endif
 
       // get the SSE_ID of the paired residue
-      IndexType adj_str;
-      try {
-        adj_str = sses.sse_ind_of(hbond[1], 'E', 1, true, hbond[2] == 0 ? 'C' : 'N');
+      char const hbond_atom = hbond[2] == 0 ? 'C' : 'N';
+      auto const found = strand_map ? (*strand_map)(hbond[1], hbond_atom) :
+                                      sses.find_sse_ind(hbond[1], 'E', 1, true, hbond_atom)
+                                          .value_or(ResidueStrandMap::none);
 
       // if not found (loop residue)
-      } catch (pdb::non_sse_resnum) {
+      if (found == ResidueStrandMap::none) {
         continue;
       }
+      IndexType const adj_str = found;
 
       // if the adj_str is unpaired or not strand
       if (adj_index_map.at(target_str).count(adj_str) == 0) {
@@ -605,6 +783,7 @@ void DirectedAdjacencyList::gen_strict_zone(AdjList const& undirected_adj_list,
 
 
 
+
 // *************************************************************************************
 // Protected Member Function translate_sub()
 // *************************************************************************************
@@ -646,7 +825,7 @@ DirectedAdjacencyList::AdjIndList DirectedAdjacencyList::init_adj_index_list() c
 
   for (auto const& strand_pair : adj_list) {
     if (ind_list.count(strand_pair.first.first) == 0) {
-      ind_list.insert({strand_pair.first.first, std::vector<IndexType>()});
+      ind_list.insert({strand_pair.first.first, arena::vector<IndexType>()});
     }
     ind_list[strand_pair.first.first].push_back(strand_pair.first.second);
   }
@@ -659,13 +838,19 @@ DirectedAdjacencyList::AdjIndList DirectedAdjacencyList::init_adj_index_list() c
 // *************************************************************************************
 // Protected Member Function init_sheets()
 // *************************************************************************************
-Sheets DirectedAdjacencyList::init_sheets() {
+Sheets DirectedAdjacencyList::init_sheets(unsigned const n_threads,
+                                          DirectedAdjacencyList const* const previous) {
+  profile::Scope const scope{"init_sheets"};
   Sheets tmp_sheets{};
 
+  // Sheets::add() merges the sheets in the order of the pairs, so only the search
+  // runs in parallel.
+  auto const attrs = search_all(n_threads, previous);
+  auto attr_iter = attrs.cbegin();
   for (auto const sub0 : sub_strands_range.vec()) {
     for (auto const sub1 : sub_strands_range.vec()) {
       SubStrandsPairKey const key{sub0, sub1};
-      auto const attr = search(sub0, sub1);
+      auto const& attr = *attr_iter++;
       if (attr.reachable) {
         tmp_sheets.add(key, attr);
       }
@@ -673,7 +858,8 @@ Sheets DirectedAdjacencyList::init_sheets() {
   }
 
   /// Initialize cycles inside sheets
-  tmp_sheets.cycle_check(adj_list_with_sub.map());
+  tmp_sheets.cycle_check(adj_list_with_sub.map(), n_threads,
+                         previous ? &previous->sheets : nullptr);
 
   // Fix undirected paths that is out of cycles. (Such as d3vlaa_)
   adj_substrands.fix_undirected_paths(adj_list_with_sub, tmp_sheets);
@@ -691,14 +877,17 @@ Sheets DirectedAdjacencyList::init_sheets() {
 // Protected Member Function init_adj_attr()
 // *************************************************************************************
 
-DirectedAdjacencyList::AdjAttrMap DirectedAdjacencyList::init_adj_attr() const {
+DirectedAdjacencyList::AdjAttrMap DirectedAdjacencyList::init_adj_attr(
+    unsigned const n_threads, DirectedAdjacencyList const* const previous) const {
+  profile::Scope const scope{"init_adj_attr"};
   AdjAttrMap map;
 
+  auto const attrs = search_all(n_threads, previous);
+  auto attr_iter = attrs.cbegin();
   for (auto const sub0 : sub_strands_range.vec()) {
     for (auto const sub1 : sub_strands_range.vec()) {
       SubStrandsPairKey const key{sub0, sub1};
-      auto const attr = search(sub0, sub1);
-      map.insert({key, attr});
+      map.insert({key, *attr_iter++});
     }
   }
 
@@ -707,6 +896,97 @@ DirectedAdjacencyList::AdjAttrMap DirectedAdjacencyList::init_adj_attr() const {
 
 
 
+
+// *************************************************************************************
+// Protected Member Function search_all()
+// *************************************************************************************
+
+std::vector<StrandsPairAttribute> DirectedAdjacencyList::search_all(
+    unsigned const n_threads, DirectedAdjacencyList const* const previous) const {
+  auto const& substrs = sub_strands_range.vec();
+  auto const n = substrs.size();
+
+  std::vector<StrandsPairAttribute> attrs;
+  attrs.reserve(n * n);
+  for (auto const& sub0 : substrs) {
+    for (auto const& sub1 : substrs) {
+      attrs.emplace_back(sub0, sub1);
+    }
+  }
+
+  // One task for each row (the first Sub-Strand).
+  parallel::for_each_task(n, n_threads, [this, &substrs, &attrs, n,
+                                         previous](std::size_t const i) {
+    // The row of the previous frame, if the paths from substrs[i] are unchanged.
+    bool const reuse = previous != nullptr and same_paths(substrs[i], *previous);
+    if (reuse) {
+      profile::count(profile::Counter::BfsRowsReused);
+    }
+
+    for (std::size_t j = 0; j < n; ++j) {
+      if (reuse) {
+        auto const found = previous->adj_attr.find(SubStrandsPairKey{substrs[i], substrs[j]});
+        if (found != previous->adj_attr.end()) {
+          attrs[i * n + j] = found->second;
+          continue;
+        }
+      }
+      attrs[i * n + j] = search(substrs[i], substrs[j]);
+    }
+  });
+
+  return attrs;
+} // protected member function search_all()
+
+
+
+
+// *************************************************************************************
+// Protected Member Function same_paths()
+// *************************************************************************************
+
+bool DirectedAdjacencyList::same_paths(SubStrand const& first,
+                                       DirectedAdjacencyList const& previous) const {
+  auto const& adj_sub_vec = adj_list_with_sub.adj_substr_vec();
+  auto const& prev_adj_sub_vec = previous.adj_list_with_sub.adj_substr_vec();
+  auto const& prev_map = previous.adj_list_with_sub.map();
+
+  // search_bfs() visits the adjacent Sub-Strands in the order of adj_sub_vec, and
+  // search_backtrace() reads the directions, so both must be the same.
+  SubStrandSet examined{first};
+  std::vector<SubStrand> stack{first};
+  while (not stack.empty()) {
+    auto const node = stack.back();
+    stack.pop_back();
+
+    auto const found = adj_sub_vec.find(node);
+    auto const prev_found = prev_adj_sub_vec.find(node);
+    if (found == adj_sub_vec.end() or prev_found == prev_adj_sub_vec.end()) {
+      if (found != adj_sub_vec.end() or prev_found != prev_adj_sub_vec.end()) {
+        return false;
+      }
+      continue;
+    }
+    if (found->second != prev_found->second) {
+      return false;
+    }
+
+    for (auto const& key : found->second) {
+      auto const prev_data = prev_map.find(key);
+      if (prev_data == prev_map.end() or
+          prev_data->second.direction != adj_list_with_sub.map(key).direction) {
+        return false;
+      }
+      if (examined.insert(key.sub1()).second) {
+        stack.push_back(key.sub1());
+      }
+    }
+  }
+  return true;
+} // protected member function same_paths()
+
+
+
 // *************************************************************************************
 // Protected Member Function search_backtrace()
 // *************************************************************************************
@@ -738,10 +1018,15 @@ void DirectedAdjacencyList::search_backtrace(StrandsPairAttribute & attr,
 // Protected Member Function search_bfs()
 // *************************************************************************************
 
-DirectedAdjacencyList::PathParents DirectedAdjacencyList::search_bfs(SubStrand const& first, SubStrand const& last, AdjSubVec const& adj_sub_vec) const {
-  PathParents parents;
-  SubStrandSet examined;
-  std::deque<SubStrand> queue;
+void DirectedAdjacencyList::search_bfs(SubStrand const& first, SubStrand const& last,
+                                       AdjSubVec const& adj_sub_vec,
+                                       arena::MonotonicArena & pool,
+                                       PathParents & parents) const {
+  std::unordered_set<SubStrand, SubStrandHasher, std::equal_to<SubStrand>,
+                     arena::Allocator<SubStrand>> examined{
+                       0, SubStrandHasher{}, std::equal_to<SubStrand>{},
+                       arena::Allocator<SubStrand>{pool}};
+  std::deque<SubStrand, arena::Allocator<SubStrand>> queue{arena::Allocator<SubStrand>{pool}};
   queue.push_back(first);
 
   while (queue.size() != 0) {
@@ -751,7 +1036,7 @@ DirectedAdjacencyList::PathParents DirectedAdjacencyList::search_bfs(SubStrand c
 
     // if found
     if (node == last) {
-      return parents;
+      return;
     }
 
     // continue if no adjacent strand
@@ -770,7 +1055,7 @@ DirectedAdjacencyList::PathParents DirectedAdjacencyList::search_bfs(SubStrand c
       parents.insert({adj, node});
     }
   }
-  return PathParents();
+  parents.clear();
 } // protected member function search_bfs()
 
 
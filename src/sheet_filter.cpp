@@ -4,6 +4,7 @@
 #include <tuple>
 #include <vector>
 
+#include "profile.h"
 #include "sheet/directed_adjacency_list.h"
 #include "sheet/filter.h"
 #include "sheet/sub_strands_range.h"
@@ -74,6 +75,7 @@ bool SheetFilterBase::operator()(SeqIter const first,
 
   // if at least one of the 2 strand doesn't have sufficient hbonds and erased
   } catch (SubStrandErased const& e) {
+    profile::count(profile::Counter::Exceptions);
     return false;
   }
 
@@ -9,14 +9,63 @@
 #include <string>
 #include <vector>
 
+#include "pdb/residue.h"
 #include "pdb/sses.h"
 #include "pdb/tools.h"
 #include "sheet/common.h"
 #include "sheet/pairs.h"
 #include "sheet/exceptions.h"
+#include "sheet/residue_strand_map.h"
 
 namespace sheet {
 
+namespace {
+
+/// @brief  The body of Pairs::resort_involved_pairs(). Both the overloads must give the
+///         same order, because the bridges depend on the order of the hbonds.
+/// @param  sse_id     The SSE ID the direction of a strand pair is looked up with.
+/// @param  strand_of  (resnum, hbond_atom) -> boost::optional<IndexType>. The strand of
+///                    a paired residue like SSES::find_sse_ind(resnum, 'E', 1, true, ..).
+template <class StrandOf>
+Pairs::PairsVec resort(Pairs::PairsVec ret, IndexType const sse_id, AdjList const& adj_list,
+                       StrandOf const& strand_of) {
+  std::sort(ret.begin(), ret.end(), [sse_id, &adj_list, &strand_of](auto const& a, auto const& b) {
+    if (a[0] < b[0]) { return true; }
+    if (a[0] == b[0]) {
+      auto const sse_id_a = strand_of(a[1], a[2] == 0 ? 'C' : 'N');
+      auto const sse_id_b = strand_of(b[1], b[2] == 0 ? 'C' : 'N');
+
+      // if either of them is a loop residue
+      if (not sse_id_a or not sse_id_b) {
+        return false;
+      }
+
+      if (*sse_id_a == *sse_id_b) {
+        if (adj_list.count({sse_id, *sse_id_a}) == 0) {
+          return false;
+        }
+        bool const dir = adj_list.at({sse_id, *sse_id_a}).direction;
+        // if parallel
+        if (dir) {
+          if (a[1] < b[1]) { return true; }
+
+        // if anti-parallel
+        } else {
+          if (b[1] < a[1]) { return true; }
+        }
+        if (a[1] == b[1]) {
+          return a[2] < b[2];
+        }
+      }
+    }
+    return false;
+  });
+
+  return ret;
+}
+
+} // namespace
+
 // **************************************************************************************
 // Public Member function Pairs::resort_involved_pairs()
 // **************************************************************************************
@@ -24,51 +73,62 @@ namespace sheet {
 
 Pairs::PairsVec Pairs::resort_involved_pairs(IndexType const serial_str_id,
                                              AdjList const& adj_list, pdb::SSES const& sses) const {
-  PairsVec ret = involved_pairs[serial_str_id];
+  return resort(involved_pairs[serial_str_id], sses.gen_index_vec('E', true)[serial_str_id],
+                adj_list, [&sses](int const resnum, char const hbond_atom) {
+    return sses.find_sse_ind(resnum, 'E', 1, true, hbond_atom);
+  });
+} // public member function resort_involved_pairs()
 
-  auto const sse_id = sses.gen_index_vec('E', true)[serial_str_id];
 
-  std::sort(ret.begin(), ret.end(), [sse_id, &adj_list, &sses](auto const& a, auto const& b) {
-    if (a[0] < b[0]) { return true; }
-    if (a[0] == b[0]) {
-      try {
-        auto const sse_id_a = sses.sse_ind_of(a[1], 'E', 1, true, a[2] == 0 ? 'C' : 'N');
-        auto const sse_id_b = sses.sse_ind_of(b[1], 'E', 1, true, b[2] == 0 ? 'C' : 'N');
-
-        if (sse_id_a == sse_id_b) {
-          if (adj_list.count({sse_id, sse_id_a}) == 0) {
-            return false;
-          }
-          bool const dir = adj_list.at({sse_id, sse_id_a}).direction;
-          // if parallel
-          if (dir) {
-            if (a[1] < b[1]) { return true; }
-
-          // if anti-parallel
-          } else {
-            if (b[1] < a[1]) { return true; }
-          }
-          if (a[1] == b[1]) {
-            return a[2] < b[2];
-          }
-        }
-      } catch (pdb::non_sse_resnum) {
-        return false;
-      }
-    }
-    return false;
-  });
 
-  return ret;
+
+// **************************************************************************************
+// Public Member function Pairs::resort_involved_pairs()
+// **************************************************************************************
+
+Pairs::PairsVec Pairs::resort_involved_pairs(IndexType const serial_str_id,
+                                             AdjList const& adj_list, pdb::SSES const& sses,
+                                             ResidueStrandMap const& strand_map) const {
+  return resort(involved_pairs[serial_str_id], sses.gen_index_vec('E', true)[serial_str_id],
+                adj_list, [&strand_map](int const resnum, char const hbond_atom) {
+    auto const found = strand_map(resnum, hbond_atom);
+    return found == ResidueStrandMap::none ? boost::none :
+                                             boost::optional<IndexType>{found};
+  });
 } // public member function resort_involved_pairs()
 
 
 
 
+// **************************************************************************************
+// Static Public Member function Pairs::apply()
+// **************************************************************************************
+
+Pairs::PairsVec Pairs::apply(PairsVec dnr_, Delta const& delta) {
+  for (auto const& pair : delta.removed) {
+    auto const found = std::find_if(dnr_.begin(), dnr_.end(), [&pair](auto const& p) {
+      return p[0] == pair[0] and p[1] == pair[1];
+    });
+    if (found == dnr_.end()) {
+      throw HbondNotFound{pair[0], pair[1]};
+    }
+    dnr_.erase(found);
+  }
+
+  for (auto const& pair : delta.added) {
+    dnr_.push_back({{pair[0], pair[1]}});
+  }
+  return dnr_;
+} // static public member function apply()
+
+
+
+
 // **************************************************************************************
 // Protected Member function Pairs::read_stride_stream()
 // **************************************************************************************
-Pairs::PairsVec Pairs::read_stride_stream(std::istream & is) const {
+Pairs::PairsVec Pairs::read_stride_stream(std::istream & is,
+                                          pdb::ResidueNumbering const& numbering) const {
   is.clear();
   is.seekg(0);
 
@@ -76,8 +136,15 @@ Pairs::PairsVec Pairs::read_stride_stream(std::istream & is) const {
 
   for (std::string buff; std::getline(is, buff); ) {
     if (buff.substr(0, 3) == "DNR") {
-      ret.push_back({{std::stoi(buff.substr(11, 4)),
-                      std::stoi(buff.substr(31, 4))}});
+      // the chain ID and the residue number (may be with the insertion code)
+      // of the N-H and the C=O
+      auto const donor = numbering.find(
+          pdb::parse_residue_token(buff, 10, buff.size() > 8 ? buff[8] : ' '));
+      auto const acceptor = numbering.find(
+          pdb::parse_residue_token(buff, 30, buff.size() > 28 ? buff[28] : ' '));
+      if (donor and acceptor) {
+        ret.push_back({{*donor, *acceptor}});
+      }
     }
   }
   return ret;
@@ -88,9 +155,9 @@ Pairs::PairsVec Pairs::read_stride_stream(std::istream & is) const {
 // **************************************************************************************
 // Protected Member function Pairs::init_involved_pairs()
 // **************************************************************************************
-std::vector<Pairs::PairsVec> Pairs::init_involved_pairs(PairsVec const& dnr_, pdb::SSES const& sses) const {
+arena::vector<Pairs::PairsVec> Pairs::init_involved_pairs(PairsVec const& dnr_, pdb::SSES const& sses) const {
 
-  std::vector<Pairs::PairsVec> involved_pairs_vec;
+  arena::vector<Pairs::PairsVec> involved_pairs_vec;
 
   for (auto const& sse_index : sses.gen_index_vec('E', true)) {
     involved_pairs_vec.push_back(involve_with(dnr_, sses[sse_index]));
@@ -100,6 +167,38 @@ std::vector<Pairs::PairsVec> Pairs::init_involved_pairs(PairsVec const& dnr_, pd
 
 
 
+// **************************************************************************************
+// Protected Member function Pairs::update_involved_pairs()
+// **************************************************************************************
+arena::vector<Pairs::PairsVec> Pairs::update_involved_pairs(PairsVec const& dnr_,
+                                                          pdb::SSES const& sses,
+                                                          Pairs const& previous,
+                                                          Delta const& delta) const {
+  auto const& indices = sses.gen_index_vec('E', true);
+  assert(indices.size() == previous.involved_pairs.size());
+
+  // involve_with() sorts the pairs in a total order, so the ones of a strand depend only
+  // on the set of the hbonds it involves.
+  auto const involved = [](pdb::SSE const& e, PairsVec const& pairs) {
+    return std::any_of(pairs.cbegin(), pairs.cend(), [&e](auto const& pair) {
+      return e.in_range(pair[0], 1, 'N') or e.in_range(pair[1], 1, 'C');
+    });
+  };
+
+  arena::vector<Pairs::PairsVec> involved_pairs_vec;
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    auto const& e = sses[indices[i]];
+    if (involved(e, delta.added) or involved(e, delta.removed)) {
+      involved_pairs_vec.push_back(involve_with(dnr_, e));
+    } else {
+      involved_pairs_vec.push_back(previous.involved_pairs[i]);
+    }
+  }
+  return involved_pairs_vec;
+} // protected member function update_involved_pairs()
+
+
+
 // **************************************************************************************
 // Protected Member function Pairs::involve_with()
 // **************************************************************************************
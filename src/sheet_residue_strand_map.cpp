@@ -0,0 +1,52 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <array>
+#include <vector>
+
+#include "pdb/sses.h"
+#include "sheet/common.h"
+#include "sheet/residue_strand_map.h"
+
+namespace sheet {
+
+// **************************************************************************************
+// Member Function Definition for Class ResidueStrandMap
+// **************************************************************************************
+
+constexpr IndexType ResidueStrandMap::none;
+
+// ********************************************************************
+// Constructor
+// ********************************************************************
+ResidueStrandMap::ResidueStrandMap(pdb::SSES const& sses, int const first, int const last):
+  first_res{first}
+{
+  if (last < first) {
+    return;
+  }
+
+  data.resize(static_cast<std::size_t>(last - first + 1));
+  for (int resnum = first; resnum <= last; ++resnum) {
+    auto & item = data[static_cast<std::size_t>(resnum - first)];
+    for (std::size_t i = 0; i < 2; ++i) {
+      auto const found = sses.find_sse_ind(resnum, 'E', 1, true, i == 0 ? 'N' : 'C');
+      item[i] = found ? *found : none;
+    }
+  }
+} // constructor
+
+
+
+
+// ********************************************************************
+// Public Member Function operator()
+// ********************************************************************
+IndexType ResidueStrandMap::operator()(int const resnum, char const hbond_atom) const {
+  if (resnum < first_res or first_res + static_cast<int>(data.size()) <= resnum) {
+    return none;
+  }
+  return data[static_cast<std::size_t>(resnum - first_res)][hbond_atom == 'N' ? 0 : 1];
+} // public member function operator()
+
+} // namespace sheet
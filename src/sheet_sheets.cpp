@@ -60,10 +60,23 @@ void Sheet::merge(Sheet const& other) {
 
 
 
-void Sheet::finish(SubStrandsPairKeyVec const& all_key_vec) {
-  auto const this_key_vec = keys(all_key_vec);
-  is_undirected = check_undirected(this_key_vec);
-  cycle_check(this_key_vec);
+void Sheet::finish(SubStrandsPairKeyVec const& all_key_vec, Sheets const* const previous) {
+  cycle_keys = keys(all_key_vec);
+
+  // The cycles depend only on the keys in their order.
+  Sheet const* same = nullptr;
+  if (previous != nullptr) {
+    auto const found = std::find_if(previous->cbegin(), previous->cend(),
+                                    [this](Sheet const& sheet) {
+                                      return sheet.cycle_keys == cycle_keys;
+                                    });
+    if (found != previous->cend()) {
+      same = &*found;
+    }
+  }
+
+  is_undirected = same ? same->is_undirected : check_undirected(cycle_keys);
+  cycle_check(cycle_keys, same);
 
   // if undirected, with_cycle must be true
   assert(not is_undirected or with_cycle);
@@ -115,15 +128,19 @@ SubStrandsPairKeyVec Sheet::keys(SubStrandsPairKeyVec const& all_key_vec) const
 
 
 /// Check if there is any cycles in this sheet.
-void Sheet::cycle_check(SubStrandsPairKeyVec const& this_key_vec) {
-  // Get all cycles
-  auto const tmp_cycles = sheet::FindCycle{this_key_vec}.cycles;
-  cycles_vec.reserve(tmp_cycles.size());
-
-
-  // Push all cycles into member varible with rotating to the smallest element.
-  for (auto const& one_cycle : tmp_cycles) {
-    cycles_vec.push_back(rotate_to_smallest(one_cycle.cbegin(), one_cycle.cend()));
+void Sheet::cycle_check(SubStrandsPairKeyVec const& this_key_vec, Sheet const* const same) {
+  if (same != nullptr) {
+    cycles_vec = same->cycles_vec;
+  } else {
+    // Get all cycles
+    auto const tmp_cycles = sheet::FindCycle{this_key_vec}.cycles;
+    cycles_vec.reserve(tmp_cycles.size());
+
+
+    // Push all cycles into member varible with rotating to the smallest element.
+    for (auto const& one_cycle : tmp_cycles) {
+      cycles_vec.push_back(rotate_to_smallest(one_cycle.cbegin(), one_cycle.cend()));
+    }
   }
   // Find the max cycle.
   auto const itr = std::max_element(cycles_vec.cbegin(), cycles_vec.cend(),
@@ -32,6 +32,28 @@ void SubStrandsRange::extend_substrand(ZoneResidue const& res) {
 
 
 
+// ********************************************************************
+// Public Member Function add_substrand()
+// ********************************************************************
+std::pair<SubStrand, bool> SubStrandsRange::add_substrand(IndexType const str_id,
+                                                          std::array<int, 2> const& range) {
+  auto & ranges = data.at(str_id);
+  SubStrand const sub{str_id, static_cast<IndexType>(ranges.size() - 1)};
+
+  // if this sub-strand is too short (less than min_sub_str_len), do not add it.
+  if (range[1] - range[0] + 1 < min_sub_str_len) {
+    return {sub, true};
+  }
+
+  ranges.back() = range;
+  // for the next sheet
+  ranges.push_back(default_range);
+  return {sub, false};
+} // public member function add_substrand()
+
+
+
+
 // ********************************************************************
 // Public Member Function last_substr_id()
 // ********************************************************************
@@ -64,7 +86,7 @@ SubStrandSet SubStrandsRange::cleanup_sheet() {
 // Public Member Function finish()
 // ********************************************************************
 
-std::unordered_map<SubStrand, SubStrand, SubStrandHasher> SubStrandsRange::finish() {
+arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> SubStrandsRange::finish() {
   std::vector<std::vector<IndexType>> changed_index_map;
   for (auto & ranges : data) {
     ranges.pop_back();
@@ -182,7 +204,7 @@ void SubStrandsRange::print(std::vector<IndexType> const& strand_indices) const
 // ********************************************************************
 // Protected Member Function sorted_indices()
 // ********************************************************************
-std::vector<IndexType> SubStrandsRange::sorted_indices(std::vector<std::array<int, 2>> const& substrs) {
+std::vector<IndexType> SubStrandsRange::sorted_indices(arena::vector<std::array<int, 2>> const& substrs) {
   std::vector<IndexType> i(substrs.size());
   std::iota(i.begin(), i.end(), 0);
   std::sort(i.begin(), i.end(), [&substrs](auto const& a, auto const& b) {
@@ -194,8 +216,8 @@ std::vector<IndexType> SubStrandsRange::sorted_indices(std::vector<std::array<in
 // ********************************************************************
 // Protected Member Function convert_to_substrand()
 // ********************************************************************
-std::unordered_map<SubStrand, SubStrand, SubStrandHasher> SubStrandsRange::convert_to_substrand(std::vector<std::vector<IndexType>> const& changed_index_map) const {
-  std::unordered_map<SubStrand, SubStrand, SubStrandHasher> ret;
+arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> SubStrandsRange::convert_to_substrand(std::vector<std::vector<IndexType>> const& changed_index_map) const {
+  arena::unordered_map<SubStrand, SubStrand, SubStrandHasher> ret;
 
   auto const n_str = changed_index_map.size();
   for (IndexType str = 0; str < n_str; ++str) {
@@ -13,6 +13,7 @@
 #include <boost/range/irange.hpp>
 
 #include "functions.h"
+#include "parallel.h"
 #include "sheets_out.h"
 #include "table.h"
 #include "pdb/sses.h"
@@ -26,8 +27,9 @@ namespace sheets_out {
 // Function print_sheet()
 // **********************************************************************************
 
-void print_sheet(table::Table<table::Sheet> & tbl,
-                 sheet::DirectedAdjacencyList const& adj) {
+void print_sheet(std::vector<stride2top::Sheet> & sheets,
+                 sheet::DirectedAdjacencyList const& adj,
+                 unsigned const n_threads) {
   // if no sheet
   if (adj.sheets.size() == 0) {
     return;
@@ -35,39 +37,44 @@ void print_sheet(table::Table<table::Sheet> & tbl,
 
   out::substr2str ss_writer{std::make_shared<sheet::DirectedAdjacencyList>(adj)};
 
-  std::size_t sheet_id = 0;
-  for (auto const& sheet : adj.sheets) {
-    bool const with_branch = sheet.size() != sheet.member().size();
-
-    bool const consec_beta = is_all_consec(sheet, adj);;
-    topology_string const topo{sheet, adj};
-    std::string const topo_str_richardson = topo.str();
-    std::string const topo_str_cohen = topo.str(2);
-
-    bool all_p = false, all_ap = false;
-    std::tie(all_p, all_ap) = check_all_pap(sheet, adj);
-
-    auto const seq_ss = sort_sheet_members(sheet);
-    auto const member_substrs = "'" +
-                                out::join(seq_ss.cbegin(), seq_ss.cend(), ",",
-                                       [&ss_writer](auto a){return ss_writer(*a);}) +
-                                "'";
-
-    tbl.add(std::make_tuple(sheet_id, sheet.member().size(), sheet.cycles().size(),
-                            (sheet.undirected() ? 'T' : 'F'),
-                            (with_branch ? 'T' : 'F'),
-                            (consec_beta ? 'T' : 'F'),
-                            (all_p ? 'T' : 'F'),
-                            (all_ap ? 'T' : 'F'),
-                            member_substrs,
-                            topo_str_richardson, topo_str_cohen
-                            ));
-    ++sheet_id;
-  }
+  auto const first = sheets.size();
+  sheets.resize(first + adj.sheets.size());
+  parallel::for_each_task(adj.sheets.size(), n_threads, [&](std::size_t const sheet_id) {
+    sheets[first + sheet_id] = sheet_row(sheet_id, adj.sheets[sheet_id], adj, ss_writer);
+  });
 } // function print_sheet()
 
 
 
+
+// **********************************************************************************
+// Function sheet_row()
+// **********************************************************************************
+
+stride2top::Sheet sheet_row(std::size_t const sheet_id, sheet::Sheet const& sheet,
+                            sheet::DirectedAdjacencyList const& adj,
+                            out::substr2str const& ss_writer) {
+  stride2top::Sheet row;
+  row.sheet_id = sheet_id;
+  row.n_cycles = sheet.cycles().size();
+  row.undirected = sheet.undirected();
+  row.with_branch = sheet.size() != sheet.member().size();
+  row.consecutive = is_all_consec(sheet, adj);
+
+  topology_string const topo{sheet, adj};
+  row.nomenclature_r = topo.str();
+  row.nomenclature_c = topo.str(2);
+
+  std::tie(row.all_parallel, row.all_antiparallel) = check_all_pap(sheet, adj);
+
+  for (auto const& ss : sort_sheet_members(sheet)) {
+    row.members.push_back(ss_writer(ss));
+  }
+  return row;
+} // function sheet_row()
+
+
+
 // **********************************************************************************
 // Function sort_sheet_members()
 // **********************************************************************************
@@ -167,17 +174,21 @@ std::tuple<bool, bool> check_all_pap(sheet::Sheet const& sheet, sheet::DirectedA
 // Function extracted_adjacent_substr_out()
 // **********************************************************************************
 
-void extracted_adjacent_substr_out(table::Table<table::ExtractedSheet> & tbl,
+void extracted_adjacent_substr_out(std::vector<stride2top::ExtractedSheet> & extracted_sheets,
                                    unsigned const n,
-                                   sheet::DirectedAdjacencyList const& adj) {
+                                   sheet::DirectedAdjacencyList const& adj,
+                                   unsigned const n_threads) {
+
+  // Run extraction for each sheet
+  std::vector<std::vector<std::vector<sheet::SubStrand>>> extracted_in_sheets(adj.sheets.size());
+  parallel::for_each_task(adj.sheets.size(), n_threads, [&](std::size_t const sheet_idx) {
+    extracted_in_sheets[sheet_idx] = extract_adjacent_substr(n, adj.sheets[sheet_idx], adj);
+  });
 
-  // Run extraction
   std::vector<std::tuple<std::vector<sheet::SubStrand>, unsigned, bool>> extracted;
 
   for (unsigned sheet_idx = 0; sheet_idx < adj.sheets.size(); ++sheet_idx) {
-
-    auto const tmp_ext = extract_adjacent_substr(n, adj.sheets[sheet_idx], adj);
-    for (auto const& each_tmp_ext : tmp_ext) {
+    for (auto const& each_tmp_ext : extracted_in_sheets[sheet_idx]) {
       extracted.push_back(std::make_tuple(each_tmp_ext, sheet_idx,
                           n == adj.sheets[sheet_idx].member().size()));
     }
@@ -189,22 +200,23 @@ void extracted_adjacent_substr_out(table::Table<table::ExtractedSheet> & tbl,
   }
   out::substr2str ss_writer{std::make_shared<sheet::DirectedAdjacencyList>(adj)};
 
-  for (unsigned i = 0; i < extracted.size(); ++i) {
+  auto const first = extracted_sheets.size();
+  extracted_sheets.resize(first + extracted.size());
+  parallel::for_each_task(extracted.size(), n_threads, [&](std::size_t const i) {
     auto const substr_vec = sort_substr_vec(std::get<0>(extracted[i]));
     assert(substr_vec.size() == n);
 
-    auto const sheet_idx = std::get<1>(extracted[i]);
     bool const with_cycle = cycle_checker(substr_vec, adj);
     topology_string const topo{substr_vec, with_cycle, adj};
-    std::string const topo_str = topo.str(2);
-
-    auto const member = "'" + out::join(substr_vec.cbegin(), substr_vec.cend(), ",",
-                                       [&ss_writer](auto a){return ss_writer(*a);}) +
-                        "'";
 
-    tbl.add(std::make_tuple(sheet_idx, n, (std::get<2>(extracted[i]) ? 'T' : 'F'),
-                            member, topo_str));
-  }
+    auto & row = extracted_sheets[first + i];
+    row.sheet_id = std::get<1>(extracted[i]);
+    row.same_as_original = std::get<2>(extracted[i]);
+    for (auto const& ss : substr_vec) {
+      row.members.push_back(ss_writer(ss));
+    }
+    row.nomenclature_c = topo.str(2);
+  });
 
 } // function extracted_adjacent_substr_out()
 
@@ -217,7 +229,7 @@ void extracted_adjacent_substr_out(table::Table<table::ExtractedSheet> & tbl,
 bool cycle_checker(std::vector<sheet::SubStrand> const& ss_vec,
                    sheet::DirectedAdjacencyList const& adj) {
 
-  std::vector<sheet::SubStrandsPairKey> key_vec;
+  sheet::SubStrandsPairKeyVec key_vec;
   assert(ss_vec.size() != 0);
   key_vec.reserve(ss_vec.size() - 1);
 
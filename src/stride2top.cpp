@@ -0,0 +1,366 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <array>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "adj_out.h"
+#include "data_store.h"
+#include "functions.h"
+#include "handedness.h"
+#include "parallel.h"
+#include "profile.h"
+#include "sheets_out.h"
+#include "stride2top.h"
+#include "substrands.h"
+#include "table.h"
+
+#include "pdb/sses.h"
+#include "bab/filter.h"
+#include "sheet/directed_adjacency_list.h"
+#include "sheet/pairs.h"
+
+namespace stride2top {
+
+namespace {
+
+/// The tables of the output, in the order of the output.
+data_store::Data<table::Set> make_tables() {
+  return data_store::Data<table::Set>{std::make_tuple(
+      table::TBLSubStrand{"substrand",
+                          {"SubStrand_ID", "Sheet_ID", "Ini", "End"}},
+
+      table::TBLHelix{"helix", {"SSE_ID", "Ini", "End"}},
+
+      table::TBLSheet{"sheet",
+                      {"Sheet_ID", "N_strands", "Cycle", "Undirected",
+                       "With_branch", "Consecutive", "All_para", "All_anti",
+                       "Member", "Nomenclature_R", "Nomenclature_C"}},
+
+      table::TBLExtractedSheet{"EXT_Sheet",
+                               {"Sheet_ID", "N_strands",
+                                "Same_as_Original", "Member",
+                                "Nomenclature_C"}},
+
+      table::TBLCycle{"cycle", {"Sheet_ID", "N_strands", "Member"}},
+
+      table::TBLSubStrandsPair{"substrands_pair",
+                               {"B1", "B2", "Sheet", "Dir", "PorA",
+                                "Jump", "D1", "D2", "Bridge",
+                                "Score", "SSEs_LBTS", "NumRes_LBTS"}},
+      table::TBLResiduePair{"residue_pair", {"ResNum1", "ResNum2",
+                                             "PorA", "Pair-type", "ForB"}}
+  )};
+}
+
+
+/// The 'Member' column of \c members .
+std::string join_members(std::vector<std::string> const& members) {
+  std::string joined;
+  for (auto const& member : members) {
+    joined += (joined.empty() ? "" : ",") + member;
+  }
+  return "'" + joined + "'";
+}
+
+
+// ********************************************************************
+// Conversion from the objects of Result to the rows of the tables
+// ********************************************************************
+
+
+table::SubStrand to_row(SubStrand const& substrand) {
+  return table::SubStrand{substrand.name, substrand.sheet_id, substrand.ini, substrand.end};
+}
+
+
+
+table::Helix to_row(Helix const& helix) {
+  return table::Helix{helix.sse_id, helix.ini, helix.end};
+}
+
+
+
+table::Sheet to_row(Sheet const& sheet) {
+  auto const flag = [](bool const b) { return b ? 'T' : 'F'; };
+  return table::Sheet{sheet.sheet_id, sheet.members.size(), sheet.n_cycles,
+                      flag(sheet.undirected), flag(sheet.with_branch),
+                      flag(sheet.consecutive), flag(sheet.all_parallel),
+                      flag(sheet.all_antiparallel), join_members(sheet.members),
+                      sheet.nomenclature_r, sheet.nomenclature_c};
+}
+
+
+
+table::ExtractedSheet to_row(ExtractedSheet const& extracted) {
+  return table::ExtractedSheet{extracted.sheet_id, extracted.members.size(),
+                               extracted.same_as_original ? 'T' : 'F',
+                               join_members(extracted.members), extracted.nomenclature_c};
+}
+
+
+
+table::Cycle to_row(Cycle const& cycle) {
+  return table::Cycle{cycle.sheet_id, cycle.members.size(), join_members(cycle.members)};
+}
+
+
+
+/// The placeholders of the pairs on other sheets and of the unreachable pairs are
+/// those of the STRIDE2TOP command.
+table::SubStrandsPair to_row(SubStrandsPair const& pair) {
+  auto const sses_lbts = pair.sses_lbts.value_or("");
+  auto const numres_lbts = pair.numres_lbts.value_or(0);
+
+  if (not pair.same_sheet) {
+    return table::SubStrandsPair{pair.substr_0, pair.substr_1, "other", "", "",
+                                 0, -1, -1, 0, -1.0, "", 0};
+  }
+  if (not pair.path) {
+    return table::SubStrandsPair{pair.substr_0, pair.substr_1, "same", "?", "????",
+                                 100, -1, -1, 0, -1.0, sses_lbts, numres_lbts};
+  }
+
+  auto const& path = *pair.path;
+  std::string sheet = "same";
+  if (path.in_cycle and path.undirected) {
+    sheet = "same_undir_cycle";
+  } else if (path.in_cycle) {
+    sheet = "same_in_cycle";
+  } else if (path.undirected) {
+    sheet = "same_undirected";
+  }
+  std::string const dir = path.forward ? (*path.forward ? "-->" : "<--") : "?";
+
+  return table::SubStrandsPair{pair.substr_0, pair.substr_1, sheet, dir,
+                               path.parallel ? "para" : "anti", path.jump,
+                               path.delta_1.value_or(-1), path.delta_2.value_or(-1),
+                               path.bridges.value_or(0), path.score.value_or(-1.0),
+                               sses_lbts, numres_lbts};
+}
+
+
+
+table::ResiduePair to_row(ResiduePair const& pair) {
+  return table::ResiduePair{pair.resnum_0, pair.resnum_1, pair.parallel ? "para" : "anti",
+                            pair.type, pair.front ? "Front" : "Back"};
+}
+
+
+/// A blank chain ID or insertion code is written as '.'.
+table::ResidueNumber to_row(ResidueNumber const& residue) {
+  auto const blank = [](char const c) { return c == ' ' ? '.' : c; };
+  return table::ResidueNumber{residue.resnum, blank(residue.chain), residue.seq,
+                              blank(residue.icode)};
+}
+
+
+/// Append the rows of \c objects to \c tbl .
+template <class T, class Object>
+void add_rows(table::Table<T> & tbl, std::vector<Object> const& objects) {
+  for (auto const& object : objects) {
+    tbl.add(to_row(object));
+  }
+}
+
+
+/// @brief  Write the table of \c residues (the 'residue' table), if any, in the format
+///         \c format_type .
+void residues_out(std::ostream & os, std::vector<ResidueNumber> const& residues,
+                  std::size_t const format_type) {
+  table::TBLResidueNumber tbl{"residue", {"ResNum", "Chain", "Seq", "ICode"}};
+  add_rows(tbl, residues);
+
+  std::array<table::FormatStrings, 2> const formats{{
+    table::FormatStrings{"REMARK %|18t|%6s  %5s  %6s  %5s\n",
+                         "RESIDUE %|18t|%6d  %5c  %6d  %5c\n"},
+    table::FormatStrings{"#\nloop_\n_residue.%s\n_residue.%s\n_residue.%s\n"
+                         "_residue.%s\n",
+                         "%6d %1c %6d %1c\n", 1}
+  }};
+  if (formats.size() <= format_type or residues.empty()) {
+    return;
+  }
+  os << tbl.format(formats[format_type]) << "\n";
+}
+
+
+bab::BabFilter make_bab_filter(sheet::DirectedAdjacencyList const& adj,
+                               Options const& options) {
+  return bab::BabFilter{adj, std::greater<double>(),
+                        options.max_mid_residues,
+                        options.max_mid_strands,
+                        options.cutoff_left_score,
+                        options.min_side_dist,
+                        bab::BabPolicy{options.with_stat, options.with_loop}};
+}
+
+} // namespace
+
+
+
+// *********************************************************************************
+// Function analyze()
+// *********************************************************************************
+
+Result analyze(Structure const& structure, Options const& options) {
+  profile::Scope parse_scope{"parse"};
+
+  pdb::CAAtoms ca_atoms;
+  for (auto const& residue : structure.residues) {
+    // the first one of the same residue number (like the alternate locations)
+    if (ca_atoms.count(residue.resnum) == 0) {
+      ca_atoms.emplace(residue.resnum,
+                       pdb::ATOM{Eigen::Vector3d{residue.x, residue.y, residue.z}, true});
+    }
+  }
+  pdb::SSES const sses{pdb::SSE::SSE_Header_vec{structure.sses.begin(), structure.sses.end()},
+                       ca_atoms, structure.name};
+
+  sheet::Pairs::PairsVec dnr;
+  dnr.reserve(structure.hbonds.size());
+  for (auto const& hbond : structure.hbonds) {
+    dnr.push_back({{hbond.donor, hbond.acceptor, 0}});
+  }
+  parse_scope.finish();
+
+  sheet::DirectedAdjacencyList const adj{
+      sses, dnr, options.strand_table_bridges ? sheet::BridgeEngine::StrandTable :
+                                                sheet::BridgeEngine::Sweep,
+      options.threads};
+  return analyze(adj, options);
+} // function analyze()
+
+
+
+// *********************************************************************************
+// Function analyze()
+// *********************************************************************************
+
+Result analyze(sheet::DirectedAdjacencyList const& adj, Options const& options) {
+  auto const n_threads = options.threads;
+  auto const sheet_id_map = substrands::gen_sheet_id_map(adj);
+
+  Result result;
+
+  // Each stage only reads adj and fills its own member of result,
+  // so the stages run concurrently.
+  std::vector<std::function<void()>> stages;
+
+  // ***************
+  // Cycles
+  // ***************
+  stages.push_back([&]() {
+    profile::Scope const scope{"cycles"};
+    cycles::output_cycles(result.cycles, adj, n_threads);
+  });
+
+
+  // ***************
+  // Default Output
+  // ***************
+  stages.push_back([&]() {
+    profile::Scope const scope{"substrands"};
+    substrands::substrands_out(result.substrands, adj, sheet_id_map);
+  });
+  stages.push_back([&]() {
+    profile::Scope const scope{"helices"};
+    substrands::helices_out(result.helices, adj);
+  });
+  stages.push_back([&]() {
+    profile::Scope const scope{"sheets"};
+    sheets_out::print_sheet(result.sheets, adj, n_threads);
+  });
+
+  stages.push_back([&]() {
+    auto const bab_filter = make_bab_filter(adj, options);
+
+    profile::Scope const scope{"pair_scoring"};
+    substrands::substrands_pair_out(result.substrands_pairs,
+                                    adj, sheet_id_map, bab_filter, n_threads);
+  });
+
+
+  // ***************
+  // Extract Sheet
+  // ***************
+  if (options.extract_sheets) {
+    stages.push_back([&]() {
+      profile::Scope const scope{"extract_sheets"};
+      sheets_out::extracted_adjacent_substr_out(result.extracted_sheets,
+                                                *options.extract_sheets, adj, n_threads);
+    });
+  }
+
+
+  // ***************
+  // Residue Pairs
+  // ***************
+  stages.push_back([&]() {
+    profile::Scope const scope{"residue_pairs"};
+    rpo::residue_pair_out(result.residue_pairs, adj);
+  });
+
+
+  // ***************
+  // Adjacency list and handedness
+  // ***************
+  if (options.adjacency) {
+    stages.push_back([&]() {
+      profile::Scope const scope{"adj_list"};
+      result.adjacency = adj_out::gen_adj_list(adj);
+    });
+  }
+  if (options.handedness) {
+    stages.push_back([&]() {
+      auto const bab_filter = make_bab_filter(adj, options);
+
+      profile::Scope const scope{"handedness"};
+      result.handedness = rare::find_handedness(adj, bab_filter, n_threads);
+    });
+  }
+
+  parallel::run_stages(stages, n_threads);
+
+  auto const& numbering = adj.sses.numbering();
+  if (not numbering.identity()) {
+    for (auto const& residue : numbering.residues()) {
+      result.residues.push_back(ResidueNumber{residue.first, residue.second.chain,
+                                              residue.second.seq, residue.second.icode});
+    }
+  }
+  return result;
+} // function analyze()
+
+
+
+// *********************************************************************************
+// Function write()
+// *********************************************************************************
+
+void write(std::ostream & os, Result const& result, std::size_t const format_type) {
+  auto tables = make_tables();
+  add_rows(tables.table<table::SubStrand>(), result.substrands);
+  add_rows(tables.table<table::Helix>(), result.helices);
+  add_rows(tables.table<table::Sheet>(), result.sheets);
+  add_rows(tables.table<table::ExtractedSheet>(), result.extracted_sheets);
+  add_rows(tables.table<table::Cycle>(), result.cycles);
+  add_rows(tables.table<table::SubStrandsPair>(), result.substrands_pairs);
+  add_rows(tables.table<table::ResiduePair>(), result.residue_pairs);
+  tables.format_out(os, format_type);
+  residues_out(os, result.residues, format_type);
+
+  // The mmcif-only sections are written after the tables.
+  if (format_type == 1) {
+    adj_out::adj_list_out(os, result.adjacency);
+    rare::output_handedness(os, result.handedness);
+  }
+} // function write()
+
+} // namespace stride2top
@@ -11,6 +11,7 @@
 #include <boost/range/irange.hpp>
 
 #include "functions.h"
+#include "parallel.h"
 #include "substrands.h"
 #include "table.h"
 
@@ -23,16 +24,14 @@ namespace substrands {
 // Function substrands_out()
 // *******************************************************************************
 
-void substrands_out(table::Table<table::SubStrand> & tbl,
+void substrands_out(std::vector<stride2top::SubStrand> & substrands,
                     sheet::DirectedAdjacencyList const& adj,
                     SubStrandStr2SheetIdxMap const& sheet_id_map) {
-  out::substr2str ss_writer{std::make_shared<sheet::DirectedAdjacencyList>(adj)};
-
   for (auto const& sub : adj.substrs().vec()) {
-    auto const substrand_id = ss_writer(sub);
-    tbl.add(std::make_tuple(substrand_id, sheet_id_map.at(substrand_id),
-                            adj.substrs().n_term_res(sub),
-                            adj.substrs().c_term_res(sub)));
+    auto const substrand_id = out::substr2str::str(sub, adj);
+    substrands.push_back(stride2top::SubStrand{substrand_id, sheet_id_map.at(substrand_id),
+                                               adj.substrs().n_term_res(sub),
+                                               adj.substrs().c_term_res(sub)});
   }
 
 } // function substrands_out()
@@ -60,11 +59,11 @@ SubStrandStr2SheetIdxMap gen_sheet_id_map(sheet::DirectedAdjacencyList const& ad
 // Function helices_out()
 // *******************************************************************************
 
-void helices_out(table::Table<table::Helix> & tbl,
+void helices_out(std::vector<stride2top::Helix> & helices,
                  sheet::DirectedAdjacencyList const& adj) {
   for (std::size_t i = 0; i < adj.sses.size; ++i) {
     if (adj.sses[i].type == 'H') {
-      tbl.add(std::make_tuple(i, adj.sses[i].init, adj.sses[i].end));
+      helices.push_back(stride2top::Helix{i, adj.sses[i].init, adj.sses[i].end});
     }
   }
 } // function helices_out()
@@ -75,135 +74,177 @@ void helices_out(table::Table<table::Helix> & tbl,
 // Function substrands_pair_out()
 // *******************************************************************************
 
-void substrands_pair_out(table::TBLSubStrandsPair & tbl,
+void substrands_pair_out(std::vector<stride2top::SubStrandsPair> & pairs,
                          sheet::DirectedAdjacencyList const& adj,
                          SubStrandStr2SheetIdxMap const& sheet_id_map,
-                         bab::BabFilter & bab) {
+                         bab::BabFilter const& bab,
+                         unsigned const n_threads) {
 
   auto const N_SUBSTR = adj.substrs().vec().size();
-  auto const ss_b = adj.substrs().vec().cbegin();
+  if (N_SUBSTR < 2) {
+    return;
+  }
 
   std::vector<pdb::IndexType> pseudo_seq(adj.sses.size);
   std::iota(pseudo_seq.begin(), pseudo_seq.end(), 0);
-  auto const pseudo_b = pseudo_seq.cbegin();
 
   out::substr2str ss_writer{std::make_shared<sheet::DirectedAdjacencyList>(adj)};
+  ConnectionTypeIndex const ctype_index{adj};
 
-  for (auto const i : pdb::range(N_SUBSTR)) {
-    for (auto const j : boost::irange(i + 1, N_SUBSTR)) {
-      auto const& ss0 = *(ss_b + i);
-      auto const& ss1 = *(ss_b + j);
+  // row_offsets[i]: The serial number of the pair (i, i+1) in the upper triangle.
+  std::vector<std::size_t> row_offsets(N_SUBSTR);
+  for (std::size_t i = 1; i < N_SUBSTR; ++i) {
+    row_offsets[i] = row_offsets[i-1] + (N_SUBSTR - i);
+  }
+  auto const n_pairs = row_offsets.back();
+  auto const n_tiles = (n_pairs + PAIR_TILE_SIZE - 1) / PAIR_TILE_SIZE;
+
+  // Pairs generated from each tile. Concatenated in the order of tiles afterwards.
+  std::vector<std::vector<stride2top::SubStrandsPair>> tile_pairs(n_tiles);
+
+  parallel::for_each_task(n_tiles, n_threads, [&](std::size_t const tile) {
+    auto const first = tile * PAIR_TILE_SIZE;
+    auto const last = std::min(first + PAIR_TILE_SIZE, n_pairs);
+
+    // The pair (i, j) at the serial number 'first'.
+    std::size_t i = std::distance(row_offsets.cbegin(),
+                                  std::upper_bound(row_offsets.cbegin(),
+                                                   row_offsets.cend(), first)) - 1;
+    std::size_t j = i + 1 + (first - row_offsets[i]);
+
+    auto & tile_pair = tile_pairs[tile];
+    tile_pair.reserve(last - first);
+    for (auto k = first; k < last; ++k) {
+      tile_pair.push_back(substrands_pair_row(i, j, adj, sheet_id_map, bab, ss_writer,
+                                              ctype_index, pseudo_seq));
+      if (++j == N_SUBSTR) {
+        ++i;
+        j = i + 1;
+      }
+    }
+  });
 
-      // sses_lbts and numres_lbts can be calculated for all SubStrand pairs.
-      auto const sses_lbts = check_connection_type(ss0, ss1, adj, sheet_id_map, ss_writer);
-      auto const numres_lbts = static_cast<std::size_t>(adj.substrs().n_term_res(ss1)-
-                                                        adj.substrs().c_term_res(ss0)-1);
+  pairs.reserve(pairs.size() + n_pairs);
+  for (auto const& tile_pair : tile_pairs) {
+    pairs.insert(pairs.end(), tile_pair.cbegin(), tile_pair.cend());
+  }
 
+} // function substrands_pair_out()
 
-      sheet::SubStrandsPairKey const seq_key{ss0, ss1};
-      auto const  rev_key = seq_key.reverse();
 
-      auto const ss0_str = ss_writer(ss0);
-      auto const ss1_str = ss_writer(ss1);
 
-      // if not on the same sheet
-      if (sheet_id_map.at(ss0_str) != sheet_id_map.at(ss1_str)) {
-        tbl.add(std::make_tuple(ss0_str, ss1_str, "other", "", "",
-                                0, -1, -1, 0, -1.0, "", 0));
-        continue;
-      }
+// *******************************************************************************
+// Function substrands_pair_row()
+// *******************************************************************************
 
-      // Attributes for the path between ss_0 and ss_1
-      auto const& seq_attr = adj.adj_attr.at(seq_key);
-      auto const& rev_attr = adj.adj_attr.at(rev_key);
+stride2top::SubStrandsPair substrands_pair_row(std::size_t const idx0,
+                                               std::size_t const idx1,
+                                               sheet::DirectedAdjacencyList const& adj,
+                                               SubStrandStr2SheetIdxMap const& sheet_id_map,
+                                               bab::BabFilter const& bab,
+                                               out::substr2str const& ss_writer,
+                                               ConnectionTypeIndex const& ctype_index,
+                                               std::vector<pdb::IndexType> const& pseudo_seq) {
+  auto const& ss0 = adj.substrs().vec()[idx0];
+  auto const& ss1 = adj.substrs().vec()[idx1];
+
+  // sses_lbts and numres_lbts can be calculated for all SubStrand pairs on a chain.
+  // Across a chain break there is no linker.
+  bool const same_chain = adj.sses.same_chain(adj.strand_indices[ss0.str],
+                                              adj.strand_indices[ss1.str]);
+
+  sheet::SubStrandsPairKey const seq_key{ss0, ss1};
+  auto const  rev_key = seq_key.reverse();
+
+  stride2top::SubStrandsPair pair;
+  pair.substr_0 = ss_writer(ss0);
+  pair.substr_1 = ss_writer(ss1);
+
+  // if not on the same sheet
+  pair.same_sheet = sheet_id_map.at(pair.substr_0) == sheet_id_map.at(pair.substr_1);
+  if (not pair.same_sheet) {
+    return pair;
+  }
 
-      // unreachable
-      if (not seq_attr.reachable and not rev_attr.reachable) {
-        tbl.add(std::make_tuple(ss0_str, ss1_str, "same", "?", "????",
-                                100, -1, -1, 0, -1.0, sses_lbts, numres_lbts));
-        continue;
-      }
+  if (same_chain) {
+    pair.sses_lbts = ctype_index(idx0, idx1);
+    pair.numres_lbts = static_cast<std::size_t>(adj.substrs().n_term_res(ss1)-
+                                                adj.substrs().c_term_res(ss0)-1);
+  }
 
-      bool const undirected = adj.sheets[sheet_id_map.at(ss0_str)].undirected();
-      bool const in_same_cycle = in_cycle(ss0, ss1,
-                                          adj.sheets[sheet_id_map.at(ss0_str)]);
-
-      // If ss0 and ss1 are in the same cycle,
-      // and 1 of 2 pathways in opposite directions are not found.
-      if (in_same_cycle and not (seq_attr.reachable and rev_attr.reachable)) {
-        if (not seq_attr.reachable and rev_attr.reachable) {
-          throw one_directional_cycle_exception{ss0_str, ss1_str};
-        } else if (seq_attr.reachable and not rev_attr.reachable) {
-          throw one_directional_cycle_exception{ss1_str, ss0_str};
-        }
-      }
+  // Attributes for the path between ss_0 and ss_1
+  auto const& seq_attr = adj.adj_attr.at(seq_key);
+  auto const& rev_attr = adj.adj_attr.at(rev_key);
 
-      auto const& attr = in_same_cycle ?
-                            (seq_attr.jump < rev_attr.jump ? seq_attr: rev_attr) :
-                            (seq_attr.reachable ? seq_attr : rev_attr);
-
-      auto const& key = in_same_cycle ?
-                            (seq_attr.jump < rev_attr.jump ? seq_key : rev_key) :
-                            (seq_attr.reachable ? seq_key : rev_key);
-
-      int d1 = -1;
-      int d2 = -1;
-      int br = 0;
-      if (attr.jump == 0) {
-        auto const& data = adj.adj_sub().map(key);
-        d1 = data.delta_1;
-        d2 = data.delta_2;
-        br = data.residue_pairs;
-        assert(data.direction == attr.direction);
-      }
+  // unreachable
+  if (not seq_attr.reachable and not rev_attr.reachable) {
+    return pair;
+  }
 
-      std::string sheet = "same";
-      std::string dir = seq_attr.reachable ? "-->" : "<--";
-
-      // if reachable in both direction
-      if (in_same_cycle and undirected) {
-        sheet = "same_undir_cycle";
-        dir = "?";
-      } else if (in_same_cycle) {
-        sheet = "same_in_cycle";
-        dir = seq_attr.jump < rev_attr.jump ? "-->" : "<--";
-      } else if (undirected) {
-        sheet = "same_undirected";
-      }
+  stride2top::SubStrandsPair::Path path;
+  path.undirected = adj.sheets[sheet_id_map.at(pair.substr_0)].undirected();
+  path.in_cycle = in_cycle(ss0, ss1, adj.sheets[sheet_id_map.at(pair.substr_0)]);
+
+  // If ss0 and ss1 are in the same cycle,
+  // and 1 of 2 pathways in opposite directions are not found.
+  if (path.in_cycle and not (seq_attr.reachable and rev_attr.reachable)) {
+    if (not seq_attr.reachable and rev_attr.reachable) {
+      throw one_directional_cycle_exception{pair.substr_0, pair.substr_1};
+    } else if (seq_attr.reachable and not rev_attr.reachable) {
+      throw one_directional_cycle_exception{pair.substr_1, pair.substr_0};
+    }
+  }
 
-      std::string const PorA = attr.direction ? "para" : "anti";
-      std::size_t const jump = attr.jump;
-
-
-      // ********************************************
-      // run bab_filter
-      // ********************************************
-      // If ss0 and ss1 are anti-parallel, calculate the score as if ss1 were reversed.
-      unsigned const reversed = attr.direction ? 0 : (1u << adj.strand_indices[ss1.str]);
-
-      // The fourth argument should be a past the end iterator.
-      // (that's why '+1' is appended.)
-      // The order of ss_0 and ss_1 must be sequential.
-      // So the order of key is ignored and it's OK.
-      bab(ss0, ss1,
-          pseudo_b + adj.strand_indices[ss0.str],
-          pseudo_b + adj.strand_indices[ss1.str] + 1, reversed);
-
-      auto const& filter_result = bab.result();
-      double score = 0.0;
-      if (filter_result.success) {
-        score = filter_result.left_score;
-      } else {
-        score = -1.0;
-      }
+  auto const& attr = path.in_cycle ?
+                        (seq_attr.jump < rev_attr.jump ? seq_attr: rev_attr) :
+                        (seq_attr.reachable ? seq_attr : rev_attr);
+
+  auto const& key = path.in_cycle ?
+                        (seq_attr.jump < rev_attr.jump ? seq_key : rev_key) :
+                        (seq_attr.reachable ? seq_key : rev_key);
+
+  path.parallel = attr.direction;
+  path.jump = attr.jump;
+  if (attr.jump == 0) {
+    auto const& data = adj.adj_sub().map(key);
+    path.delta_1 = data.delta_1;
+    path.delta_2 = data.delta_2;
+    path.bridges = static_cast<std::size_t>(data.residue_pairs);
+    assert(data.direction == attr.direction);
+  }
 
-      tbl.add(std::make_tuple(ss0_str, ss1_str, sheet, dir, PorA,
-                              jump, d1, d2, br,
-                              score, sses_lbts, numres_lbts));
-    }
+  // if reachable in both direction, the direction is unknown
+  if (path.in_cycle and path.undirected) {
+    path.forward = boost::none;
+  } else if (path.in_cycle) {
+    path.forward = seq_attr.jump < rev_attr.jump;
+  } else {
+    path.forward = seq_attr.reachable;
   }
 
-} // function substrands_pair_out()
+
+  // ********************************************
+  // run bab_filter
+  // ********************************************
+  // If ss0 and ss1 are anti-parallel, calculate the score as if ss1 were reversed.
+  unsigned const reversed = attr.direction ? 0 : (1u << adj.strand_indices[ss1.str]);
+
+  // The fourth argument should be a past the end iterator.
+  // (that's why '+1' is appended.)
+  // The order of ss_0 and ss_1 must be sequential.
+  // So the order of key is ignored and it's OK.
+  auto const pseudo_b = pseudo_seq.cbegin();
+  auto const filter_result = bab.evaluate(ss0, ss1,
+                                          pseudo_b + adj.strand_indices[ss0.str],
+                                          pseudo_b + adj.strand_indices[ss1.str] + 1,
+                                          reversed);
+  if (filter_result.success) {
+    path.score = filter_result.left_score;
+  }
+
+  pair.path = path;
+  return pair;
+} // function substrands_pair_row()
 
 
 
@@ -264,12 +305,102 @@ std::string check_connection_type(sheet::SubStrand const& ss0,
 
 
 
+// *******************************************************************************
+// Constructor ConnectionTypeIndex::ConnectionTypeIndex()
+// *******************************************************************************
+
+ConnectionTypeIndex::ConnectionTypeIndex(sheet::DirectedAdjacencyList const& adj_):
+  adj{adj_}
+{
+  helix_prefix.reserve(adj.sses.size + 1);
+  helix_prefix.push_back(0);
+  for (std::size_t i = 0; i < adj.sses.size; ++i) {
+    helix_prefix.push_back(helix_prefix.back() + (adj.sses[i].type == 'H' ? 1 : 0));
+  }
+
+  auto const& substrs = adj.substrs().vec();
+  substr_sheet.resize(substrs.size(), adj.sheets.size());
+  for (std::size_t sheet_id = 0; sheet_id < adj.sheets.size(); ++sheet_id) {
+    for (auto const& ss : adj.sheets[sheet_id].member()) {
+      auto const itr = std::lower_bound(substrs.cbegin(), substrs.cend(), ss);
+      assert(itr != substrs.cend() and *itr == ss);
+      substr_sheet[std::distance(substrs.cbegin(), itr)] = sheet_id;
+    }
+  }
+
+  sheet_prefix.resize(adj.sheets.size(), std::vector<std::size_t>(substrs.size() + 1, 0));
+  for (std::size_t sheet_id = 0; sheet_id < adj.sheets.size(); ++sheet_id) {
+    auto & prefix = sheet_prefix[sheet_id];
+    for (std::size_t i = 0; i < substrs.size(); ++i) {
+      prefix[i+1] = prefix[i] + (substr_sheet[i] == sheet_id ? 1 : 0);
+    }
+  }
+} // constructor ConnectionTypeIndex::ConnectionTypeIndex()
+
+
+
+// *******************************************************************************
+// Public Member Function ConnectionTypeIndex::operator()()
+// *******************************************************************************
+
+std::string ConnectionTypeIndex::operator()(std::size_t const idx0,
+                                            std::size_t const idx1) const {
+  assert(idx0 < idx1);
+  auto const& substrs = adj.substrs().vec();
+
+  std::size_t ctype = 2u;
+  if (n_helices_between(adj.strand_indices[substrs[idx0].str],
+                        adj.strand_indices[substrs[idx1].str])) {
+    ctype |= 1u;
+  }
+
+  // Sub-Strands between them are compared with the sheet of the last one.
+  auto const n_mid = idx1 - idx0 - 1;
+  auto const n_same = n_substrs_between(idx0, idx1, substr_sheet[idx1]);
+  if (n_same < n_mid) {
+    ctype |= 4u;
+  }
+
+  return gen_sses_lbts(ctype, n_same != 0);
+} // public member function ConnectionTypeIndex::operator()()
+
+
+
+// *******************************************************************************
+// Public Member Function ConnectionTypeIndex::n_helices_between()
+// *******************************************************************************
+
+std::size_t ConnectionTypeIndex::n_helices_between(std::size_t const sse_id_0,
+                                                   std::size_t const sse_id_1) const {
+  if (sse_id_1 <= sse_id_0 + 1) {
+    return 0;
+  }
+  return helix_prefix[sse_id_1] - helix_prefix[sse_id_0 + 1];
+} // public member function ConnectionTypeIndex::n_helices_between()
+
+
+
+// *******************************************************************************
+// Public Member Function ConnectionTypeIndex::n_substrs_between()
+// *******************************************************************************
+
+std::size_t ConnectionTypeIndex::n_substrs_between(std::size_t const idx0,
+                                                   std::size_t const idx1,
+                                                   std::size_t const sheet_id) const {
+  if (idx1 <= idx0 + 1 or sheet_prefix.size() <= sheet_id) {
+    return 0;
+  }
+  return sheet_prefix[sheet_id][idx1] - sheet_prefix[sheet_id][idx0 + 1];
+} // public member function ConnectionTypeIndex::n_substrs_between()
+
+
+
 // *******************************************************************************
 // Function check_middle_ss_sheet()
 // *******************************************************************************
 
-bool check_middle_ss_sheet(std::vector<sheet::SubStrand>::const_iterator itr0,
-                           std::vector<sheet::SubStrand>::const_iterator itr1,
+bool check_middle_ss_sheet(arena::vector<sheet::SubStrand>::const_iterator itr0,
+                           arena::vector<sheet::SubStrand>::const_iterator itr1,
                            std::function<bool(std::size_t, std::size_t)> cmp,
                            SubStrandStr2SheetIdxMap const& sheet_id_map,
                            out::substr2str const& ss_writer) {
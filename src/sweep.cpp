@@ -0,0 +1,297 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include "parallel.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "sweep.h"
+
+#include "bab/filter.h"
+#include "pdb/sses.h"
+#include "pdb/stride_stream.h"
+
+namespace sweep {
+
+namespace {
+
+/// @brief  The pairs of Sub-Strands of the edge strands of a range of SSEs, in the order
+///         BabFilter::evaluate() tries them.
+using Unit = std::vector<bab::BabFilterRaw>;
+
+
+/// @brief  The values of \c list ('V1,V2,...') of the option \c name .
+template <class T>
+std::vector<T> parse_values(std::string const& name, std::string const& list) {
+  std::vector<T> values;
+  std::istringstream iss{list};
+  for (std::string token; std::getline(iss, token, ',');) {
+    try {
+      // lexical_cast wraps a negative value around for an unsigned type
+      if (std::is_unsigned<T>::value and token.find('-') != std::string::npos) {
+        throw boost::bad_lexical_cast{};
+      }
+      values.push_back(boost::lexical_cast<T>(token));
+    } catch (boost::bad_lexical_cast const&) {
+      throw sweep_error{"INVALID VALUE '" + token + "' OF '" + name + "'"};
+    }
+  }
+  if (values.empty() or list.back() == ',') {
+    throw sweep_error{"NO VALUE OF '" + name + "'"};
+  }
+  return values;
+}
+
+
+/// @brief  Examine every range of SSEs as rare::get_handedness() does, up to the loosest
+///         cut-off values. The ranges none of whose pairs can succeed are left out.
+std::vector<Unit> examine_units(sheet::DirectedAdjacencyList const& adj,
+                                bab::BabFilter const& bab_filter,
+                                unsigned const max_res_len, unsigned const max_mid_str,
+                                unsigned const n_threads) {
+  auto const& sses = adj.sses;
+  auto const n_sse = sses.size;
+  std::vector<pdb::IndexType> pseudo_seq(n_sse);
+  std::iota(pseudo_seq.begin(), pseudo_seq.end(), 0);
+  auto const b = pseudo_seq.cbegin();
+
+  // One task for the ranges from each SSE.
+  std::vector<std::vector<Unit>> units_from(n_sse);
+  parallel::for_each_task(n_sse, n_threads, [&](std::size_t const i) {
+    if (sses[i].type != 'E') {
+      return;
+    }
+    for (auto j = i + 1; j <= n_sse; ++j) {
+      if (sses[j - 1].type != 'E') {
+        continue;
+      }
+
+      Unit unit;
+      bool examined = false;
+      for (auto const& sub_first: adj.substrs().vec(sses.serial_strand_id[i])) {
+        for (auto const& sub_last: adj.substrs().vec(sses.serial_strand_id[j - 1])) {
+          unit.push_back(bab_filter.evaluate_raw(sub_first, sub_last, b + i, b + j,
+                                                 max_res_len, max_mid_str));
+          examined = examined or unit.back().examined;
+        }
+      }
+      if (examined) {
+        units_from[i].push_back(std::move(unit));
+      }
+    }
+  });
+
+  std::vector<Unit> units;
+  for (auto & from : units_from) {
+    std::move(from.begin(), from.end(), std::back_inserter(units));
+  }
+  return units;
+}
+
+
+/// @brief  The row of the 'sweep' table: the connections which rare::get_handedness()
+///         finds with the cut-off values, and the left-handed ones among them.
+table::Sweep sweep_row(std::vector<Unit> const& units, bab::BabFilter const& bab_filter,
+                       double const min_side_dist, double const cutoff_left_score,
+                       unsigned const max_mid_residues, unsigned const max_mid_strands) {
+  std::size_t n_units = 0;
+  std::vector<std::string> left_handed;
+  for (auto const& unit : units) {
+    // the first pair that passed, or the last pair tried (BabFilter::evaluate())
+    bab::BabFilterResult result{};
+    for (auto const& raw : unit) {
+      result = raw.result(max_mid_residues, max_mid_strands, min_side_dist);
+      if (bab_filter.passed(result, cutoff_left_score)) {
+        break;
+      }
+    }
+    if (not result.success) {
+      continue;
+    }
+
+    ++n_units;
+    if (bab_filter.passed(result, cutoff_left_score)) {
+      left_handed.push_back(result.sub_first.string() + "-" + result.sub_last.string());
+    }
+  }
+
+  // '-' for none, so that the column is never empty
+  std::string joined;
+  for (auto const& connection : left_handed) {
+    joined += (joined.empty() ? "" : ",") + connection;
+  }
+  return table::Sweep{min_side_dist, cutoff_left_score, max_mid_residues, max_mid_strands,
+                      n_units, left_handed.size(), joined.empty() ? "-" : joined};
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function parse_grid()
+// **************************************************************************
+
+Grid parse_grid(bpo::variables_map const& vm) {
+  Grid grid;
+  std::vector<std::string> given;
+  if (vm.count("sweep")) {
+    for (auto const& entry : vm["sweep"].as<std::vector<std::string>>()) {
+      auto const eq = entry.find('=');
+      auto const name = entry.substr(0, eq);
+      if (eq == std::string::npos) {
+        throw sweep_error{"NO VALUE OF '" + name + "'"};
+      }
+      if (std::find(given.cbegin(), given.cend(), name) != given.cend()) {
+        throw sweep_error{"'" + name + "' IS GIVEN TWICE"};
+      }
+      given.push_back(name);
+
+      auto const list = entry.substr(eq + 1);
+      if (name == "min-side-dist") {
+        grid.min_side_dist = parse_values<double>(name, list);
+      } else if (name == "cutoff-left-score") {
+        grid.cutoff_left_score = parse_values<double>(name, list);
+      } else if (name == "max-mid-residues") {
+        grid.max_mid_residues = parse_values<unsigned>(name, list);
+      } else if (name == "max-mid-strands") {
+        grid.max_mid_strands = parse_values<unsigned>(name, list);
+      } else {
+        throw sweep_error{"UNKNOWN OPTION '" + name + "'"};
+      }
+    }
+  }
+
+  // the value of the option itself, if not swept
+  if (grid.min_side_dist.empty()) {
+    grid.min_side_dist.push_back(vm["min-side-dist"].as<double>());
+  }
+  if (grid.cutoff_left_score.empty()) {
+    grid.cutoff_left_score.push_back(vm["cutoff-left-score"].as<double>());
+  }
+  if (grid.max_mid_residues.empty()) {
+    grid.max_mid_residues.push_back(vm["max-mid-residues"].as<unsigned>());
+  }
+  if (grid.max_mid_strands.empty()) {
+    grid.max_mid_strands.push_back(vm["max-mid-strands"].as<unsigned>());
+  }
+  return grid;
+} // function parse_grid()
+
+
+
+// **************************************************************************
+// Function evaluate()
+// **************************************************************************
+
+std::vector<table::Sweep> evaluate(sheet::DirectedAdjacencyList const& adj,
+                                   stride2top::Options const& options, Grid const& grid) {
+  auto const max_res_len = *std::max_element(grid.max_mid_residues.cbegin(),
+                                             grid.max_mid_residues.cend());
+  auto const max_mid_str = *std::max_element(grid.max_mid_strands.cbegin(),
+                                             grid.max_mid_strands.cend());
+
+  // The triangles (BabFilter::sides_map) do not depend on the cut-off values.
+  bab::BabFilter const bab_filter{adj, std::greater<double>(),
+                                  max_res_len, max_mid_str,
+                                  options.cutoff_left_score,
+                                  options.min_side_dist,
+                                  bab::BabPolicy{options.with_stat, options.with_loop}};
+
+  profile::Scope examine_scope{"sweep_examine"};
+  auto const units = examine_units(adj, bab_filter, max_res_len, max_mid_str,
+                                   options.threads);
+  examine_scope.finish();
+
+  profile::Scope const scope{"sweep_rows"};
+  std::vector<table::Sweep> rows;
+  for (auto const min_side_dist : grid.min_side_dist) {
+    for (auto const max_mid_residues : grid.max_mid_residues) {
+      for (auto const max_mid_strands : grid.max_mid_strands) {
+        for (auto const cutoff_left_score : grid.cutoff_left_score) {
+          rows.push_back(sweep_row(units, bab_filter, min_side_dist, cutoff_left_score,
+                                   max_mid_residues, max_mid_strands));
+        }
+      }
+    }
+  }
+  return rows;
+} // function evaluate()
+
+
+
+// **************************************************************************
+// Function sweep_out()
+// **************************************************************************
+
+void sweep_out(std::ostream & os, std::vector<table::Sweep> const& rows,
+               std::size_t const format_type) {
+  table::TBLSweep tbl{"sweep", {"Side_dist", "Cutoff", "Max_res", "Max_str", "N_units",
+                                "N_left", "Left_handed"}};
+  for (auto const& row : rows) {
+    tbl.add(row);
+  }
+
+  std::array<table::FormatStrings, 2> const formats{{
+    table::FormatStrings{"REMARK %|18t|%9s  %6s  %7s  %7s  %7s  %6s  %s\n",
+                         "SWEEP %|18t|%9g  %6g  %7d  %7d  %7d  %6d  %s\n"},
+    table::FormatStrings{"#\nloop_\n_sweep.%s\n_sweep.%s\n_sweep.%s\n_sweep.%s\n"
+                         "_sweep.%s\n_sweep.%s\n_sweep.%s\n",
+                         "%g %g %d %d %d %d %s\n", 1}
+  }};
+  os << tbl.format(formats[format_type]) << "\n";
+} // function sweep_out()
+
+
+
+// **************************************************************************
+// Function run()
+// **************************************************************************
+
+void run(bpo::variables_map const& vm, std::ostream & out_stream) {
+  auto const format_type = vm["format-type"].as<std::size_t>();
+  if (1 < format_type) {
+    std::cerr << "Fatal error: Unknown format type '" << format_type << "'." << std::endl;
+    throw arg::argument_error{"unknown type"};
+  }
+  auto const grid = parse_grid(vm);
+
+  auto const input = pipeline::read_input(vm);
+  profile::Scope parse_scope{"parse"};
+  std::istringstream stride_is{input.stride_text};
+  pdb::stride_stream stride{stride_is};
+
+  // If no-stride-sse, use the SSE headers in the PDB data
+  std::istringstream pdb_is{input.pdb_text};
+  auto const sses = vm["no-stride-sse"].as<bool>() ?
+                      pdb::SSES{pdb_is, input.pdb_name} :
+                      pdb::SSES{pdb_is, input.pdb_name, stride};
+  parse_scope.finish();
+
+  auto const options = pipeline::analysis_options(vm);
+  sheet::DirectedAdjacencyList const adj{
+      sses, stride, options.strand_table_bridges ? sheet::BridgeEngine::StrandTable :
+                                                   sheet::BridgeEngine::Sweep,
+      options.threads};
+
+  auto const rows = evaluate(adj, options, grid);
+
+  profile::Scope const scope{"format_out"};
+  sweep_out(out_stream, rows, format_type);
+  out_stream.flush();
+} // function run()
+
+} // namespace sweep
@@ -0,0 +1,427 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "pdb/constants.h"
+#include "pdb/exceptions.h"
+#include "synth/generator.h"
+
+namespace synth {
+
+namespace {
+
+/// Distance between neighbouring strands in a sheet.
+constexpr double strand_gap = 4.8;
+
+/// Rise per residue along a strand.
+constexpr double strand_rise = 3.3;
+
+/// Height of the pleat of a strand.
+constexpr double pleat = 0.8;
+
+/// Rise per residue along a helix, and its radius.
+constexpr double helix_rise = 1.5;
+constexpr double helix_radius = 2.3;
+
+/// Distance between the axis of a helix and the sheet it packs against.
+constexpr double helix_offset = 10.0;
+
+/// Space between two sheets (or barrels).
+constexpr double sheet_gap = 20.0;
+
+/// The residue numbers are written in 4 columns.
+constexpr int max_resnum = 9999;
+
+
+struct Point {
+  double x;
+  double y;
+  double z;
+};
+
+
+/// A strand at the position \c pos of the sheet \c sheet .
+struct Strand {
+  std::size_t sheet;
+  std::size_t pos;
+  /// The direction along the sheet axis (z). All the strands start from the same level.
+  bool up;
+  /// Register of the hydrogen bonds (0 or 1) relative to the first strand of the sheet.
+  unsigned reg;
+  /// The residue number of the first residue. Set while laying out the chain.
+  int init;
+  /// The SSE index. Set while laying out the chain.
+  std::size_t sse;
+};
+
+
+/// @brief  Two strands of the same sheet forming hydrogen bonds at the levels [lo, hi) of
+///         str0. The level t of str0 faces the level t + shift of str1.
+///         str0 bonds at the levels of its own register parity and str1 at the other parity,
+///         so that no residue is paired on both of its sides.
+struct StrandPair {
+  std::size_t str0;
+  std::size_t str1;
+  std::size_t lo;
+  std::size_t hi;
+  unsigned shift;
+  bool cross_link;
+};
+
+
+/// An SSE laid out in space, before the residue numbers are assigned.
+struct Block {
+  char type;
+  std::vector<Point> atoms;
+  /// Index into the vector of Strand. Only for strands.
+  std::size_t strand;
+};
+
+
+void validate(Params const& params) {
+  if (params.sheets == 0 or params.strands == 0) {
+    throw invalid_params{"at least one sheet with one strand is required."};
+  }
+  if (params.barrel and params.strands < 3) {
+    throw invalid_params{"a barrel needs at least 3 strands."};
+  }
+  if (params.strand_len < static_cast<std::size_t>(pdb::STRAND_MIN_LEN)) {
+    throw invalid_params{"strand_len must be at least " +
+                         std::to_string(pdb::STRAND_MIN_LEN) + "."};
+  }
+  if (params.helix_every != 0 and
+      params.helix_len < static_cast<std::size_t>(pdb::HELIX_MIN_LEN)) {
+    throw invalid_params{"helix_len must be at least " +
+                         std::to_string(pdb::HELIX_MIN_LEN) + "."};
+  }
+  if (params.loop_len == 0) {
+    throw invalid_params{"loop_len must be at least 1."};
+  }
+  if (params.pattern.empty() or
+      (params.pattern != "random" and
+       params.pattern.find_first_not_of("ap") != std::string::npos)) {
+    throw invalid_params{"pattern must be 'random' or a string of 'a' and 'p'."};
+  }
+}
+
+
+/// @return The strands of all the sheets with their directions and registers.
+std::vector<Strand> place_strands(Params const& params, std::mt19937 & rng) {
+  std::vector<Strand> strands;
+  std::size_t n_pairs = 0;
+  for (std::size_t sheet = 0; sheet < params.sheets; ++sheet) {
+    strands.push_back(Strand{sheet, 0, true, 0, 0, 0});
+    for (std::size_t pos = 1; pos < params.strands; ++pos, ++n_pairs) {
+      auto const& prev = strands.back();
+      bool const parallel = params.pattern == "random" ?
+        (rng() % 2 == 0) : (params.pattern[n_pairs % params.pattern.size()] == 'p');
+      // Antiparallel neighbours alternate the register, parallel ones keep it.
+      strands.push_back(Strand{sheet, pos, parallel ? prev.up : not prev.up,
+                               parallel ? prev.reg : 1u - prev.reg, 0, 0});
+    }
+  }
+  return strands;
+}
+
+
+/// @return The pairs of neighbouring strands, the closing pairs of the barrels and
+///         the cross links.
+std::vector<StrandPair> pair_strands(Params const& params, std::vector<Strand> const& strands,
+                                     std::mt19937 & rng) {
+  auto const n = params.strands;
+  auto const len = params.strand_len;
+
+  // The shift keeping the register when str1 is not the next neighbour of str0.
+  auto const shift_of = [&strands](std::size_t const s0, std::size_t const s1) {
+    auto const sum = strands[s0].reg + strands[s1].reg;
+    return strands[s0].up == strands[s1].up ? sum % 2 : (1 + sum) % 2;
+  };
+
+  std::vector<StrandPair> pairs;
+  for (std::size_t sheet = 0; sheet < params.sheets; ++sheet) {
+    auto const first = sheet * n;
+    for (std::size_t pos = 0; pos + 1 < n; ++pos) {
+      pairs.push_back(StrandPair{first + pos, first + pos + 1, 0, len, 0, false});
+    }
+    if (params.barrel) {
+      // The last strand is on the left of the first one (a sheared barrel if the
+      // registers do not meet).
+      pairs.push_back(StrandPair{first + n - 1, first, 0, len,
+                                 shift_of(first + n - 1, first), false});
+    }
+  }
+
+  if (params.cross_links == 0) {
+    return pairs;
+  }
+
+  // A cross link pairs the upper half of the right side of a strand with the upper half
+  // of the left side of a non-neighbouring strand of the same sheet. The neighbour pairs
+  // on those sides keep only their lower halves, and each of them is cut only once.
+  if (len < 4) {
+    throw invalid_params{"cross links need strands of at least 4 residues."};
+  }
+  std::vector<std::pair<std::size_t, std::size_t>> candidates;
+  for (std::size_t sheet = 0; sheet < params.sheets; ++sheet) {
+    for (std::size_t p0 = 0; p0 < n; ++p0) {
+      for (std::size_t p1 = p0 + 2; p1 < n; ++p1) {
+        candidates.push_back({sheet * n + p0, sheet * n + p1});
+      }
+    }
+  }
+  std::shuffle(candidates.begin(), candidates.end(), rng);
+
+  // pairs[right_side[s]] is the neighbour pair on the right side of the strand s.
+  std::vector<std::size_t> right_side(strands.size());
+  for (std::size_t i = 0; i < pairs.size(); ++i) {
+    if (pairs[i].str1 == pairs[i].str0 + 1) {
+      right_side[pairs[i].str0] = i;
+    }
+  }
+  std::vector<bool> cut(pairs.size(), false);
+
+  std::size_t n_links = 0;
+  for (auto const& c : candidates) {
+    if (n_links == params.cross_links) {
+      break;
+    }
+    auto const right = right_side[c.first];
+    auto const left = right_side[c.second - 1];
+    if (cut[right] or cut[left]) {
+      continue;
+    }
+    cut[right] = cut[left] = true;
+    pairs[right].hi = pairs[left].hi = len / 2;
+    pairs.push_back(StrandPair{c.first, c.second, len / 2, len,
+                               shift_of(c.first, c.second), true});
+    ++n_links;
+  }
+  if (n_links < params.cross_links) {
+    throw invalid_params{"only " + std::to_string(n_links) + " cross links can be placed."};
+  }
+  return pairs;
+}
+
+} // namespace
+
+
+
+// **************************************************************************
+// Function generate()
+// **************************************************************************
+
+Structure generate(Params const& params) {
+  validate(params);
+
+  std::mt19937 rng{params.seed};
+  auto strands = place_strands(params, rng);
+  auto const pairs = pair_strands(params, strands, rng);
+
+  auto const n = params.strands;
+  auto const len = params.strand_len;
+  double const barrel_radius = std::max(strand_gap * static_cast<double>(n) / (2.0 * M_PI),
+                                        strand_gap);
+  double const sheet_width = params.barrel ? 2.0 * barrel_radius :
+                                             strand_gap * static_cast<double>(n - 1);
+
+  // The coordinates of the residue at the level t of the strand s, and the direction
+  // pointing away from the sheet (to place the helices).
+  auto const strand_atom = [&](Strand const& s, std::size_t const t) {
+    double const x0 = static_cast<double>(s.sheet) * (sheet_width + sheet_gap);
+    double const z = strand_rise * static_cast<double>(t);
+    double const bump = pleat * static_cast<double>(t % 2);
+    if (params.barrel) {
+      double const a = 2.0 * M_PI * static_cast<double>(s.pos) / static_cast<double>(n);
+      double const r = barrel_radius + bump;
+      return Point{x0 + barrel_radius + r * std::cos(a), r * std::sin(a), z};
+    }
+    return Point{x0 + strand_gap * static_cast<double>(s.pos), bump, z};
+  };
+  auto const outward = [&](Strand const& s, std::size_t const n_helices) {
+    if (params.barrel) {
+      double const a = 2.0 * M_PI * static_cast<double>(s.pos) / static_cast<double>(n);
+      return Point{std::cos(a), std::sin(a), 0.0};
+    }
+    // alternate the faces of the sheet
+    return Point{0.0, n_helices % 2 == 0 ? 1.0 : -1.0, 0.0};
+  };
+
+  // The order of the strands along the chain.
+  std::vector<std::size_t> order(strands.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (params.shuffle) {
+    std::shuffle(order.begin(), order.end(), rng);
+  }
+
+  // Lay out the SSEs.
+  std::vector<Block> blocks;
+  std::size_t n_helices = 0;
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    auto const& s = strands[order[i]];
+    Block strand{'E', {}, order[i]};
+    for (std::size_t k = 0; k < len; ++k) {
+      strand.atoms.push_back(strand_atom(s, s.up ? k : len - 1 - k));
+    }
+    auto const last = strand.atoms.back();
+    blocks.push_back(std::move(strand));
+
+    if (params.helix_every != 0 and (i + 1) % params.helix_every == 0) {
+      auto const dir = outward(s, n_helices++);
+      Block helix{'H', {}, 0};
+      for (std::size_t k = 0; k < params.helix_len; ++k) {
+        double const a = static_cast<double>(k) * 100.0 / 180.0 * M_PI;
+        double const r = helix_offset + helix_radius * std::sin(a);
+        helix.atoms.push_back(Point{last.x + dir.x * r + helix_radius * std::cos(a),
+                                    last.y + dir.y * r,
+                                    helix_rise * static_cast<double>(k)});
+      }
+      blocks.push_back(std::move(helix));
+    }
+  }
+
+  // Assign the residue numbers and write the ATOM and LOC records.
+  Structure ret;
+  std::ostringstream pdb_oss;
+  std::ostringstream loc_oss;
+  int resnum = 1;
+  auto const atom = [&pdb_oss, &resnum](Point const& p) {
+    if (resnum > max_resnum) {
+      throw invalid_params{"more than " + std::to_string(max_resnum) + " residues."};
+    }
+    pdb_oss << boost::format("ATOM  %5d  CA  ALA A%4d    %8.3f%8.3f%8.3f  1.00  0.00"
+                             "           C\n") % resnum % resnum % p.x % p.y % p.z;
+    ++resnum;
+  };
+
+  for (std::size_t b = 0; b < blocks.size(); ++b) {
+    auto const& block = blocks[b];
+
+    // loop from the previous SSE
+    if (b != 0) {
+      auto const& from = blocks[b - 1].atoms.back();
+      auto const& to = block.atoms.front();
+      for (std::size_t k = 1; k <= params.loop_len; ++k) {
+        double const f = static_cast<double>(k) / static_cast<double>(params.loop_len + 1);
+        atom(Point{from.x + (to.x - from.x) * f, from.y + (to.y - from.y) * f + 3.0,
+                   from.z + (to.z - from.z) * f});
+      }
+    }
+
+    int const init = resnum;
+    for (auto const& p : block.atoms) {
+      atom(p);
+    }
+    loc_oss << boost::format("LOC  %-17s%-18d%-5d\n")
+               % (block.type == 'E' ? "Strand" : "AlphaHelix") % init % (resnum - 1);
+
+    if (block.type == 'E') {
+      strands[block.strand].init = init;
+      strands[block.strand].sse = ret.n_sses;
+    }
+    ++ret.n_sses;
+  }
+  pdb_oss << "END\n";
+  ret.pdb = pdb_oss.str();
+
+  // The hydrogen bonds of each pair.
+  // The residue number at the level t of the strand s.
+  auto const res = [len](Strand const& s, std::size_t const t) {
+    return s.init + static_cast<int>(s.up ? t : len - 1 - t);
+  };
+  std::ostringstream dnr_oss;
+  auto const dnr = [&dnr_oss](int const donor, int const acceptor) {
+    dnr_oss << boost::format("DNR ALA A  %4d %4d ->  ALA A %4d %4d   2.9\n")
+               % donor % (donor - 1) % acceptor % (acceptor - 1);
+  };
+  auto const in_strand = [len](long const t) { return 0 <= t and t < static_cast<long>(len); };
+  for (auto const& pair : pairs) {
+    auto const& s0 = strands[pair.str0];
+    auto const& s1 = strands[pair.str1];
+    if (s0.up == s1.up) {
+      // parallel: the bridge (i, j) is made of N(j) -> O(i - 1) and N(i + 1) -> O(j),
+      // where i - 1 is the previous residue along the chain.
+      long const prev = s0.up ? -1 : 1;
+      for (std::size_t t = pair.lo + (s0.reg + 1 + pair.lo) % 2; t < pair.hi; t += 2) {
+        long const t0 = static_cast<long>(t);
+        long const t1 = t0 + pair.shift;
+        if (not in_strand(t1)) {
+          continue;
+        }
+        if (in_strand(t0 + prev)) {
+          dnr(res(s1, t1), res(s0, t0 + prev));
+        }
+        if (in_strand(t0 - prev)) {
+          dnr(res(s0, t0 - prev), res(s1, t1));
+        }
+      }
+    } else {
+      // antiparallel: a pair of hydrogen bonds at every other level
+      for (std::size_t t = pair.lo + (s0.reg + pair.lo) % 2; t < pair.hi; t += 2) {
+        auto const t1 = t + pair.shift;
+        if (in_strand(static_cast<long>(t1))) {
+          dnr(res(s0, t), res(s1, t1));
+          dnr(res(s1, t1), res(s0, t));
+        }
+      }
+    }
+  }
+  ret.stride = loc_oss.str() + "ASG  (synthetic structure)\n" + dnr_oss.str();
+
+  // The ground truth.
+  std::ostringstream truth_oss;
+  truth_oss << "#\nloop_\n_truth_sheet.Sheet_ID\n_truth_sheet.N_strands\n"
+               "_truth_sheet.Barrel\n_truth_sheet.Member\n";
+  for (std::size_t sheet = 0; sheet < params.sheets; ++sheet) {
+    std::string members;
+    for (std::size_t pos = 0; pos < n; ++pos) {
+      members += (pos == 0 ? "" : ",") + std::to_string(strands[sheet * n + pos].sse);
+    }
+    truth_oss << boost::format("%3d %4d %s '%s'\n")
+                 % sheet % n % (params.barrel ? "T" : "F") % members;
+  }
+  truth_oss << "\n#\nloop_\n_truth_pair.SSE_ID1\n_truth_pair.SSE_ID2\n"
+               "_truth_pair.PorA\n_truth_pair.Cross_link\n";
+  for (auto const& pair : pairs) {
+    auto const& s0 = strands[pair.str0];
+    auto const& s1 = strands[pair.str1];
+    truth_oss << boost::format("%6d %6d %s %s\n")
+                 % std::min(s0.sse, s1.sse) % std::max(s0.sse, s1.sse)
+                 % (s0.up == s1.up ? "P" : "A") % (pair.cross_link ? "T" : "F");
+  }
+  ret.truth = truth_oss.str();
+
+  return ret;
+} // function generate()
+
+
+
+// **************************************************************************
+// Function write()
+// **************************************************************************
+
+void write(Structure const& structure, std::string const& prefix) {
+  for (auto const& file : {std::make_pair(".pdb", &structure.pdb),
+                           std::make_pair(".stride", &structure.stride),
+                           std::make_pair(".truth", &structure.truth)}) {
+    std::ofstream ofs{prefix + file.first};
+    if (not ofs) {
+      throw pdb::open_file_error{prefix + file.first, "In synth::write()"};
+    }
+    ofs << *file.second;
+  }
+} // function write()
+
+} // namespace synth
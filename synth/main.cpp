@@ -0,0 +1,82 @@
+// Distributed under the MIT License.
+// See LICENSE.txt for details.
+
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include "synth/generator.h"
+
+namespace bpo = boost::program_options;
+
+int main(int const argc, char * const * argv) {
+  synth::Params params;
+
+  bpo::options_description opts{"Usage: STRIDE2TOP_SYNTH [options] PREFIX\n"
+                                "Write PREFIX.pdb, PREFIX.stride and PREFIX.truth.\n\n"
+                                "Option Descriptions"};
+  opts.add_options()
+    ("help,h", "Show this help message and exit.")
+
+    ("sheets", bpo::value<std::size_t>(&params.sheets)->default_value(params.sheets),
+     "The number of sheets (or barrels).")
+
+    ("strands,n", bpo::value<std::size_t>(&params.strands)->default_value(params.strands),
+     "The number of strands in each sheet.")
+
+    ("length,l", bpo::value<std::size_t>(&params.strand_len)->default_value(params.strand_len),
+     "The number of residues of each strand.")
+
+    ("pattern,p", bpo::value<std::string>(&params.pattern)->default_value(params.pattern),
+     "The orientation of each pair of neighbouring strands: a string of 'a' (antiparallel) "
+     "and 'p' (parallel) repeated cyclically, or 'random'.")
+
+    ("barrel,b", bpo::bool_switch(&params.barrel),
+     "Close each sheet into a barrel.")
+
+    ("helix-every", bpo::value<std::size_t>(&params.helix_every)->default_value(0),
+     "Insert a helix after every this many strands along the chain. 0 for no helices.")
+
+    ("helix-length",
+     bpo::value<std::size_t>(&params.helix_len)->default_value(params.helix_len),
+     "The number of residues of each helix.")
+
+    ("loop-length", bpo::value<std::size_t>(&params.loop_len)->default_value(params.loop_len),
+     "The number of residues of each loop.")
+
+    ("shuffle", bpo::bool_switch(&params.shuffle),
+     "Visit the strands in a random order along the chain instead of one sheet after "
+     "another from edge to edge.")
+
+    ("cross-links", bpo::value<std::size_t>(&params.cross_links)->default_value(0),
+     "The number of extra pairs between non-neighbouring strands of the same sheet.")
+
+    ("seed", bpo::value<unsigned>(&params.seed)->default_value(params.seed),
+     "The seed of the random choices.")
+
+    ("prefix", bpo::value<std::string>(), "The prefix of the output files.")
+    ;
+
+  bpo::positional_options_description p_opts;
+  p_opts.add("prefix", 1);
+
+  try {
+    bpo::variables_map vm;
+    bpo::store(bpo::command_line_parser(argc, argv).options(opts).positional(p_opts).run(), vm);
+    bpo::notify(vm);
+
+    if (vm.count("help") or vm.count("prefix") == 0) {
+      std::cout << opts << std::endl;
+      return vm.count("help") ? 0 : 1;
+    }
+
+    auto const structure = synth::generate(params);
+    synth::write(structure, vm["prefix"].as<std::string>());
+    std::cerr << structure.n_sses << " SSEs\n";
+
+  } catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}